@@ -5,6 +5,7 @@ include(EnumOption)
 # Define Enum Options
 #--------------------------------------------------------------------
 enum_option(WINDOW_SYSTEM "GLFW;" "Select the windowing system to use.")
+enum_option(LOG_MIN_LEVEL "ALL;TRACE;DEBUG;INFO;WARNING;ERROR;FATAL;NONE" "Lowest log level compiled into TRACELOG calls.")
 
 #--------------------------------------------------------------------
 # Build Options
@@ -15,6 +16,7 @@ option(USE_CCACHE "Enable compiler cache that can drastically improve build time
 option(CCACHE_OPTIONS "Compiler cache options" "CCACHE_CPP2=true;CCACHE_SLOPPINESS=clang_index_store")
 
 option(LOG_SUPPORT "Enable Vultra logging system" ON)
+option(PROFILE_SUPPORT "Enable Vultra CPU profiling zones" ON)
 
 #--------------------------------------------------------------------
 # Sanitize Options
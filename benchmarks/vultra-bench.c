@@ -0,0 +1,664 @@
+/*******************************************************************************************
+*
+*   Vultra Benchmarks - Headless Benchmark Suite
+*
+*   Initially created with Vultra v25.0.0
+*
+*   Runs fixed workloads on a headless context and writes their timings as JSON, to track
+*   performance across engine versions. With a baseline, every metric is printed with its change
+*   (positive when worse), the ones worse than the threshold are regressions and fail the run:
+*
+*       vultra-bench [-o results.json] [-c baseline.json] [-t percent] [-f frames]
+*
+*       -o results  Write the JSON results to a file instead of the standard output
+*       -c baseline Compare against results written by a previous run
+*       -t percent  Regression threshold, 10 by default
+*       -f frames   Frames measured by the frame workloads, 600 by default
+*
+*   A workload that cannot complete (textures never fully resident) also fails the run.
+*
+*   Runs without a GPU on lavapipe (see examples/core/headless.c). Compare runs of the same
+*   machine and driver only, the absolute numbers mean nothing across them.
+*
+*   Licensed under the zlib/libpng license.
+*   Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+*
+********************************************************************************************/
+
+#include "vultra/vultra.h"
+#include "vultra/vvul.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_WIDTH         1280
+#define BENCH_HEIGHT        720
+#define BENCH_WARMUP_FRAMES 30           // Frames run before measuring, filling the pools and caches
+#define BENCH_SMALL_DRAWS   10000        // Rectangles per frame of the small draws workload
+#define BENCH_UPLOAD_SIZE   ( 32 << 20 ) // Bytes per upload of the buffer upload workload
+#define BENCH_UPLOADS       16
+#define BENCH_POLLS         100000
+#define BENCH_MESSAGES      200000
+#define BENCH_STREAM_COUNT  256  // Textures of the streaming workload, drawn every frame
+#define BENCH_STREAM_SIZE   256  // Their size: 3 swaps each (tail, 128, 256), dozens per frame
+#define BENCH_STREAM_FRAMES 1200 // Frames allowed to reach full residency
+#define BENCH_MAX_METRICS   6
+#define BENCH_MAX_RESULTS   8
+
+// Metric of a workload, compared against the baseline by name
+typedef struct BenchMetric
+{
+    const char * name;
+    double       value;
+    bool         higherIsBetter;
+} BenchMetric;
+
+// Result of a workload
+typedef struct BenchResult
+{
+    const char * name;
+    int          iterations;
+    BenchMetric  metrics[BENCH_MAX_METRICS];
+    int          metricCount;
+    bool         failed; // The workload did not complete, its metrics are partial
+} BenchResult;
+
+// Draws of a frame workload, between BeginDrawing() and EndDrawing()
+typedef void ( *BenchDrawCallback )( void );
+
+//----------------------------------------------------------------------------------------------------------------------
+// Allocation counting, through the linker wrappers set by CMakeLists.txt
+//----------------------------------------------------------------------------------------------------------------------
+#if defined( BENCH_COUNT_ALLOCATIONS )
+void * __real_malloc( size_t size );
+void * __real_calloc( size_t count, size_t size );
+void * __real_realloc( void * pointer, size_t size );
+
+static long allocationCount = 0;
+
+void *
+__wrap_malloc( size_t size )
+{
+    __atomic_fetch_add( &allocationCount, 1, __ATOMIC_RELAXED );
+    return __real_malloc( size );
+}
+
+void *
+__wrap_calloc( size_t count, size_t size )
+{
+    __atomic_fetch_add( &allocationCount, 1, __ATOMIC_RELAXED );
+    return __real_calloc( count, size );
+}
+
+void *
+__wrap_realloc( void * pointer, size_t size )
+{
+    __atomic_fetch_add( &allocationCount, 1, __ATOMIC_RELAXED );
+    return __real_realloc( pointer, size );
+}
+
+// Get the heap allocations made so far
+static long
+GetAllocationCount( void )
+{
+    return __atomic_load_n( &allocationCount, __ATOMIC_RELAXED );
+}
+#else
+// Allocations are not counted on this platform
+static long
+GetAllocationCount( void )
+{
+    return -1;
+}
+#endif
+
+// Allocations per iteration since a count, -1 when not counted
+static double
+AllocationsSince( long start, int iterations )
+{
+    return ( 0 > start ) ? -1.0 : (double)( GetAllocationCount() - start ) / (double)iterations;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Results
+//----------------------------------------------------------------------------------------------------------------------
+// Add a metric to a result
+static void
+AddMetric( BenchResult * result, const char * name, double value, bool higherIsBetter )
+{
+    if( BENCH_MAX_METRICS <= result->metricCount ) return;
+
+    BenchMetric * metric   = &result->metrics[result->metricCount++];
+    metric->name           = name;
+    metric->value          = value;
+    metric->higherIsBetter = higherIsBetter;
+}
+
+// Write the results as JSON, one workload per line
+static void
+WriteResults( FILE * file, const BenchResult * results, int count )
+{
+    const VkPhysicalDeviceProperties * properties = vGetDeviceProperties();
+
+    fprintf( file, "{\n" );
+    fprintf( file, "  \"vultra\": \"%s\",\n", VULTRA_VERSION );
+    fprintf( file, "  \"device\": \"%s\",\n", ( NULL != properties ) ? properties->deviceName : "unknown" );
+    fprintf( file, "  \"workers\": %d,\n", GetWorkerCount() );
+    fprintf( file, "  \"workloads\": [\n" );
+
+    for( int i = 0; i < count; ++i )
+        {
+            const BenchResult * result = &results[i];
+
+            fprintf( file, "    { \"name\": \"%s\", \"iterations\": %d", result->name, result->iterations );
+            if( result->failed ) fprintf( file, ", \"failed\": true" );
+            for( int m = 0; m < result->metricCount; ++m )
+                {
+                    fprintf( file, ", \"%s\": %.9g", result->metrics[m].name, result->metrics[m].value );
+                }
+            fprintf( file, " }%s\n", ( i + 1 < count ) ? "," : "" );
+        }
+
+    fprintf( file, "  ]\n}\n" );
+}
+
+// Read a whole file, NUL terminated, NULL on failure
+static char *
+ReadWholeFile( const char * path )
+{
+    FILE * file = fopen( path, "rb" );
+    char * data = NULL;
+    long   size = 0;
+
+    if( NULL == file ) return NULL;
+
+    if( 0 == fseek( file, 0, SEEK_END ) && 0 <= ( size = ftell( file ) ) && 0 == fseek( file, 0, SEEK_SET ) )
+        {
+            data = (char *)malloc( (size_t)size + 1 );
+            if( NULL != data && (size_t)size != fread( data, 1, (size_t)size, file ) )
+                {
+                    free( data );
+                    data = NULL;
+                }
+            if( NULL != data ) data[size] = '\0';
+        }
+
+    fclose( file );
+    return data;
+}
+
+// Find a metric of a workload in results written by WriteResults()
+static bool
+FindBaselineMetric( const char * json, const char * workload, const char * metric, double * value )
+{
+    char key[128];
+
+    snprintf( key, sizeof( key ), "\"name\": \"%s\"", workload );
+    const char * object = strstr( json, key );
+    if( NULL == object ) return false;
+
+    const char * end = strchr( object, '}' );
+    snprintf( key, sizeof( key ), "\"%s\":", metric );
+    const char * field = strstr( object, key );
+    if( NULL == field || ( NULL != end && field > end ) ) return false;
+
+    *value = strtod( field + strlen( key ), NULL );
+    return true;
+}
+
+// Compare the results against a baseline, returns the regressions found, -1 if the baseline cannot be read
+static int
+CompareResults( const BenchResult * results, int count, const char * path, double threshold )
+{
+    char * json = ReadWholeFile( path );
+    if( NULL == json )
+        {
+            fprintf( stderr, "vultra-bench: cannot read %s\n", path );
+            return -1;
+        }
+
+    int regressions = 0;
+    for( int i = 0; i < count; ++i )
+        {
+            for( int m = 0; m < results[i].metricCount; ++m )
+                {
+                    const BenchMetric * metric   = &results[i].metrics[m];
+                    double              baseline = 0.0;
+
+                    if( !FindBaselineMetric( json, results[i].name, metric->name, &baseline ) ) continue;
+                    if( 0.0 > baseline || 0.0 > metric->value ) continue; // Not measured
+
+                    // Relative change, positive when worse. Counts from zero regress on any increase
+                    double worse = metric->higherIsBetter ? baseline - metric->value : metric->value - baseline;
+                    if( 0.0 < baseline ) worse = 100.0 * worse / baseline;
+                    else worse = ( 0.5 < worse ) ? 100.0 * worse : 0.0;
+
+                    const bool regressed = ( worse > threshold );
+                    if( regressed ) ++regressions;
+
+                    fprintf( stderr, "vultra-bench: %-14s %-20s %12.6g -> %12.6g %+7.1f%%%s\n", results[i].name,
+                             metric->name, baseline, metric->value, worse, regressed ? "  REGRESSION" : "" );
+                }
+        }
+
+    free( json );
+    return regressions;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Workloads
+//----------------------------------------------------------------------------------------------------------------------
+// qsort comparison of two durations
+static int
+CompareTimes( const void * a, const void * b )
+{
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+
+    return ( x > y ) - ( x < y );
+}
+
+static void
+DrawNothing( void )
+{
+}
+
+static void
+DrawClear( void )
+{
+    ClearBackground( (Color){ 0.1F, 0.2F, 0.3F, 1.0F } );
+}
+
+static void
+DrawSmallRectangles( void )
+{
+    ClearBackground( (Color){ 0.0F, 0.0F, 0.0F, 1.0F } );
+    for( int i = 0; i < BENCH_SMALL_DRAWS; ++i )
+        {
+            const int x = ( i * 37 ) % ( BENCH_WIDTH - 8 );
+            const int y = ( i * 101 ) % ( BENCH_HEIGHT - 8 );
+            DrawRectangle( x, y, 8, 8, (Color){ (float)( i & 255 ) / 255.0F, 0.5F, 1.0F, 1.0F } );
+        }
+}
+
+// Run frames of a draw callback: frame time, time spent in EndDrawing() (recording end and submission)
+static BenchResult
+RunFrames( const char * name, int frames, BenchDrawCallback draw, int quadsPerFrame )
+{
+    BenchResult result = { 0 };
+    result.name        = name;
+    result.iterations  = frames;
+
+    double * times = (double *)malloc( (size_t)frames * sizeof( double ) );
+    if( NULL == times ) return result;
+
+    for( int i = 0; i < BENCH_WARMUP_FRAMES; ++i )
+        {
+            BeginDrawing();
+            draw();
+            EndDrawing();
+        }
+
+    const long allocations = GetAllocationCount();
+    double     submitTime  = 0.0;
+    double     totalTime   = 0.0;
+
+    for( int i = 0; i < frames; ++i )
+        {
+            const double start = GetTime();
+            BeginDrawing();
+            draw();
+            const double submit = GetTime();
+            EndDrawing();
+            const double end = GetTime();
+
+            times[i] = end - start;
+            totalTime += times[i];
+            submitTime += end - submit;
+        }
+
+    const double allocationsPerFrame = AllocationsSince( allocations, frames );
+
+    qsort( times, (size_t)frames, sizeof( double ), CompareTimes );
+    AddMetric( &result, "frame_ms", 1000.0 * totalTime / frames, false );
+    AddMetric( &result, "frame_p99_ms", 1000.0 * times[( frames * 99 ) / 100], false );
+    AddMetric( &result, "submit_ms", 1000.0 * submitTime / frames, false );
+    // Quads, not draw calls: the batcher merges them into a few instanced draws per frame
+    if( 0 < quadsPerFrame ) AddMetric( &result, "quads_per_second", (double)quadsPerFrame * frames / totalTime, true );
+    AddMetric( &result, "allocations", allocationsPerFrame, false );
+
+    free( times );
+    return result;
+}
+
+// Upload a large device local buffer through the staging ring, waiting for each upload to complete
+static BenchResult
+RunBufferUploads( void )
+{
+    BenchResult result = { 0 };
+    result.name        = "buffer_upload";
+    result.iterations  = BENCH_UPLOADS;
+
+    const VkDeviceSize size   = BENCH_UPLOAD_SIZE;
+    VkBuffer           buffer = VK_NULL_HANDLE;
+    vvulAllocation     memory = { 0 };
+
+    VkBufferCreateInfo bufferInfo = { 0 };
+    bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size               = size;
+    bufferInfo.usage              = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferInfo.sharingMode        = VK_SHARING_MODE_EXCLUSIVE;
+
+    unsigned char * data = (unsigned char *)malloc( (size_t)size );
+    if( NULL == data || VK_SUCCESS != vkCreateBuffer( vGetDevice(), &bufferInfo, NULL, &buffer ) )
+        {
+            free( data );
+            return result;
+        }
+
+    if( !vAllocateBufferMemory( buffer, VVUL_MEMORY_GPU_ONLY, &memory ) )
+        {
+            vkDestroyBuffer( vGetDevice(), buffer, NULL );
+            free( data );
+            return result;
+        }
+
+    for( size_t i = 0; i < (size_t)size; ++i ) data[i] = (unsigned char)( i * 131 );
+
+    const long allocations = GetAllocationCount();
+    double     uploadTime  = 0.0;
+
+    for( int i = 0; i < BENCH_UPLOADS; ++i )
+        {
+            const double start = GetTime();
+            vWaitUpload( vUploadBuffer( buffer, 0, data, size ) );
+            uploadTime += GetTime() - start;
+
+            // Frames between the uploads acquire the buffer on the graphics queue and recycle the staging ring
+            BeginDrawing();
+            EndDrawing();
+        }
+
+    const double allocationsPerUpload = AllocationsSince( allocations, BENCH_UPLOADS );
+
+    AddMetric( &result, "upload_ms", 1000.0 * uploadTime / BENCH_UPLOADS, false );
+    AddMetric( &result, "upload_mb_per_s", (double)size * BENCH_UPLOADS / ( 1024.0 * 1024.0 ) / uploadTime, true );
+    AddMetric( &result, "allocations", allocationsPerUpload, false );
+
+    vkDeviceWaitIdle( vGetDevice() );
+    vkDestroyBuffer( vGetDevice(), buffer, NULL );
+    vFreeMemory( &memory );
+    free( data );
+
+    return result;
+}
+
+// Poll the platform events, nothing is pending on the headless platform: the fixed cost of a poll
+static BenchResult
+RunInputPolling( void )
+{
+    BenchResult result = { 0 };
+    result.name        = "input_polling";
+    result.iterations  = BENCH_POLLS;
+
+    const long   allocations = GetAllocationCount();
+    const double start       = GetTime();
+
+    for( int i = 0; i < BENCH_POLLS; ++i ) PollInputEvents();
+
+    const double time = GetTime() - start;
+
+    AddMetric( &result, "poll_us", 1000000.0 * time / BENCH_POLLS, false );
+    AddMetric( &result, "polls_per_second", BENCH_POLLS / time, true );
+    AddMetric( &result, "allocations", AllocationsSince( allocations, BENCH_POLLS ), false );
+
+    return result;
+}
+
+// Store little-endian integers
+static void
+WriteU32( unsigned char * data, uint32_t value )
+{
+    for( int i = 0; i < 4; ++i ) data[i] = (unsigned char)( value >> ( 8 * i ) );
+}
+
+static void
+WriteU64( unsigned char * data, uint64_t value )
+{
+    for( int i = 0; i < 8; ++i ) data[i] = (unsigned char)( value >> ( 8 * i ) );
+}
+
+// Write a single level RGBA8 KTX2 file, the mips are built by the loader
+static bool
+WriteStreamTexture( const char * path, int seed )
+{
+    static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    unsigned char  header[80 + 24] = { 0 }; // Header, index and the level index of level 0
+    unsigned char  row[BENCH_STREAM_SIZE * 4];
+    const uint64_t size = (uint64_t)BENCH_STREAM_SIZE * BENCH_STREAM_SIZE * 4;
+
+    memcpy( header, identifier, sizeof( identifier ) );
+    WriteU32( header + 12, 37 ); // VK_FORMAT_R8G8B8A8_UNORM
+    WriteU32( header + 16, 1 );  // typeSize
+    WriteU32( header + 20, BENCH_STREAM_SIZE );
+    WriteU32( header + 24, BENCH_STREAM_SIZE );
+    WriteU32( header + 36, 1 ); // faceCount
+    WriteU32( header + 40, 1 ); // levelCount
+    WriteU64( header + 80, sizeof( header ) );
+    WriteU64( header + 88, size );
+    WriteU64( header + 96, size );
+
+    FILE * file = fopen( path, "wb" );
+    if( NULL == file ) return false;
+
+    bool written = ( sizeof( header ) == fwrite( header, 1, sizeof( header ), file ) );
+    for( int y = 0; y < BENCH_STREAM_SIZE && written; ++y )
+        {
+            for( int x = 0; x < BENCH_STREAM_SIZE; ++x )
+                {
+                    row[4 * x + 0] = (unsigned char)( x + seed );
+                    row[4 * x + 1] = (unsigned char)( y );
+                    row[4 * x + 2] = (unsigned char)( seed * 37 );
+                    row[4 * x + 3] = 255;
+                }
+            written = ( sizeof( row ) == fwrite( row, 1, sizeof( row ), file ) );
+        }
+
+    return ( 0 == fclose( file ) ) && written;
+}
+
+// Stream textures drawn every frame until their finest mip is resident: many image swaps (and retirements) per
+// frame, then unload them all within one frame. Fails if they never become fully resident
+static BenchResult
+RunTextureStreaming( void )
+{
+    BenchResult result = { 0 };
+    result.name        = "texture_streaming";
+
+    static Texture textures[BENCH_STREAM_COUNT];
+    char           path[64];
+    double         times[BENCH_STREAM_FRAMES];
+    int            frames   = 0;
+    bool           resident = false;
+
+    for( int i = 0; i < BENCH_STREAM_COUNT; ++i )
+        {
+            snprintf( path, sizeof( path ), "vultra-bench-%03d.ktx2", i );
+            textures[i] = WriteStreamTexture( path, i ) ? LoadTexture( path ) : (Texture){ 0 };
+        }
+
+    const long allocations = GetAllocationCount();
+
+    while( !resident && frames < BENCH_STREAM_FRAMES )
+        {
+            const double start = GetTime();
+            BeginDrawing();
+            for( int i = 0; i < BENCH_STREAM_COUNT; ++i )
+                {
+                    DrawTexture( textures[i], ( i % 32 ) * 40, ( i / 32 ) * 40, (Color){ 1.0F, 1.0F, 1.0F, 1.0F } );
+                }
+            EndDrawing();
+            times[frames++] = GetTime() - start;
+
+            resident = true;
+            for( int i = 0; i < BENCH_STREAM_COUNT && resident; ++i )
+                {
+                    resident = ( 0 == GetTextureResidentMip( textures[i] ) );
+                }
+        }
+
+    const double allocationsPerFrame = AllocationsSince( allocations, frames );
+
+    // Level teardown: every texture retired within the same frame
+    BeginDrawing();
+    for( int i = 0; i < BENCH_STREAM_COUNT; ++i ) UnloadTexture( textures[i] );
+    EndDrawing();
+
+    for( int i = 0; i < BENCH_STREAM_COUNT; ++i )
+        {
+            snprintf( path, sizeof( path ), "vultra-bench-%03d.ktx2", i );
+            remove( path );
+        }
+
+    if( !resident ) fprintf( stderr, "vultra-bench: streamed textures not resident after %d frames\n", frames );
+
+    qsort( times, (size_t)frames, sizeof( double ), CompareTimes );
+    result.iterations = frames;
+    result.failed     = !resident;
+    AddMetric( &result, "frames", frames, false );
+    AddMetric( &result, "frame_p99_ms", 1000.0 * times[( frames * 99 ) / 100], false );
+    AddMetric( &result, "frame_max_ms", 1000.0 * times[frames - 1], false );
+    AddMetric( &result, "allocations", allocationsPerFrame, false );
+
+    return result;
+}
+
+// Log callback formatting into a buffer: measures TraceLog() dispatch and formatting, not the console
+static void
+FormatLogMessage( int logLevel, const char * text, va_list args )
+{
+    static char line[256];
+
+    (void)logLevel;
+    vsnprintf( line, sizeof( line ), text, args );
+}
+
+// Log callback of the whole run, keeping the standard output for the JSON results
+static void
+WriteLogMessage( int logLevel, const char * text, va_list args )
+{
+    (void)logLevel;
+    fputs( "vultra-bench: ", stderr );
+    vfprintf( stderr, text, args );
+    fputc( '\n', stderr );
+}
+
+// Log formatted messages, the level and callback of the run are restored after
+static BenchResult
+RunLogging( void )
+{
+    BenchResult result = { 0 };
+    result.name        = "logging";
+    result.iterations  = BENCH_MESSAGES;
+
+    SetTraceLogCallback( FormatLogMessage );
+    SetTraceLogLevel( LOG_INFO );
+
+    const long   allocations = GetAllocationCount();
+    const double start       = GetTime();
+
+    for( int i = 0; i < BENCH_MESSAGES; ++i )
+        {
+            TraceLog( LOG_INFO, "BENCH: Message %d of %d (%s), %.3f ms", i, BENCH_MESSAGES, "logging", 0.25 * i );
+        }
+
+    const double time = GetTime() - start;
+
+    SetTraceLogLevel( LOG_WARNING );
+    SetTraceLogCallback( WriteLogMessage );
+
+    AddMetric( &result, "message_us", 1000000.0 * time / BENCH_MESSAGES, false );
+    AddMetric( &result, "messages_per_second", BENCH_MESSAGES / time, true );
+    AddMetric( &result, "allocations", AllocationsSince( allocations, BENCH_MESSAGES ), false );
+
+    return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Program main entry point
+//----------------------------------------------------------------------------------------------------------------------
+int
+main( int argc, char ** argv )
+{
+    const char * output    = NULL;
+    const char * baseline  = NULL;
+    double       threshold = 10.0;
+    int          frames    = 600;
+
+    for( int i = 1; i < argc; ++i )
+        {
+            if( 0 == strcmp( argv[i], "-o" ) && i + 1 < argc ) output = argv[++i];
+            else if( 0 == strcmp( argv[i], "-c" ) && i + 1 < argc ) baseline = argv[++i];
+            else if( 0 == strcmp( argv[i], "-t" ) && i + 1 < argc ) threshold = atof( argv[++i] );
+            else if( 0 == strcmp( argv[i], "-f" ) && i + 1 < argc ) frames = atoi( argv[++i] );
+            else
+                {
+                    fprintf( stderr, "usage: vultra-bench [-o results.json] [-c baseline.json] [-t percent] "
+                                     "[-f frames]\n" );
+                    return EXIT_FAILURE;
+                }
+        }
+    if( 0 >= frames ) frames = 1;
+
+    SetTraceLogCallback( WriteLogMessage );
+    SetTraceLogLevel( LOG_WARNING );
+
+    SetConfigFlags( FLAG_WINDOW_HEADLESS );
+    InitWindow( BENCH_WIDTH, BENCH_HEIGHT, "Vultra: Benchmarks" );
+    SetTargetFPS( 0 );
+
+    if( VK_NULL_HANDLE == vGetDevice() )
+        {
+            fprintf( stderr, "vultra-bench: no Vulkan device\n" );
+            CloseWindow();
+            return EXIT_FAILURE;
+        }
+
+    BenchResult results[BENCH_MAX_RESULTS];
+    int         count = 0;
+
+    results[count++] = RunFrames( "empty_frame", frames, DrawNothing, 0 );
+    results[count++] = RunFrames( "clear", frames, DrawClear, 0 );
+    results[count++] = RunFrames( "small_draws", frames, DrawSmallRectangles, BENCH_SMALL_DRAWS );
+    results[count++] = RunBufferUploads();
+    results[count++] = RunTextureStreaming();
+    results[count++] = RunInputPolling();
+    results[count++] = RunLogging();
+
+    FILE * file = ( NULL != output ) ? fopen( output, "w" ) : stdout;
+    if( NULL == file ) fprintf( stderr, "vultra-bench: cannot write %s\n", output );
+    else
+        {
+            WriteResults( file, results, count );
+            if( stdout != file ) fclose( file );
+        }
+
+    CloseWindow();
+
+    int regressions = 0;
+    if( NULL != baseline )
+        {
+            regressions = CompareResults( results, count, baseline, threshold );
+            if( 0 < regressions )
+                {
+                    fprintf( stderr, "vultra-bench: %d regressions over %.1f%%\n", regressions, threshold );
+                }
+        }
+
+    bool failed = false;
+    for( int i = 0; i < count; ++i ) failed = failed || results[i].failed;
+
+    return ( NULL != file && 0 == regressions && !failed ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -16,7 +16,8 @@ if(NOT SHADERC_FOUND)
             "SHADERC_SKIP_COPYRIGHT_CHECK ON"
     )
 
-    list(APPEND LINK_DEPS $<TARGET_OBJECTS:shaderc>)
+    # Linking the target brings its include directory and glslang/SPIRV-Tools along
+    list(APPEND LINK_DEPS shaderc)
 else()
     list(APPEND LINK_DEPS ${SHADERC_LIBRARIES})
     set(INCLUDE_DEPS_DIR ${SHADERC_INCLUDE_DIRS})
@@ -0,0 +1,11 @@
+# stb is header-only and has no releases, pin a commit
+CPMAddPackage(
+    NAME stb
+    GITHUB_REPOSITORY nothings/stb
+    GIT_TAG f75e8d1cad7d90d72ef7a4661f1b994ef78b4e31
+    DOWNLOAD_ONLY YES
+)
+
+if(stb_ADDED)
+    list(APPEND INCLUDE_DEPS_DIR ${stb_SOURCE_DIR})
+endif()
@@ -0,0 +1,62 @@
+/*******************************************************************************************
+*
+*   Vultra Core Example - Headless Rendering
+*
+*   Initially created with Vultra v25.0.0
+*
+*   Demonstrates rendering without a display and reading the result back to the CPU.
+*   Runs on machines without a window system or GPU, e.g. using lavapipe:
+*       VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./headless
+*
+*   Licensed under the zlib/libpng license.
+*   Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+*
+********************************************************************************************/
+
+#include "vultra/vultra.h"
+
+#include <stdio.h>
+
+int
+main( void )
+{
+    const int screenWidth  = 640;
+    const int screenHeight = 480;
+    const int frameCount   = 60;
+
+    SetConfigFlags( FLAG_WINDOW_HEADLESS );
+    InitWindow( screenWidth, screenHeight, "Vultra: Headless Rendering" );
+
+    for( int frame = 0; frame < frameCount; ++frame )
+        {
+            BeginDrawing();
+            {
+                // ...
+            }
+            EndDrawing();
+        }
+
+    // Read back the last frame and store it as a binary PPM
+    int             width  = 0;
+    int             height = 0;
+    unsigned char * pixels = LoadScreenPixels( &width, &height );
+
+    if( NULL != pixels )
+        {
+            FILE * file = fopen( "headless.ppm", "wb" );
+            if( NULL != file )
+                {
+                    fprintf( file, "P6\n%d %d\n255\n", width, height );
+                    for( int i = 0; i < width * height; ++i )
+                        {
+                            fwrite( &pixels[i * 4], 1, 3, file ); // Drop alpha
+                        }
+                    fclose( file );
+                }
+
+            UnloadScreenPixels( pixels );
+        }
+
+    CloseWindow();
+    return EXIT_SUCCESS;
+}
@@ -28,7 +28,12 @@ main( void )
 
             BeginDrawing();
             {
-                // ...
+                ClearBackground( ( Color ){ 0.10F, 0.10F, 0.12F, 1.0F } );
+
+                DrawRectangle( 40, 40, 200, 120, ( Color ){ 0.90F, 0.30F, 0.25F, 1.0F } );
+                DrawRectangleLines( 260, 40, 200, 120, ( Color ){ 0.95F, 0.95F, 0.95F, 1.0F } );
+                DrawCircle( screenWidth / 2, screenHeight / 2 + 60, 80.0F, ( Color ){ 0.25F, 0.55F, 0.90F, 0.8F } );
+                DrawLine( 0, screenHeight - 1, screenWidth, 0, ( Color ){ 1.0F, 1.0F, 1.0F, 0.5F } );
             }
             EndDrawing();
         }
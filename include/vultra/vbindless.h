@@ -0,0 +1,85 @@
+/****************************** VBINDLESS ********************************
+ * vbindless: Global bindless resource table (descriptor indexing)
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - A single descriptor set holds every sampled image, sampler and storage buffer registered,
+ *   addressed by a stable index the shaders use directly. Bind it once per command buffer with
+ *   BindBindlessSet(), then draws only pass indices (push constants, instance data, buffers):
+ *     layout( set = 0, binding = 0 ) uniform texture2D uTextures[];
+ *     layout( set = 0, binding = 1 ) uniform sampler uSamplers[];
+ *     layout( set = 0, binding = 2 ) buffer Buffer { uint data[]; } uBuffers[];
+ *   Indices varying inside a draw need nonuniformEXT() (GL_EXT_nonuniform_qualifier).
+ * - Every frame in flight owns a copy of the set. Writes go to the copy of the frame being
+ *   recorded right away (the bindings are update-after-bind) and to the other copies when their
+ *   frame begins, so a set is never written while the GPU may read it.
+ * - Requires Vulkan 1.2 descriptor indexing, see IsBindlessSupported().
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#ifndef VBINDLESS_H
+#define VBINDLESS_H
+
+#include "vultra/vultra.h"
+
+#include <stdint.h>
+
+#include <vulkan/vulkan.h>
+
+#define BINDLESS_INDEX_NONE UINT32_MAX // Invalid index
+
+// Bindings of the bindless set
+#define BINDLESS_BINDING_TEXTURES 0 // texture2D array
+#define BINDLESS_BINDING_SAMPLERS 1 // sampler array
+#define BINDLESS_BINDING_BUFFERS  2 // Storage buffer array
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------------------------------------------
+
+CXX_GUARD_START
+
+VAPI bool                  IsBindlessSupported( void );  // Check if the bindless table is available
+VAPI VkDescriptorSetLayout GetBindlessSetLayout( void ); // Get the set layout, for pipeline layouts
+VAPI VkDescriptorSet       GetBindlessSet( void );       // Get the set of the frame being recorded
+
+// Bind the set of the frame being recorded at a set number of a pipeline layout
+VAPI void BindBindlessSet( VkCommandBuffer cmd, VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t set );
+
+// Register resources, BINDLESS_INDEX_NONE when the table is full or unavailable
+VAPI uint32_t BindlessAddTexture( VkImageView view, VkImageLayout layout ); // Sampled image
+VAPI uint32_t BindlessAddSampler( VkSampler sampler );
+VAPI uint32_t BindlessAddBuffer( VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range ); // Storage buffer
+
+// Replace the resource behind an index, frames already recorded keep the previous one
+VAPI void BindlessUpdateTexture( uint32_t index, VkImageView view, VkImageLayout layout );
+VAPI void BindlessUpdateBuffer( uint32_t index, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range );
+
+// Release indices, reused from the next frame on (the resources must outlive the frames in flight)
+VAPI void BindlessRemoveTexture( uint32_t index );
+VAPI void BindlessRemoveSampler( uint32_t index );
+VAPI void BindlessRemoveBuffer( uint32_t index );
+
+CXX_GUARD_END
+
+#endif // VBINDLESS_H
@@ -0,0 +1,93 @@
+/******************************** VCULL **********************************
+ * vcull: CPU culling and transform kernels over structures of arrays
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - Objects are stored as structures of arrays: element k of object i is array[k][i]. Arrays are
+ *   64 byte aligned and can be filled directly, AddCullObject() is only a convenience.
+ * - Every kernel has a scalar version (on top of cglm) and SSE2, AVX2 + FMA or NEON versions,
+ *   whichever the CPU runs. AVX2 is detected at runtime, the best kernels are picked on first use.
+ * - UpdateCullBounds() transforms the local bounding boxes by the world transforms into world
+ *   boxes and spheres, both cull functions read those. Call it after moving objects.
+ * - Transforms are 3x4 row-major affine matrices (as vscene), viewProjection and the matrix of
+ *   TransformPoints() column-major 4x4 (cglm mat4) mapping to Vulkan clip space, depth 0 to 1.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#ifndef VCULL_H
+#define VCULL_H
+
+#include "vultra/vultra.h"
+
+#include <stdint.h>
+
+#define CULL_NONE UINT32_MAX // Invalid object
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Objects to cull, every array holds capacity floats
+typedef struct CullObjects
+{
+    float * world[12];      // World transforms, 3x4 row-major affine
+    float * center[3];      // Local bounding box center
+    float * extent[3];      // Local bounding box half size
+    float * worldCenter[3]; // World bounding box and sphere center, written by UpdateCullBounds()
+    float * worldExtent[3]; // World bounding box half size, written by UpdateCullBounds()
+    float * worldRadius;    // World bounding sphere radius, written by UpdateCullBounds()
+
+    uint32_t count;
+    uint32_t capacity;
+    void *   memory; // Allocation backing the arrays
+} CullObjects;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------------------------------------------
+
+CXX_GUARD_START
+
+VAPI CullObjects * LoadCullObjects( uint32_t capacity ); // NULL on failure
+VAPI void          UnloadCullObjects( CullObjects * objects );
+
+// Append an object from its world transform and local bounds, CULL_NONE when full
+VAPI uint32_t AddCullObject( CullObjects * objects, const float world[12], const float boundsMin[3],
+                             const float boundsMax[3] );
+VAPI void     SetCullObjectTransform( CullObjects * objects, uint32_t object, const float world[12] );
+VAPI void     UpdateCullBounds( CullObjects * objects ); // Transform every local box into world bounds
+
+// Write the indices of the objects inside the frustum, visible holds objects->count indices. Spheres are cheaper,
+// boxes tighter
+VAPI uint32_t CullSpheres( const CullObjects * objects, const float viewProjection[16], uint32_t * visible );
+VAPI uint32_t CullBoxes( const CullObjects * objects, const float viewProjection[16], uint32_t * visible );
+
+// Transform count points (w = 1) by a 4x4 matrix, outW may be NULL. Outputs must not alias the inputs
+VAPI void TransformPoints( const float matrix[16], uint32_t count, const float * x, const float * y, const float * z,
+                           float * outX, float * outY, float * outZ, float * outW );
+
+VAPI const char * GetCullKernel( void );              // Get the kernels in use: "avx2", "sse2", "neon" or "scalar"
+VAPI bool         SetCullKernel( const char * name ); // Force kernels (benchmarks), false when the CPU lacks them
+
+CXX_GUARD_END
+
+#endif // VCULL_H
@@ -0,0 +1,129 @@
+/******************************** VGRAPH *********************************
+ * vgraph: Render graph, automatic barriers and transient memory aliasing
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - Passes are declared every frame in execution order, along with the resources they read and
+ *   write. ExecuteRenderGraph() then:
+ *   - culls the passes whose results are never used (see GraphSetSideEffect()),
+ *   - records one vkCmdPipelineBarrier2 batch before each pass, holding only the layout
+ *     transitions and the dependencies the declared accesses need (read after read is free),
+ *   - places the transient textures and buffers whose lifetimes do not overlap at the same
+ *     offsets of a single memory allocation.
+ * - Transient resources are created by the graph and stay valid for the execution only, their
+ *   contents are undefined on first use. The physical resources are kept across frames as long
+ *   as the declared transients do not change, so steady frames create nothing.
+ * - Passes record their own commands (render passes, dispatches, ...) in their callback, with
+ *   the handles returned by GraphGetImage()/GraphGetImageView()/GraphGetBuffer().
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#ifndef VGRAPH_H
+#define VGRAPH_H
+
+#include "vultra/vultra.h"
+
+#include <stdint.h>
+
+#include <vulkan/vulkan.h>
+
+#define GRAPH_RESOURCE_NONE UINT32_MAX // Invalid resource handle
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Render graph, passes and resources of a frame
+typedef struct RenderGraph RenderGraph;
+
+// Resource handle, valid until ResetRenderGraph()
+typedef uint32_t GraphResource;
+
+// How a pass accesses a resource, the stages, access flags and layout follow from it
+typedef enum
+{
+    GRAPH_ACCESS_COLOR_ATTACHMENT = 0, // Color attachment, read: blending input only
+    GRAPH_ACCESS_DEPTH_ATTACHMENT,     // Depth/stencil attachment, read: read-only depth test
+    GRAPH_ACCESS_SAMPLED,              // Sampled image in any shader stage, read only
+    GRAPH_ACCESS_STORAGE,              // Storage image or buffer in the fragment or compute stage
+    GRAPH_ACCESS_TRANSFER_SRC,         // Copy or blit source, read only
+    GRAPH_ACCESS_TRANSFER_DST,         // Copy, blit or clear destination, write only
+    GRAPH_ACCESS_VERTEX_BUFFER,        // Vertex buffer, read only
+    GRAPH_ACCESS_INDEX_BUFFER,         // Index buffer, read only
+    GRAPH_ACCESS_INDIRECT_BUFFER,      // Indirect draw/dispatch arguments, read only
+    GRAPH_ACCESS_UNIFORM_BUFFER,       // Uniform buffer in any shader stage, read only
+    GRAPH_ACCESS_COUNT
+} GraphAccess;
+
+// Transient texture, 2D with a single mip level and layer
+typedef struct GraphTextureDesc
+{
+    uint32_t          width;
+    uint32_t          height;
+    VkFormat          format;
+    VkImageUsageFlags usage; // Extra usage, the one implied by the declared accesses is added
+} GraphTextureDesc;
+
+// Transient buffer
+typedef struct GraphBufferDesc
+{
+    VkDeviceSize       size;
+    VkBufferUsageFlags usage; // Extra usage, the one implied by the declared accesses is added
+} GraphBufferDesc;
+
+// Record the commands of a pass
+typedef void ( *GraphPassCallback )( VkCommandBuffer cmd, const RenderGraph * graph, void * user );
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------------------------------------------
+
+CXX_GUARD_START
+
+VAPI RenderGraph * LoadRenderGraph( void );                // Create an empty render graph
+VAPI void          UnloadRenderGraph( RenderGraph * graph ); // Unload a graph, frames in flight are unaffected
+VAPI void          ResetRenderGraph( RenderGraph * graph ); // Clear the passes and resources, keep the physical ones
+
+// Resources
+VAPI GraphResource GraphCreateTexture( RenderGraph * graph, const char * name, const GraphTextureDesc * desc );
+VAPI GraphResource GraphCreateBuffer( RenderGraph * graph, const char * name, const GraphBufferDesc * desc );
+VAPI GraphResource GraphImportTexture( RenderGraph * graph, const char * name, VkImage image, VkImageView view,
+                                       VkFormat format, VkImageLayout layout, VkImageLayout finalLayout );
+VAPI GraphResource GraphImportBuffer( RenderGraph * graph, const char * name, VkBuffer buffer );
+
+// Passes, recorded in the order they are added
+VAPI uint32_t GraphAddPass( RenderGraph * graph, const char * name, GraphPassCallback callback, void * user );
+VAPI void     GraphRead( RenderGraph * graph, uint32_t pass, GraphResource resource, GraphAccess access );
+VAPI void     GraphWrite( RenderGraph * graph, uint32_t pass, GraphResource resource, GraphAccess access );
+VAPI void     GraphSetSideEffect( RenderGraph * graph, uint32_t pass ); // Never cull the pass
+
+// Culls, places the transients and records every pass with its barriers into cmd
+VAPI bool ExecuteRenderGraph( RenderGraph * graph, VkCommandBuffer cmd );
+
+// Physical handles, valid inside the pass callbacks
+VAPI VkImage     GraphGetImage( const RenderGraph * graph, GraphResource resource );
+VAPI VkImageView GraphGetImageView( const RenderGraph * graph, GraphResource resource );
+VAPI VkBuffer    GraphGetBuffer( const RenderGraph * graph, GraphResource resource );
+
+CXX_GUARD_END
+
+#endif // VGRAPH_H
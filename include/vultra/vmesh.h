@@ -0,0 +1,95 @@
+/******************************** VMESH **********************************
+ * vmesh: Cooked meshes, ready for the GPU
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - Cooked meshes are written offline by the vultra-cook tool (tools/): the triangles are
+ *   reordered for the post-transform vertex cache and then for overdraw, the vertices are
+ *   reordered by first use (vertex fetch locality) and quantized to 16 bytes.
+ * - Layout, little endian: MeshHeader, the vertices (MeshVertex), then the indices (uint16_t
+ *   when the mesh has 65535 vertices or less, uint32_t otherwise). Both arrays are copied to
+ *   vertex and index buffers as is, there is nothing left to convert at load time.
+ * - Positions are unsigned normalized over the mesh bounds, the shader (or the model matrix)
+ *   applies positionOffset + position * positionScale; texture coordinates likewise over their
+ *   own bounds. Normals are signed normalized.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#ifndef VMESH_H
+#define VMESH_H
+
+#include "vultra/vultra.h"
+
+#include <stdint.h>
+
+#define MESH_MAGIC   0x48534D56 // "VMSH"
+#define MESH_VERSION 1
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Cooked vertex, 16 bytes
+typedef struct MeshVertex
+{
+    uint16_t position[4]; // VK_FORMAT_R16G16B16A16_UNORM, w is unused
+    int8_t   normal[4];   // VK_FORMAT_R8G8B8A8_SNORM, w is unused
+    uint16_t texcoord[2]; // VK_FORMAT_R16G16_UNORM
+} MeshVertex;
+
+// Cooked mesh file header, 64 bytes
+typedef struct MeshHeader
+{
+    uint32_t magic;   // MESH_MAGIC
+    uint32_t version; // MESH_VERSION
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexSize; // 2 or 4 bytes
+
+    float positionScale[3];  // Mesh bounds extent
+    float positionOffset[3]; // Mesh bounds minimum
+    float texcoordScale[2];
+    float texcoordOffset[2];
+
+    uint32_t reserved; // 0
+} MeshHeader;
+
+// Cooked mesh, pointing into the cooked data
+typedef struct CookedMesh
+{
+    const MeshHeader * header;
+    const MeshVertex * vertices; // header->vertexCount vertices
+    const void *       indices;  // header->indexCount indices of header->indexSize bytes
+} CookedMesh;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------------------------------------------
+
+CXX_GUARD_START
+
+// Check cooked data (4 byte aligned, e.g. GetPackEntryData()) and point into it, false if invalid
+VAPI bool ParseCookedMesh( const void * data, uint64_t size, CookedMesh * mesh );
+
+CXX_GUARD_END
+
+#endif // VMESH_H
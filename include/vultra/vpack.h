@@ -0,0 +1,85 @@
+/******************************** VPACK **********************************
+ * vpack: Memory-mapped asset packs
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - A pack is a single file holding many assets: opening it costs one open and one mapping,
+ *   instead of one open/read per loose file. Entries are found by name through a hash sorted
+ *   index, in O(log n) and without touching the entry data.
+ * - Entries stored uncompressed are read in place from the mapping (GetPackEntryData()), no copy
+ *   is made. Compressed entries are split into independent chunks (LZ4 block format) and
+ *   decompressed in parallel by ReadPackEntry().
+ * - Entries of 64 KiB or more start on a 64 KiB boundary, smaller ones never straddle one, so
+ *   an entry never shares its pages with more neighbors than needed. The mapping is set for
+ *   random access; PrefetchPackEntry()/EvictPackEntry() tell the kernel what comes next.
+ * - Packs are built offline with the writer functions, or the vultra-pack tool (tools/).
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#ifndef VPACK_H
+#define VPACK_H
+
+#include "vultra/vultra.h"
+
+#include <stdint.h>
+
+#define PACK_ENTRY_NONE UINT32_MAX // Invalid entry
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Opened pack, read only and safe to use from any thread
+typedef struct AssetPack AssetPack;
+
+// Pack being written
+typedef struct AssetPackWriter AssetPackWriter;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------------------------------------------
+
+CXX_GUARD_START
+
+// Reading
+VAPI AssetPack * OpenAssetPack( const char * fileName ); // Map a pack, NULL if missing or invalid
+VAPI void        CloseAssetPack( AssetPack * pack );     // Unmap a pack, its entry data pointers become invalid
+
+VAPI uint32_t     GetPackEntryCount( const AssetPack * pack );
+VAPI uint32_t     FindPackEntry( const AssetPack * pack, const char * name ); // PACK_ENTRY_NONE when not found
+VAPI const char * GetPackEntryName( const AssetPack * pack, uint32_t entry );
+VAPI uint64_t     GetPackEntrySize( const AssetPack * pack, uint32_t entry ); // Uncompressed size in bytes
+
+VAPI const void * GetPackEntryData( const AssetPack * pack, uint32_t entry ); // In place, NULL when compressed
+VAPI bool ReadPackEntry( const AssetPack * pack, uint32_t entry, void * buffer, uint64_t size ); // Copy or decompress
+
+VAPI void PrefetchPackEntry( const AssetPack * pack, uint32_t entry ); // Start reading an entry from disk ahead of use
+VAPI void EvictPackEntry( const AssetPack * pack, uint32_t entry );    // Drop the cached pages of an entry
+
+// Writing
+VAPI AssetPackWriter * BeginAssetPack( const char * fileName ); // Create a pack file, NULL on failure
+VAPI bool AddPackEntry( AssetPackWriter * writer, const char * name, const void * data, uint64_t size, bool compress );
+VAPI bool EndAssetPack( AssetPackWriter * writer ); // Write the index and close, false if any entry failed
+
+CXX_GUARD_END
+
+#endif // VPACK_H
@@ -0,0 +1,62 @@
+/******************************* VRENDER *********************************
+ * vrender: Frame recording helpers on top of the Vulkan backend
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - RecordParallel() splits a draw list in contiguous batches recorded by the job workers into
+ *   secondary command buffers, then executes them in list order on the frame command buffer, so
+ *   the result does not depend on which thread recorded what.
+ * - Every worker records from its own command pool per frame in flight, recording never locks.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#ifndef VRENDER_H
+#define VRENDER_H
+
+#include "vultra/vultra.h"
+
+#include <vulkan/vulkan.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Record items [first, first + count) of a draw list, called concurrently from the job workers
+typedef void ( *RecordCallback )( VkCommandBuffer cmd, int first, int count, void * user );
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------------------------------------------
+
+CXX_GUARD_START
+
+VAPI VkCommandBuffer GetFrameCommandBuffer( void ); // Get the primary command buffer of the frame, NULL outside of one
+
+// Record a draw list across the job workers into the current frame (use between BeginDrawing and EndDrawing).
+// Draws continue the render pass described by inheritance, begun with secondary contents (NULL: the screen target,
+// see vCmdBeginTargetPass())
+VAPI bool RecordParallel( int itemCount, int minBatchSize, const VkCommandBufferInheritanceInfo * inheritance,
+                          RecordCallback callback, void * user );
+
+CXX_GUARD_END
+
+#endif // VRENDER_H
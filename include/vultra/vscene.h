@@ -0,0 +1,84 @@
+/******************************** VSCENE *********************************
+ * vscene: GPU-driven instance rendering
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - Built for scenes of 100k to 1M instances: there is no per-instance work on the CPU at draw
+ *   time. Instances (transform, mesh, color) live in a storage buffer, only the ones changed
+ *   since the last frame are copied into it.
+ * - Every mesh of a scene shares one vertex buffer and one index buffer. A compute pass culls
+ *   the instance bounding spheres against the view frustum and buckets the survivors per mesh;
+ *   a second one compacts the non-empty buckets into VkDrawIndexedIndirectCommand records and
+ *   a draw count, drawn by a single vkCmdDrawIndexedIndirectCount().
+ * - Without drawIndirectCount every mesh keeps its record (empty buckets draw 0 instances) and
+ *   one multi-draw indirect is recorded; without multiDrawIndirect, one indirect draw per mesh.
+ * - Occlusion culling runs in two phases against a hierarchical depth (Hi-Z) pyramid: the
+ *   instances visible last frame are drawn first, the pyramid is reduced from that depth in a
+ *   single dispatch, then the remaining instances test their bounding box against it and the
+ *   survivors are drawn. Nothing is read back, instances coming into view show the same frame.
+ * - DrawScene() is recorded in the 2D draw order: what is drawn before it stays behind it. The
+ *   scene clears its own depth buffer, the color of the target is kept.
+ * - Transforms are 3x4 row-major affine matrices (the last row of a 4x4 dropped), viewProjection
+ *   a column-major 4x4 (cglm mat4) mapping to Vulkan clip space: y down, depth 0 to 1.
+ *   Triangles counter-clockwise in world space are front facing.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#ifndef VSCENE_H
+#define VSCENE_H
+
+#include "vultra/vmesh.h"
+#include "vultra/vultra.h"
+
+#include <stdint.h>
+
+#define SCENE_NONE UINT32_MAX // Invalid mesh or instance
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Scene: geometry, instances and the GPU resources culling and drawing them
+typedef struct Scene Scene;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------------------------------------------
+
+CXX_GUARD_START
+
+VAPI Scene * LoadScene( uint32_t maxInstances, uint32_t maxVertices, uint32_t maxIndices ); // NULL on failure
+VAPI void    UnloadScene( Scene * scene ); // Not between DrawScene() and the end of the frame
+
+VAPI uint32_t AddSceneMesh( Scene * scene, const CookedMesh * mesh ); // Upload a mesh, SCENE_NONE when full
+VAPI uint32_t AddSceneInstance( Scene * scene, uint32_t mesh, const float transform[12], Color color );
+VAPI void     SetSceneInstanceTransforms( Scene * scene, uint32_t first, uint32_t count, const float * transforms );
+VAPI void     SetSceneInstanceColor( Scene * scene, uint32_t instance, Color color );
+VAPI void     ClearSceneInstances( Scene * scene ); // Remove every instance, the meshes are kept
+VAPI uint32_t GetSceneInstanceCount( const Scene * scene );
+
+VAPI void SetSceneOcclusion( Scene * scene, bool enabled ); // Two-phase Hi-Z occlusion culling, enabled by default
+VAPI void DrawScene( Scene * scene, const float viewProjection[16] ); // Cull and draw every instance
+
+CXX_GUARD_END
+
+#endif // VSCENE_H
@@ -0,0 +1,108 @@
+/******************************* VSHADER *********************************
+ * vshader: GLSL/HLSL to SPIR-V compilation with a persistent cache
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - Compiled SPIR-V is cached in the cache directory (see SetCacheDirectory()), keyed by a hash of
+ *   the preprocessed source (includes and defines expanded), the entry point, the compile options
+ *   and the compiler SPIR-V version. Editing any included file invalidates exactly its dependents.
+ * - CompileShaders()/LoadShaderModules() spread cache misses across the job workers.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#ifndef VSHADER_H
+#define VSHADER_H
+
+#include "vultra/vultra.h"
+
+#include <stdint.h>
+
+#include <vulkan/vulkan.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Shader stages
+typedef enum
+{
+    SHADER_STAGE_VERTEX = 0,
+    SHADER_STAGE_FRAGMENT,
+    SHADER_STAGE_COMPUTE,
+    SHADER_STAGE_GEOMETRY,
+    SHADER_STAGE_TESS_CONTROL,
+    SHADER_STAGE_TESS_EVALUATION
+} ShaderStage;
+
+// Shader source languages
+typedef enum
+{
+    SHADER_LANGUAGE_GLSL = 0,
+    SHADER_LANGUAGE_HLSL
+} ShaderLanguage;
+
+// Preprocessor definition, value may be NULL
+typedef struct ShaderDefine
+{
+    const char * name;
+    const char * value;
+} ShaderDefine;
+
+// Shader compilation parameters
+typedef struct ShaderDesc
+{
+    const char *         path;             // Source file, names the shader in errors and resolves relative includes
+    const char *         source;           // Source text (NULL: read from path)
+    const char *         includeDirectory; // Searched by #include <...> (NULL: the source directory)
+    const char *         entryPoint;       // Entry point (NULL: "main")
+    const ShaderDefine * defines;
+    int                  defineCount;
+    ShaderStage          stage;
+    ShaderLanguage       language;
+    bool                 optimize;         // Optimize for performance
+    bool                 debugInfo;        // Keep debug information (names, lines)
+} ShaderDesc;
+
+// SPIR-V binary
+typedef struct ShaderCode
+{
+    uint32_t * code; // SPIR-V words, NULL if compilation failed
+    size_t     size; // Size in bytes
+} ShaderCode;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------------------------------------------
+
+CXX_GUARD_START
+
+VAPI ShaderCode CompileShader( const ShaderDesc * desc ); // Compile a shader, or load it from the cache
+VAPI int        CompileShaders( const ShaderDesc * descs, int count, ShaderCode * codes ); // Compile in parallel
+VAPI void       UnloadShaderCode( ShaderCode code );                                       // Unload a SPIR-V binary
+
+VAPI VkShaderModule LoadShaderModule( const ShaderDesc * desc ); // Compile a shader and create its module
+VAPI int  LoadShaderModules( const ShaderDesc * descs, int count, VkShaderModule * modules ); // Load in parallel
+VAPI void UnloadShaderModule( VkShaderModule module );                                      // Destroy a module
+
+CXX_GUARD_END
+
+#endif // VSHADER_H
@@ -0,0 +1,76 @@
+/****************************** VTRANSFORM *******************************
+ * vtransform: Transform hierarchy, updated incrementally
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - Transforms are handles into flat arrays, kept in depth-first order (parents before their
+ *   children, every subtree contiguous). Only the subtrees under a changed local transform are
+ *   recomputed by UpdateTransforms(), a static scene costs nothing.
+ * - Changed subtrees are independent, they are updated in parallel on the job workers. A large
+ *   subtree is split below its root so a single moving parent still spreads over the workers.
+ * - World transforms are stored contiguously by handle, ready to upload: with handles used as
+ *   instance indices, GetWorldTransforms() feeds SetSceneInstanceTransforms() directly.
+ * - Adding, removing or reparenting transforms reorders the arrays at the next update, which
+ *   then recomputes everything: build hierarchies at load time, move them at run time.
+ * - Transforms are 3x4 row-major affine matrices (as vscene), world = parent world * local.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#ifndef VTRANSFORM_H
+#define VTRANSFORM_H
+
+#include "vultra/vultra.h"
+
+#include <stdint.h>
+
+#define TRANSFORM_NONE UINT32_MAX // Invalid transform, or no parent
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// TransformTree: local and world transforms of a hierarchy
+typedef struct TransformTree TransformTree;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------------------------------------------
+
+CXX_GUARD_START
+
+VAPI TransformTree * LoadTransformTree( uint32_t capacity ); // NULL on failure
+VAPI void            UnloadTransformTree( TransformTree * tree );
+
+VAPI uint32_t AddTransform( TransformTree * tree, uint32_t parent, const float local[12] ); // TRANSFORM_NONE when full
+VAPI void     RemoveTransform( TransformTree * tree, uint32_t transform ); // Remove with its descendants
+VAPI bool     SetTransformParent( TransformTree * tree, uint32_t transform, uint32_t parent ); // false if a cycle
+VAPI void     SetTransformLocal( TransformTree * tree, uint32_t transform, const float local[12] );
+
+VAPI uint32_t UpdateTransforms( TransformTree * tree ); // Recompute the changed subtrees, returns transforms updated
+
+// World transforms by handle (12 floats each), as of the last update, and the handles it changed
+VAPI const float * GetTransformWorld( const TransformTree * tree, uint32_t transform );
+VAPI const float * GetWorldTransforms( const TransformTree * tree, uint32_t * first, uint32_t * count );
+
+CXX_GUARD_END
+
+#endif // VTRANSFORM_H
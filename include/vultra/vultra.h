@@ -89,6 +89,11 @@
 #    define VUL_FREE( ptr ) free( ptr )
 #endif
 
+// Transient allocations, released in bulk at the end of the frame (never freed individually)
+#ifndef VUL_FRAME_MALLOC
+#    define VUL_FRAME_MALLOC( sz ) MemFrameAlloc( sz )
+#endif
+
 // C++ compatibility, preventing name mangling
 #if defined( __cplusplus )
 /* clang-format off */
@@ -135,6 +140,9 @@ typedef enum bool
 // STRUCTS
 //==============================================================================================================
 
+// Linear allocator, allocations are released in bulk by rewinding it
+typedef struct Arena Arena;
+
 // Color
 typedef struct Color
 {
@@ -144,15 +152,69 @@ typedef struct Color
     float a;
 } Color;
 
+// Vector2, 2 components
+typedef struct Vector2
+{
+    float x;
+    float y;
+} Vector2;
+
+// Rectangle, 4 components
+typedef struct Rectangle
+{
+    float x;
+    float y;
+    float width;
+    float height;
+} Rectangle;
+
+// Texture, GPU image data
+typedef struct Texture
+{
+    unsigned int id;     // Texture identifier, 0 when not loaded
+    int          width;  // Width in pixels
+    int          height; // Height in pixels
+} Texture;
+
+// Key transition, recorded by the input event queue in arrival order
+typedef struct KeyEvent
+{
+    double time;   // GetTime() when the platform delivered the transition, in seconds
+    int    key;    // KeyboardCode
+    int    action; // KeyAction
+} KeyEvent;
+
+// GPU zone timing, read back from the timestamps of a completed frame (milliseconds)
+typedef struct GpuZone
+{
+    const char * name;     // Name given to BeginGpuZone()
+    int          depth;    // Nesting depth, 0 for the frame zone
+    double       start;    // Start relative to the frame start
+    double       duration; // Time between the begin and end timestamps
+} GpuZone;
+
+// Frame pacing statistics, computed over the rolling frame time history (seconds)
+typedef struct FrameStats
+{
+    float minFrameTime; // Fastest frame in the history window
+    float avgFrameTime; // Mean frame duration
+    float p99FrameTime; // 99th percentile frame duration
+    float maxFrameTime; // Slowest frame in the history window
+    int   sampleCount;  // Number of frames the statistics were computed from
+} FrameStats;
+
 //===========================================================================================================
 // ENUMERATORS
 //===========================================================================================================
 typedef enum
 {
-    FLAG_NONE             = 0,
-    FLAG_VSYNC_HINT       = 1 << 0, // 0x01: Enable vertical sync
-    FLAG_WINDOW_RESIZABLE = 1 << 1, // 0x02: Allow window resizing
-    FLAG_MSAA_HINT        = 1 << 2  // 0x04: Enable MSAA (Multi-Sample Anti-Aliasing)
+    FLAG_NONE              = 0,
+    FLAG_VSYNC_HINT        = 1 << 0, // 0x01: Enable vertical sync
+    FLAG_WINDOW_RESIZABLE  = 1 << 1, // 0x02: Allow window resizing
+    FLAG_MSAA_HINT         = 1 << 2, // 0x04: Enable MSAA (Multi-Sample Anti-Aliasing)
+    FLAG_WINDOW_HEADLESS   = 1 << 3, // 0x08: No display required, render offscreen only (GLFW null platform)
+    FLAG_PRESENT_IMMEDIATE = 1 << 4, // 0x10: Present without waiting for vertical blank, may tear
+    FLAG_MEMORY_HUGE_PAGES = 1 << 5  // 0x20: Back memory arenas with transparent huge pages (Linux)
 } ConfigFlags;
 
 // Log levels
@@ -295,6 +357,14 @@ typedef enum
     KEY_NUM_EQUAL     = 336, // =
 } KeyboardCode;
 
+// Key transitions
+typedef enum
+{
+    KEY_ACTION_RELEASE = 0, // Key released
+    KEY_ACTION_PRESS,       // Key pressed
+    KEY_ACTION_REPEAT       // Key held down, repeated by the OS
+} KeyAction;
+
 //===========================================================================================================
 // Functions callbacks
 //===========================================================================================================
@@ -302,6 +372,9 @@ typedef enum
 // Custom trace log
 typedef void ( *TraceLogCallback )( int logLevel, const char * text, va_list args );
 
+// Job executed once per index by ParallelFor(), or once by SubmitJob()
+typedef void ( *JobCallback )( void * user, int index );
+
 //===========================================================================================================
 // FUNCTIONS DECLARATIONS
 //===========================================================================================================
@@ -311,6 +384,7 @@ CXX_GUARD_START
 //--- CORE --------------------------------------------------------------------------------------------------
 
 // Window
+VAPI void   SetConfigFlags( unsigned int flags ); // Setup init configuration flags (use before InitWindow)
 VAPI void   InitWindow( int width, int height, const char * title );
 VAPI void   CloseWindow( void );
 VAPI void   SetWindowTitle( const char * title );
@@ -319,22 +393,98 @@ VAPI void * GetWindowHandle( void );
 VAPI void   SignalClose( void );
 
 // Timing functions
-VAPI void   SetTargetFPS( int fps );
-VAPI float  GetFrameTime( void );
-VAPI double GetTime( void );
-VAPI int    GetFPS( void );
+VAPI void       SetTargetFPS( int fps );        // Set target FPS (0: unlimited)
+VAPI float      GetFrameTime( void );           // Get time in seconds for last frame drawn
+VAPI double     GetTime( void );                // Get elapsed time in seconds since InitWindow()
+VAPI int        GetFPS( void );                 // Get current FPS, averaged over the frame history
+VAPI FrameStats GetFrameStats( void );          // Get min/avg/p99/max frame times of the frame history
+VAPI void       WaitTime( double seconds );     // Wait for some time, sleeping coarsely and spinning the remainder
+
+// Graphics device
+VAPI void SetPreferredDevice( const char * device ); // Select the GPU by index or name substring (use before InitWindow)
+VAPI void SetFramesInFlight( int count );            // Set frames recorded ahead of the GPU, 1-3 (use before InitWindow)
+VAPI void SetCacheDirectory( const char * path );    // Set where persistent caches are kept, "" disables (use before InitWindow)
 
 // Drawing functions
 VAPI void BeginDrawing( void );
 VAPI void EndDrawing( void );
+VAPI void ClearBackground( Color color ); // Clear the whole screen, drawn in order with the shapes
+
+// Screen readback
+VAPI unsigned char * LoadScreenPixels( int * width, int * height ); // Read back the last drawn frame (RGBA8)
+VAPI void            UnloadScreenPixels( unsigned char * pixels );  // Unload pixels loaded with LoadScreenPixels()
 
 // Miscellaneous core functions
 VAPI void SetTraceLogCallback( TraceLogCallback callback ); // Set custom trace log
 VAPI void TraceLog( int logLevel, const char * text, ... ); // Display a log message
 VAPI void SetTraceLogLevel( int logLevel );
+VAPI void SetTraceLogAsync( bool enabled ); // Write log messages from a background thread, never blocking the caller
+VAPI void FlushTraceLog( void );            // Wait until every queued log message was written
 
 VAPI void PollInputEvents( void );
 
+//--- MEMORY ------------------------------------------------------------------------------------------------
+
+VAPI Arena * LoadArena( size_t capacity );                 // Reserve a linear allocator, pages commit on first use
+VAPI void    UnloadArena( Arena * arena );                 // Release an arena and all its allocations
+VAPI void *  ArenaAlloc( Arena * arena, size_t size );     // Allocate 16 byte aligned memory, NULL when exhausted
+VAPI size_t  ArenaMark( const Arena * arena );             // Get the current position of an arena
+VAPI void    ArenaRewind( Arena * arena, size_t mark );    // Release all allocations made after a mark
+VAPI size_t  GetArenaPeakUsage( const Arena * arena );     // Get the highest number of bytes an arena had in use
+VAPI void *  MemFrameAlloc( size_t size );                 // Allocate memory valid until EndDrawing() returns
+VAPI Arena * GetScratchArena( void );                      // Get the thread-local scratch arena (mark/rewind it)
+VAPI void    UnloadScratchArena( void );                   // Unload the calling thread scratch arena
+
+//--- SHAPES ------------------------------------------------------------------------------------------------
+
+VAPI void DrawLine( int startX, int startY, int endX, int endY, Color color );          // Draw a 1 pixel wide line
+VAPI void DrawLineEx( Vector2 start, Vector2 end, float thick, Color color );           // Draw a line of any width
+VAPI void DrawRectangle( int posX, int posY, int width, int height, Color color );      // Draw a filled rectangle
+VAPI void DrawRectangleRec( Rectangle rec, Color color );                               // Draw a filled rectangle
+VAPI void DrawRectangleLines( int posX, int posY, int width, int height, Color color ); // Draw a rectangle outline
+VAPI void DrawCircle( int centerX, int centerY, float radius, Color color );            // Draw a filled circle
+VAPI void DrawCircleV( Vector2 center, float radius, Color color );                     // Draw a filled circle
+
+//--- TEXTURES ----------------------------------------------------------------------------------------------
+
+VAPI Texture LoadTextureFromPixels( const void * pixels, int width, int height ); // Load RGBA8 pixels into a texture
+VAPI void    UnloadTexture( Texture texture ); // Unload a texture, frames still drawing it are unaffected
+VAPI bool    IsTextureValid( Texture texture ); // Check if a texture is loaded
+
+VAPI unsigned int GetTextureIndex( Texture texture ); // Get the bindless index of a texture, for custom shaders
+
+// Streaming: the file is decoded in the background and its mips uploaded lowest first, within the budgets
+VAPI Texture LoadTexture( const char * fileName ); // Load a PNG, JPEG or KTX2 file, drawable once resident
+VAPI void    SetTextureStreamingBudget( int uploadKilobytes, int residentMegabytes ); // Per frame and resident, 0: auto
+VAPI int     GetTextureResidentMip( Texture texture ); // Get the finest mip resident, -1 while none is
+
+VAPI void DrawTexture( Texture texture, int posX, int posY, Color tint );                    // Draw a texture
+VAPI void DrawTextureRec( Texture texture, Rectangle source, Vector2 position, Color tint ); // Draw a texture part
+VAPI void DrawTextureScaled( Texture texture, Rectangle source, Rectangle dest, Color tint ); // Draw a part scaled
+
+//--- JOBS --------------------------------------------------------------------------------------------------
+
+VAPI int  GetWorkerCount( void );                                  // Get the threads jobs run on, caller included
+VAPI int  GetWorkerIndex( void );                                  // Get the calling thread index, 0 on the main thread
+VAPI void ParallelFor( int count, JobCallback callback, void * user ); // Run callback for indices [0, count) in parallel
+
+VAPI void SubmitJob( JobCallback callback, void * user, int index ); // Run callback once on a worker, in the background
+VAPI void WaitJobs( void );                                          // Wait for every submitted job to complete
+
+//--- PROFILING ---------------------------------------------------------------------------------------------
+
+VAPI void BeginGpuZone( const char * name );            // Open a GPU zone in the frame command buffer (string literal)
+VAPI void EndGpuZone( void );                           // Close the innermost GPU zone
+VAPI int  GetGpuZones( GpuZone * zones, int capacity ); // Get the last completed frame zones, zone 0 is the frame
+VAPI bool BeginTraceCapture( const char * path );       // Stream profiling events into a Chrome trace JSON file
+VAPI void EndTraceCapture( void );                      // Finish the trace file
+
+// CPU instrumentation, prefer the PROFILE_* macros of vutils.h, they compile out without PROFILE_SUPPORT
+VAPI void ProfileZoneBegin( const char * name );             // Open a zone on the calling thread (string literal)
+VAPI void ProfileZoneEnd( void );                            // Close the innermost zone of the calling thread
+VAPI void ProfileCounter( const char * name, double value ); // Record a counter value
+VAPI void ProfileFrameMark( void );                          // Mark the end of a frame
+
 //--- INPUT -------------------------------------------------------------------------------------------------
 
 VAPI bool IsAnyKeyPressed( void );         // Check if any key is been pressed
@@ -343,6 +493,7 @@ VAPI bool IsKeyPressedRepeated( int key ); // Check if the given key is repeated
 VAPI bool IsKeyDown( int key );            // Check if the given key is being pressed
 VAPI bool IsKeyReleased( int key );        // Check if the given key has been released once
 VAPI bool IsKeyUp( int key );              // Check if the key is NOT being pressed
+VAPI int  GetKeyEvents( KeyEvent * events, int capacity ); // Drain the queued key transitions, oldest first
 
 CXX_GUARD_END
 
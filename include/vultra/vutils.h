@@ -6,6 +6,9 @@
  * INFO:
  * - DEFINES:
  *   - LOG_SUPPORT: Enable Logging system
+ *   - PROFILE_SUPPORT: Enable the PROFILE_* CPU instrumentation macros
+ *   - LOG_MIN_LEVEL: Lowest level TRACELOG() keeps, calls below it compile out (default: LOG_ALL).
+ *     LOG_FATAL calls are always kept, they abort the program
  *
  *                               LICENSE
  * ------------------------------------------------------------------------
@@ -34,11 +37,16 @@
 //----------------------------------------------------------------------------------------------------------------------
 // Logging Macros
 //----------------------------------------------------------------------------------------------------------------------
+#if !defined( LOG_MIN_LEVEL )
+#    define LOG_MIN_LEVEL LOG_ALL
+#endif
+
 #if defined( LOG_SUPPORT )
-#    define TRACELOG( level, ... ) TraceLog( level, __VA_ARGS__ )
+#    define TRACELOG( level, ... )                                                                                     \
+        ( ( ( level ) >= LOG_MIN_LEVEL || LOG_FATAL == ( level ) ) ? TraceLog( level, __VA_ARGS__ ) : (void)0 )
 
 #    if defined( LOG_SUPPORT_DEBUG )
-#        define TRACELOGD( ... ) TraceLog( LOG_DEBUG, __VA_ARGS__ )
+#        define TRACELOGD( ... ) TRACELOG( LOG_DEBUG, __VA_ARGS__ )
 #    else
 #        define TRACELOGD( ... ) ( (void)0 )
 #    endif
@@ -47,4 +55,41 @@
 #    define TRACELOGD( ... )       ( (void)( 0 ) )
 #endif // LOG_SUPPORT
 
+//----------------------------------------------------------------------------------------------------------------------
+// Profiling Macros
+//----------------------------------------------------------------------------------------------------------------------
+#if defined( PROFILE_SUPPORT )
+#    define PROFILE_ZONE_BEGIN( name )     ProfileZoneBegin( name )
+#    define PROFILE_ZONE_END()             ProfileZoneEnd()
+#    define PROFILE_COUNTER( name, value ) ProfileCounter( name, value )
+#    define PROFILE_FRAME_MARK()           ProfileFrameMark()
+#else // !PROFILE_SUPPORT
+#    define PROFILE_ZONE_BEGIN( name )     ( (void)( 0 ) )
+#    define PROFILE_ZONE_END()             ( (void)( 0 ) )
+#    define PROFILE_COUNTER( name, value ) ( (void)( 0 ) )
+#    define PROFILE_FRAME_MARK()           ( (void)( 0 ) )
+#endif // PROFILE_SUPPORT
+
+//----------------------------------------------------------------------------------------------------------------------
+// Atomics and Thread Storage, on long and pointer sized values
+//----------------------------------------------------------------------------------------------------------------------
+#if defined( _MSC_VER )
+#    include <intrin.h>
+#    define ATOMIC_LOAD( p )         ( *(volatile long *)( p ) )
+#    define ATOMIC_STORE( p, v )     ( *(volatile long *)( p ) = ( v ) )
+#    define ATOMIC_LOAD_PTR( p )     ( *(void * volatile *)( p ) )
+#    define ATOMIC_STORE_PTR( p, v ) ( *(void * volatile *)( p ) = ( v ) )
+#    define ATOMIC_FETCH_ADD( p, v ) _InterlockedExchangeAdd( (volatile long *)( p ), ( v ) )
+#    define ATOMIC_CAS( p, e, d )    ( ( e ) == _InterlockedCompareExchange( (volatile long *)( p ), ( d ), ( e ) ) )
+#    define THREAD_LOCAL             __declspec( thread )
+#else
+#    define ATOMIC_LOAD( p )         __atomic_load_n( ( p ), __ATOMIC_ACQUIRE )
+#    define ATOMIC_STORE( p, v )     __atomic_store_n( ( p ), ( v ), __ATOMIC_RELEASE )
+#    define ATOMIC_LOAD_PTR( p )     __atomic_load_n( ( p ), __ATOMIC_ACQUIRE )
+#    define ATOMIC_STORE_PTR( p, v ) __atomic_store_n( ( p ), ( v ), __ATOMIC_RELEASE )
+#    define ATOMIC_FETCH_ADD( p, v ) __atomic_fetch_add( ( p ), ( v ), __ATOMIC_ACQ_REL )
+#    define ATOMIC_CAS( p, e, d )    __sync_bool_compare_and_swap( ( p ), ( e ), ( d ) )
+#    define THREAD_LOCAL             __thread
+#endif
+
 #endif // !VUTILS_H
@@ -4,6 +4,19 @@
  *
  *                            CONFIGURATIONS
  * ------------------------------------------------------------------------
+ * #define VVUL_IMPLEMENTATION
+ *     Generates the implementation of the module, define it in only one translation unit.
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - Rendering always happens into an offscreen color target owned by vvul. Headless contexts skip
+ *   presentation entirely, so any Vulkan implementation (lavapipe, SwiftShader, ...) can drive them.
+ * - Windowed contexts copy the target into the swapchain at the end of every frame. Resizes only flag the
+ *   swapchain as outdated; it is recreated through oldSwapchain at the next frame and retired resources
+ *   are destroyed once the frames in flight that used them complete, the GPU is never drained.
+ * - The pipeline cache is loaded from vvulInitInfo.cacheDirectory and written back by vClose. Files written by
+ *   another device or driver, truncated or corrupt are discarded, so a stale cache only costs a cold start.
  *
  *                               LICENSE
  * ------------------------------------------------------------------------
@@ -34,6 +47,7 @@
 #include "vultra/vapi.h"
 #include "vultra/vversion.h"
 
+#include <stdio.h>  /* fopen(), rename() */
 #include <stdlib.h> /* malloc(), free() */
 #include <string.h> /* strcmp(), strlen() */
 
@@ -104,27 +118,429 @@
 #endif
 /* clang-format on */
 
+// Render target color format, matches the RGBA8 layout returned by readbacks
+#define VVUL_TARGET_FORMAT VK_FORMAT_R8G8B8A8_UNORM
+
+// Highest Vulkan version requested, older loaders and devices are negotiated down
+#define VVUL_API_VERSION           VK_API_VERSION_1_3
+
+// Environment variable overriding the physical device selection (index or name substring)
+#define VVUL_DEVICE_ENV            "VULTRA_DEVICE"
+
+// Maximum device extensions enabled at once
+#define VVUL_MAX_DEVICE_EXTENSIONS 16
+
+// Frames the CPU may record ahead of the GPU
+#define VVUL_MAX_FRAMES_IN_FLIGHT  3
+#define VVUL_FRAMES_IN_FLIGHT      2 // Default
+
+// Threads recording secondary command buffers, each owns a command pool per frame in flight
+#define VVUL_MAX_RECORD_THREADS    64
+
+// Swapchain image limit
+#define VVUL_MAX_SWAPCHAIN_IMAGES  8
+
+// Resources retired but possibly still in use by in-flight frames, initial capacity of the growable queue
+#define VVUL_GARBAGE_CAPACITY      256
+
+// Device memory sub-allocation
+#define VVUL_MAX_MEMORY_BLOCKS     256                       // Device memory blocks alive at once
+#define VVUL_MEMORY_BLOCK_SIZE     ( (VkDeviceSize)64 << 20 ) // Preferred block size, smaller on small heaps
+#define VVUL_TLSF_SL_LOG2          5                         // log2 of the second level classes per power of two
+#define VVUL_TLSF_SL_COUNT         ( 1U << VVUL_TLSF_SL_LOG2 )
+#define VVUL_TLSF_FL_SHIFT         8                         // Sizes below 1 << shift share the first level class
+#define VVUL_TLSF_FL_COUNT         32
+#define VVUL_TLSF_SMALL_SIZE       ( (VkDeviceSize)1 << VVUL_TLSF_FL_SHIFT )
+#define VVUL_NULL_NODE             UINT32_MAX
+#define VVUL_BLOCK_DEDICATED       UINT32_MAX         // Allocation owns its device memory
+#define VVUL_BLOCK_LINEAR          ( UINT32_MAX - 1 ) // Allocation belongs to a linear pool
+
+// Uploads
+#define VVUL_STAGING_SIZE          ( (VkDeviceSize)32 << 20 ) // Persistently mapped staging ring size
+#define VVUL_STAGING_ALIGNMENT     16                         // Staging offsets alignment, multiple of texel sizes
+#define VVUL_UPLOAD_BATCHES        8                          // Upload submissions in flight
+
+// Persistent caches
+#define VVUL_MAX_PATH              512
+#define VVUL_PIPELINE_CACHE_FILE   "pipeline.cache"
+#define VVUL_PIPELINE_CACHE_MAGIC  0x43505656U // "VVPC"
+#define VVUL_PIPELINE_CACHE_FORMAT 1           // Bumped whenever vvulPipelineCacheHeader changes
+
+// Presentation modes
+typedef enum vvulPresentMode
+{
+    VVUL_PRESENT_LOW_LATENCY = 0, // MAILBOX, falling back to IMMEDIATE then FIFO
+    VVUL_PRESENT_VSYNC,           // FIFO, always available
+    VVUL_PRESENT_IMMEDIATE        // IMMEDIATE (tearing allowed), falling back to MAILBOX then FIFO
+} vvulPresentMode;
+
+// Creates the window surface, implemented by the platform layer
+typedef VkResult ( *vvulCreateSurfaceCallback )( VkInstance instance, VkSurfaceKHR * surface );
+
+// Kinds of deferred destructions
+typedef enum vvulGarbageType
+{
+    VVUL_GARBAGE_SWAPCHAIN = 0,
+    VVUL_GARBAGE_SEMAPHORE,
+    VVUL_GARBAGE_IMAGE,
+    VVUL_GARBAGE_IMAGE_VIEW,
+    VVUL_GARBAGE_BUFFER,
+    VVUL_GARBAGE_MEMORY,
+    VVUL_GARBAGE_ALLOCATION,
+    VVUL_GARBAGE_FRAMEBUFFER,
+    VVUL_GARBAGE_DESCRIPTOR_SET, // vvulPooledSet
+    VVUL_GARBAGE_IMAGE_RESOURCES // vvulRetiredImage, see vDeferDestroyImage()
+} vvulGarbageType;
+
+// Descriptor set along with the pool it is freed to
+typedef struct vvulPooledSet
+{
+    VkDescriptorPool pool; // Created with VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT
+    VkDescriptorSet  set;
+
+} vvulPooledSet;
+
+// Intended access pattern of a memory allocation, selects the memory type
+typedef enum vvulMemoryUsage
+{
+    VVUL_MEMORY_GPU_ONLY = 0, // Device local, not host visible on discrete GPUs
+    VVUL_MEMORY_CPU_TO_GPU,   // Host visible and coherent, written by the CPU (uploads, dynamic data)
+    VVUL_MEMORY_GPU_TO_CPU    // Host visible, cached when possible, read by the CPU (readbacks)
+} vvulMemoryUsage;
+
+// Sub-allocated device memory range
+typedef struct vvulAllocation
+{
+    VkDeviceMemory memory;    // Backing device memory, shared with other allocations
+    VkDeviceSize   offset;    // Offset of the range in memory, to bind resources at
+    VkDeviceSize   size;      // Size of the range, including granularity padding
+    void *         mapped;    // Persistently mapped host pointer to the range, NULL if not host visible
+    uint32_t       typeIndex; // Memory type of the backing memory
+    uint32_t       block;     // Owning block, VVUL_BLOCK_DEDICATED or VVUL_BLOCK_LINEAR
+    uint32_t       node;      // TLSF node of the range in its block
+
+} vvulAllocation;
+
+// Image retired along with its views and memory, a single deferred destruction
+typedef struct vvulRetiredImage
+{
+    VkImage        image;
+    VkImageView    view;      // Single view, or VK_NULL_HANDLE
+    VkImageView *  views;     // More views, owned by the entry (VUL_MALLOC)
+    uint32_t       viewCount; // Views in views
+    vvulAllocation memory;    // Skipped when memory.memory is VK_NULL_HANDLE
+
+} vvulRetiredImage;
+
+// Bump allocator over a single device memory block, for transient resources released together
+typedef struct vvulLinearPool
+{
+    VkDeviceMemory memory;
+    VkDeviceSize   size;
+    VkDeviceSize   offset; // Bytes in use
+    void *         mapped; // Persistently mapped base, NULL if not host visible
+    uint32_t       typeIndex;
+
+} vvulLinearPool;
+
+// Memory usage of a heap, in bytes
+typedef struct vvulMemoryBudget
+{
+    VkDeviceSize budget;    // Usable by the process, VK_EXT_memory_budget or 80% of the heap size
+    VkDeviceSize usage;     // In use by the process, VK_EXT_memory_budget or the bytes allocated by vvul
+    VkDeviceSize allocated; // Device memory allocated by vvul
+    VkDeviceSize used;      // Bytes handed out to resources from the allocated memory
+
+} vvulMemoryBudget;
+
+// Upload identifier, complete once the GPU finished the copy (0 is always complete)
+typedef uint64_t vvulUploadTicket;
+
+#define VVUL_UPLOAD_FAILED ( (vvulUploadTicket)UINT64_MAX ) // Upload not (fully) recorded, never completes
+
+// Upload submission, its staging range is reclaimed once the GPU completes it
+typedef struct vvulUploadBatch
+{
+    VkCommandBuffer cmd;
+    VkFence         fence;   // Completion without timeline semaphores
+    uint64_t        value;   // Ticket of the batch, timeline value it signals
+    uint64_t        ringEnd; // Staging ring head when the batch was submitted
+
+} vvulUploadBatch;
+
+// Prefix of pipeline cache files, guards the driver data against truncation and corruption
+typedef struct vvulPipelineCacheHeader
+{
+    uint32_t magic;         // VVUL_PIPELINE_CACHE_MAGIC
+    uint32_t format;        // VVUL_PIPELINE_CACHE_FORMAT
+    uint32_t driverVersion; // Drivers may not bump pipelineCacheUUID on every release
+    uint32_t reserved;
+    uint64_t dataSize;      // Bytes of driver data following the header
+    uint64_t checksum;      // FNV-1a of the driver data
+
+} vvulPipelineCacheHeader;
+
+// TLSF range of a memory block, free or in use
+typedef struct vvulMemoryNode
+{
+    VkDeviceSize offset;
+    VkDeviceSize size;
+    uint32_t     prevPhysical; // Adjacent ranges, for coalescing
+    uint32_t     nextPhysical;
+    uint32_t     prevFree;     // Free list of the size class, nextFree also links recycled nodes
+    uint32_t     nextFree;
+    bool         free;
+
+} vvulMemoryNode;
+
+// Device memory block carved by a two-level segregated fit allocator, O(1) allocation and free
+typedef struct vvulMemoryBlock
+{
+    VkDeviceMemory memory;
+    VkDeviceSize   size;
+    VkDeviceSize   used;
+    void *         mapped; // Persistently mapped base, NULL if not host visible
+    uint32_t       typeIndex;
+    uint32_t       allocationCount;
+
+    vvulMemoryNode * nodes;
+    uint32_t         nodeCount;
+    uint32_t         nodeCapacity;
+    uint32_t         unusedNodes; // Recycled nodes, linked through nextFree
+
+    uint32_t flBitmap;                                         // First level classes with free ranges
+    uint32_t slBitmap[VVUL_TLSF_FL_COUNT];                     // Second level classes with free ranges
+    uint32_t heads[VVUL_TLSF_FL_COUNT][VVUL_TLSF_SL_COUNT];    // Free list head of every class
+
+} vvulMemoryBlock;
+
+// Resource retired during a frame, destroyed once no in-flight frame can reference it
+typedef struct vvulGarbage
+{
+    uint64_t        frame; // Frame number the resource was retired at
+    vvulGarbageType type;
+
+    union
+    {
+        VkSwapchainKHR   swapchain;
+        VkSemaphore      semaphore;
+        VkImage          image;
+        VkImageView      view;
+        VkBuffer         buffer;
+        VkDeviceMemory   memory;
+        vvulAllocation   allocation;
+        VkFramebuffer    framebuffer;
+        vvulPooledSet    descriptorSet;
+        vvulRetiredImage retiredImage;
+    } handle;
+
+} vvulGarbage;
+
+// Secondary command buffers of one recording thread, recycled every time the frame slot comes around
+typedef struct vvulThreadCommands
+{
+    VkCommandPool     pool;     // Created on first use, only ever touched by its thread
+    VkCommandBuffer * cmds;     // Allocated secondaries, reused after the pool reset
+    uint32_t          count;    // Secondaries allocated
+    uint32_t          capacity;
+    uint32_t          used;     // Secondaries handed out during the current frame
+
+} vvulThreadCommands;
+
+// Per frame-in-flight resources
+typedef struct vvulFrame
+{
+    VkCommandPool      pool;           // Reset as a whole at the start of the frame
+    VkCommandBuffer    cmd;            // Primary command buffer of the frame
+    VkFence            fence;          // Signaled when the frame submission completes
+    VkSemaphore        imageAvailable; // Signaled when the acquired swapchain image can be written
+    vvulThreadCommands threads[VVUL_MAX_RECORD_THREADS];
+
+} vvulFrame;
+
+// Queue roles
+typedef enum vvulQueueType
+{
+    VVUL_QUEUE_GRAPHICS = 0, // Graphics, always available
+    VVUL_QUEUE_COMPUTE,      // Async compute, aliases graphics when there is no separate compute queue
+    VVUL_QUEUE_TRANSFER,     // Dedicated transfer (DMA), aliases graphics when not available
+    VVUL_QUEUE_COUNT
+} vvulQueueType;
+
+// Optional device features, enabled when supported
+typedef struct vvulDeviceFeatures
+{
+    bool timelineSemaphore;    // Vulkan 1.2
+    bool descriptorIndexing;   // Vulkan 1.2, bindless descriptors
+    bool drawIndirectCount;    // Vulkan 1.2
+    bool hostQueryReset;       // Vulkan 1.2
+    bool synchronization2;     // Vulkan 1.3
+    bool dynamicRendering;     // Vulkan 1.3
+    bool multiDrawIndirect;    // Vulkan 1.0 optional feature
+    bool textureCompressionBC; // Vulkan 1.0 optional feature, BC1-7 sampled images
+
+} vvulDeviceFeatures;
+
+// Initialization parameters
+typedef struct vvulInitInfo
+{
+    const char ** extensions;     // Instance extensions required by the platform
+    uint32_t      extensionCount; // Number of platform instance extensions
+    uint32_t      width;          // Render target width
+    uint32_t      height;         // Render target height
+    bool          headless;       // Render offscreen only, no surface or presentation is required
+    const char *  device;         // Device override, index or name substring (NULL: VVUL_DEVICE_ENV or automatic)
+    const char *  cacheDirectory; // Existing directory persistent caches are kept in (NULL: nothing is persisted)
+
+    vvulCreateSurfaceCallback createSurface;  // Window surface factory, unused when headless
+    vvulPresentMode           presentMode;    // Requested presentation mode
+    uint32_t                  framesInFlight; // Frames recorded ahead of the GPU (0: VVUL_FRAMES_IN_FLIGHT)
+
+} vvulInitInfo;
+
 // Current vvul State and Configs
 typedef struct vvulContext
 {
     struct
     {
         VkInstance handle;
+        uint32_t   apiVersion; // Negotiated instance version
 
     } Instance;
 
-} vvulContext;
+    struct
+    {
+        VkPhysicalDevice                 physical;
+        VkDevice                         handle;
+        VkPhysicalDeviceProperties       properties;
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        vvulDeviceFeatures               features;   // Optional features enabled on the device
+        uint32_t                         apiVersion; // min( instance, device ) version
 
-//----------------------------------------------------------------------------------------------------------------------
-// Global Variables Definition
-//----------------------------------------------------------------------------------------------------------------------
-static vvulContext vState = { 0 };
+    } Device;
 
-//----------------------------------------------------------------------------------------------------------------------
-// Module Specific Functions Declarations
-//----------------------------------------------------------------------------------------------------------------------
-static INLINE const char * VkResultToStr( VkResult err );
-static INLINE bool         vCreateInstance( const char ** requiredExtensions, uint32_t extensionCount );
+    struct
+    {
+        VkQueue  handles[VVUL_QUEUE_COUNT];  // Queue per role (queue 0 of its family), roles may share a queue
+        uint32_t families[VVUL_QUEUE_COUNT]; // Queue family index per role
+
+    } Queue;
+
+    // Blocking one-shot submissions (initialization, readbacks)
+    struct
+    {
+        VkCommandPool   pool;
+        VkCommandBuffer cmd;
+        VkFence         fence;
+
+    } Immediate;
+
+    // Offscreen color target every frame is rendered into
+    struct
+    {
+        VkImage        image;
+        vvulAllocation memory;
+        VkImageView    view;
+        VkFramebuffer  framebuffer;
+        VkRenderPass   renderPass; // Loads and stores the target, kept across resizes
+        VkExtent2D     extent;
+        VkImageLayout  layout;     // Layout the image is left in between submissions
+
+    } Target;
+
+    struct
+    {
+        VkSurfaceKHR     surface;
+        VkSwapchainKHR   handle;
+        VkSurfaceFormatKHR format;
+        VkPresentModeKHR   presentMode;
+        vvulPresentMode    requestedMode;
+        VkExtent2D         extent;
+        VkExtent2D         requestedExtent;                           // Framebuffer size reported by the platform
+        uint32_t           imageCount;
+        VkImage            images[VVUL_MAX_SWAPCHAIN_IMAGES];
+        VkSemaphore        renderFinished[VVUL_MAX_SWAPCHAIN_IMAGES]; // Per image, waited by presentation
+        uint32_t           imageIndex;                                // Image acquired for the current frame
+        bool               outdated;                                  // Recreate before the next acquire
+        bool               blit;                                      // Format supports scaled blits
+
+    } Swapchain;
+
+    struct
+    {
+        vvulFrame frames[VVUL_MAX_FRAMES_IN_FLIGHT];
+        uint32_t  count;  // Frames in flight
+        uint32_t  index;  // Current frame slot
+        uint64_t  number; // Frames begun since initialization
+        bool      active; // Is a frame being recorded?
+
+    } Frame;
+
+    struct
+    {
+        vvulGarbage * items; // Ring buffer, ordered by retirement frame, grown when full
+        uint32_t      capacity;
+        uint32_t      head;
+        uint32_t      count;
+
+    } Garbage;
+
+    struct
+    {
+        vvulMemoryBlock * blocks[VVUL_MAX_MEMORY_BLOCKS]; // NULL slots are free
+        uint32_t          blockCount;                     // Highest used slot + 1
+        uint32_t          allocationCount;                // Live vkAllocateMemory allocations
+        VkDeviceSize      granularity;                    // bufferImageGranularity
+        VkDeviceSize      allocated[VK_MAX_MEMORY_HEAPS]; // Device memory held per heap
+        VkDeviceSize      used[VK_MAX_MEMORY_HEAPS];      // Bytes handed out per heap
+        VkDeviceSize      budget[VK_MAX_MEMORY_HEAPS];
+        VkDeviceSize      usage[VK_MAX_MEMORY_HEAPS];
+        bool              budgetSupported;                // VK_EXT_memory_budget enabled
+
+    } Memory;
+
+    // Staging ring and upload submissions
+    struct
+    {
+        VkBuffer       buffer;
+        vvulAllocation memory;
+        VkDeviceSize   size;
+        uint64_t       head; // Monotonic ring positions, head - tail bytes are in use
+        uint64_t       tail;
+
+        VkCommandPool   pool;
+        vvulUploadBatch batches[VVUL_UPLOAD_BATCHES];
+        uint32_t        first;     // Oldest submitted batch
+        uint32_t        count;     // Submitted batches not yet reclaimed
+        bool            recording; // Is the batch after the submitted ones recording?
+
+        VkSemaphore   timeline;  // Signaled with the batch tickets, VK_NULL_HANDLE without timeline semaphores
+        uint64_t      next;      // Ticket of the batch being recorded
+        uint64_t      completed; // Highest completed ticket
+        uint64_t      waited;    // Highest ticket frames already wait for
+        vvulQueueType queue;     // Queue the copies are submitted to
+        bool          dedicated; // Copies run on a separate queue family, ownership is transferred to graphics
+
+        VkBufferMemoryBarrier * bufferAcquires; // Ownership acquires recorded by the next frame
+        uint32_t                bufferAcquireCount;
+        uint32_t                bufferAcquireCapacity;
+        VkImageMemoryBarrier *  imageAcquires;
+        uint32_t                imageAcquireCount;
+        uint32_t                imageAcquireCapacity;
+
+    } Upload;
+
+    // Driver pipeline cache, loaded at initialization and written back on close
+    struct
+    {
+        VkPipelineCache handle;
+        char            path[VVUL_MAX_PATH]; // Cache file, empty when nothing is persisted
+
+    } PipelineCache;
+
+    bool headless; // Is context running without presentation?
+
+} vvulContext;
 
 //----------------------------------------------------------------------------------------------------------------------
 // Module Functions Declarations
@@ -134,8 +550,71 @@ static INLINE bool         vCreateInstance( const char ** requiredExtensions, ui
 CXX_GUARD_START
 //
 
-VAPI void vInit( const char ** requiredExtensions, uint32_t extensionCount );
-VAPI void vClose( void ); // Deinitialize Vulkan
+VAPI bool vInit( const vvulInitInfo * info ); // Initialize Vulkan
+VAPI void vClose( void );                     // Deinitialize Vulkan
+
+VAPI VkQueue                    vGetQueue( vvulQueueType type );         // Get the queue used for a role
+VAPI uint32_t                   vGetQueueFamily( vvulQueueType type );   // Get the queue family index of a role
+VAPI bool                       vIsQueueDedicated( vvulQueueType type ); // Check if a role runs on its own queue
+VAPI VkDevice                   vGetDevice( void );                      // Get the logical device
+VAPI const vvulDeviceFeatures * vGetDeviceFeatures( void );              // Get the optional features enabled
+VAPI VkPipelineCache            vGetPipelineCache( void );               // Get the cache every pipeline is created with
+
+VAPI VkPhysicalDevice                   vGetPhysicalDevice( void );   // Get the physical device
+VAPI const VkPhysicalDeviceProperties * vGetDeviceProperties( void ); // Get the physical device properties (limits, ...)
+
+VAPI VkCommandBuffer vBeginFrame( void );                            // Begin recording a frame, NULL if it must be skipped
+VAPI void            vEndFrame( void );                              // Submit and present the current frame
+VAPI void            vResize( uint32_t width, uint32_t height );     // Notify a framebuffer resize, applied next frame
+VAPI VkCommandBuffer vGetFrameCommandBuffer( void );                 // Get the command buffer of the current frame
+VAPI uint32_t        vGetFrameIndex( void );                         // Get the current frame-in-flight slot
+VAPI uint32_t        vGetFramesInFlight( void );                     // Get the number of frames in flight
+VAPI uint64_t        vGetFrameNumber( void );                        // Get the number of frames ended
+
+VAPI VkCommandBuffer vBeginSecondary( uint32_t thread, const VkCommandBufferInheritanceInfo * inheritance );
+VAPI bool            vEndSecondary( VkCommandBuffer cmd );
+VAPI void            vCmdExecuteSecondaries( const VkCommandBuffer * cmds, uint32_t count ); // Into the primary
+
+// Device memory, resources are bound at allocation->offset of allocation->memory
+VAPI bool vAllocateMemory( const VkMemoryRequirements * requirements, vvulMemoryUsage usage, bool optimalImage,
+                          vvulAllocation * allocation );
+VAPI bool vAllocateBufferMemory( VkBuffer buffer, vvulMemoryUsage usage, vvulAllocation * allocation );
+VAPI bool vAllocateImageMemory( VkImage image, vvulMemoryUsage usage, vvulAllocation * allocation );
+VAPI void vFreeMemory( vvulAllocation * allocation );            // Free memory the GPU no longer uses
+VAPI void vDeferFreeMemory( const vvulAllocation * allocation ); // Free once the frames in flight complete
+VAPI void vDeferDestroy( vvulGarbageType type, const void * handle ); // Destroy once the frames in flight complete
+VAPI void vDeferDestroyImage( VkImage image, const VkImageView * views, uint32_t viewCount,
+                              const vvulAllocation * memory ); // Image, views and memory as one entry
+
+// Linear pools, transient resources released all at once
+VAPI bool vCreateLinearPool( VkDeviceSize size, vvulMemoryUsage usage, uint32_t typeBits, vvulLinearPool * pool );
+VAPI bool vLinearPoolAllocate( vvulLinearPool * pool, const VkMemoryRequirements * requirements, bool optimalImage,
+                               vvulAllocation * allocation );
+VAPI void vResetLinearPool( vvulLinearPool * pool );
+VAPI void vDestroyLinearPool( vvulLinearPool * pool );
+
+VAPI vvulMemoryBudget vGetMemoryBudget( uint32_t heap ); // Get the memory usage of a heap
+
+// Uploads through the staging ring, the data is visible to frames begun after the upload.
+// They return VVUL_UPLOAD_FAILED on failure, 0 when there was nothing to copy (an empty upload)
+VAPI vvulUploadTicket vUploadBuffer( VkBuffer buffer, VkDeviceSize offset, const void * data, VkDeviceSize size );
+VAPI vvulUploadTicket vUploadImage( VkImage image, uint32_t mipLevel, uint32_t width, uint32_t height,
+                                    uint32_t texelSize, const void * data, VkImageLayout finalLayout );
+VAPI vvulUploadTicket vUploadImageBlocks( VkImage image, uint32_t mipLevel, uint32_t width, uint32_t height,
+                                          uint32_t blockWidth, uint32_t blockHeight, uint32_t blockSize,
+                                          const void * data, VkImageLayout finalLayout ); // Block compressed
+VAPI vvulUploadTicket vFlushUploads( void );                     // Submit the recorded uploads
+VAPI bool             vIsUploadComplete( vvulUploadTicket ticket ); // Check if an upload finished, never blocks
+VAPI void             vWaitUpload( vvulUploadTicket ticket );    // Block until an upload finished
+
+VAPI VkExtent2D vGetTargetExtent( void );                                 // Get the render target size
+VAPI void *     vReadTargetPixels( uint32_t * width, uint32_t * height ); // Read back the render target (RGBA8)
+
+VAPI VkImageView                    vGetTargetView( void );        // Get the view of the target, changes on resize
+VAPI VkRenderPass                   vGetTargetRenderPass( void );  // Get the render pass drawing into the target
+VAPI VkCommandBufferInheritanceInfo vGetTargetInheritance( void ); // Get the inheritance of secondaries drawing in it
+VAPI void vCmdBeginTargetPass( VkCommandBuffer cmd, VkSubpassContents contents ); // Begin drawing into the target
+VAPI void vCmdEndTargetPass( VkCommandBuffer cmd );                               // End drawing into the target
 
 //
 CXX_GUARD_END
@@ -148,99 +627,3334 @@ CXX_GUARD_END
 //**********************************************************************************************************************
 #ifdef VVUL_IMPLEMENTATION
 
-INLINE void
-vInit( const char ** requiredExtensions, uint32_t extensionCount )
+#    if defined( _WIN32 )
+#        include <process.h> /* _getpid */
+#        define VVUL_PROCESS_ID() _getpid()
+// Declared manually to avoid pulling <windows.h> and its symbol clashes (CloseWindow, ...)
+__declspec( dllimport ) int __stdcall MoveFileExA( const char * existing, const char * replacement, unsigned long flags );
+#    else
+#        include <unistd.h> /* getpid */
+#        define VVUL_PROCESS_ID() getpid()
+#    endif
+
+//----------------------------------------------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------------------------------------------
+static vvulContext vState = { 0 };
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Specific Functions Declarations
+//----------------------------------------------------------------------------------------------------------------------
+static INLINE const char * VkResultToStr( VkResult err );
+static INLINE bool         vCreateInstance( const char ** requiredExtensions, uint32_t extensionCount );
+static INLINE bool         vCreateDevice( const char * override );
+static INLINE bool         vDeviceHasExtension( VkPhysicalDevice device, const char * name );
+static INLINE void         vFindQueueFamilies( VkPhysicalDevice device, uint32_t families[VVUL_QUEUE_COUNT] );
+static INLINE void         vQueryDeviceFeatures( VkPhysicalDevice device, uint32_t apiVersion,
+                                                 vvulDeviceFeatures * supported );
+static INLINE int64_t      vScorePhysicalDevice( VkPhysicalDevice device );
+static INLINE int          vSelectPhysicalDevice( VkPhysicalDevice * devices, uint32_t count, const char * override );
+static INLINE bool         vCreateImmediateContext( void );
+static INLINE bool         vCreateTargetRenderPass( void );
+static INLINE bool         vCreateTarget( uint32_t width, uint32_t height );
+static INLINE void         vRetireTarget( void );
+static INLINE void         vCmdInitializeTarget( VkCommandBuffer cmd );
+static INLINE bool         vCreateFrames( uint32_t count );
+static INLINE void         vDestroyFrames( void );
+static INLINE void         vResetThreadCommands( vvulFrame * frame );
+static INLINE bool         vCreateSwapchain( void );
+static INLINE void         vDestroySwapchain( void );
+static INLINE void         vCmdPresentTarget( VkCommandBuffer cmd );
+
+static INLINE bool            vCreateUploadContext( void );
+static INLINE void            vDestroyUploadContext( void );
+static INLINE VkCommandBuffer vAllocateStaging( VkDeviceSize size, VkDeviceSize * offset );
+static INLINE VkCommandBuffer vGetUploadCommandBuffer( void );
+static INLINE void            vUpdateUploads( void );
+static INLINE void            vCmdAcquireUploads( VkCommandBuffer cmd );
+static INLINE bool            vPushAcquire( void ** barriers, uint32_t * count, uint32_t * capacity, size_t size,
+                                            const void * barrier );
+
+static INLINE bool     vCreatePipelineCache( const char * directory );
+static INLINE void     vSavePipelineCache( void );
+static INLINE void *   vLoadPipelineCacheData( size_t * size );
+static INLINE uint64_t vHashBytes( const void * data, size_t size, uint64_t seed );
+static INLINE void *   vReadFile( const char * path, size_t * size );
+static INLINE bool     vWriteFileAtomic( const char * path, const void * header, size_t headerSize, const void * data,
+                                         size_t dataSize );
+
+static INLINE void vCollectGarbage( uint64_t end );
+
+static INLINE uint32_t        vFindMemoryType( uint32_t typeBits, VkMemoryPropertyFlags properties );
+static INLINE uint32_t        vSelectMemoryType( uint32_t typeBits, vvulMemoryUsage usage );
+static INLINE VkDeviceSize    vGetBlockSize( uint32_t typeIndex );
+static INLINE void            vUpdateMemoryBudget( void );
+static INLINE bool            vAllocateDeviceMemory( uint32_t typeIndex, VkDeviceSize size, VkDeviceMemory * memory,
+                                                     void ** mapped );
+static INLINE void            vFreeDeviceMemory( uint32_t typeIndex, VkDeviceSize size, VkDeviceMemory memory );
+static INLINE bool vAllocateFromType( uint32_t typeIndex, VkDeviceSize size, VkDeviceSize alignment,
+                                      vvulAllocation * allocation );
+static INLINE uint32_t vCreateMemoryBlock( uint32_t typeIndex, VkDeviceSize size, VkDeviceSize minSize );
+static INLINE void     vDestroyMemoryBlock( uint32_t index );
+static INLINE void     vDestroyMemory( void );
+static INLINE uint32_t vBitScanForward( uint32_t mask );
+static INLINE uint32_t vBitScanReverse( uint64_t value );
+static INLINE void     vTlsfMapping( VkDeviceSize size, uint32_t * fl, uint32_t * sl );
+static INLINE bool     vTlsfReserveNodes( vvulMemoryBlock * block );
+static INLINE uint32_t vTlsfNewNode( vvulMemoryBlock * block );
+static INLINE void     vTlsfInsert( vvulMemoryBlock * block, uint32_t index );
+static INLINE void     vTlsfRemove( vvulMemoryBlock * block, uint32_t index );
+static INLINE uint32_t vTlsfFindFree( vvulMemoryBlock * block, VkDeviceSize size );
+static INLINE bool     vTlsfAllocate( vvulMemoryBlock * block, VkDeviceSize size, VkDeviceSize alignment,
+                                      vvulAllocation * allocation );
+static INLINE void     vTlsfFree( vvulMemoryBlock * block, uint32_t index );
+static INLINE VkCommandBuffer vBeginImmediate( void );
+static INLINE bool            vEndImmediate( void );
+static INLINE void vCmdImageBarrier( VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                                     VkPipelineStageFlags srcStage, VkAccessFlags srcAccess,
+                                     VkPipelineStageFlags dstStage, VkAccessFlags dstAccess );
+
+INLINE bool
+vInit( const vvulInitInfo * info )
 {
+    vState.headless = info->headless;
+
     // Instance
     //----------------------------------------------------------
-    if( !vCreateInstance( requiredExtensions, extensionCount ) ) return;
+    if( !vCreateInstance( info->extensions, info->extensionCount ) ) return false;
+
+    // Surface, the device must be able to present to it
+    //----------------------------------------------------------
+    if( !vState.headless )
+        {
+            const VkResult result = ( NULL != info->createSurface )
+                                        ? info->createSurface( vState.Instance.handle, &vState.Swapchain.surface )
+                                        : VK_ERROR_INITIALIZATION_FAILED;
+            if( VK_SUCCESS != result )
+                {
+                    TRACELOG( LOG_FATAL, "VVUL: Failed to create window surface: %s", VkResultToStr( result ) );
+                    return false;
+                }
+        }
+
+    // Device
+    //----------------------------------------------------------
+    if( !vCreateDevice( info->device ) ) return false;
+    if( !vCreateImmediateContext() ) return false;
+    if( !vCreateUploadContext() ) return false;
+    if( !vCreatePipelineCache( info->cacheDirectory ) ) return false;
+
+    // Frames in flight
+    //----------------------------------------------------------
+    uint32_t framesInFlight = ( 0 == info->framesInFlight ) ? VVUL_FRAMES_IN_FLIGHT : info->framesInFlight;
+    if( VVUL_MAX_FRAMES_IN_FLIGHT < framesInFlight ) framesInFlight = VVUL_MAX_FRAMES_IN_FLIGHT;
+    if( !vCreateFrames( framesInFlight ) ) return false;
+
+    // Render target and swapchain
+    //----------------------------------------------------------
+    vState.Swapchain.requestedExtent.width  = info->width;
+    vState.Swapchain.requestedExtent.height = info->height;
+    vState.Swapchain.requestedMode          = info->presentMode;
+
+    if( !vCreateTargetRenderPass() ) return false;
+    if( !vCreateTarget( info->width, info->height ) ) return false;
+    if( !vState.headless && !vCreateSwapchain() ) return false;
+
+    TRACELOG( LOG_INFO, "VVUL: Initialized %s context (%ux%u)", vState.headless ? "headless" : "windowed",
+              info->width, info->height );
+
+    return true;
 }
 
 // Deinitializes and closes the Vulkan context
 INLINE void
 vClose( void )
 {
+    if( VK_NULL_HANDLE != vState.Device.handle )
+        {
+            vkDeviceWaitIdle( vState.Device.handle );
+
+            vSavePipelineCache();
+            vkDestroyPipelineCache( vState.Device.handle, vState.PipelineCache.handle, NULL );
+
+            vRetireTarget();
+            vDestroySwapchain();
+            vCollectGarbage( UINT64_MAX );
+            VUL_FREE( vState.Garbage.items );
+            vState.Garbage.items    = NULL;
+            vState.Garbage.capacity = 0;
+            vkDestroyRenderPass( vState.Device.handle, vState.Target.renderPass, NULL );
+            vDestroyFrames();
+            vDestroyUploadContext();
+            vDestroyMemory();
+
+            vkDestroyFence( vState.Device.handle, vState.Immediate.fence, NULL );
+            vkDestroyCommandPool( vState.Device.handle, vState.Immediate.pool, NULL );
+            vkDestroyDevice( vState.Device.handle, NULL );
+        }
+
+    if( VK_NULL_HANDLE != vState.Swapchain.surface )
+        {
+            vkDestroySurfaceKHR( vState.Instance.handle, vState.Swapchain.surface, NULL );
+        }
+
     vkDestroyInstance( vState.Instance.handle, NULL );
 }
 
-//----------------------------------------------------------------------------------------------------------------------
-// Module specific Functions Definition
-//----------------------------------------------------------------------------------------------------------------------
-
-static INLINE const char *
-VkResultToStr( VkResult err )
+// Begin recording a frame, returns NULL when the frame must be skipped (e.g. minimized window)
+INLINE VkCommandBuffer
+vBeginFrame( void )
 {
-    switch( err )
+    const VkDevice device = vState.Device.handle;
+    vvulFrame *    frame  = &vState.Frame.frames[vState.Frame.index];
+    VkResult       result = VK_SUCCESS;
+
+    // The only CPU/GPU synchronization point of a frame: wait for the submission that last used this slot
+    vkWaitForFences( device, 1, &frame->fence, VK_TRUE, UINT64_MAX );
+
+    // Frames up to (number - count) are known complete, keep one extra frame for the presentation engine
+    if( vState.Frame.number + 1 >= vState.Frame.count ) vCollectGarbage( vState.Frame.number + 1 - vState.Frame.count );
+
+    // Resize, the previous target is retired and released once no frame in flight uses it
+    const VkExtent2D requested = vState.Swapchain.requestedExtent;
+    if( 0 == requested.width || 0 == requested.height ) return VK_NULL_HANDLE;
+
+    if( requested.width != vState.Target.extent.width || requested.height != vState.Target.extent.height )
         {
-#    define STR( R )                                                                                                   \
-    case VK_##R: return #R
-            STR( SUCCESS );
-            STR( NOT_READY );
-            STR( TIMEOUT );
-            STR( EVENT_SET );
-            STR( EVENT_RESET );
-            STR( INCOMPLETE );
-            STR( ERROR_OUT_OF_HOST_MEMORY );
-            STR( ERROR_OUT_OF_DEVICE_MEMORY );
-            STR( ERROR_INITIALIZATION_FAILED );
-            STR( ERROR_DEVICE_LOST );
-            STR( ERROR_MEMORY_MAP_FAILED );
-            STR( ERROR_LAYER_NOT_PRESENT );
-            STR( ERROR_EXTENSION_NOT_PRESENT );
-            STR( ERROR_FEATURE_NOT_PRESENT );
-            STR( ERROR_INCOMPATIBLE_DRIVER );
-            STR( ERROR_TOO_MANY_OBJECTS );
-            STR( ERROR_FORMAT_NOT_SUPPORTED );
-            STR( ERROR_SURFACE_LOST_KHR );
-            STR( SUBOPTIMAL_KHR );
-            STR( ERROR_OUT_OF_DATE_KHR );
-            STR( ERROR_INCOMPATIBLE_DISPLAY_KHR );
-            STR( ERROR_NATIVE_WINDOW_IN_USE_KHR );
-            STR( ERROR_VALIDATION_FAILED_EXT );
-#    undef STR
-        default: return "UNKNOWN_RESULT";
+            vRetireTarget();
+            if( !vCreateTarget( requested.width, requested.height ) ) return VK_NULL_HANDLE;
+        }
+
+    // Acquire, recreating the swapchain once if it went out of date
+    if( !vState.headless )
+        {
+            for( int attempt = 0; attempt < 2; ++attempt )
+                {
+                    if( vState.Swapchain.outdated && !vCreateSwapchain() ) return VK_NULL_HANDLE;
+                    if( 0 == vState.Swapchain.extent.width || 0 == vState.Swapchain.extent.height )
+                        {
+                            return VK_NULL_HANDLE;
+                        }
+
+                    result = vkAcquireNextImageKHR( device, vState.Swapchain.handle, UINT64_MAX, frame->imageAvailable,
+                                                    VK_NULL_HANDLE, &vState.Swapchain.imageIndex );
+
+                    if( VK_ERROR_OUT_OF_DATE_KHR == result )
+                        {
+                            vState.Swapchain.outdated = true;
+                            continue;
+                        }
+
+                    // Suboptimal images can still be presented, recreate on the next frame
+                    if( VK_SUBOPTIMAL_KHR == result ) vState.Swapchain.outdated = true;
+                    break;
+                }
+
+            if( VK_SUCCESS != result && VK_SUBOPTIMAL_KHR != result )
+                {
+                    if( VK_ERROR_OUT_OF_DATE_KHR != result )
+                        {
+                            TRACELOG( LOG_ERROR, "VVUL: Failed to acquire swapchain image: %s", VkResultToStr( result ) );
+                        }
+                    return VK_NULL_HANDLE;
+                }
         }
+
+    // Reset only once the frame is certain to be submitted, a skipped frame must leave the fence signaled
+    vkResetFences( device, 1, &frame->fence );
+    vkResetCommandPool( device, frame->pool, 0 );
+    vResetThreadCommands( frame );
+
+    VkCommandBufferBeginInfo beginInfo = { 0 };
+    beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer( frame->cmd, &beginInfo );
+
+    if( VK_IMAGE_LAYOUT_UNDEFINED == vState.Target.layout ) vCmdInitializeTarget( frame->cmd );
+
+    // Everything uploaded so far becomes visible to this frame
+    vCmdAcquireUploads( frame->cmd );
+
+    vState.Frame.active = true;
+
+    return frame->cmd;
 }
 
-// Create Vulkan instance
-static INLINE bool
-vCreateInstance( const char ** extensions, uint32_t extensionCount )
+// Submit the current frame and present it
+INLINE void
+vEndFrame( void )
 {
-    VkApplicationInfo    appInfo    = { 0 };
-    VkInstanceCreateInfo createInfo = { 0 };
-    VkResult             result;
+    if( !vState.Frame.active ) return;
 
-    // Application Info
-    {
-        appInfo.sType              = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-        appInfo.pApplicationName   = "Vultra Application";
-        appInfo.applicationVersion = VK_MAKE_VERSION( 1, 0, 0 );
-        appInfo.pEngineName        = "Vultra";
-        appInfo.engineVersion      = VULTRA_VK_VERSION;
-        appInfo.apiVersion         = VK_API_VERSION_1_0;
-    }
+    vvulFrame *    frame = &vState.Frame.frames[vState.Frame.index];
+    const uint32_t image = vState.Swapchain.imageIndex;
+    VkResult       result;
 
-    // Instance Create Info
-    {
-        createInfo.sType                   = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
-        createInfo.pApplicationInfo        = &appInfo;
+    if( !vState.headless ) vCmdPresentTarget( frame->cmd );
 
-        createInfo.enabledExtensionCount   = extensionCount;
-        createInfo.ppEnabledExtensionNames = extensions;
+    vkEndCommandBuffer( frame->cmd );
 
-        // TODO: Implement valiantion layers
-        createInfo.enabledLayerCount       = 0;
-        createInfo.ppEnabledLayerNames     = NULL;
-    }
+    VkSemaphore          waitSemaphores[2];
+    VkPipelineStageFlags waitStages[2];
+    uint64_t             waitValues[2] = { 0, 0 }; // Binary semaphores ignore their value
+    uint32_t             waitCount     = 0;
 
-    result = vkCreateInstance( &createInfo, NULL, &vState.Instance.handle );
-    if( VK_SUCCESS != result )
+    // The first swapchain write is the copy of the target, so only transfers wait for the acquire
+    if( !vState.headless )
         {
-            TRACELOG( LOG_FATAL, "VVUL: Failed to create Vulkan instance: %s", VkResultToStr( result ) );
-            return false;
+            waitSemaphores[waitCount] = frame->imageAvailable;
+            waitStages[waitCount]     = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            ++waitCount;
         }
 
-    return true;
+    // Uploads acquired by this frame run on the transfer queue, wait for their batches
+    VkTimelineSemaphoreSubmitInfo timelineInfo = { 0 };
+    const void *                  submitNext   = NULL;
+    if( vState.Upload.dedicated && vState.Upload.waited > vState.Upload.completed )
+        {
+            waitSemaphores[waitCount] = vState.Upload.timeline;
+            waitStages[waitCount]     = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            waitValues[waitCount]     = vState.Upload.waited;
+            ++waitCount;
+
+            timelineInfo.sType                   = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+            timelineInfo.waitSemaphoreValueCount = waitCount;
+            timelineInfo.pWaitSemaphoreValues    = waitValues;
+            submitNext                           = &timelineInfo;
+        }
+
+    VkSubmitInfo submitInfo       = { 0 };
+    submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext              = submitNext;
+    submitInfo.waitSemaphoreCount = waitCount;
+    submitInfo.pWaitSemaphores    = waitSemaphores;
+    submitInfo.pWaitDstStageMask  = waitStages;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers    = &frame->cmd;
+
+    if( !vState.headless )
+        {
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores    = &vState.Swapchain.renderFinished[image];
+        }
+
+    result = vkQueueSubmit( vState.Queue.handles[VVUL_QUEUE_GRAPHICS], 1, &submitInfo, frame->fence );
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_ERROR, "VVUL: Failed to submit frame: %s", VkResultToStr( result ) );
+        }
+
+    if( !vState.headless && VK_SUCCESS == result )
+        {
+            VkPresentInfoKHR presentInfo   = { 0 };
+            presentInfo.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+            presentInfo.waitSemaphoreCount = 1;
+            presentInfo.pWaitSemaphores    = &vState.Swapchain.renderFinished[image];
+            presentInfo.swapchainCount     = 1;
+            presentInfo.pSwapchains        = &vState.Swapchain.handle;
+            presentInfo.pImageIndices      = &image;
+
+            result = vkQueuePresentKHR( vState.Queue.handles[VVUL_QUEUE_GRAPHICS], &presentInfo );
+            if( VK_ERROR_OUT_OF_DATE_KHR == result || VK_SUBOPTIMAL_KHR == result )
+                {
+                    vState.Swapchain.outdated = true;
+                }
+            else if( VK_SUCCESS != result )
+                {
+                    TRACELOG( LOG_ERROR, "VVUL: Failed to present: %s", VkResultToStr( result ) );
+                }
+        }
+
+    vState.Frame.active = false;
+    vState.Frame.index  = ( vState.Frame.index + 1 ) % vState.Frame.count;
+    ++vState.Frame.number;
+}
+
+// Notify a framebuffer resize, resources are recreated at the start of the next frame without draining the GPU
+INLINE void
+vResize( uint32_t width, uint32_t height )
+{
+    vState.Swapchain.requestedExtent.width  = width;
+    vState.Swapchain.requestedExtent.height = height;
+    vState.Swapchain.outdated               = true;
+}
+
+// Get the command buffer of the frame being recorded
+INLINE VkCommandBuffer
+vGetFrameCommandBuffer( void )
+{
+    return vState.Frame.active ? vState.Frame.frames[vState.Frame.index].cmd : VK_NULL_HANDLE;
+}
+
+// Get the current frame-in-flight slot
+INLINE uint32_t
+vGetFrameIndex( void )
+{
+    return vState.Frame.index;
+}
+
+// Get the number of frames in flight
+INLINE uint32_t
+vGetFramesInFlight( void )
+{
+    return vState.Frame.count;
+}
+
+// Get the number of frames ended, the frame being recorded is not counted yet
+INLINE uint64_t
+vGetFrameNumber( void )
+{
+    return vState.Frame.number;
+}
+
+// Begin a secondary command buffer of the current frame on a recording thread, NULL outside of a frame.
+// Every thread index must be used by one thread at a time, its buffers come from a pool no other thread touches
+INLINE VkCommandBuffer
+vBeginSecondary( uint32_t thread, const VkCommandBufferInheritanceInfo * inheritance )
+{
+    if( !vState.Frame.active || VVUL_MAX_RECORD_THREADS <= thread ) return VK_NULL_HANDLE;
+
+    const VkDevice       device   = vState.Device.handle;
+    vvulThreadCommands * commands = &vState.Frame.frames[vState.Frame.index].threads[thread];
+    VkResult             result   = VK_SUCCESS;
+
+    if( VK_NULL_HANDLE == commands->pool )
+        {
+            VkCommandPoolCreateInfo poolInfo = { 0 };
+            poolInfo.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.flags                   = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            poolInfo.queueFamilyIndex        = vState.Queue.families[VVUL_QUEUE_GRAPHICS];
+
+            result = vkCreateCommandPool( device, &poolInfo, NULL, &commands->pool );
+            if( VK_SUCCESS != result )
+                {
+                    TRACELOG( LOG_ERROR, "VVUL: Failed to create recording pool: %s", VkResultToStr( result ) );
+                    return VK_NULL_HANDLE;
+                }
+        }
+
+    if( commands->used == commands->count )
+        {
+            if( commands->count == commands->capacity )
+                {
+                    const uint32_t    capacity = ( 0 == commands->capacity ) ? 8 : commands->capacity * 2;
+                    VkCommandBuffer * cmds
+                        = (VkCommandBuffer *)VUL_REALLOC( commands->cmds, capacity * sizeof( VkCommandBuffer ) );
+                    if( NULL == cmds ) return VK_NULL_HANDLE;
+
+                    commands->cmds     = cmds;
+                    commands->capacity = capacity;
+                }
+
+            VkCommandBufferAllocateInfo allocInfo = { 0 };
+            allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool                 = commands->pool;
+            allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocInfo.commandBufferCount          = 1;
+
+            result = vkAllocateCommandBuffers( device, &allocInfo, &commands->cmds[commands->count] );
+            if( VK_SUCCESS != result )
+                {
+                    TRACELOG( LOG_ERROR, "VVUL: Failed to allocate secondary command buffer: %s",
+                              VkResultToStr( result ) );
+                    return VK_NULL_HANDLE;
+                }
+            ++commands->count;
+        }
+
+    // Secondaries always need inheritance info, draws continue the render pass or dynamic rendering they inherit
+    VkCommandBufferInheritanceInfo emptyInheritance = { 0 };
+    emptyInheritance.sType                          = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    if( NULL == inheritance ) inheritance = &emptyInheritance;
+
+    bool                      continuesRendering = ( VK_NULL_HANDLE != inheritance->renderPass );
+    const VkBaseInStructure * next               = (const VkBaseInStructure *)inheritance->pNext;
+    for( ; NULL != next; next = next->pNext )
+        {
+            if( VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO == next->sType ) continuesRendering = true;
+        }
+
+    VkCommandBufferBeginInfo beginInfo = { 0 };
+    beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo         = inheritance;
+    if( continuesRendering ) beginInfo.flags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+
+    VkCommandBuffer cmd = commands->cmds[commands->used];
+    result              = vkBeginCommandBuffer( cmd, &beginInfo );
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_ERROR, "VVUL: Failed to begin secondary command buffer: %s", VkResultToStr( result ) );
+            return VK_NULL_HANDLE;
+        }
+
+    ++commands->used;
+
+    return cmd;
+}
+
+// End a secondary command buffer begun by vBeginSecondary()
+INLINE bool
+vEndSecondary( VkCommandBuffer cmd )
+{
+    const VkResult result = vkEndCommandBuffer( cmd );
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_ERROR, "VVUL: Failed to end secondary command buffer: %s", VkResultToStr( result ) );
+        }
+
+    return ( VK_SUCCESS == result );
+}
+
+// Execute recorded secondaries in order on the primary command buffer, from the thread recording the frame
+INLINE void
+vCmdExecuteSecondaries( const VkCommandBuffer * cmds, uint32_t count )
+{
+    if( !vState.Frame.active || 0 == count ) return;
+
+    vkCmdExecuteCommands( vState.Frame.frames[vState.Frame.index].cmd, count, cmds );
+}
+
+// Get the queue used for a role
+INLINE VkQueue
+vGetQueue( vvulQueueType type )
+{
+    return vState.Queue.handles[type];
+}
+
+// Get the queue family index used for a role
+INLINE uint32_t
+vGetQueueFamily( vvulQueueType type )
+{
+    return vState.Queue.families[type];
+}
+
+// Check if a role runs on its own queue, so its work can overlap graphics
+INLINE bool
+vIsQueueDedicated( vvulQueueType type )
+{
+    if( VVUL_QUEUE_GRAPHICS == type ) return true;
+
+    return vState.Queue.handles[type] != vState.Queue.handles[VVUL_QUEUE_GRAPHICS];
+}
+
+// Get the logical device, for resources created outside vvul
+INLINE VkDevice
+vGetDevice( void )
+{
+    return vState.Device.handle;
+}
+
+// Get the physical device the context was created on
+INLINE VkPhysicalDevice
+vGetPhysicalDevice( void )
+{
+    return vState.Device.physical;
+}
+
+// Get the properties (limits, timestamp period, ...) of the physical device
+INLINE const VkPhysicalDeviceProperties *
+vGetDeviceProperties( void )
+{
+    return &vState.Device.properties;
+}
+
+// Get the optional features enabled on the device
+INLINE const vvulDeviceFeatures *
+vGetDeviceFeatures( void )
+{
+    return &vState.Device.features;
+}
+
+// Get the pipeline cache, pass it to every vkCreate*Pipelines call so warm starts skip driver compilation
+INLINE VkPipelineCache
+vGetPipelineCache( void )
+{
+    return vState.PipelineCache.handle;
+}
+
+// Sub-allocate device memory for a resource, optimal tiling images must set optimalImage
+INLINE bool
+vAllocateMemory( const VkMemoryRequirements * requirements, vvulMemoryUsage usage, bool optimalImage,
+                 vvulAllocation * allocation )
+{
+    VkDeviceSize size      = requirements->size;
+    VkDeviceSize alignment = ( 0 < requirements->alignment ) ? requirements->alignment : 1;
+
+    // Optimal images own whole granularity pages, so linear resources can never alias a page with them
+    if( optimalImage && vState.Memory.granularity > alignment ) alignment = vState.Memory.granularity;
+    if( optimalImage ) size = ( size + vState.Memory.granularity - 1 ) & ~( vState.Memory.granularity - 1 );
+
+    memset( allocation, 0, sizeof( vvulAllocation ) );
+
+    // Fall back to the next best memory type when a heap is exhausted
+    uint32_t typeBits = requirements->memoryTypeBits;
+    while( 0 != typeBits )
+        {
+            const uint32_t typeIndex = vSelectMemoryType( typeBits, usage );
+            if( UINT32_MAX == typeIndex ) break;
+
+            if( vAllocateFromType( typeIndex, size, alignment, allocation ) ) return true;
+
+            typeBits &= ~( 1U << typeIndex );
+        }
+
+    TRACELOG( LOG_ERROR, "VVUL: Failed to allocate %llu bytes of device memory", (unsigned long long)size );
+
+    return false;
+}
+
+// Allocate and bind memory for a buffer
+INLINE bool
+vAllocateBufferMemory( VkBuffer buffer, vvulMemoryUsage usage, vvulAllocation * allocation )
+{
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements( vState.Device.handle, buffer, &requirements );
+
+    if( !vAllocateMemory( &requirements, usage, false, allocation ) ) return false;
+
+    vkBindBufferMemory( vState.Device.handle, buffer, allocation->memory, allocation->offset );
+
+    return true;
+}
+
+// Allocate and bind memory for an optimal tiling image
+INLINE bool
+vAllocateImageMemory( VkImage image, vvulMemoryUsage usage, vvulAllocation * allocation )
+{
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements( vState.Device.handle, image, &requirements );
+
+    if( !vAllocateMemory( &requirements, usage, true, allocation ) ) return false;
+
+    vkBindImageMemory( vState.Device.handle, image, allocation->memory, allocation->offset );
+
+    return true;
+}
+
+// Free an allocation, the GPU must not access it anymore (see vDeferFreeMemory)
+INLINE void
+vFreeMemory( vvulAllocation * allocation )
+{
+    if( VK_NULL_HANDLE == allocation->memory || VVUL_BLOCK_LINEAR == allocation->block ) return;
+
+    const uint32_t heap = vState.Device.memoryProperties.memoryTypes[allocation->typeIndex].heapIndex;
+    vState.Memory.used[heap] -= allocation->size;
+
+    if( VVUL_BLOCK_DEDICATED == allocation->block )
+        {
+            vFreeDeviceMemory( allocation->typeIndex, allocation->size, allocation->memory );
+        }
+    else
+        {
+            vvulMemoryBlock * block = vState.Memory.blocks[allocation->block];
+
+            block->used -= block->nodes[allocation->node].size;
+            --block->allocationCount;
+            vTlsfFree( block, allocation->node );
+
+            // Keep one empty block per memory type around, so that alloc/free patterns do not thrash the driver
+            if( 0 == block->allocationCount )
+                {
+                    for( uint32_t i = 0; i < vState.Memory.blockCount; ++i )
+                        {
+                            const vvulMemoryBlock * other = vState.Memory.blocks[i];
+                            if( NULL != other && other != block && other->typeIndex == block->typeIndex )
+                                {
+                                    vDestroyMemoryBlock( allocation->block );
+                                    break;
+                                }
+                        }
+                }
+        }
+
+    memset( allocation, 0, sizeof( vvulAllocation ) );
+}
+
+// Free an allocation once the frames in flight that may use it have completed
+INLINE void
+vDeferFreeMemory( const vvulAllocation * allocation )
+{
+    if( VK_NULL_HANDLE != allocation->memory ) vDeferDestroy( VVUL_GARBAGE_ALLOCATION, allocation );
+}
+
+// Create a linear pool, typeBits restricts the memory types the pool resources accept (UINT32_MAX: any)
+INLINE bool
+vCreateLinearPool( VkDeviceSize size, vvulMemoryUsage usage, uint32_t typeBits, vvulLinearPool * pool )
+{
+    memset( pool, 0, sizeof( vvulLinearPool ) );
+
+    pool->typeIndex = vSelectMemoryType( typeBits, usage );
+    if( UINT32_MAX == pool->typeIndex ) return false;
+
+    if( !vAllocateDeviceMemory( pool->typeIndex, size, &pool->memory, &pool->mapped ) )
+        {
+            TRACELOG( LOG_ERROR, "VVUL: Failed to allocate linear pool of %llu bytes", (unsigned long long)size );
+            return false;
+        }
+
+    pool->size = size;
+
+    return true;
+}
+
+// Bump allocate from a linear pool, memory is only reclaimed by vResetLinearPool()
+INLINE bool
+vLinearPoolAllocate( vvulLinearPool * pool, const VkMemoryRequirements * requirements, bool optimalImage,
+                     vvulAllocation * allocation )
+{
+    VkDeviceSize size      = requirements->size;
+    VkDeviceSize alignment = ( 0 < requirements->alignment ) ? requirements->alignment : 1;
+
+    if( 0 == ( requirements->memoryTypeBits & ( 1U << pool->typeIndex ) ) ) return false;
+
+    // Same page ownership rule as vAllocateMemory(), images never share a granularity page with buffers
+    if( optimalImage && vState.Memory.granularity > alignment ) alignment = vState.Memory.granularity;
+    if( optimalImage ) size = ( size + vState.Memory.granularity - 1 ) & ~( vState.Memory.granularity - 1 );
+
+    const VkDeviceSize offset = ( pool->offset + alignment - 1 ) & ~( alignment - 1 );
+    if( offset + size > pool->size ) return false;
+
+    allocation->memory    = pool->memory;
+    allocation->offset    = offset;
+    allocation->size      = size;
+    allocation->mapped    = ( NULL != pool->mapped ) ? (unsigned char *)pool->mapped + offset : NULL;
+    allocation->typeIndex = pool->typeIndex;
+    allocation->block     = VVUL_BLOCK_LINEAR;
+    allocation->node      = VVUL_NULL_NODE;
+
+    pool->offset = offset + size;
+
+    return true;
+}
+
+// Release every allocation of a linear pool, the GPU must not access them anymore
+INLINE void
+vResetLinearPool( vvulLinearPool * pool )
+{
+    pool->offset = 0;
+}
+
+// Free the device memory of a linear pool
+INLINE void
+vDestroyLinearPool( vvulLinearPool * pool )
+{
+    if( VK_NULL_HANDLE != pool->memory ) vFreeDeviceMemory( pool->typeIndex, pool->size, pool->memory );
+
+    memset( pool, 0, sizeof( vvulLinearPool ) );
+}
+
+// Get the memory usage of a heap, refreshed from VK_EXT_memory_budget when available
+INLINE vvulMemoryBudget
+vGetMemoryBudget( uint32_t heap )
+{
+    vvulMemoryBudget budget = { 0 };
+
+    if( heap >= vState.Device.memoryProperties.memoryHeapCount ) return budget;
+
+    vUpdateMemoryBudget();
+
+    budget.budget    = vState.Memory.budget[heap];
+    budget.usage     = vState.Memory.usage[heap];
+    budget.allocated = vState.Memory.allocated[heap];
+    budget.used      = vState.Memory.used[heap];
+
+    return budget;
+}
+
+// Upload data into a buffer, the previous contents of the written range are replaced.
+// Returns VVUL_UPLOAD_FAILED if any chunk could not be recorded, 0 for an empty upload
+INLINE vvulUploadTicket
+vUploadBuffer( VkBuffer buffer, VkDeviceSize offset, const void * data, VkDeviceSize size )
+{
+    if( 0 == size ) return 0;
+
+    const unsigned char * source   = (const unsigned char *)data;
+    VkCommandBuffer       cmd      = VK_NULL_HANDLE;
+    bool                  recorded = false;
+
+    // Large uploads are split so that they never need the whole ring at once
+    while( 0 < size )
+        {
+            const VkDeviceSize chunk = ( size < vState.Upload.size / 4 ) ? size : vState.Upload.size / 4;
+            VkDeviceSize       staging;
+
+            cmd = vAllocateStaging( chunk, &staging );
+            if( VK_NULL_HANDLE == cmd ) break;
+
+            memcpy( (unsigned char *)vState.Upload.memory.mapped + staging, source, (size_t)chunk );
+
+            const VkBufferCopy region = { staging, offset, chunk };
+            vkCmdCopyBuffer( cmd, vState.Upload.buffer, buffer, 1, &region );
+
+            source += chunk;
+            offset += chunk;
+            size -= chunk;
+            recorded = true;
+        }
+
+    if( !recorded ) return VVUL_UPLOAD_FAILED;
+
+    // A partial upload still released what its recorded chunks wrote, they may sit in batches already submitted
+    if( VK_NULL_HANDLE == cmd ) cmd = vGetUploadCommandBuffer();
+    if( VK_NULL_HANDLE == cmd ) return VVUL_UPLOAD_FAILED;
+
+    // Hand the buffer over to the graphics queue, the next frame records the matching acquire
+    if( vState.Upload.dedicated )
+        {
+            VkBufferMemoryBarrier barrier = { 0 };
+            barrier.sType                 = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.srcAccessMask         = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.srcQueueFamilyIndex   = vState.Queue.families[VVUL_QUEUE_TRANSFER];
+            barrier.dstQueueFamilyIndex   = vState.Queue.families[VVUL_QUEUE_GRAPHICS];
+            barrier.buffer                = buffer;
+            barrier.size                  = VK_WHOLE_SIZE;
+
+            vkCmdPipelineBarrier( cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL,
+                                  1, &barrier, 0, NULL );
+
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+            vPushAcquire( (void **)&vState.Upload.bufferAcquires, &vState.Upload.bufferAcquireCount,
+                          &vState.Upload.bufferAcquireCapacity, sizeof( VkBufferMemoryBarrier ), &barrier );
+        }
+
+    return ( 0 == size ) ? vState.Upload.next : VVUL_UPLOAD_FAILED;
+}
+
+// Upload a 2D mip level of an image, tightly packed rows of texelSize bytes, left in finalLayout
+INLINE vvulUploadTicket
+vUploadImage( VkImage image, uint32_t mipLevel, uint32_t width, uint32_t height, uint32_t texelSize,
+              const void * data, VkImageLayout finalLayout )
+{
+    return vUploadImageBlocks( image, mipLevel, width, height, 1, 1, texelSize, data, finalLayout );
+}
+
+// Upload a 2D mip level of a block compressed image, tightly packed rows of blocks of blockSize bytes.
+// width and height are in texels, the blocks of the last row and column may extend past them.
+// Returns VVUL_UPLOAD_FAILED if any row could not be recorded, 0 for an empty level
+INLINE vvulUploadTicket
+vUploadImageBlocks( VkImage image, uint32_t mipLevel, uint32_t width, uint32_t height, uint32_t blockWidth,
+                    uint32_t blockHeight, uint32_t blockSize, const void * data, VkImageLayout finalLayout )
+{
+    const unsigned char *         source    = (const unsigned char *)data;
+    const uint32_t                blocksY   = ( height + blockHeight - 1 ) / blockHeight;
+    const VkDeviceSize            rowPitch  = (VkDeviceSize)( ( width + blockWidth - 1 ) / blockWidth ) * blockSize;
+    const VkImageSubresourceRange range     = { VK_IMAGE_ASPECT_COLOR_BIT, mipLevel, 1, 0, 1 };
+    VkDeviceSize                  chunkRows = ( vState.Upload.size / 4 ) / rowPitch;
+    VkCommandBuffer               cmd       = VK_NULL_HANDLE;
+
+    if( 0 == blocksY || 0 == rowPitch ) return 0;
+    if( 0 == chunkRows ) chunkRows = 1;
+
+    uint32_t row = 0;
+    while( row < blocksY )
+        {
+            const uint32_t rows = ( blocksY - row < chunkRows ) ? blocksY - row : (uint32_t)chunkRows;
+            const uint32_t top  = row * blockHeight;
+            VkDeviceSize   staging;
+
+            cmd = vAllocateStaging( rows * rowPitch, &staging );
+            if( VK_NULL_HANDLE == cmd ) break;
+
+            // Chunks can land in later batches, the transition only happens once on the same queue
+            if( 0 == row )
+                {
+                    VkImageMemoryBarrier barrier = { 0 };
+                    barrier.sType                = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                    barrier.dstAccessMask        = VK_ACCESS_TRANSFER_WRITE_BIT;
+                    barrier.oldLayout            = VK_IMAGE_LAYOUT_UNDEFINED;
+                    barrier.newLayout            = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                    barrier.srcQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.dstQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.image                = image;
+                    barrier.subresourceRange     = range;
+
+                    vkCmdPipelineBarrier( cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                                          NULL, 0, NULL, 1, &barrier );
+                }
+
+            memcpy( (unsigned char *)vState.Upload.memory.mapped + staging, source + row * rowPitch,
+                    (size_t)( rows * rowPitch ) );
+
+            VkBufferImageCopy region               = { 0 };
+            region.bufferOffset                    = staging;
+            region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel       = mipLevel;
+            region.imageSubresource.layerCount     = 1;
+            region.imageOffset.y                   = (int32_t)top;
+            region.imageExtent.width               = width;
+            region.imageExtent.height              = ( height - top < rows * blockHeight ) ? height - top
+                                                                                           : rows * blockHeight;
+            region.imageExtent.depth               = 1;
+
+            vkCmdCopyBufferToImage( cmd, vState.Upload.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region );
+
+            row += rows;
+        }
+
+    const bool complete = ( row >= blocksY );
+    if( 0 == row ) return VVUL_UPLOAD_FAILED;
+
+    // A partial upload still leaves the transfer layout and the transfer queue, its chunks may be submitted already
+    if( VK_NULL_HANDLE == cmd ) cmd = vGetUploadCommandBuffer();
+    if( VK_NULL_HANDLE == cmd ) return VVUL_UPLOAD_FAILED;
+
+    // Final layout, with a release to the graphics queue when the copy ran on the transfer queue
+    VkImageMemoryBarrier barrier = { 0 };
+    barrier.sType                = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask        = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout            = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout            = finalLayout;
+    barrier.srcQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image                = image;
+    barrier.subresourceRange     = range;
+
+    if( vState.Upload.dedicated )
+        {
+            barrier.srcQueueFamilyIndex = vState.Queue.families[VVUL_QUEUE_TRANSFER];
+            barrier.dstQueueFamilyIndex = vState.Queue.families[VVUL_QUEUE_GRAPHICS];
+
+            vkCmdPipelineBarrier( cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL,
+                                  0, NULL, 1, &barrier );
+
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+            vPushAcquire( (void **)&vState.Upload.imageAcquires, &vState.Upload.imageAcquireCount,
+                          &vState.Upload.imageAcquireCapacity, sizeof( VkImageMemoryBarrier ), &barrier );
+        }
+    else
+        {
+            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+            vkCmdPipelineBarrier( cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, NULL,
+                                  0, NULL, 1, &barrier );
+        }
+
+    return complete ? vState.Upload.next : VVUL_UPLOAD_FAILED;
+}
+
+// Submit the recorded uploads, returns the ticket of the submitted batch (0 if there was nothing to submit)
+INLINE vvulUploadTicket
+vFlushUploads( void )
+{
+    if( !vState.Upload.recording ) return 0;
+
+    vvulUploadBatch * batch = &vState.Upload.batches[( vState.Upload.first + vState.Upload.count ) % VVUL_UPLOAD_BATCHES];
+
+    // Buffer copies on the graphics queue are made visible to every later submission at once
+    if( !vState.Upload.dedicated )
+        {
+            VkMemoryBarrier barrier = { 0 };
+            barrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask   = VK_ACCESS_MEMORY_READ_BIT;
+
+            vkCmdPipelineBarrier( batch->cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1,
+                                  &barrier, 0, NULL, 0, NULL );
+        }
+
+    vkEndCommandBuffer( batch->cmd );
+
+    batch->value   = vState.Upload.next;
+    batch->ringEnd = vState.Upload.head;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = { 0 };
+    timelineInfo.sType                         = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount     = 1;
+    timelineInfo.pSignalSemaphoreValues        = &batch->value;
+
+    VkSubmitInfo submitInfo       = { 0 };
+    submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers    = &batch->cmd;
+
+    if( VK_NULL_HANDLE != vState.Upload.timeline )
+        {
+            submitInfo.pNext                = &timelineInfo;
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores    = &vState.Upload.timeline;
+        }
+
+    const VkResult result = vkQueueSubmit( vState.Queue.handles[vState.Upload.queue], 1, &submitInfo, batch->fence );
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_ERROR, "VVUL: Failed to submit uploads: %s", VkResultToStr( result ) );
+        }
+
+    vState.Upload.recording = false;
+    ++vState.Upload.count;
+    ++vState.Upload.next;
+
+    return batch->value;
+}
+
+// Check if an upload finished, never blocks
+INLINE bool
+vIsUploadComplete( vvulUploadTicket ticket )
+{
+    if( ticket <= vState.Upload.completed ) return true;
+
+    vUpdateUploads();
+
+    return ticket <= vState.Upload.completed;
+}
+
+// Block until an upload finished, submitting it first if it is still being recorded
+INLINE void
+vWaitUpload( vvulUploadTicket ticket )
+{
+    if( ticket <= vState.Upload.completed ) return;
+    if( ticket >= vState.Upload.next ) vFlushUploads();
+    if( ticket >= vState.Upload.next ) return; // Never recorded, nothing to wait for
+
+    if( VK_NULL_HANDLE != vState.Upload.timeline )
+        {
+            VkSemaphoreWaitInfo waitInfo = { 0 };
+            waitInfo.sType               = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+            waitInfo.semaphoreCount      = 1;
+            waitInfo.pSemaphores         = &vState.Upload.timeline;
+            waitInfo.pValues             = &ticket;
+
+            vkWaitSemaphores( vState.Device.handle, &waitInfo, UINT64_MAX );
+        }
+    else
+        {
+            for( uint32_t i = 0; i < vState.Upload.count; ++i )
+                {
+                    const vvulUploadBatch * batch
+                        = &vState.Upload.batches[( vState.Upload.first + i ) % VVUL_UPLOAD_BATCHES];
+                    if( batch->value != ticket ) continue;
+
+                    vkWaitForFences( vState.Device.handle, 1, &batch->fence, VK_TRUE, UINT64_MAX );
+                    break;
+                }
+        }
+
+    vUpdateUploads();
+}
+
+// Get the render target size
+INLINE VkExtent2D
+vGetTargetExtent( void )
+{
+    return vState.Target.extent;
+}
+
+// Get the view of the render target, framebuffers holding it must be recreated when it changes
+INLINE VkImageView
+vGetTargetView( void )
+{
+    return vState.Target.view;
+}
+
+// Get the render pass drawing into the target, pipelines drawing into the target are created against it
+INLINE VkRenderPass
+vGetTargetRenderPass( void )
+{
+    return vState.Target.renderPass;
+}
+
+// Get the inheritance of secondaries executed in a target pass begun with secondary command buffer contents
+INLINE VkCommandBufferInheritanceInfo
+vGetTargetInheritance( void )
+{
+    VkCommandBufferInheritanceInfo inheritance = { 0 };
+    inheritance.sType                          = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance.renderPass                     = vState.Target.renderPass;
+    inheritance.framebuffer                    = vState.Target.framebuffer;
+
+    return inheritance;
+}
+
+// Begin drawing into the whole target, its content is preserved
+INLINE void
+vCmdBeginTargetPass( VkCommandBuffer cmd, VkSubpassContents contents )
+{
+    VkRenderPassBeginInfo beginInfo = { 0 };
+    beginInfo.sType                 = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    beginInfo.renderPass            = vState.Target.renderPass;
+    beginInfo.framebuffer           = vState.Target.framebuffer;
+    beginInfo.renderArea.extent     = vState.Target.extent;
+
+    vkCmdBeginRenderPass( cmd, &beginInfo, contents );
+}
+
+// End drawing into the target
+INLINE void
+vCmdEndTargetPass( VkCommandBuffer cmd )
+{
+    vkCmdEndRenderPass( cmd );
+}
+
+// Read back the render target as tightly packed RGBA8 pixels, the returned memory must be released with VUL_FREE
+INLINE void *
+vReadTargetPixels( uint32_t * width, uint32_t * height )
+{
+    const VkDevice     device = vState.Device.handle;
+    const VkExtent2D   extent = vState.Target.extent;
+    const VkDeviceSize size   = (VkDeviceSize)extent.width * extent.height * 4;
+
+    VkBuffer       buffer = VK_NULL_HANDLE;
+    vvulAllocation memory = { 0 };
+    void *         pixels = NULL;
+    VkResult       result;
+
+    // Host visible staging buffer, cached memory is preferred since the CPU reads it back
+    {
+        VkBufferCreateInfo bufferInfo = { 0 };
+        bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size               = size;
+        bufferInfo.usage              = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        bufferInfo.sharingMode        = VK_SHARING_MODE_EXCLUSIVE;
+
+        result = vkCreateBuffer( device, &bufferInfo, NULL, &buffer );
+        if( VK_SUCCESS != result )
+            {
+                TRACELOG( LOG_ERROR, "VVUL: Failed to create readback buffer: %s", VkResultToStr( result ) );
+                return NULL;
+            }
+
+        if( !vAllocateBufferMemory( buffer, VVUL_MEMORY_GPU_TO_CPU, &memory ) )
+            {
+                TRACELOG( LOG_ERROR, "VVUL: Failed to allocate readback memory" );
+                vkDestroyBuffer( device, buffer, NULL );
+                return NULL;
+            }
+    }
+
+    // Copy the target into the staging buffer
+    {
+        VkCommandBuffer cmd = vBeginImmediate();
+
+        // Nothing was drawn since the target was (re)created, give it defined contents
+        if( VK_IMAGE_LAYOUT_UNDEFINED == vState.Target.layout ) vCmdInitializeTarget( cmd );
+
+        vCmdImageBarrier( cmd, vState.Target.image, vState.Target.layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                          VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT );
+
+        VkBufferImageCopy region           = { 0 };
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent.width           = extent.width;
+        region.imageExtent.height          = extent.height;
+        region.imageExtent.depth           = 1;
+
+        vkCmdCopyImageToBuffer( cmd, vState.Target.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1, &region );
+
+        vCmdImageBarrier( cmd, vState.Target.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, vState.Target.layout,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                          VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT );
+
+        // Make the transfer visible to host reads
+        VkBufferMemoryBarrier hostBarrier = { 0 };
+        hostBarrier.sType                 = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        hostBarrier.srcAccessMask         = VK_ACCESS_TRANSFER_WRITE_BIT;
+        hostBarrier.dstAccessMask         = VK_ACCESS_HOST_READ_BIT;
+        hostBarrier.srcQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+        hostBarrier.dstQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+        hostBarrier.buffer                = buffer;
+        hostBarrier.size                  = VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier( cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, NULL, 1,
+                              &hostBarrier, 0, NULL );
+    }
+
+    // The immediate submission completed, so the staging range can be read and freed right away
+    if( vEndImmediate() )
+        {
+            pixels = VUL_MALLOC( (size_t)size );
+            if( NULL != pixels ) memcpy( pixels, memory.mapped, (size_t)size );
+        }
+
+    vkDestroyBuffer( device, buffer, NULL );
+    vFreeMemory( &memory );
+
+    if( NULL != pixels )
+        {
+            if( NULL != width ) *width = extent.width;
+            if( NULL != height ) *height = extent.height;
+        }
+
+    return pixels;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+
+static INLINE const char *
+VkResultToStr( VkResult err )
+{
+    switch( err )
+        {
+#    define STR( R )                                                                                                   \
+    case VK_##R: return #R
+            STR( SUCCESS );
+            STR( NOT_READY );
+            STR( TIMEOUT );
+            STR( EVENT_SET );
+            STR( EVENT_RESET );
+            STR( INCOMPLETE );
+            STR( ERROR_OUT_OF_HOST_MEMORY );
+            STR( ERROR_OUT_OF_DEVICE_MEMORY );
+            STR( ERROR_INITIALIZATION_FAILED );
+            STR( ERROR_DEVICE_LOST );
+            STR( ERROR_MEMORY_MAP_FAILED );
+            STR( ERROR_LAYER_NOT_PRESENT );
+            STR( ERROR_EXTENSION_NOT_PRESENT );
+            STR( ERROR_FEATURE_NOT_PRESENT );
+            STR( ERROR_INCOMPATIBLE_DRIVER );
+            STR( ERROR_TOO_MANY_OBJECTS );
+            STR( ERROR_FORMAT_NOT_SUPPORTED );
+            STR( ERROR_SURFACE_LOST_KHR );
+            STR( SUBOPTIMAL_KHR );
+            STR( ERROR_OUT_OF_DATE_KHR );
+            STR( ERROR_INCOMPATIBLE_DISPLAY_KHR );
+            STR( ERROR_NATIVE_WINDOW_IN_USE_KHR );
+            STR( ERROR_VALIDATION_FAILED_EXT );
+#    undef STR
+        default: return "UNKNOWN_RESULT";
+        }
+}
+
+// Create Vulkan instance
+static INLINE bool
+vCreateInstance( const char ** extensions, uint32_t extensionCount )
+{
+    VkApplicationInfo    appInfo    = { 0 };
+    VkInstanceCreateInfo createInfo = { 0 };
+    VkResult             result;
+
+    // Negotiate the version, Vulkan 1.0 loaders do not expose vkEnumerateInstanceVersion
+    {
+        PFN_vkEnumerateInstanceVersion enumerateVersion
+            = (PFN_vkEnumerateInstanceVersion)vkGetInstanceProcAddr( NULL, "vkEnumerateInstanceVersion" );
+
+        vState.Instance.apiVersion = VK_API_VERSION_1_0;
+        if( NULL != enumerateVersion ) enumerateVersion( &vState.Instance.apiVersion );
+        if( VVUL_API_VERSION < vState.Instance.apiVersion ) vState.Instance.apiVersion = VVUL_API_VERSION;
+    }
+
+    // Application Info
+    {
+        appInfo.sType              = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+        appInfo.pApplicationName   = "Vultra Application";
+        appInfo.applicationVersion = VK_MAKE_VERSION( 1, 0, 0 );
+        appInfo.pEngineName        = "Vultra";
+        appInfo.engineVersion      = VULTRA_VK_VERSION;
+        appInfo.apiVersion         = vState.Instance.apiVersion;
+    }
+
+    // Instance Create Info
+    {
+        createInfo.sType                   = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        createInfo.pApplicationInfo        = &appInfo;
+
+        createInfo.enabledExtensionCount   = extensionCount;
+        createInfo.ppEnabledExtensionNames = extensions;
+
+        // TODO: Implement valiantion layers
+        createInfo.enabledLayerCount       = 0;
+        createInfo.ppEnabledLayerNames     = NULL;
+    }
+
+    result = vkCreateInstance( &createInfo, NULL, &vState.Instance.handle );
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_FATAL, "VVUL: Failed to create Vulkan instance: %s", VkResultToStr( result ) );
+            return false;
+        }
+
+    return true;
+}
+
+// Select a physical device and create the logical device with its graphics, compute and transfer queues
+static INLINE bool
+vCreateDevice( const char * override )
+{
+    uint32_t deviceCount = 0;
+    VkResult result      = vkEnumeratePhysicalDevices( vState.Instance.handle, &deviceCount, NULL );
+    if( VK_SUCCESS != result || 0 == deviceCount )
+        {
+            TRACELOG( LOG_FATAL, "VVUL: No Vulkan physical device found" );
+            return false;
+        }
+
+    VkPhysicalDevice * devices = (VkPhysicalDevice *)VUL_MALLOC( deviceCount * sizeof( VkPhysicalDevice ) );
+    vkEnumeratePhysicalDevices( vState.Instance.handle, &deviceCount, devices );
+
+    const int selected = vSelectPhysicalDevice( devices, deviceCount, override );
+    if( 0 <= selected ) vState.Device.physical = devices[selected];
+
+    VUL_FREE( devices );
+
+    if( VK_NULL_HANDLE == vState.Device.physical )
+        {
+            TRACELOG( LOG_FATAL, "VVUL: No suitable Vulkan device found" );
+            return false;
+        }
+
+    const VkPhysicalDevice physical = vState.Device.physical;
+    vkGetPhysicalDeviceProperties( physical, &vState.Device.properties );
+    vkGetPhysicalDeviceMemoryProperties( physical, &vState.Device.memoryProperties );
+
+    vState.Device.apiVersion = vState.Device.properties.apiVersion < vState.Instance.apiVersion
+                                   ? vState.Device.properties.apiVersion
+                                   : vState.Instance.apiVersion;
+
+    // Queues, one per distinct family
+    //----------------------------------------------------------
+    const float             priorities[VVUL_QUEUE_COUNT] = { 1.0F, 1.0F, 1.0F };
+    VkDeviceQueueCreateInfo queueInfos[VVUL_QUEUE_COUNT] = { 0 };
+    uint32_t                queueInfoCount               = 0;
+
+    vFindQueueFamilies( physical, vState.Queue.families );
+
+    for( int type = 0; type < VVUL_QUEUE_COUNT; ++type )
+        {
+            bool unique = true;
+            for( uint32_t i = 0; i < queueInfoCount; ++i )
+                {
+                    if( queueInfos[i].queueFamilyIndex == vState.Queue.families[type] ) unique = false;
+                }
+            if( !unique ) continue;
+
+            queueInfos[queueInfoCount].sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            queueInfos[queueInfoCount].queueFamilyIndex = vState.Queue.families[type];
+            queueInfos[queueInfoCount].queueCount       = 1;
+            queueInfos[queueInfoCount].pQueuePriorities = priorities;
+            ++queueInfoCount;
+        }
+
+    // Features, every optional feature the device supports is enabled
+    //----------------------------------------------------------
+    VkPhysicalDeviceVulkan13Features features13 = { 0 };
+    VkPhysicalDeviceVulkan12Features features12 = { 0 };
+    VkPhysicalDeviceFeatures2        features   = { 0 };
+    vvulDeviceFeatures *             enabled    = &vState.Device.features;
+
+    vQueryDeviceFeatures( physical, vState.Device.apiVersion, enabled );
+
+    features.sType                              = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.features.multiDrawIndirect         = enabled->multiDrawIndirect;
+    features.features.drawIndirectFirstInstance = enabled->multiDrawIndirect;
+    features.features.textureCompressionBC      = enabled->textureCompressionBC;
+
+    if( VK_API_VERSION_1_2 <= vState.Device.apiVersion )
+        {
+            features12.sType                                         = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+            features12.timelineSemaphore                             = enabled->timelineSemaphore;
+            features12.drawIndirectCount                             = enabled->drawIndirectCount;
+            features12.hostQueryReset                                = enabled->hostQueryReset;
+            features12.descriptorIndexing                            = enabled->descriptorIndexing;
+            features12.runtimeDescriptorArray                        = enabled->descriptorIndexing;
+            features12.descriptorBindingPartiallyBound               = enabled->descriptorIndexing;
+            features12.descriptorBindingVariableDescriptorCount      = enabled->descriptorIndexing;
+            features12.descriptorBindingUpdateUnusedWhilePending     = enabled->descriptorIndexing;
+            features12.descriptorBindingSampledImageUpdateAfterBind  = enabled->descriptorIndexing;
+            features12.descriptorBindingStorageBufferUpdateAfterBind = enabled->descriptorIndexing;
+            features12.shaderSampledImageArrayNonUniformIndexing     = enabled->descriptorIndexing;
+            features12.shaderStorageBufferArrayNonUniformIndexing    = enabled->descriptorIndexing;
+            features.pNext                                           = &features12;
+        }
+
+    if( VK_API_VERSION_1_3 <= vState.Device.apiVersion )
+        {
+            features13.sType            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+            features13.synchronization2 = enabled->synchronization2;
+            features13.dynamicRendering = enabled->dynamicRendering;
+            features12.pNext            = &features13;
+        }
+
+    // Extensions
+    //----------------------------------------------------------
+    const char * extensions[VVUL_MAX_DEVICE_EXTENSIONS];
+    uint32_t     extensionCount = 0;
+
+    if( VK_NULL_HANDLE != vState.Swapchain.surface ) extensions[extensionCount++] = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+
+    // Budget queries go through vkGetPhysicalDeviceMemoryProperties2, core since Vulkan 1.1
+    if( VK_API_VERSION_1_1 <= vState.Device.apiVersion
+        && vDeviceHasExtension( physical, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME ) )
+        {
+            extensions[extensionCount++]  = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+            vState.Memory.budgetSupported = true;
+        }
+
+    // Required by the specification on non-conformant implementations (e.g. MoltenVK)
+    if( vDeviceHasExtension( physical, "VK_KHR_portability_subset" ) )
+        {
+            extensions[extensionCount++] = "VK_KHR_portability_subset";
+        }
+
+    // Device
+    //----------------------------------------------------------
+    VkDeviceCreateInfo createInfo      = { 0 };
+    createInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.queueCreateInfoCount    = queueInfoCount;
+    createInfo.pQueueCreateInfos       = queueInfos;
+    createInfo.enabledExtensionCount   = extensionCount;
+    createInfo.ppEnabledExtensionNames = extensions;
+
+    // Vulkan 1.0 devices cannot take a features chain
+    if( VK_API_VERSION_1_1 <= vState.Device.apiVersion ) createInfo.pNext = &features;
+    else createInfo.pEnabledFeatures = &features.features;
+
+    result = vkCreateDevice( physical, &createInfo, NULL, &vState.Device.handle );
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_FATAL, "VVUL: Failed to create logical device: %s", VkResultToStr( result ) );
+            return false;
+        }
+
+    vState.Memory.granularity = vState.Device.properties.limits.bufferImageGranularity;
+    if( 0 == vState.Memory.granularity ) vState.Memory.granularity = 1;
+
+    for( int type = 0; type < VVUL_QUEUE_COUNT; ++type )
+        {
+            vkGetDeviceQueue( vState.Device.handle, vState.Queue.families[type], 0, &vState.Queue.handles[type] );
+        }
+
+    TRACELOG( LOG_INFO, "VVUL: Device: %s (Vulkan %u.%u.%u)", vState.Device.properties.deviceName,
+              VK_API_VERSION_MAJOR( vState.Device.apiVersion ), VK_API_VERSION_MINOR( vState.Device.apiVersion ),
+              VK_API_VERSION_PATCH( vState.Device.apiVersion ) );
+    TRACELOG( LOG_INFO, "VVUL: Queue families: graphics %u, compute %u%s, transfer %u%s",
+              vState.Queue.families[VVUL_QUEUE_GRAPHICS], vState.Queue.families[VVUL_QUEUE_COMPUTE],
+              vIsQueueDedicated( VVUL_QUEUE_COMPUTE ) ? " (async)" : "", vState.Queue.families[VVUL_QUEUE_TRANSFER],
+              vIsQueueDedicated( VVUL_QUEUE_TRANSFER ) ? " (dedicated)" : "" );
+
+    return true;
+}
+
+// Check if a device extension is available
+static INLINE bool
+vDeviceHasExtension( VkPhysicalDevice device, const char * name )
+{
+    uint32_t count = 0;
+    bool     found = false;
+
+    vkEnumerateDeviceExtensionProperties( device, NULL, &count, NULL );
+    if( 0 == count ) return false;
+
+    VkExtensionProperties * properties = (VkExtensionProperties *)VUL_MALLOC( count * sizeof( VkExtensionProperties ) );
+    vkEnumerateDeviceExtensionProperties( device, NULL, &count, properties );
+
+    for( uint32_t i = 0; i < count && !found; ++i )
+        {
+            found = ( 0 == strcmp( properties[i].extensionName, name ) );
+        }
+
+    VUL_FREE( properties );
+
+    return found;
+}
+
+// Find the queue family of every role, UINT32_MAX for graphics if the device cannot render
+static INLINE void
+vFindQueueFamilies( VkPhysicalDevice device, uint32_t families[VVUL_QUEUE_COUNT] )
+{
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties( device, &familyCount, NULL );
+
+    VkQueueFamilyProperties * properties
+        = (VkQueueFamilyProperties *)VUL_MALLOC( familyCount * sizeof( VkQueueFamilyProperties ) );
+    vkGetPhysicalDeviceQueueFamilyProperties( device, &familyCount, properties );
+
+    for( int type = 0; type < VVUL_QUEUE_COUNT; ++type ) families[type] = UINT32_MAX;
+
+    for( uint32_t f = 0; f < familyCount; ++f )
+        {
+            const VkQueueFlags flags    = properties[f].queueFlags;
+            const bool         graphics = ( 0 != ( flags & VK_QUEUE_GRAPHICS_BIT ) );
+            const bool         compute  = ( 0 != ( flags & VK_QUEUE_COMPUTE_BIT ) );
+            const bool         transfer = ( 0 != ( flags & VK_QUEUE_TRANSFER_BIT ) );
+
+            if( 0 == properties[f].queueCount ) continue;
+
+            if( graphics && UINT32_MAX == families[VVUL_QUEUE_GRAPHICS] ) families[VVUL_QUEUE_GRAPHICS] = f;
+
+            // Compute without graphics runs asynchronously to the graphics queue
+            if( compute && !graphics && UINT32_MAX == families[VVUL_QUEUE_COMPUTE] ) families[VVUL_QUEUE_COMPUTE] = f;
+
+            // Transfer only families map to the copy engines
+            if( transfer && !graphics && !compute && UINT32_MAX == families[VVUL_QUEUE_TRANSFER] )
+                {
+                    families[VVUL_QUEUE_TRANSFER] = f;
+                }
+        }
+
+    VUL_FREE( properties );
+
+    // Fallbacks: transfers can still overlap graphics on the async compute queue, otherwise share graphics
+    if( UINT32_MAX == families[VVUL_QUEUE_COMPUTE] ) families[VVUL_QUEUE_COMPUTE] = families[VVUL_QUEUE_GRAPHICS];
+    if( UINT32_MAX == families[VVUL_QUEUE_TRANSFER] ) families[VVUL_QUEUE_TRANSFER] = families[VVUL_QUEUE_COMPUTE];
+}
+
+// Query which optional features the device supports
+static INLINE void
+vQueryDeviceFeatures( VkPhysicalDevice device, uint32_t apiVersion, vvulDeviceFeatures * supported )
+{
+    VkPhysicalDeviceVulkan13Features features13 = { 0 };
+    VkPhysicalDeviceVulkan12Features features12 = { 0 };
+    VkPhysicalDeviceFeatures2        features   = { 0 };
+
+    features.sType   = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+
+    if( VK_API_VERSION_1_2 <= apiVersion ) features.pNext = &features12;
+    if( VK_API_VERSION_1_3 <= apiVersion ) features12.pNext = &features13;
+
+    if( VK_API_VERSION_1_1 <= apiVersion ) vkGetPhysicalDeviceFeatures2( device, &features );
+    else vkGetPhysicalDeviceFeatures( device, &features.features );
+
+    memset( supported, 0, sizeof( vvulDeviceFeatures ) );
+
+    supported->multiDrawIndirect    = features.features.multiDrawIndirect && features.features.drawIndirectFirstInstance;
+    supported->textureCompressionBC = features.features.textureCompressionBC;
+
+    supported->timelineSemaphore  = features12.timelineSemaphore;
+    supported->drawIndirectCount  = features12.drawIndirectCount;
+    supported->hostQueryReset     = features12.hostQueryReset;
+    supported->descriptorIndexing = features12.descriptorIndexing && features12.runtimeDescriptorArray
+                                    && features12.descriptorBindingPartiallyBound
+                                    && features12.descriptorBindingVariableDescriptorCount
+                                    && features12.descriptorBindingUpdateUnusedWhilePending
+                                    && features12.descriptorBindingSampledImageUpdateAfterBind
+                                    && features12.descriptorBindingStorageBufferUpdateAfterBind
+                                    && features12.shaderSampledImageArrayNonUniformIndexing
+                                    && features12.shaderStorageBufferArrayNonUniformIndexing;
+    supported->synchronization2   = features13.synchronization2;
+    supported->dynamicRendering   = features13.dynamicRendering;
+}
+
+// Rate a physical device, negative if it cannot be used
+static INLINE int64_t
+vScorePhysicalDevice( VkPhysicalDevice device )
+{
+    VkPhysicalDeviceProperties       properties;
+    VkPhysicalDeviceMemoryProperties memory;
+    vvulDeviceFeatures               features;
+    uint32_t                         families[VVUL_QUEUE_COUNT];
+    int64_t                          score = 0;
+
+    vkGetPhysicalDeviceProperties( device, &properties );
+    vkGetPhysicalDeviceMemoryProperties( device, &memory );
+
+    // Requirements
+    vFindQueueFamilies( device, families );
+    if( UINT32_MAX == families[VVUL_QUEUE_GRAPHICS] ) return -1;
+
+    // Windowed contexts present from the graphics queue
+    if( VK_NULL_HANDLE != vState.Swapchain.surface )
+        {
+            VkBool32 present = VK_FALSE;
+            if( !vDeviceHasExtension( device, VK_KHR_SWAPCHAIN_EXTENSION_NAME ) ) return -1;
+            vkGetPhysicalDeviceSurfaceSupportKHR( device, families[VVUL_QUEUE_GRAPHICS], vState.Swapchain.surface,
+                                                  &present );
+            if( VK_TRUE != present ) return -1;
+        }
+
+    // Type, hardware first, software implementations remain usable as a last resort
+    switch( properties.deviceType )
+        {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:   score += 1000000; break;
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: score += 500000; break;
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:    score += 250000; break;
+        case VK_PHYSICAL_DEVICE_TYPE_CPU:            score += 10000; break;
+        default:                                     break;
+        }
+
+    // Features and queue topology
+    const uint32_t apiVersion = properties.apiVersion < vState.Instance.apiVersion ? properties.apiVersion
+                                                                                    : vState.Instance.apiVersion;
+    vQueryDeviceFeatures( device, apiVersion, &features );
+
+    score += 20000 * ( features.timelineSemaphore + features.descriptorIndexing + features.drawIndirectCount
+                       + features.synchronization2 + features.dynamicRendering + features.multiDrawIndirect );
+    if( families[VVUL_QUEUE_COMPUTE] != families[VVUL_QUEUE_GRAPHICS] ) score += 30000;
+    if( families[VVUL_QUEUE_TRANSFER] != families[VVUL_QUEUE_GRAPHICS] ) score += 30000;
+
+    // Limits: device local memory (MiB) and maximum render target size
+    for( uint32_t i = 0; i < memory.memoryHeapCount; ++i )
+        {
+            if( memory.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT )
+                {
+                    score += (int64_t)( memory.memoryHeaps[i].size >> 20 );
+                }
+        }
+    score += properties.limits.maxImageDimension2D;
+
+    return score;
+}
+
+// Select the physical device to use, either the override (index or name substring) or the best rated one
+static INLINE int
+vSelectPhysicalDevice( VkPhysicalDevice * devices, uint32_t count, const char * override )
+{
+    int     best      = -1;
+    int64_t bestScore = -1;
+
+    if( !( NULL != override && '\0' != override[0] ) ) override = getenv( VVUL_DEVICE_ENV );
+
+    for( uint32_t i = 0; i < count; ++i )
+        {
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties( devices[i], &properties );
+
+            const int64_t score = vScorePhysicalDevice( devices[i] );
+            TRACELOGD( "VVUL: Device %u: %s (score %lld)", i, properties.deviceName, (long long)score );
+
+            if( score > bestScore )
+                {
+                    best      = (int)i;
+                    bestScore = score;
+                }
+        }
+
+    if( NULL != override && '\0' != override[0] )
+        {
+            char *     end   = NULL;
+            const long index = strtol( override, &end, 10 );
+
+            for( uint32_t i = 0; i < count; ++i )
+                {
+                    VkPhysicalDeviceProperties properties;
+                    vkGetPhysicalDeviceProperties( devices[i], &properties );
+
+                    const bool match = ( '\0' == *end ) ? ( (long)i == index )
+                                                         : ( NULL != strstr( properties.deviceName, override ) );
+                    if( !match ) continue;
+
+                    if( 0 > vScorePhysicalDevice( devices[i] ) )
+                        {
+                            TRACELOG( LOG_WARNING, "VVUL: Requested device '%s' is not suitable, ignoring override",
+                                      properties.deviceName );
+                            break;
+                        }
+
+                    return (int)i;
+                }
+
+            TRACELOG( LOG_WARNING, "VVUL: No device matches override '%s', selecting automatically", override );
+        }
+
+    return best;
+}
+
+// Create the command pool and fence used for blocking one-shot submissions
+static INLINE bool
+vCreateImmediateContext( void )
+{
+    const VkDevice device = vState.Device.handle;
+
+    VkCommandPoolCreateInfo poolInfo = { 0 };
+    poolInfo.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags                   = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex        = vState.Queue.families[VVUL_QUEUE_GRAPHICS];
+
+    VkCommandBufferAllocateInfo allocInfo = { 0 };
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount          = 1;
+
+    VkFenceCreateInfo fenceInfo = { 0 };
+    fenceInfo.sType             = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    VkResult result = vkCreateCommandPool( device, &poolInfo, NULL, &vState.Immediate.pool );
+    if( VK_SUCCESS == result )
+        {
+            allocInfo.commandPool = vState.Immediate.pool;
+            result                = vkAllocateCommandBuffers( device, &allocInfo, &vState.Immediate.cmd );
+        }
+    if( VK_SUCCESS == result ) result = vkCreateFence( device, &fenceInfo, NULL, &vState.Immediate.fence );
+
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_FATAL, "VVUL: Failed to create immediate submission context: %s", VkResultToStr( result ) );
+            return false;
+        }
+
+    return true;
+}
+
+// Create the render pass drawing into the target, which stays in color attachment layout between passes
+static INLINE bool
+vCreateTargetRenderPass( void )
+{
+    VkAttachmentDescription attachment = { 0 };
+    attachment.format                  = VVUL_TARGET_FORMAT;
+    attachment.samples                 = VK_SAMPLE_COUNT_1_BIT;
+    attachment.loadOp                  = VK_ATTACHMENT_LOAD_OP_LOAD;
+    attachment.storeOp                 = VK_ATTACHMENT_STORE_OP_STORE;
+    attachment.stencilLoadOp           = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachment.stencilStoreOp          = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachment.initialLayout           = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    attachment.finalLayout             = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    const VkAttachmentReference colorReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+
+    VkSubpassDescription subpass = { 0 };
+    subpass.pipelineBindPoint    = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments    = &colorReference;
+
+    // Earlier writes (initialization clear, previous passes, presentation copy) finish before the pass draws
+    VkSubpassDependency dependency = { 0 };
+    dependency.srcSubpass          = VK_SUBPASS_EXTERNAL;
+    dependency.dstSubpass          = 0;
+    dependency.srcStageMask        = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dependency.srcAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    dependency.dstStageMask        = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.dstAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    VkRenderPassCreateInfo renderPassInfo = { 0 };
+    renderPassInfo.sType                  = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount        = 1;
+    renderPassInfo.pAttachments           = &attachment;
+    renderPassInfo.subpassCount           = 1;
+    renderPassInfo.pSubpasses             = &subpass;
+    renderPassInfo.dependencyCount        = 1;
+    renderPassInfo.pDependencies          = &dependency;
+
+    const VkResult result
+        = vkCreateRenderPass( vState.Device.handle, &renderPassInfo, NULL, &vState.Target.renderPass );
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_FATAL, "VVUL: Failed to create render target pass: %s", VkResultToStr( result ) );
+            return false;
+        }
+
+    return true;
+}
+
+// Create the offscreen color target, its contents are defined by the first frame recording into it
+static INLINE bool
+vCreateTarget( uint32_t width, uint32_t height )
+{
+    const VkDevice device = vState.Device.handle;
+    VkResult       result;
+
+    VkImageCreateInfo imageInfo = { 0 };
+    imageInfo.sType             = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType         = VK_IMAGE_TYPE_2D;
+    imageInfo.format            = VVUL_TARGET_FORMAT;
+    imageInfo.extent.width      = width;
+    imageInfo.extent.height     = height;
+    imageInfo.extent.depth      = 1;
+    imageInfo.mipLevels         = 1;
+    imageInfo.arrayLayers       = 1;
+    imageInfo.samples           = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling            = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    result = vkCreateImage( device, &imageInfo, NULL, &vState.Target.image );
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_FATAL, "VVUL: Failed to create render target: %s", VkResultToStr( result ) );
+            return false;
+        }
+
+    if( !vAllocateImageMemory( vState.Target.image, VVUL_MEMORY_GPU_ONLY, &vState.Target.memory ) )
+        {
+            TRACELOG( LOG_FATAL, "VVUL: Failed to allocate render target memory" );
+            return false;
+        }
+
+    VkImageViewCreateInfo viewInfo       = { 0 };
+    viewInfo.sType                       = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image                       = vState.Target.image;
+    viewInfo.viewType                    = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format                      = VVUL_TARGET_FORMAT;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    result = vkCreateImageView( device, &viewInfo, NULL, &vState.Target.view );
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_FATAL, "VVUL: Failed to create render target view: %s", VkResultToStr( result ) );
+            return false;
+        }
+
+    VkFramebufferCreateInfo framebufferInfo = { 0 };
+    framebufferInfo.sType                   = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass              = vState.Target.renderPass;
+    framebufferInfo.attachmentCount         = 1;
+    framebufferInfo.pAttachments            = &vState.Target.view;
+    framebufferInfo.width                   = width;
+    framebufferInfo.height                  = height;
+    framebufferInfo.layers                  = 1;
+
+    result = vkCreateFramebuffer( device, &framebufferInfo, NULL, &vState.Target.framebuffer );
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_FATAL, "VVUL: Failed to create render target framebuffer: %s", VkResultToStr( result ) );
+            return false;
+        }
+
+    vState.Target.extent.width  = width;
+    vState.Target.extent.height = height;
+    vState.Target.layout        = VK_IMAGE_LAYOUT_UNDEFINED; // Initialized by the first command buffer using it
+
+    return true;
+}
+
+// Retire the render target, it is destroyed once no frame in flight references it
+static INLINE void
+vRetireTarget( void )
+{
+    vDeferDestroy( VVUL_GARBAGE_FRAMEBUFFER, &vState.Target.framebuffer );
+    vDeferDestroy( VVUL_GARBAGE_IMAGE_VIEW, &vState.Target.view );
+    vDeferDestroy( VVUL_GARBAGE_IMAGE, &vState.Target.image );
+    vDeferFreeMemory( &vState.Target.memory );
+
+    vState.Target.framebuffer = VK_NULL_HANDLE;
+    vState.Target.view        = VK_NULL_HANDLE;
+    vState.Target.image       = VK_NULL_HANDLE;
+    memset( &vState.Target.memory, 0, sizeof( vvulAllocation ) );
+}
+
+// Clear a freshly created render target and leave it in color attachment layout
+static INLINE void
+vCmdInitializeTarget( VkCommandBuffer cmd )
+{
+    const VkImageSubresourceRange range = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    const VkClearColorValue       black = { { 0.0F, 0.0F, 0.0F, 1.0F } };
+
+    vCmdImageBarrier( cmd, vState.Target.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                      VK_ACCESS_TRANSFER_WRITE_BIT );
+
+    vkCmdClearColorImage( cmd, vState.Target.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &black, 1, &range );
+
+    vCmdImageBarrier( cmd, vState.Target.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                      VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                      VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                      VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT );
+
+    vState.Target.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+}
+
+// Create the per frame-in-flight command pools, fences and semaphores
+static INLINE bool
+vCreateFrames( uint32_t count )
+{
+    const VkDevice device = vState.Device.handle;
+    VkResult       result = VK_SUCCESS;
+
+    VkCommandPoolCreateInfo poolInfo = { 0 };
+    poolInfo.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags                   = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex        = vState.Queue.families[VVUL_QUEUE_GRAPHICS];
+
+    // Created signaled, so waiting on a slot that was never submitted returns immediately
+    VkFenceCreateInfo fenceInfo = { 0 };
+    fenceInfo.sType             = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags             = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    VkSemaphoreCreateInfo semaphoreInfo = { 0 };
+    semaphoreInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    vState.Frame.count = count;
+
+    for( uint32_t i = 0; i < count && VK_SUCCESS == result; ++i )
+        {
+            vvulFrame * frame = &vState.Frame.frames[i];
+
+            result = vkCreateCommandPool( device, &poolInfo, NULL, &frame->pool );
+            if( VK_SUCCESS == result )
+                {
+                    VkCommandBufferAllocateInfo allocInfo = { 0 };
+                    allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                    allocInfo.commandPool                 = frame->pool;
+                    allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+                    allocInfo.commandBufferCount          = 1;
+
+                    result = vkAllocateCommandBuffers( device, &allocInfo, &frame->cmd );
+                }
+            if( VK_SUCCESS == result ) result = vkCreateFence( device, &fenceInfo, NULL, &frame->fence );
+            if( VK_SUCCESS == result )
+                {
+                    result = vkCreateSemaphore( device, &semaphoreInfo, NULL, &frame->imageAvailable );
+                }
+        }
+
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_FATAL, "VVUL: Failed to create frame resources: %s", VkResultToStr( result ) );
+            return false;
+        }
+
+    TRACELOG( LOG_INFO, "VVUL: Frames in flight: %u", count );
+
+    return true;
+}
+
+// Destroy the per frame-in-flight resources
+static INLINE void
+vDestroyFrames( void )
+{
+    const VkDevice device = vState.Device.handle;
+
+    for( uint32_t i = 0; i < vState.Frame.count; ++i )
+        {
+            vvulFrame * frame = &vState.Frame.frames[i];
+
+            vkDestroySemaphore( device, frame->imageAvailable, NULL );
+            vkDestroyFence( device, frame->fence, NULL );
+            vkDestroyCommandPool( device, frame->pool, NULL );
+
+            for( uint32_t t = 0; t < VVUL_MAX_RECORD_THREADS; ++t )
+                {
+                    vkDestroyCommandPool( device, frame->threads[t].pool, NULL );
+                    VUL_FREE( frame->threads[t].cmds );
+                }
+            memset( frame->threads, 0, sizeof( frame->threads ) );
+        }
+
+    vState.Frame.count = 0;
+}
+
+// Recycle the secondaries the recording threads used the last time this frame slot was recorded
+static INLINE void
+vResetThreadCommands( vvulFrame * frame )
+{
+    for( uint32_t t = 0; t < VVUL_MAX_RECORD_THREADS; ++t )
+        {
+            vvulThreadCommands * commands = &frame->threads[t];
+            if( 0 == commands->used ) continue;
+
+            vkResetCommandPool( vState.Device.handle, commands->pool, 0 );
+            commands->used = 0;
+        }
+}
+
+// Create or recreate the swapchain, the previous one is handed over through oldSwapchain and retired
+static INLINE bool
+vCreateSwapchain( void )
+{
+    const VkDevice         device   = vState.Device.handle;
+    const VkPhysicalDevice physical = vState.Device.physical;
+    const VkSurfaceKHR     surface  = vState.Swapchain.surface;
+    VkSurfaceCapabilitiesKHR capabilities;
+    VkResult                 result;
+
+    result = vkGetPhysicalDeviceSurfaceCapabilitiesKHR( physical, surface, &capabilities );
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_ERROR, "VVUL: Failed to query surface capabilities: %s", VkResultToStr( result ) );
+            return false;
+        }
+
+    // Extent, a special value of UINT32_MAX lets the framebuffer size decide
+    VkExtent2D extent = capabilities.currentExtent;
+    if( UINT32_MAX == extent.width )
+        {
+            extent = vState.Swapchain.requestedExtent;
+            if( extent.width < capabilities.minImageExtent.width ) extent.width = capabilities.minImageExtent.width;
+            if( extent.width > capabilities.maxImageExtent.width ) extent.width = capabilities.maxImageExtent.width;
+            if( extent.height < capabilities.minImageExtent.height ) extent.height = capabilities.minImageExtent.height;
+            if( extent.height > capabilities.maxImageExtent.height ) extent.height = capabilities.maxImageExtent.height;
+        }
+
+    // Minimized, keep the current swapchain until the window is restored
+    if( 0 == extent.width || 0 == extent.height )
+        {
+            vState.Swapchain.extent = extent;
+            return true;
+        }
+
+    // Format, the render target is UNORM so the swapchain must not apply another sRGB encode
+    {
+        uint32_t           count = 0;
+        VkSurfaceFormatKHR formats[64];
+
+        vkGetPhysicalDeviceSurfaceFormatsKHR( physical, surface, &count, NULL );
+        if( VUL_ARRAYSIZE( formats ) < (int)count ) count = VUL_ARRAYSIZE( formats );
+        vkGetPhysicalDeviceSurfaceFormatsKHR( physical, surface, &count, formats );
+
+        vState.Swapchain.format = formats[0];
+        for( uint32_t i = 0; i < count; ++i )
+            {
+                if( ( VK_FORMAT_B8G8R8A8_UNORM == formats[i].format || VVUL_TARGET_FORMAT == formats[i].format )
+                    && VK_COLOR_SPACE_SRGB_NONLINEAR_KHR == formats[i].colorSpace )
+                    {
+                        vState.Swapchain.format = formats[i];
+                        break;
+                    }
+            }
+
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties( physical, vState.Swapchain.format.format, &properties );
+        vState.Swapchain.blit = ( 0 != ( properties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT ) );
+    }
+
+    // Present mode, FIFO is the only mode guaranteed to exist
+    {
+        static const VkPresentModeKHR preferences[][3] = {
+            [VVUL_PRESENT_LOW_LATENCY] = { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR,
+                                           VK_PRESENT_MODE_FIFO_KHR },
+            [VVUL_PRESENT_VSYNC]     = { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR },
+            [VVUL_PRESENT_IMMEDIATE] = { VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR,
+                                         VK_PRESENT_MODE_FIFO_KHR },
+        };
+
+        uint32_t         count = 0;
+        VkPresentModeKHR modes[16];
+
+        vkGetPhysicalDeviceSurfacePresentModesKHR( physical, surface, &count, NULL );
+        if( VUL_ARRAYSIZE( modes ) < (int)count ) count = VUL_ARRAYSIZE( modes );
+        vkGetPhysicalDeviceSurfacePresentModesKHR( physical, surface, &count, modes );
+
+        vState.Swapchain.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+        for( int p = 0; p < 3 && VK_PRESENT_MODE_FIFO_KHR == vState.Swapchain.presentMode; ++p )
+            {
+                const VkPresentModeKHR candidate = preferences[vState.Swapchain.requestedMode][p];
+                for( uint32_t i = 0; i < count; ++i )
+                    {
+                        if( candidate == modes[i] )
+                            {
+                                vState.Swapchain.presentMode = candidate;
+                                break;
+                            }
+                    }
+                if( VK_PRESENT_MODE_FIFO_KHR == candidate ) break;
+            }
+    }
+
+    // One image more than the minimum, so acquiring never waits on the presentation engine
+    uint32_t imageCount = capabilities.minImageCount + 1;
+    if( 0 < capabilities.maxImageCount && imageCount > capabilities.maxImageCount )
+        {
+            imageCount = capabilities.maxImageCount;
+        }
+    if( VVUL_MAX_SWAPCHAIN_IMAGES < imageCount ) imageCount = VVUL_MAX_SWAPCHAIN_IMAGES;
+
+    VkSwapchainCreateInfoKHR createInfo = { 0 };
+    createInfo.sType                    = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+    createInfo.surface                  = surface;
+    createInfo.minImageCount            = imageCount;
+    createInfo.imageFormat              = vState.Swapchain.format.format;
+    createInfo.imageColorSpace          = vState.Swapchain.format.colorSpace;
+    createInfo.imageExtent              = extent;
+    createInfo.imageArrayLayers         = 1;
+    createInfo.imageUsage               = VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    createInfo.imageSharingMode         = VK_SHARING_MODE_EXCLUSIVE;
+    createInfo.preTransform             = capabilities.currentTransform;
+    createInfo.compositeAlpha           = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    createInfo.presentMode              = vState.Swapchain.presentMode;
+    createInfo.clipped                  = VK_TRUE;
+    createInfo.oldSwapchain             = vState.Swapchain.handle; // Lets the driver reuse resources, no GPU drain
+
+    VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+    result                   = vkCreateSwapchainKHR( device, &createInfo, NULL, &swapchain );
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_ERROR, "VVUL: Failed to create swapchain: %s", VkResultToStr( result ) );
+            return false;
+        }
+
+    // Retire the previous swapchain and its semaphores, frames in flight may still present from them
+    vDestroySwapchain();
+
+    vState.Swapchain.handle     = swapchain;
+    vState.Swapchain.extent     = extent;
+    vState.Swapchain.imageCount = VVUL_MAX_SWAPCHAIN_IMAGES;
+    vState.Swapchain.outdated   = false;
+    vkGetSwapchainImagesKHR( device, swapchain, &vState.Swapchain.imageCount, vState.Swapchain.images );
+
+    VkSemaphoreCreateInfo semaphoreInfo = { 0 };
+    semaphoreInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    for( uint32_t i = 0; i < vState.Swapchain.imageCount; ++i )
+        {
+            vkCreateSemaphore( device, &semaphoreInfo, NULL, &vState.Swapchain.renderFinished[i] );
+        }
+
+    TRACELOG( LOG_INFO, "VVUL: Swapchain: %ux%u, %u images, present mode %d", extent.width, extent.height,
+              vState.Swapchain.imageCount, (int)vState.Swapchain.presentMode );
+
+    return true;
+}
+
+// Retire the swapchain and its semaphores
+static INLINE void
+vDestroySwapchain( void )
+{
+    if( VK_NULL_HANDLE == vState.Swapchain.handle ) return;
+
+    for( uint32_t i = 0; i < vState.Swapchain.imageCount; ++i )
+        {
+            vDeferDestroy( VVUL_GARBAGE_SEMAPHORE, &vState.Swapchain.renderFinished[i] );
+            vState.Swapchain.renderFinished[i] = VK_NULL_HANDLE;
+        }
+    vDeferDestroy( VVUL_GARBAGE_SWAPCHAIN, &vState.Swapchain.handle );
+
+    vState.Swapchain.handle     = VK_NULL_HANDLE;
+    vState.Swapchain.imageCount = 0;
+}
+
+// Record the copy of the render target into the acquired swapchain image, leaving it ready to present
+static INLINE void
+vCmdPresentTarget( VkCommandBuffer cmd )
+{
+    const VkImage    image  = vState.Swapchain.images[vState.Swapchain.imageIndex];
+    const VkExtent2D source = vState.Target.extent;
+    const VkExtent2D dest   = vState.Swapchain.extent;
+
+    vCmdImageBarrier( cmd, vState.Target.image, vState.Target.layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                      VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+                      VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT );
+    vCmdImageBarrier( cmd, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                      VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                      VK_ACCESS_TRANSFER_WRITE_BIT );
+
+    const VkImageSubresourceLayers layers = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+
+    if( vState.Swapchain.blit )
+        {
+            // Blits convert between RGBA and BGRA and scale while the target catches up with a resize
+            VkImageBlit region      = { 0 };
+            region.srcSubresource   = layers;
+            region.srcOffsets[1].x  = (int32_t)source.width;
+            region.srcOffsets[1].y  = (int32_t)source.height;
+            region.srcOffsets[1].z  = 1;
+            region.dstSubresource   = layers;
+            region.dstOffsets[1].x  = (int32_t)dest.width;
+            region.dstOffsets[1].y  = (int32_t)dest.height;
+            region.dstOffsets[1].z  = 1;
+
+            vkCmdBlitImage( cmd, vState.Target.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image,
+                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region, VK_FILTER_LINEAR );
+        }
+    else
+        {
+            VkImageCopy region    = { 0 };
+            region.srcSubresource = layers;
+            region.dstSubresource = layers;
+            region.extent.width   = ( source.width < dest.width ) ? source.width : dest.width;
+            region.extent.height  = ( source.height < dest.height ) ? source.height : dest.height;
+            region.extent.depth   = 1;
+
+            vkCmdCopyImage( cmd, vState.Target.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image,
+                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region );
+        }
+
+    vCmdImageBarrier( cmd, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                      VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0 );
+    vCmdImageBarrier( cmd, vState.Target.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, vState.Target.layout,
+                      VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                      VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT );
+}
+
+// Create the staging ring and the upload command buffers
+static INLINE bool
+vCreateUploadContext( void )
+{
+    const VkDevice device = vState.Device.handle;
+    VkResult       result;
+
+    // Copies go to the transfer queue only when it is separate and frames can wait on it with a timeline
+    vState.Upload.dedicated = vState.Device.features.timelineSemaphore && vIsQueueDedicated( VVUL_QUEUE_TRANSFER );
+    vState.Upload.queue     = vState.Upload.dedicated ? VVUL_QUEUE_TRANSFER : VVUL_QUEUE_GRAPHICS;
+    vState.Upload.size      = VVUL_STAGING_SIZE;
+    vState.Upload.next      = 1;
+
+    VkBufferCreateInfo bufferInfo = { 0 };
+    bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size               = vState.Upload.size;
+    bufferInfo.usage              = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode        = VK_SHARING_MODE_EXCLUSIVE;
+
+    result = vkCreateBuffer( device, &bufferInfo, NULL, &vState.Upload.buffer );
+    if( VK_SUCCESS != result || !vAllocateBufferMemory( vState.Upload.buffer, VVUL_MEMORY_CPU_TO_GPU,
+                                                        &vState.Upload.memory ) )
+        {
+            TRACELOG( LOG_FATAL, "VVUL: Failed to create staging buffer" );
+            return false;
+        }
+
+    VkCommandPoolCreateInfo poolInfo = { 0 };
+    poolInfo.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags                   = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex        = vState.Queue.families[vState.Upload.queue];
+
+    result = vkCreateCommandPool( device, &poolInfo, NULL, &vState.Upload.pool );
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_FATAL, "VVUL: Failed to create upload command pool: %s", VkResultToStr( result ) );
+            return false;
+        }
+
+    VkCommandBufferAllocateInfo allocInfo = { 0 };
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool                 = vState.Upload.pool;
+    allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount          = 1;
+
+    VkFenceCreateInfo fenceInfo = { 0 };
+    fenceInfo.sType             = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    for( uint32_t i = 0; i < VVUL_UPLOAD_BATCHES && VK_SUCCESS == result; ++i )
+        {
+            result = vkAllocateCommandBuffers( device, &allocInfo, &vState.Upload.batches[i].cmd );
+            if( VK_SUCCESS == result && !vState.Device.features.timelineSemaphore )
+                {
+                    result = vkCreateFence( device, &fenceInfo, NULL, &vState.Upload.batches[i].fence );
+                }
+        }
+
+    if( VK_SUCCESS == result && vState.Device.features.timelineSemaphore )
+        {
+            VkSemaphoreTypeCreateInfo typeInfo = { 0 };
+            typeInfo.sType                     = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+            typeInfo.semaphoreType             = VK_SEMAPHORE_TYPE_TIMELINE;
+            typeInfo.initialValue              = 0;
+
+            VkSemaphoreCreateInfo semaphoreInfo = { 0 };
+            semaphoreInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            semaphoreInfo.pNext                 = &typeInfo;
+
+            result = vkCreateSemaphore( device, &semaphoreInfo, NULL, &vState.Upload.timeline );
+        }
+
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_FATAL, "VVUL: Failed to create upload context: %s", VkResultToStr( result ) );
+            return false;
+        }
+
+    TRACELOG( LOG_INFO, "VVUL: Uploads: %llu MiB staging ring on the %s queue",
+              (unsigned long long)( vState.Upload.size >> 20 ), vState.Upload.dedicated ? "transfer" : "graphics" );
+
+    return true;
+}
+
+// Destroy the staging ring, the device must be idle
+static INLINE void
+vDestroyUploadContext( void )
+{
+    const VkDevice device = vState.Device.handle;
+
+    for( uint32_t i = 0; i < VVUL_UPLOAD_BATCHES; ++i ) vkDestroyFence( device, vState.Upload.batches[i].fence, NULL );
+
+    vkDestroySemaphore( device, vState.Upload.timeline, NULL );
+    vkDestroyCommandPool( device, vState.Upload.pool, NULL );
+    vkDestroyBuffer( device, vState.Upload.buffer, NULL );
+    vFreeMemory( &vState.Upload.memory );
+
+    VUL_FREE( vState.Upload.bufferAcquires );
+    VUL_FREE( vState.Upload.imageAcquires );
+}
+
+// Reserve a staging range, returns the command buffer the copy from it must be recorded into
+static INLINE VkCommandBuffer
+vAllocateStaging( VkDeviceSize size, VkDeviceSize * offset )
+{
+    const VkDeviceSize ringSize = vState.Upload.size;
+
+    size = ( size + VVUL_STAGING_ALIGNMENT - 1 ) & ~( (VkDeviceSize)VVUL_STAGING_ALIGNMENT - 1 );
+    if( size > ringSize ) return VK_NULL_HANDLE;
+
+    // Ranges never wrap, the end of the ring is skipped instead
+    uint64_t           head     = vState.Upload.head;
+    const VkDeviceSize position = head % ringSize;
+    if( position + size > ringSize ) head += ringSize - position;
+
+    // Ring full: submit what is recorded and reclaim the oldest batches until the range fits
+    while( head + size - vState.Upload.tail > ringSize )
+        {
+            vUpdateUploads();
+            if( head + size - vState.Upload.tail <= ringSize ) break;
+
+            if( 0 == vState.Upload.count ) vFlushUploads();
+            if( 0 == vState.Upload.count ) return VK_NULL_HANDLE; // Nothing in flight can free space
+
+            vWaitUpload( vState.Upload.batches[vState.Upload.first].value );
+        }
+
+    VkCommandBuffer cmd = vGetUploadCommandBuffer();
+    if( VK_NULL_HANDLE == cmd ) return VK_NULL_HANDLE;
+
+    *offset            = head % ringSize;
+    vState.Upload.head = head + size;
+
+    return cmd;
+}
+
+// Get the command buffer of the batch being recorded, beginning one if needed
+static INLINE VkCommandBuffer
+vGetUploadCommandBuffer( void )
+{
+    if( !vState.Upload.recording )
+        {
+            // Every batch is in flight, the oldest one must complete before its command buffer is reused
+            if( VVUL_UPLOAD_BATCHES == vState.Upload.count )
+                {
+                    vWaitUpload( vState.Upload.batches[vState.Upload.first].value );
+                }
+
+            vvulUploadBatch * batch
+                = &vState.Upload.batches[( vState.Upload.first + vState.Upload.count ) % VVUL_UPLOAD_BATCHES];
+
+            VkCommandBufferBeginInfo beginInfo = { 0 };
+            beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            if( VK_SUCCESS != vkBeginCommandBuffer( batch->cmd, &beginInfo ) ) return VK_NULL_HANDLE;
+            vState.Upload.recording = true;
+        }
+
+    return vState.Upload.batches[( vState.Upload.first + vState.Upload.count ) % VVUL_UPLOAD_BATCHES].cmd;
+}
+
+// Reclaim the staging ranges of completed batches
+static INLINE void
+vUpdateUploads( void )
+{
+    const VkDevice device = vState.Device.handle;
+
+    if( VK_NULL_HANDLE != vState.Upload.timeline )
+        {
+            vkGetSemaphoreCounterValue( device, vState.Upload.timeline, &vState.Upload.completed );
+        }
+
+    while( 0 < vState.Upload.count )
+        {
+            vvulUploadBatch * batch = &vState.Upload.batches[vState.Upload.first];
+
+            if( VK_NULL_HANDLE == vState.Upload.timeline )
+                {
+                    if( VK_SUCCESS != vkGetFenceStatus( device, batch->fence ) ) break;
+
+                    vkResetFences( device, 1, &batch->fence );
+                    vState.Upload.completed = batch->value;
+                }
+            else if( batch->value > vState.Upload.completed )
+                {
+                    break;
+                }
+
+            vState.Upload.tail  = batch->ringEnd;
+            vState.Upload.first = ( vState.Upload.first + 1 ) % VVUL_UPLOAD_BATCHES;
+            --vState.Upload.count;
+        }
+}
+
+// Submit pending uploads and record the ownership acquires of everything released so far
+static INLINE void
+vCmdAcquireUploads( VkCommandBuffer cmd )
+{
+    vFlushUploads();
+    vUpdateUploads();
+
+    if( !vState.Upload.dedicated ) return;
+    if( 0 == vState.Upload.bufferAcquireCount && 0 == vState.Upload.imageAcquireCount ) return;
+
+    vkCmdPipelineBarrier( cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, NULL,
+                          vState.Upload.bufferAcquireCount, vState.Upload.bufferAcquires,
+                          vState.Upload.imageAcquireCount, vState.Upload.imageAcquires );
+
+    // The releases were submitted, so the frame waits for the last submitted batch
+    vState.Upload.waited             = vState.Upload.next - 1;
+    vState.Upload.bufferAcquireCount = 0;
+    vState.Upload.imageAcquireCount  = 0;
+}
+
+// Append an ownership acquire barrier to a growable array
+static INLINE bool
+vPushAcquire( void ** barriers, uint32_t * count, uint32_t * capacity, size_t size, const void * barrier )
+{
+    if( *count == *capacity )
+        {
+            const uint32_t grown  = ( 0 == *capacity ) ? 64 : *capacity * 2;
+            void *         memory = VUL_REALLOC( *barriers, grown * size );
+            if( NULL == memory )
+                {
+                    TRACELOG( LOG_ERROR, "VVUL: Failed to grow upload acquire barriers" );
+                    return false;
+                }
+
+            *barriers = memory;
+            *capacity = grown;
+        }
+
+    memcpy( (unsigned char *)*barriers + *count * size, barrier, size );
+    ++*count;
+
+    return true;
+}
+
+// Create the pipeline cache, seeded from the cache file when it was written by this device and driver
+static INLINE bool
+vCreatePipelineCache( const char * directory )
+{
+    size_t dataSize = 0;
+    void * data     = NULL;
+
+    vState.PipelineCache.path[0] = '\0';
+    if( NULL != directory && '\0' != directory[0] )
+        {
+            const int length = snprintf( vState.PipelineCache.path, VVUL_MAX_PATH, "%s/%s", directory,
+                                         VVUL_PIPELINE_CACHE_FILE );
+            if( 0 > length || VVUL_MAX_PATH <= length )
+                {
+                    TRACELOG( LOG_WARNING, "VVUL: Pipeline cache path too long, pipelines will not be persisted" );
+                    vState.PipelineCache.path[0] = '\0';
+                }
+        }
+
+    if( '\0' != vState.PipelineCache.path[0] ) data = vLoadPipelineCacheData( &dataSize );
+
+    VkPipelineCacheCreateInfo cacheInfo = { 0 };
+    cacheInfo.sType                     = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize           = dataSize;
+    cacheInfo.pInitialData              = data;
+
+    VkResult result = vkCreatePipelineCache( vState.Device.handle, &cacheInfo, NULL, &vState.PipelineCache.handle );
+
+    // Drivers may still reject data that passed validation, start cold rather than fail
+    if( VK_SUCCESS != result && NULL != data )
+        {
+            TRACELOG( LOG_WARNING, "VVUL: Pipeline cache data rejected by the driver, starting cold" );
+            cacheInfo.initialDataSize = 0;
+            cacheInfo.pInitialData    = NULL;
+            result = vkCreatePipelineCache( vState.Device.handle, &cacheInfo, NULL, &vState.PipelineCache.handle );
+        }
+
+    VUL_FREE( data );
+
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_FATAL, "VVUL: Failed to create pipeline cache: %s", VkResultToStr( result ) );
+            return false;
+        }
+
+    if( 0 < dataSize )
+        {
+            TRACELOG( LOG_INFO, "VVUL: Pipeline cache: loaded %llu KiB from %s", (unsigned long long)( dataSize >> 10 ),
+                      vState.PipelineCache.path );
+        }
+
+    return true;
+}
+
+// Write the pipeline cache back, merged with what other processes stored since it was loaded
+static INLINE void
+vSavePipelineCache( void )
+{
+    const VkDevice device = vState.Device.handle;
+
+    if( VK_NULL_HANDLE == vState.PipelineCache.handle || '\0' == vState.PipelineCache.path[0] ) return;
+
+    // Another instance may have written the file meanwhile, keep its pipelines too
+    {
+        size_t diskSize = 0;
+        void * diskData = vLoadPipelineCacheData( &diskSize );
+
+        if( NULL != diskData )
+            {
+                VkPipelineCacheCreateInfo cacheInfo = { 0 };
+                cacheInfo.sType                     = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+                cacheInfo.initialDataSize           = diskSize;
+                cacheInfo.pInitialData              = diskData;
+
+                VkPipelineCache disk = VK_NULL_HANDLE;
+                if( VK_SUCCESS == vkCreatePipelineCache( device, &cacheInfo, NULL, &disk ) )
+                    {
+                        vkMergePipelineCaches( device, vState.PipelineCache.handle, 1, &disk );
+                        vkDestroyPipelineCache( device, disk, NULL );
+                    }
+
+                VUL_FREE( diskData );
+            }
+    }
+
+    size_t   dataSize = 0;
+    VkResult result   = vkGetPipelineCacheData( device, vState.PipelineCache.handle, &dataSize, NULL );
+    if( VK_SUCCESS != result || 0 == dataSize ) return;
+
+    void * data = VUL_MALLOC( dataSize );
+    if( NULL == data ) return;
+
+    result = vkGetPipelineCacheData( device, vState.PipelineCache.handle, &dataSize, data );
+    if( VK_SUCCESS == result )
+        {
+            vvulPipelineCacheHeader header = { 0 };
+            header.magic                   = VVUL_PIPELINE_CACHE_MAGIC;
+            header.format                  = VVUL_PIPELINE_CACHE_FORMAT;
+            header.driverVersion           = vState.Device.properties.driverVersion;
+            header.dataSize                = dataSize;
+            header.checksum                = vHashBytes( data, dataSize, 0 );
+
+            if( vWriteFileAtomic( vState.PipelineCache.path, &header, sizeof( header ), data, dataSize ) )
+                {
+                    TRACELOG( LOG_INFO, "VVUL: Pipeline cache: saved %llu KiB", (unsigned long long)( dataSize >> 10 ) );
+                }
+            else
+                {
+                    TRACELOG( LOG_WARNING, "VVUL: Failed to write pipeline cache %s", vState.PipelineCache.path );
+                }
+        }
+
+    VUL_FREE( data );
+}
+
+// Read the cache file and return its driver data, NULL when missing, corrupt or written by another device or driver
+static INLINE void *
+vLoadPipelineCacheData( size_t * size )
+{
+    size_t                  fileSize = 0;
+    unsigned char *         file     = (unsigned char *)vReadFile( vState.PipelineCache.path, &fileSize );
+    vvulPipelineCacheHeader header;
+    const char *            reason = NULL;
+
+    *size = 0;
+    if( NULL == file ) return NULL;
+
+    // Layout: vvul header, then the driver data starting with VkPipelineCacheHeaderVersionOne
+    if( sizeof( header ) + sizeof( VkPipelineCacheHeaderVersionOne ) > fileSize ) reason = "truncated";
+
+    if( NULL == reason )
+        {
+            memcpy( &header, file, sizeof( header ) );
+            if( VVUL_PIPELINE_CACHE_MAGIC != header.magic || VVUL_PIPELINE_CACHE_FORMAT != header.format )
+                {
+                    reason = "unknown format";
+                }
+            else if( header.dataSize != fileSize - sizeof( header ) )
+                {
+                    reason = "truncated";
+                }
+            else if( header.checksum != vHashBytes( file + sizeof( header ), (size_t)header.dataSize, 0 ) )
+                {
+                    reason = "corrupt";
+                }
+            else if( header.driverVersion != vState.Device.properties.driverVersion )
+                {
+                    reason = "driver changed";
+                }
+        }
+
+    if( NULL == reason )
+        {
+            VkPipelineCacheHeaderVersionOne driver;
+            memcpy( &driver, file + sizeof( header ), sizeof( driver ) );
+
+            if( sizeof( driver ) > driver.headerSize || VK_PIPELINE_CACHE_HEADER_VERSION_ONE != driver.headerVersion )
+                {
+                    reason = "unknown driver header";
+                }
+            else if( driver.vendorID != vState.Device.properties.vendorID
+                     || driver.deviceID != vState.Device.properties.deviceID
+                     || 0 != memcmp( driver.pipelineCacheUUID, vState.Device.properties.pipelineCacheUUID,
+                                     VK_UUID_SIZE ) )
+                {
+                    reason = "device changed";
+                }
+        }
+
+    if( NULL != reason )
+        {
+            TRACELOG( LOG_WARNING, "VVUL: Discarding pipeline cache %s (%s)", vState.PipelineCache.path, reason );
+            VUL_FREE( file );
+            return NULL;
+        }
+
+    // Drop the vvul header in place, callers receive the driver data only
+    *size = (size_t)header.dataSize;
+    memmove( file, file + sizeof( header ), *size );
+
+    return file;
+}
+
+// 64-bit FNV-1a hash, chain calls by passing the previous hash as seed (0: start a new hash)
+static INLINE uint64_t
+vHashBytes( const void * data, size_t size, uint64_t seed )
+{
+    const unsigned char * bytes = (const unsigned char *)data;
+    uint64_t              hash  = ( 0 == seed ) ? 14695981039346656037ULL : seed;
+
+    for( size_t i = 0; i < size; ++i )
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+
+    return hash;
+}
+
+// Read a whole file, the returned memory must be released with VUL_FREE, NULL if it cannot be read
+static INLINE void *
+vReadFile( const char * path, size_t * size )
+{
+    FILE * file = fopen( path, "rb" );
+    void * data = NULL;
+    long   length;
+
+    *size = 0;
+    if( NULL == file ) return NULL;
+
+    if( 0 == fseek( file, 0, SEEK_END ) && 0 < ( length = ftell( file ) ) && 0 == fseek( file, 0, SEEK_SET ) )
+        {
+            data = VUL_MALLOC( (size_t)length );
+            if( NULL != data && (size_t)length != fread( data, 1, (size_t)length, file ) )
+                {
+                    VUL_FREE( data );
+                    data = NULL;
+                }
+        }
+
+    fclose( file );
+
+    if( NULL != data ) *size = (size_t)length;
+
+    return data;
+}
+
+// Write a file through a temporary that replaces it once complete, readers never observe a partial file
+static INLINE bool
+vWriteFileAtomic( const char * path, const void * header, size_t headerSize, const void * data, size_t dataSize )
+{
+    // Unique per process, several processes may share the cache path
+    char temporary[VVUL_MAX_PATH + 24];
+    snprintf( temporary, sizeof( temporary ), "%s.%d.tmp", path, (int)VVUL_PROCESS_ID() );
+
+    FILE * file = fopen( temporary, "wb" );
+    if( NULL == file ) return false;
+
+    bool written = ( headerSize == fwrite( header, 1, headerSize, file ) )
+                && ( dataSize == fwrite( data, 1, dataSize, file ) ) && ( 0 == fflush( file ) );
+    written = ( 0 == fclose( file ) ) && written;
+
+#    if defined( _WIN32 )
+    // rename() never replaces an existing file on Windows
+    if( written ) written = ( 0 != MoveFileExA( temporary, path, 0x1 /* MOVEFILE_REPLACE_EXISTING */ ) );
+#    else
+    if( written ) written = ( 0 == rename( temporary, path ) );
+#    endif
+
+    if( !written ) remove( temporary );
+
+    return written;
+}
+
+// Queue a resource for destruction once the frames in flight at retirement time have completed
+INLINE void
+vDeferDestroy( vvulGarbageType type, const void * handle )
+{
+    // Full ring: grow it, the wrapped part moves after the old end to keep the retirement order
+    if( vState.Garbage.capacity == vState.Garbage.count )
+        {
+            const uint32_t capacity
+                = ( 0 == vState.Garbage.capacity ) ? VVUL_GARBAGE_CAPACITY : 2 * vState.Garbage.capacity;
+            vvulGarbage * items
+                = (vvulGarbage *)VUL_REALLOC( vState.Garbage.items, capacity * sizeof( vvulGarbage ) );
+
+            if( NULL != items )
+                {
+                    memcpy( &items[vState.Garbage.capacity], items, vState.Garbage.head * sizeof( vvulGarbage ) );
+                    vState.Garbage.items    = items;
+                    vState.Garbage.capacity = capacity;
+                }
+            else
+                {
+                    // Out of memory: drain the device, the resources of the frame being recorded are still kept
+                    TRACELOG( LOG_WARNING, "VVUL: Deferred destruction queue cannot grow, waiting for the device" );
+                    vkDeviceWaitIdle( vState.Device.handle );
+                    vCollectGarbage( vState.Frame.number );
+                    if( vState.Garbage.capacity == vState.Garbage.count )
+                        {
+                            TRACELOG( LOG_ERROR, "VVUL: Deferred destruction queue full, resource leaked" );
+                            return;
+                        }
+                }
+        }
+
+    const uint32_t tail = ( vState.Garbage.head + vState.Garbage.count ) % vState.Garbage.capacity;
+    vvulGarbage *  item = &vState.Garbage.items[tail];
+
+    item->frame = vState.Frame.number;
+    item->type  = type;
+
+    // Non-dispatchable handles share a single size
+    size_t size = sizeof( VkImage );
+    if( VVUL_GARBAGE_ALLOCATION == type ) size = sizeof( vvulAllocation );
+    else if( VVUL_GARBAGE_DESCRIPTOR_SET == type ) size = sizeof( vvulPooledSet );
+    else if( VVUL_GARBAGE_IMAGE_RESOURCES == type ) size = sizeof( vvulRetiredImage );
+    memcpy( &item->handle, handle, size );
+
+    ++vState.Garbage.count;
+}
+
+// Queue an image, its views and its memory (may be NULL) as a single entry, null handles are skipped
+INLINE void
+vDeferDestroyImage( VkImage image, const VkImageView * views, uint32_t viewCount, const vvulAllocation * memory )
+{
+    vvulRetiredImage retired = { 0 };
+    retired.image            = image;
+
+    if( 1 == viewCount ) retired.view = views[0];
+    else if( 1 < viewCount )
+        {
+            retired.views = (VkImageView *)VUL_MALLOC( viewCount * sizeof( VkImageView ) );
+            if( NULL != retired.views )
+                {
+                    memcpy( retired.views, views, viewCount * sizeof( VkImageView ) );
+                    retired.viewCount = viewCount;
+                }
+            else
+                {
+                    // Out of memory: one entry per view
+                    for( uint32_t i = 0; i < viewCount; ++i )
+                        {
+                            if( VK_NULL_HANDLE != views[i] ) vDeferDestroy( VVUL_GARBAGE_IMAGE_VIEW, &views[i] );
+                        }
+                }
+        }
+
+    if( NULL != memory ) retired.memory = *memory;
+
+    if( VK_NULL_HANDLE == retired.image && VK_NULL_HANDLE == retired.view && 0 == retired.viewCount
+        && VK_NULL_HANDLE == retired.memory.memory )
+        {
+            return;
+        }
+
+    vDeferDestroy( VVUL_GARBAGE_IMAGE_RESOURCES, &retired );
+}
+
+// Destroy the resources retired before frame end (UINT64_MAX: all of them, on shutdown only)
+static INLINE void
+vCollectGarbage( uint64_t end )
+{
+    const VkDevice device = vState.Device.handle;
+
+    while( 0 < vState.Garbage.count )
+        {
+            vvulGarbage * item = &vState.Garbage.items[vState.Garbage.head];
+
+            if( item->frame >= end ) break;
+
+            switch( item->type )
+                {
+                case VVUL_GARBAGE_SWAPCHAIN:   vkDestroySwapchainKHR( device, item->handle.swapchain, NULL ); break;
+                case VVUL_GARBAGE_SEMAPHORE:   vkDestroySemaphore( device, item->handle.semaphore, NULL ); break;
+                case VVUL_GARBAGE_IMAGE:       vkDestroyImage( device, item->handle.image, NULL ); break;
+                case VVUL_GARBAGE_IMAGE_VIEW:  vkDestroyImageView( device, item->handle.view, NULL ); break;
+                case VVUL_GARBAGE_BUFFER:      vkDestroyBuffer( device, item->handle.buffer, NULL ); break;
+                case VVUL_GARBAGE_MEMORY:      vkFreeMemory( device, item->handle.memory, NULL ); break;
+                case VVUL_GARBAGE_ALLOCATION:  vFreeMemory( &item->handle.allocation ); break;
+                case VVUL_GARBAGE_FRAMEBUFFER: vkDestroyFramebuffer( device, item->handle.framebuffer, NULL ); break;
+                case VVUL_GARBAGE_DESCRIPTOR_SET:
+                    vkFreeDescriptorSets( device, item->handle.descriptorSet.pool, 1, &item->handle.descriptorSet.set );
+                    break;
+                case VVUL_GARBAGE_IMAGE_RESOURCES:
+                    {
+                        vvulRetiredImage * retired = &item->handle.retiredImage;
+
+                        for( uint32_t i = 0; i < retired->viewCount; ++i )
+                            {
+                                vkDestroyImageView( device, retired->views[i], NULL );
+                            }
+                        VUL_FREE( retired->views );
+                        vkDestroyImageView( device, retired->view, NULL );
+                        vkDestroyImage( device, retired->image, NULL );
+                        if( VK_NULL_HANDLE != retired->memory.memory ) vFreeMemory( &retired->memory );
+                    }
+                    break;
+                default: break;
+                }
+
+            vState.Garbage.head = ( vState.Garbage.head + 1 ) % vState.Garbage.capacity;
+            --vState.Garbage.count;
+        }
+}
+
+// Find a memory type index matching the type bits and property flags, UINT32_MAX if none
+static INLINE uint32_t
+vFindMemoryType( uint32_t typeBits, VkMemoryPropertyFlags properties )
+{
+    const VkPhysicalDeviceMemoryProperties * memory = &vState.Device.memoryProperties;
+
+    for( uint32_t i = 0; i < memory->memoryTypeCount; ++i )
+        {
+            if( ( typeBits & ( 1U << i ) ) && ( properties == ( memory->memoryTypes[i].propertyFlags & properties ) ) )
+                {
+                    return i;
+                }
+        }
+
+    return UINT32_MAX;
+}
+
+// Select the best memory type for an access pattern, UINT32_MAX if none matches
+static INLINE uint32_t
+vSelectMemoryType( uint32_t typeBits, vvulMemoryUsage usage )
+{
+    VkMemoryPropertyFlags required  = 0;
+    VkMemoryPropertyFlags preferred = 0;
+
+    switch( usage )
+        {
+        case VVUL_MEMORY_GPU_ONLY: preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT; break;
+        case VVUL_MEMORY_CPU_TO_GPU:
+            required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            break;
+        case VVUL_MEMORY_GPU_TO_CPU:
+            required  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            preferred = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+            break;
+        default: break;
+        }
+
+    const uint32_t typeIndex = vFindMemoryType( typeBits, required | preferred );
+    return ( UINT32_MAX != typeIndex ) ? typeIndex : vFindMemoryType( typeBits, required );
+}
+
+// Size of the blocks carved for a memory type, an eighth of heaps up to 1GiB (integrated GPUs, BAR)
+static INLINE VkDeviceSize
+vGetBlockSize( uint32_t typeIndex )
+{
+    const VkPhysicalDeviceMemoryProperties * memory = &vState.Device.memoryProperties;
+    const VkDeviceSize heapSize = memory->memoryHeaps[memory->memoryTypes[typeIndex].heapIndex].size;
+
+    return ( heapSize <= ( (VkDeviceSize)1 << 30 ) ) ? heapSize / 8 : VVUL_MEMORY_BLOCK_SIZE;
+}
+
+// Refresh the per heap budget and usage
+static INLINE void
+vUpdateMemoryBudget( void )
+{
+    const VkPhysicalDeviceMemoryProperties * memory = &vState.Device.memoryProperties;
+
+    if( vState.Memory.budgetSupported )
+        {
+            VkPhysicalDeviceMemoryBudgetPropertiesEXT budget = { 0 };
+            budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+            VkPhysicalDeviceMemoryProperties2 properties = { 0 };
+            properties.sType                             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+            properties.pNext                             = &budget;
+
+            vkGetPhysicalDeviceMemoryProperties2( vState.Device.physical, &properties );
+
+            for( uint32_t heap = 0; heap < memory->memoryHeapCount; ++heap )
+                {
+                    vState.Memory.budget[heap] = budget.heapBudget[heap];
+                    vState.Memory.usage[heap]  = budget.heapUsage[heap];
+                }
+        }
+    else
+        {
+            // Without the extension, assume the process can use most of the heap and only count our own memory
+            for( uint32_t heap = 0; heap < memory->memoryHeapCount; ++heap )
+                {
+                    vState.Memory.budget[heap] = memory->memoryHeaps[heap].size / 10 * 8;
+                    vState.Memory.usage[heap]  = vState.Memory.allocated[heap];
+                }
+        }
+}
+
+// Allocate and, when host visible, persistently map a device memory object
+static INLINE bool
+vAllocateDeviceMemory( uint32_t typeIndex, VkDeviceSize size, VkDeviceMemory * memory, void ** mapped )
+{
+    const VkMemoryType * type = &vState.Device.memoryProperties.memoryTypes[typeIndex];
+
+    if( vState.Memory.allocationCount >= vState.Device.properties.limits.maxMemoryAllocationCount )
+        {
+            TRACELOG( LOG_ERROR, "VVUL: maxMemoryAllocationCount (%u) reached",
+                      vState.Device.properties.limits.maxMemoryAllocationCount );
+            return false;
+        }
+
+    VkMemoryAllocateInfo allocInfo = { 0 };
+    allocInfo.sType                = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize       = size;
+    allocInfo.memoryTypeIndex      = typeIndex;
+
+    if( VK_SUCCESS != vkAllocateMemory( vState.Device.handle, &allocInfo, NULL, memory ) ) return false;
+
+    *mapped = NULL;
+    if( type->propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT )
+        {
+            if( VK_SUCCESS != vkMapMemory( vState.Device.handle, *memory, 0, VK_WHOLE_SIZE, 0, mapped ) )
+                {
+                    vkFreeMemory( vState.Device.handle, *memory, NULL );
+                    return false;
+                }
+        }
+
+    vState.Memory.allocated[type->heapIndex] += size;
+    ++vState.Memory.allocationCount;
+
+    return true;
+}
+
+// Free a device memory object allocated with vAllocateDeviceMemory()
+static INLINE void
+vFreeDeviceMemory( uint32_t typeIndex, VkDeviceSize size, VkDeviceMemory memory )
+{
+    vkFreeMemory( vState.Device.handle, memory, NULL );
+
+    vState.Memory.allocated[vState.Device.memoryProperties.memoryTypes[typeIndex].heapIndex] -= size;
+    --vState.Memory.allocationCount;
+}
+
+// Allocate from the blocks of a memory type, creating a block or a dedicated allocation when needed
+static INLINE bool
+vAllocateFromType( uint32_t typeIndex, VkDeviceSize size, VkDeviceSize alignment, vvulAllocation * allocation )
+{
+    const VkDeviceSize blockSize = vGetBlockSize( typeIndex );
+    const uint32_t     heap      = vState.Device.memoryProperties.memoryTypes[typeIndex].heapIndex;
+
+    // Large resources get their own memory, they would fragment the blocks
+    if( size > blockSize / 2 )
+        {
+            if( !vAllocateDeviceMemory( typeIndex, size, &allocation->memory, &allocation->mapped ) ) return false;
+
+            allocation->offset    = 0;
+            allocation->size      = size;
+            allocation->typeIndex = typeIndex;
+            allocation->block     = VVUL_BLOCK_DEDICATED;
+            allocation->node      = VVUL_NULL_NODE;
+
+            vState.Memory.used[heap] += size;
+            return true;
+        }
+
+    for( uint32_t i = 0; i < vState.Memory.blockCount; ++i )
+        {
+            vvulMemoryBlock * block = vState.Memory.blocks[i];
+            if( NULL == block || typeIndex != block->typeIndex || block->size - block->used < size ) continue;
+
+            if( vTlsfAllocate( block, size, alignment, allocation ) )
+                {
+                    allocation->block = i;
+                    vState.Memory.used[heap] += allocation->size;
+                    return true;
+                }
+        }
+
+    const uint32_t index = vCreateMemoryBlock( typeIndex, blockSize, size );
+    if( UINT32_MAX == index || !vTlsfAllocate( vState.Memory.blocks[index], size, alignment, allocation ) )
+        {
+            return false;
+        }
+
+    allocation->block = index;
+    vState.Memory.used[heap] += allocation->size;
+
+    return true;
+}
+
+// Create a block for a memory type, shrunk down to minSize to stay within the heap budget
+static INLINE uint32_t
+vCreateMemoryBlock( uint32_t typeIndex, VkDeviceSize size, VkDeviceSize minSize )
+{
+    const uint32_t heap = vState.Device.memoryProperties.memoryTypes[typeIndex].heapIndex;
+
+    uint32_t index = 0;
+    while( index < vState.Memory.blockCount && NULL != vState.Memory.blocks[index] ) ++index;
+    if( VVUL_MAX_MEMORY_BLOCKS == index )
+        {
+            TRACELOG( LOG_ERROR, "VVUL: Device memory block limit (%d) reached", VVUL_MAX_MEMORY_BLOCKS );
+            return UINT32_MAX;
+        }
+
+    vUpdateMemoryBudget();
+
+    const VkDeviceSize usage     = vState.Memory.usage[heap];
+    const VkDeviceSize available = ( vState.Memory.budget[heap] > usage ) ? vState.Memory.budget[heap] - usage : 0;
+    while( size > available && size / 2 >= minSize ) size /= 2;
+    if( size > available )
+        {
+            TRACELOG( LOG_WARNING, "VVUL: Heap %u over budget (%llu of %llu MiB used)", heap,
+                      (unsigned long long)( usage >> 20 ), (unsigned long long)( vState.Memory.budget[heap] >> 20 ) );
+        }
+
+    vvulMemoryBlock * block = (vvulMemoryBlock *)VUL_CALLOC( 1, sizeof( vvulMemoryBlock ) );
+    if( NULL == block ) return UINT32_MAX;
+
+    block->nodeCapacity = 64;
+    block->nodes        = (vvulMemoryNode *)VUL_MALLOC( block->nodeCapacity * sizeof( vvulMemoryNode ) );
+
+    if( NULL == block->nodes || !vAllocateDeviceMemory( typeIndex, size, &block->memory, &block->mapped ) )
+        {
+            VUL_FREE( block->nodes );
+            VUL_FREE( block );
+            return UINT32_MAX;
+        }
+
+    block->size        = size;
+    block->typeIndex   = typeIndex;
+    block->unusedNodes = VVUL_NULL_NODE;
+    memset( block->heads, 0xFF, sizeof( block->heads ) );
+
+    // The whole block starts as a single free range
+    block->nodeCount             = 1;
+    block->nodes[0].offset       = 0;
+    block->nodes[0].size         = size;
+    block->nodes[0].prevPhysical = VVUL_NULL_NODE;
+    block->nodes[0].nextPhysical = VVUL_NULL_NODE;
+    vTlsfInsert( block, 0 );
+
+    vState.Memory.blocks[index] = block;
+    if( index == vState.Memory.blockCount ) ++vState.Memory.blockCount;
+
+    TRACELOGD( "VVUL: Memory block %u created (type %u, %llu KiB)", index, typeIndex,
+               (unsigned long long)( size >> 10 ) );
+
+    return index;
+}
+
+// Release a memory block and its device memory
+static INLINE void
+vDestroyMemoryBlock( uint32_t index )
+{
+    vvulMemoryBlock * block = vState.Memory.blocks[index];
+
+    vFreeDeviceMemory( block->typeIndex, block->size, block->memory );
+    VUL_FREE( block->nodes );
+    VUL_FREE( block );
+
+    vState.Memory.blocks[index] = NULL;
+    while( 0 < vState.Memory.blockCount && NULL == vState.Memory.blocks[vState.Memory.blockCount - 1] )
+        {
+            --vState.Memory.blockCount;
+        }
+}
+
+// Release every memory block, reporting allocations that were never freed
+static INLINE void
+vDestroyMemory( void )
+{
+    for( uint32_t i = 0; i < vState.Memory.blockCount; ++i )
+        {
+            const vvulMemoryBlock * block = vState.Memory.blocks[i];
+            if( NULL == block ) continue;
+
+            if( 0 < block->allocationCount )
+                {
+                    TRACELOG( LOG_WARNING, "VVUL: Memory block %u destroyed with %u live allocations", i,
+                              block->allocationCount );
+                }
+        }
+
+    while( 0 < vState.Memory.blockCount ) vDestroyMemoryBlock( vState.Memory.blockCount - 1 );
+}
+
+// Index of the lowest set bit, mask must not be 0
+static INLINE uint32_t
+vBitScanForward( uint32_t mask )
+{
+#    if defined( __GNUC__ ) || defined( __clang__ )
+    return (uint32_t)__builtin_ctz( mask );
+#    else
+    uint32_t index = 0;
+    while( 0 == ( mask & 1U ) )
+        {
+            mask >>= 1;
+            ++index;
+        }
+    return index;
+#    endif
+}
+
+// Index of the highest set bit, value must not be 0
+static INLINE uint32_t
+vBitScanReverse( uint64_t value )
+{
+#    if defined( __GNUC__ ) || defined( __clang__ )
+    return 63U - (uint32_t)__builtin_clzll( value );
+#    else
+    uint32_t index = 0;
+    while( value >>= 1 ) ++index;
+    return index;
+#    endif
+}
+
+// Size class of a range: first level is the power of two, second level splits it linearly
+static INLINE void
+vTlsfMapping( VkDeviceSize size, uint32_t * fl, uint32_t * sl )
+{
+    if( size < VVUL_TLSF_SMALL_SIZE )
+        {
+            *fl = 0;
+            *sl = (uint32_t)( size / ( VVUL_TLSF_SMALL_SIZE / VVUL_TLSF_SL_COUNT ) );
+            return;
+        }
+
+    const uint32_t msb = vBitScanReverse( size );
+    *sl                = (uint32_t)( size >> ( msb - VVUL_TLSF_SL_LOG2 ) ) ^ VVUL_TLSF_SL_COUNT;
+    *fl                = msb - VVUL_TLSF_FL_SHIFT + 1;
+}
+
+// Make sure a split can take two nodes without failing halfway
+static INLINE bool
+vTlsfReserveNodes( vvulMemoryBlock * block )
+{
+    if( block->nodeCount + 2 <= block->nodeCapacity ) return true;
+
+    const uint32_t   capacity = block->nodeCapacity * 2;
+    vvulMemoryNode * nodes    = (vvulMemoryNode *)VUL_REALLOC( block->nodes, capacity * sizeof( vvulMemoryNode ) );
+    if( NULL == nodes ) return false;
+
+    block->nodes        = nodes;
+    block->nodeCapacity = capacity;
+
+    return true;
+}
+
+// Get a node, recycled when possible
+static INLINE uint32_t
+vTlsfNewNode( vvulMemoryBlock * block )
+{
+    if( VVUL_NULL_NODE == block->unusedNodes ) return block->nodeCount++;
+
+    const uint32_t index = block->unusedNodes;
+    block->unusedNodes   = block->nodes[index].nextFree;
+
+    return index;
+}
+
+// Push a range on the free list of its size class
+static INLINE void
+vTlsfInsert( vvulMemoryBlock * block, uint32_t index )
+{
+    vvulMemoryNode * node = &block->nodes[index];
+    uint32_t         fl, sl;
+    vTlsfMapping( node->size, &fl, &sl );
+
+    const uint32_t head = block->heads[fl][sl];
+    node->free          = true;
+    node->prevFree      = VVUL_NULL_NODE;
+    node->nextFree      = head;
+    if( VVUL_NULL_NODE != head ) block->nodes[head].prevFree = index;
+
+    block->heads[fl][sl] = index;
+    block->flBitmap |= 1U << fl;
+    block->slBitmap[fl] |= 1U << sl;
+}
+
+// Unlink a range from the free list of its size class
+static INLINE void
+vTlsfRemove( vvulMemoryBlock * block, uint32_t index )
+{
+    vvulMemoryNode * node = &block->nodes[index];
+    uint32_t         fl, sl;
+    vTlsfMapping( node->size, &fl, &sl );
+
+    if( VVUL_NULL_NODE != node->nextFree ) block->nodes[node->nextFree].prevFree = node->prevFree;
+
+    if( VVUL_NULL_NODE != node->prevFree )
+        {
+            block->nodes[node->prevFree].nextFree = node->nextFree;
+        }
+    else
+        {
+            block->heads[fl][sl] = node->nextFree;
+            if( VVUL_NULL_NODE == node->nextFree )
+                {
+                    block->slBitmap[fl] &= ~( 1U << sl );
+                    if( 0 == block->slBitmap[fl] ) block->flBitmap &= ~( 1U << fl );
+                }
+        }
+
+    node->free = false;
+}
+
+// Find a free range of at least size bytes, VVUL_NULL_NODE if the block cannot fit it
+static INLINE uint32_t
+vTlsfFindFree( vvulMemoryBlock * block, VkDeviceSize size )
+{
+    // Round up to the next class, so that any range of the class found is large enough
+    if( size < VVUL_TLSF_SMALL_SIZE ) size += VVUL_TLSF_SMALL_SIZE / VVUL_TLSF_SL_COUNT - 1;
+    else size += ( (VkDeviceSize)1 << ( vBitScanReverse( size ) - VVUL_TLSF_SL_LOG2 ) ) - 1;
+
+    uint32_t fl, sl;
+    vTlsfMapping( size, &fl, &sl );
+    if( VVUL_TLSF_FL_COUNT <= fl ) return VVUL_NULL_NODE;
+
+    uint32_t slMap = block->slBitmap[fl] & ( ~0U << sl );
+    if( 0 == slMap )
+        {
+            const uint32_t flMap = ( VVUL_TLSF_FL_COUNT > fl + 1 ) ? block->flBitmap & ( ~0U << ( fl + 1 ) ) : 0;
+            if( 0 == flMap ) return VVUL_NULL_NODE;
+
+            fl    = vBitScanForward( flMap );
+            slMap = block->slBitmap[fl];
+        }
+
+    return block->heads[fl][vBitScanForward( slMap )];
+}
+
+// Carve an aligned range out of a block, padding and remainder go back to the free lists
+static INLINE bool
+vTlsfAllocate( vvulMemoryBlock * block, VkDeviceSize size, VkDeviceSize alignment, vvulAllocation * allocation )
+{
+    if( !vTlsfReserveNodes( block ) ) return false;
+
+    // Search for the worst case padding, the first range of the class found always fits
+    const uint32_t index = vTlsfFindFree( block, size + alignment - 1 );
+    if( VVUL_NULL_NODE == index ) return false;
+
+    vvulMemoryNode * nodes = block->nodes;
+    vTlsfRemove( block, index );
+
+    // Alignment padding becomes a free range of its own, its physical predecessor is never free
+    const VkDeviceSize aligned = ( nodes[index].offset + alignment - 1 ) & ~( alignment - 1 );
+    if( aligned > nodes[index].offset )
+        {
+            const uint32_t padding = vTlsfNewNode( block );
+
+            nodes[padding].offset       = nodes[index].offset;
+            nodes[padding].size         = aligned - nodes[index].offset;
+            nodes[padding].prevPhysical = nodes[index].prevPhysical;
+            nodes[padding].nextPhysical = index;
+            if( VVUL_NULL_NODE != nodes[index].prevPhysical ) nodes[nodes[index].prevPhysical].nextPhysical = padding;
+
+            nodes[index].prevPhysical = padding;
+            nodes[index].offset       = aligned;
+            nodes[index].size -= nodes[padding].size;
+            vTlsfInsert( block, padding );
+        }
+
+    // Remainder
+    if( nodes[index].size > size )
+        {
+            const uint32_t rest = vTlsfNewNode( block );
+
+            nodes[rest].offset       = aligned + size;
+            nodes[rest].size         = nodes[index].size - size;
+            nodes[rest].prevPhysical = index;
+            nodes[rest].nextPhysical = nodes[index].nextPhysical;
+            if( VVUL_NULL_NODE != nodes[index].nextPhysical ) nodes[nodes[index].nextPhysical].prevPhysical = rest;
+
+            nodes[index].nextPhysical = rest;
+            nodes[index].size         = size;
+            vTlsfInsert( block, rest );
+        }
+
+    block->used += size;
+    ++block->allocationCount;
+
+    allocation->memory    = block->memory;
+    allocation->offset    = aligned;
+    allocation->size      = size;
+    allocation->mapped    = ( NULL != block->mapped ) ? (unsigned char *)block->mapped + aligned : NULL;
+    allocation->typeIndex = block->typeIndex;
+    allocation->node      = index;
+
+    return true;
+}
+
+// Return a range to its block, merging it with free neighbours
+static INLINE void
+vTlsfFree( vvulMemoryBlock * block, uint32_t index )
+{
+    vvulMemoryNode * nodes = block->nodes;
+
+    const uint32_t prev = nodes[index].prevPhysical;
+    if( VVUL_NULL_NODE != prev && nodes[prev].free )
+        {
+            vTlsfRemove( block, prev );
+
+            nodes[prev].size += nodes[index].size;
+            nodes[prev].nextPhysical = nodes[index].nextPhysical;
+            if( VVUL_NULL_NODE != nodes[index].nextPhysical ) nodes[nodes[index].nextPhysical].prevPhysical = prev;
+
+            nodes[index].nextFree = block->unusedNodes;
+            block->unusedNodes    = index;
+            index                 = prev;
+        }
+
+    const uint32_t next = nodes[index].nextPhysical;
+    if( VVUL_NULL_NODE != next && nodes[next].free )
+        {
+            vTlsfRemove( block, next );
+
+            nodes[index].size += nodes[next].size;
+            nodes[index].nextPhysical = nodes[next].nextPhysical;
+            if( VVUL_NULL_NODE != nodes[next].nextPhysical ) nodes[nodes[next].nextPhysical].prevPhysical = index;
+
+            nodes[next].nextFree = block->unusedNodes;
+            block->unusedNodes   = next;
+        }
+
+    vTlsfInsert( block, index );
+}
+
+// Begin recording a blocking one-shot command buffer
+static INLINE VkCommandBuffer
+vBeginImmediate( void )
+{
+    VkCommandBufferBeginInfo beginInfo = { 0 };
+    beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkResetCommandPool( vState.Device.handle, vState.Immediate.pool, 0 );
+    vkBeginCommandBuffer( vState.Immediate.cmd, &beginInfo );
+
+    return vState.Immediate.cmd;
+}
+
+// Submit the one-shot command buffer and wait for its completion
+static INLINE bool
+vEndImmediate( void )
+{
+    vkEndCommandBuffer( vState.Immediate.cmd );
+
+    VkSubmitInfo submitInfo       = { 0 };
+    submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers    = &vState.Immediate.cmd;
+
+    VkResult result = vkQueueSubmit( vState.Queue.handles[VVUL_QUEUE_GRAPHICS], 1, &submitInfo, vState.Immediate.fence );
+    if( VK_SUCCESS == result )
+        {
+            result = vkWaitForFences( vState.Device.handle, 1, &vState.Immediate.fence, VK_TRUE, UINT64_MAX );
+        }
+    vkResetFences( vState.Device.handle, 1, &vState.Immediate.fence );
+
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_ERROR, "VVUL: Immediate submission failed: %s", VkResultToStr( result ) );
+            return false;
+        }
+
+    return true;
+}
+
+// Record a single image layout transition covering the whole color image
+static INLINE void
+vCmdImageBarrier( VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                  VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage,
+                  VkAccessFlags dstAccess )
+{
+    VkImageMemoryBarrier barrier        = { 0 };
+    barrier.sType                       = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask               = srcAccess;
+    barrier.dstAccessMask               = dstAccess;
+    barrier.oldLayout                   = oldLayout;
+    barrier.newLayout                   = newLayout;
+    barrier.srcQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image                       = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+    barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+    vkCmdPipelineBarrier( cmd, srcStage, dstStage, 0, 0, NULL, 0, NULL, 1, &barrier );
 }
 
 #endif // VVUL_IMPLEMENTATION
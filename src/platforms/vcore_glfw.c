@@ -1,11 +1,39 @@
+#if !defined( _WIN32 ) && !defined( _POSIX_C_SOURCE )
+#    define _POSIX_C_SOURCE 199309L // nanosleep()
+#endif
+
 #include "vcore_context.h"
 
 #include "vultra/vultra.h"
 #include "vultra/vutils.h"
 
+#include <math.h> /* sqrt */
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 
+#if defined( _WIN32 )
+// Declared manually to avoid pulling <windows.h> and its symbol clashes (CloseWindow, ...)
+__declspec( dllimport ) void __stdcall Sleep( unsigned long msTimeout );
+__declspec( dllimport ) unsigned int __stdcall timeBeginPeriod( unsigned int uPeriod );
+__declspec( dllimport ) unsigned int __stdcall timeEndPeriod( unsigned int uPeriod );
+#else
+#    include <time.h> /* nanosleep */
+#endif
+
+#if defined( __x86_64__ ) || defined( __i386__ ) || defined( _M_X64 ) || defined( _M_IX86 )
+#    include <immintrin.h>
+#    define CPU_RELAX() _mm_pause()
+#elif defined( __aarch64__ ) && ( defined( __GNUC__ ) || defined( __clang__ ) )
+#    define CPU_RELAX() __asm__ __volatile__( "yield" )
+#else
+#    define CPU_RELAX() ( (void)0 )
+#endif
+
+#ifndef PACING_SLEEP_SAMPLES_MAX
+#    define PACING_SLEEP_SAMPLES_MAX 512 // Sleep observations kept before the overshoot estimate is reset
+#endif
+
 #define GLFW_INCLUDE_VULKAN
 #include "GLFW/glfw3.h"
 #include "GLFW/glfw3native.h"
@@ -16,6 +44,16 @@
 typedef struct PlatformContext
 {
     GLFWwindow * handle;
+
+    // Running estimate of how long a 1ms OS sleep actually takes (Welford mean/variance)
+    struct sleep
+    {
+        double   estimate; // Remaining time below which we stop sleeping and spin
+        double   mean;
+        double   m2;
+        uint64_t count;
+    } sleep;
+
 } PlatformContext;
 
 //--------------------------------------------------------------------------------------------------------------
@@ -35,6 +73,9 @@ void ClosePlatform( void );
 // Get all the required extensions for Vulkan instance
 const char ** ExtensionCallback( uint32_t * count );
 
+// Create the Vulkan surface of the main window
+VkResult CreateWindowSurface( VkInstance instance, VkSurfaceKHR * surface );
+
 extern void SignalClose( void );
 
 // Getters
@@ -47,6 +88,9 @@ static void FramebufferSizeCallback( GLFWwindow * window, int width, int height
 static void KeyCallback( GLFWwindow * window, int key, int scancode, int action, int mods );
 static void WindowPosCallback( GLFWwindow * window, int x, int y );
 
+// Sleep the calling thread for about one millisecond
+static void SleepMillisecond( void );
+
 // Wrappers used by glfwInitAllocator
 static void * AllocateWrapper( size_t size, void * user );
 static void * ReallocateWrapper( void * block, size_t size, void * user );
@@ -96,11 +140,28 @@ InitPlatform( void )
 
     glfwInitAllocator( &allocator );
 
+#if defined( _WIN32 )
+    // Raise the scheduler resolution so that coarse frame pacing sleeps are ~1ms accurate
+    timeBeginPeriod( 1 );
+#endif
+
+    // Conservative initial sleep overshoot estimate, refined on every WaitTime()
+    platform.sleep.estimate = 5e-3;
+    platform.sleep.mean     = 5e-3;
+    platform.sleep.m2       = 0.0;
+    platform.sleep.count    = 1;
+
 #if defined( __APPLE__ )
     // Disable Resources folder working directory change on macOS
     glfwInitHint( GLFW_COCOA_CHDIR_RESOURCES, GLFW_FALSE );
 #endif
 
+    // Headless contexts run on the null platform, no display server is required
+    if( FLAG_CHECK( core.window.flags, FLAG_WINDOW_HEADLESS ) )
+        {
+            glfwInitHint( GLFW_PLATFORM, GLFW_PLATFORM_NULL );
+        }
+
     if( GLFW_FALSE == glfwInit() )
         {
             TRACELOG( LOG_ERROR, "GLFW: Failed to initialize" );
@@ -140,7 +201,8 @@ InitPlatform( void )
     glfwSetKeyCallback( platform.handle, KeyCallback );
     glfwSetWindowPosCallback( platform.handle, WindowPosCallback );
 
-    TRACELOG( LOG_INFO, "GLFW: %s", glfwGetVersionString() );
+    TRACELOG( LOG_INFO, "GLFW: %s (%s)", glfwGetVersionString(),
+              ( GLFW_PLATFORM_NULL == glfwGetPlatform() ) ? "headless" : "windowed" );
 
     return 0;
 }
@@ -150,6 +212,10 @@ ClosePlatform( void )
 {
     glfwDestroyWindow( platform.handle );
     glfwTerminate();
+
+#if defined( _WIN32 )
+    timeEndPeriod( 1 );
+#endif
 }
 
 INLINE void
@@ -162,9 +228,23 @@ SignalClose( void )
 const char **
 ExtensionCallback( uint32_t * count )
 {
+    // Headless contexts never create a surface, so no instance extension is required
+    if( FLAG_CHECK( core.window.flags, FLAG_WINDOW_HEADLESS ) )
+        {
+            *count = 0;
+            return NULL;
+        }
+
     return glfwGetRequiredInstanceExtensions( count );
 }
 
+// Create the Vulkan surface of the main window
+VkResult
+CreateWindowSurface( VkInstance instance, VkSurfaceKHR * surface )
+{
+    return glfwCreateWindowSurface( instance, platform.handle, NULL, surface );
+}
+
 INLINE bool
 ShouldQuit( void )
 {
@@ -183,10 +263,51 @@ SwapBuffers( void )
 {
 }
 
+// Get elapsed time in seconds since InitWindow(), from the platform monotonic clock
+double
+GetTime( void )
+{
+    return glfwGetTime();
+}
+
+// Wait for some time, sleeping while the OS scheduler can be trusted and spinning the remainder
 void
 WaitTime( double seconds )
 {
-    UNUSED( seconds );
+    if( 0.0 >= seconds ) return;
+
+    const double destination = GetTime() + seconds;
+
+    // Coarse phase: sleep in 1ms steps while the remaining time exceeds the observed sleep overshoot
+    while( seconds > platform.sleep.estimate )
+        {
+            const double start = GetTime();
+            SleepMillisecond();
+            const double observed = GetTime() - start;
+            seconds -= observed;
+
+            if( PACING_SLEEP_SAMPLES_MAX <= platform.sleep.count )
+                {
+                    // Restart the statistics so the estimate follows changes in system load
+                    platform.sleep.mean  = platform.sleep.estimate;
+                    platform.sleep.m2    = 0.0;
+                    platform.sleep.count = 1;
+                }
+
+            ++platform.sleep.count;
+            const double delta = observed - platform.sleep.mean;
+            platform.sleep.mean += delta / (double)platform.sleep.count;
+            platform.sleep.m2 += delta * ( observed - platform.sleep.mean );
+
+            const double stddev     = sqrt( platform.sleep.m2 / (double)( platform.sleep.count - 1 ) );
+            platform.sleep.estimate = platform.sleep.mean + stddev;
+        }
+
+    // Fine phase: spin for the last sub-millisecond to hit the deadline with low jitter
+    while( GetTime() < destination )
+        {
+            CPU_RELAX();
+        }
 }
 
 // Window size getters
@@ -212,6 +333,17 @@ GetWindowHandle( void )
     return (void *)platform.handle;
 }
 
+static void
+SleepMillisecond( void )
+{
+#if defined( _WIN32 )
+    Sleep( 1 );
+#else
+    struct timespec request = { 0, 1000000L };
+    nanosleep( &request, NULL );
+#endif
+}
+
 static void
 ErrorCallback( int error, const char * description )
 {
@@ -223,6 +355,9 @@ FramebufferSizeCallback( GLFWwindow * window, int width, int height )
 {
     UNUSED( window );
 
+    // Picked up by the next BeginDrawing(), a minimized (0x0) window skips rendering until restored
+    core.window.resized = 1;
+
     if( ( 0 == width ) || ( 0 == height ) ) return;
 
     core.window.screen.width  = (unsigned int)width;
@@ -248,57 +383,84 @@ KeyCallback( GLFWwindow * window, int key, int scancode, int action, int mods )
     UNUSED( scancode );
 
     // Filter invalid key codes
-    if( UNLIKELY( KEY_NULL > key ) ) return;
+    if( UNLIKELY( KEY_NULL > key || KEYBOARD_KEY_COUNT <= key ) ) return;
 
     switch( action )
         {
         case GLFW_RELEASE:
             {
-                // Clear key state immediately on release
-                core.input.keyboard.currKeyState[key] = 0;
+                // Latched, a press and release within the same frame still reports both
+                KEY_BIT_CLEAR( core.input.keyboard.currKeyState, key );
+                KEY_BIT_SET( core.input.keyboard.releasedKeys, key );
                 break;
             }
         case GLFW_PRESS:
             {
-                // Update state and record press event
-                core.input.keyboard.currKeyState[key] = 1;
-                ++core.input.keyboard.pressedKeyCount;
+                KEY_BIT_SET( core.input.keyboard.currKeyState, key );
+                KEY_BIT_SET( core.input.keyboard.pressedKeys, key );
                 break;
             }
         case GLFW_REPEAT:
             {
                 // Track sustained key repeats
-                core.input.keyboard.keyRepeats[key] = 1;
+                KEY_BIT_SET( core.input.keyboard.keyRepeats, key );
                 break;
             }
-        default: break;
+        default: return;
+        }
+
+    // Queue the transition, overwriting the oldest one when nobody drains the queue
+    unsigned int slot;
+    if( KEY_EVENT_QUEUE_SIZE == core.input.keyboard.eventCount )
+        {
+            slot                          = core.input.keyboard.eventHead;
+            core.input.keyboard.eventHead = ( slot + 1 ) & ( KEY_EVENT_QUEUE_SIZE - 1 );
         }
+    else
+        {
+            slot = ( core.input.keyboard.eventHead + core.input.keyboard.eventCount++ ) & ( KEY_EVENT_QUEUE_SIZE - 1 );
+        }
+
+    core.input.keyboard.events[slot].time   = GetTime();
+    core.input.keyboard.events[slot].key    = key;
+    core.input.keyboard.events[slot].action = ( GLFW_PRESS == action )     ? KEY_ACTION_PRESS
+                                            : ( GLFW_REPEAT == action ) ? KEY_ACTION_REPEAT
+                                                                        : KEY_ACTION_RELEASE;
 
     // Force lock keys to active state when modifiers match
     if( ( KEY_CAPS_LOCK == key && ( mods & GLFW_MOD_CAPS_LOCK ) )
         || ( KEY_NUM_LOCK == key && ( mods & GLFW_MOD_NUM_LOCK ) ) )
         {
-            core.input.keyboard.currKeyState[key] = 1;
+            KEY_BIT_SET( core.input.keyboard.currKeyState, key );
         }
 }
 
 void
 PollInputEvents( void )
 {
-    /* Store previous states */
-    for( size_t i = 0; i < KEYBOARD_KEY_COUNT; ++i )
-        {
-            core.input.keyboard.prevKeyState[i] = core.input.keyboard.currKeyState[i];
-            core.input.keyboard.keyRepeats[i]   = 0;
-        }
+    PROFILE_ZONE_BEGIN( "PollInputEvents" );
 
-    /* Clear states */
-    core.input.keyboard.pressedKeyCount = 0;
+    /* Store previous states, clear the per-frame transitions */
+    memcpy( core.input.keyboard.prevKeyState, core.input.keyboard.currKeyState,
+            sizeof( core.input.keyboard.prevKeyState ) );
+    memset( core.input.keyboard.pressedKeys, 0, sizeof( core.input.keyboard.pressedKeys ) );
+    memset( core.input.keyboard.releasedKeys, 0, sizeof( core.input.keyboard.releasedKeys ) );
+    memset( core.input.keyboard.keyRepeats, 0, sizeof( core.input.keyboard.keyRepeats ) );
 
     /* Poll events */
     glfwPollEvents();
 
+    /* Edges not reported by the callbacks (lock keys forced down by their modifier) */
+    for( int i = 0; i < KEY_STATE_WORDS; ++i )
+        {
+            const uint64_t changed = core.input.keyboard.currKeyState[i] ^ core.input.keyboard.prevKeyState[i];
+            core.input.keyboard.pressedKeys[i] |= changed & core.input.keyboard.currKeyState[i];
+            core.input.keyboard.releasedKeys[i] |= changed & core.input.keyboard.prevKeyState[i];
+        }
+
     /* Handle quit event */
     core.window.shouldQuit = glfwWindowShouldClose( platform.handle );
     glfwSetWindowShouldClose( platform.handle, GLFW_FALSE );
+
+    PROFILE_ZONE_END();
 }
@@ -0,0 +1,540 @@
+/****************************** VBINDLESS ********************************
+ * vbindless: Global bindless resource table (descriptor indexing)
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - The table keeps the descriptor of every index on the CPU, plus one dirty bit per index and
+ *   frame slot. A frame slot rewrites its dirty descriptors when it begins (its fence was waited
+ *   on), or right away while it is being recorded; runs of consecutive indices share one write.
+ * - Removed indices are reused from the next frame on only, so commands recorded earlier in the
+ *   frame never see a descriptor written later at the same index.
+ * - The array sizes are clamped to the update-after-bind limits of the device.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#include "vultra/vbindless.h"
+#include "vultra/vultra.h"
+#include "vultra/vutils.h"
+
+#include "vultra/vvul.h"
+
+#include <string.h> /* memset */
+
+#ifndef BINDLESS_MAX_TEXTURES
+#    define BINDLESS_MAX_TEXTURES 16384 // Sampled images, before the device limits
+#endif
+#ifndef BINDLESS_MAX_SAMPLERS
+#    define BINDLESS_MAX_SAMPLERS 64 // Samplers, before the device limits
+#endif
+#ifndef BINDLESS_MAX_BUFFERS
+#    define BINDLESS_MAX_BUFFERS 4096 // Storage buffers, before the device limits
+#endif
+
+#define BINDLESS_WORDS( n ) ( ( (n) + 63 ) / 64 )
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Resource arrays of the set, in binding order
+typedef enum
+{
+    BINDLESS_TEXTURES = 0,
+    BINDLESS_SAMPLERS,
+    BINDLESS_BUFFERS,
+    BINDLESS_ARRAY_COUNT
+} BindlessArray;
+
+// Index allocator and dirty tracking of an array
+typedef struct BindlessTable
+{
+    VkDescriptorType type;
+    uint32_t         capacity; // Descriptors in the binding
+    uint32_t         count;    // Indices ever used
+    uint32_t *       free;     // Stack of indices reusable now
+    uint32_t         freeCount;
+    uint32_t *       retired; // Stack of indices removed during the frame, reusable from the next one
+    uint32_t         retiredCount;
+    uint64_t *       live;                            // Indices holding a descriptor
+    uint64_t *       dirty[VVUL_MAX_FRAMES_IN_FLIGHT]; // Indices the set of a frame slot is missing
+} BindlessTable;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Variables Definition
+//----------------------------------------------------------------------------------------------------------------------
+static struct
+{
+    VkDescriptorSetLayout setLayout;
+    VkDescriptorPool      pool;
+    VkDescriptorSet       sets[VVUL_MAX_FRAMES_IN_FLIGHT];
+    uint32_t              setCount;
+
+    BindlessTable tables[BINDLESS_ARRAY_COUNT];
+
+    // Descriptors of every index
+    VkDescriptorImageInfo  textures[BINDLESS_MAX_TEXTURES];
+    VkDescriptorImageInfo  samplers[BINDLESS_MAX_SAMPLERS];
+    VkDescriptorBufferInfo buffers[BINDLESS_MAX_BUFFERS];
+
+    // Table storage
+    uint32_t textureIndices[2][BINDLESS_MAX_TEXTURES];
+    uint32_t samplerIndices[2][BINDLESS_MAX_SAMPLERS];
+    uint32_t bufferIndices[2][BINDLESS_MAX_BUFFERS];
+    uint64_t textureBits[VVUL_MAX_FRAMES_IN_FLIGHT + 1][BINDLESS_WORDS( BINDLESS_MAX_TEXTURES )];
+    uint64_t samplerBits[VVUL_MAX_FRAMES_IN_FLIGHT + 1][BINDLESS_WORDS( BINDLESS_MAX_SAMPLERS )];
+    uint64_t bufferBits[VVUL_MAX_FRAMES_IN_FLIGHT + 1][BINDLESS_WORDS( BINDLESS_MAX_BUFFERS )];
+} bindless = { 0 };
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Declaration
+//----------------------------------------------------------------------------------------------------------------------
+void InitBindless( void );       // Create the set layout and the sets of the frames in flight
+void CloseBindless( void );      // Destroy the sets and their layout
+void BeginBindlessFrame( void ); // Bring the set of the frame slot up to date, release the removed indices
+
+static uint32_t AllocateIndex( BindlessArray array );
+static void     ReleaseIndex( BindlessArray array, uint32_t index );
+static bool     IsIndexLive( BindlessArray array, uint32_t index );
+static void     MarkDirty( BindlessArray array, uint32_t index );
+static void     WriteSet( uint32_t slot );
+static uint32_t LowestBit( uint64_t bits );
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Table
+//----------------------------------------------------------------------------------------------------------------------
+// Check if the bindless table is available (Vulkan 1.2 descriptor indexing)
+bool
+IsBindlessSupported( void )
+{
+    return ( 0 < bindless.setCount );
+}
+
+// Get the set layout, set it at the bindless set number of the pipeline layouts
+VkDescriptorSetLayout
+GetBindlessSetLayout( void )
+{
+    return bindless.setLayout;
+}
+
+// Get the set of the frame being recorded
+VkDescriptorSet
+GetBindlessSet( void )
+{
+    if( 0 == bindless.setCount ) return VK_NULL_HANDLE;
+
+    return bindless.sets[vGetFrameIndex() % bindless.setCount];
+}
+
+// Bind the set of the frame being recorded
+void
+BindBindlessSet( VkCommandBuffer cmd, VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t set )
+{
+    const VkDescriptorSet descriptorSet = GetBindlessSet();
+    if( VK_NULL_HANDLE == descriptorSet ) return;
+
+    vkCmdBindDescriptorSets( cmd, bindPoint, layout, set, 1, &descriptorSet, 0, NULL );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Resources
+//----------------------------------------------------------------------------------------------------------------------
+// Register a sampled image
+uint32_t
+BindlessAddTexture( VkImageView view, VkImageLayout layout )
+{
+    const uint32_t index = AllocateIndex( BINDLESS_TEXTURES );
+    if( BINDLESS_INDEX_NONE != index ) BindlessUpdateTexture( index, view, layout );
+
+    return index;
+}
+
+// Register a sampler
+uint32_t
+BindlessAddSampler( VkSampler sampler )
+{
+    const uint32_t index = AllocateIndex( BINDLESS_SAMPLERS );
+    if( BINDLESS_INDEX_NONE == index ) return index;
+
+    bindless.samplers[index].sampler = sampler;
+    MarkDirty( BINDLESS_SAMPLERS, index );
+
+    return index;
+}
+
+// Register a range of a storage buffer
+uint32_t
+BindlessAddBuffer( VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range )
+{
+    const uint32_t index = AllocateIndex( BINDLESS_BUFFERS );
+    if( BINDLESS_INDEX_NONE != index ) BindlessUpdateBuffer( index, buffer, offset, range );
+
+    return index;
+}
+
+// Replace the sampled image behind an index
+void
+BindlessUpdateTexture( uint32_t index, VkImageView view, VkImageLayout layout )
+{
+    if( !IsIndexLive( BINDLESS_TEXTURES, index ) ) return;
+
+    bindless.textures[index].imageView   = view;
+    bindless.textures[index].imageLayout = layout;
+    MarkDirty( BINDLESS_TEXTURES, index );
+}
+
+// Replace the storage buffer range behind an index
+void
+BindlessUpdateBuffer( uint32_t index, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range )
+{
+    if( !IsIndexLive( BINDLESS_BUFFERS, index ) ) return;
+
+    bindless.buffers[index].buffer = buffer;
+    bindless.buffers[index].offset = offset;
+    bindless.buffers[index].range  = range;
+    MarkDirty( BINDLESS_BUFFERS, index );
+}
+
+// Release a sampled image index
+void
+BindlessRemoveTexture( uint32_t index )
+{
+    ReleaseIndex( BINDLESS_TEXTURES, index );
+}
+
+// Release a sampler index
+void
+BindlessRemoveSampler( uint32_t index )
+{
+    ReleaseIndex( BINDLESS_SAMPLERS, index );
+}
+
+// Release a storage buffer index
+void
+BindlessRemoveBuffer( uint32_t index )
+{
+    ReleaseIndex( BINDLESS_BUFFERS, index );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Core
+//----------------------------------------------------------------------------------------------------------------------
+void
+InitBindless( void )
+{
+    if( !vGetDeviceFeatures()->descriptorIndexing )
+        {
+            TRACELOG( LOG_INFO, "BINDLESS: Descriptor indexing not supported, bindless table disabled" );
+            return;
+        }
+
+    const VkDevice device = vGetDevice();
+    VkResult       result;
+
+    // Limits
+    //--------------------------------------------------------------
+    VkPhysicalDeviceVulkan12Properties properties12 = { 0 };
+    properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties = { 0 };
+    properties.sType                       = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext                       = &properties12;
+
+    vkGetPhysicalDeviceProperties2( vGetPhysicalDevice(), &properties );
+
+    uint32_t limits[BINDLESS_ARRAY_COUNT] = { BINDLESS_MAX_TEXTURES, BINDLESS_MAX_SAMPLERS, BINDLESS_MAX_BUFFERS };
+
+    const uint32_t deviceLimits[BINDLESS_ARRAY_COUNT][2] = {
+        { properties12.maxDescriptorSetUpdateAfterBindSampledImages,
+          properties12.maxPerStageDescriptorUpdateAfterBindSampledImages },
+        { properties12.maxDescriptorSetUpdateAfterBindSamplers,
+          properties12.maxPerStageDescriptorUpdateAfterBindSamplers },
+        { properties12.maxDescriptorSetUpdateAfterBindStorageBuffers,
+          properties12.maxPerStageDescriptorUpdateAfterBindStorageBuffers },
+    };
+
+    for( int i = 0; i < BINDLESS_ARRAY_COUNT; ++i )
+        {
+            if( deviceLimits[i][0] < limits[i] ) limits[i] = deviceLimits[i][0];
+            if( deviceLimits[i][1] < limits[i] ) limits[i] = deviceLimits[i][1];
+        }
+
+    // Tables
+    //--------------------------------------------------------------
+    uint32_t * indices[BINDLESS_ARRAY_COUNT][2] = {
+        { bindless.textureIndices[0], bindless.textureIndices[1] },
+        { bindless.samplerIndices[0], bindless.samplerIndices[1] },
+        { bindless.bufferIndices[0], bindless.bufferIndices[1] },
+    };
+    const VkDescriptorType types[BINDLESS_ARRAY_COUNT]
+        = { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_SAMPLER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER };
+
+    for( int i = 0; i < BINDLESS_ARRAY_COUNT; ++i )
+        {
+            BindlessTable * table = &bindless.tables[i];
+            table->type           = types[i];
+            table->capacity       = limits[i];
+            table->free           = indices[i][0];
+            table->retired        = indices[i][1];
+
+            for( uint32_t slot = 0; slot <= VVUL_MAX_FRAMES_IN_FLIGHT; ++slot )
+                {
+                    uint64_t * bits = ( BINDLESS_TEXTURES == i )   ? bindless.textureBits[slot]
+                                      : ( BINDLESS_SAMPLERS == i ) ? bindless.samplerBits[slot]
+                                                                   : bindless.bufferBits[slot];
+                    if( VVUL_MAX_FRAMES_IN_FLIGHT == slot ) table->live = bits;
+                    else table->dirty[slot] = bits;
+                }
+        }
+
+    // Set layout, every binding partially bound and updatable while bound
+    //--------------------------------------------------------------
+    VkDescriptorSetLayoutBinding bindings[BINDLESS_ARRAY_COUNT] = { 0 };
+    VkDescriptorBindingFlags     bindingFlags[BINDLESS_ARRAY_COUNT];
+    VkDescriptorPoolSize         poolSizes[BINDLESS_ARRAY_COUNT];
+
+    bindless.setCount = vGetFramesInFlight();
+
+    for( int i = 0; i < BINDLESS_ARRAY_COUNT; ++i )
+        {
+            bindings[i].binding         = (uint32_t)i;
+            bindings[i].descriptorType  = types[i];
+            bindings[i].descriptorCount = limits[i];
+            bindings[i].stageFlags      = VK_SHADER_STAGE_ALL;
+            bindingFlags[i] = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+            poolSizes[i].type            = types[i];
+            poolSizes[i].descriptorCount = limits[i] * bindless.setCount;
+        }
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo = { 0 };
+    flagsInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    flagsInfo.bindingCount  = BINDLESS_ARRAY_COUNT;
+    flagsInfo.pBindingFlags = bindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo = { 0 };
+    setLayoutInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.pNext                           = &flagsInfo;
+    setLayoutInfo.flags                           = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    setLayoutInfo.bindingCount                    = BINDLESS_ARRAY_COUNT;
+    setLayoutInfo.pBindings                       = bindings;
+
+    result = vkCreateDescriptorSetLayout( device, &setLayoutInfo, NULL, &bindless.setLayout );
+
+    // Sets, one per frame in flight
+    //--------------------------------------------------------------
+    if( VK_SUCCESS == result )
+        {
+            VkDescriptorPoolCreateInfo poolInfo = { 0 };
+            poolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            poolInfo.flags                      = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+            poolInfo.maxSets                    = bindless.setCount;
+            poolInfo.poolSizeCount              = BINDLESS_ARRAY_COUNT;
+            poolInfo.pPoolSizes                 = poolSizes;
+
+            result = vkCreateDescriptorPool( device, &poolInfo, NULL, &bindless.pool );
+        }
+
+    if( VK_SUCCESS == result )
+        {
+            VkDescriptorSetLayout layouts[VVUL_MAX_FRAMES_IN_FLIGHT];
+            for( uint32_t i = 0; i < bindless.setCount; ++i ) layouts[i] = bindless.setLayout;
+
+            VkDescriptorSetAllocateInfo allocInfo = { 0 };
+            allocInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocInfo.descriptorPool              = bindless.pool;
+            allocInfo.descriptorSetCount          = bindless.setCount;
+            allocInfo.pSetLayouts                 = layouts;
+
+            result = vkAllocateDescriptorSets( device, &allocInfo, bindless.sets );
+        }
+
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_WARNING, "BINDLESS: Failed to create the bindless table (%d)", (int)result );
+            CloseBindless();
+            return;
+        }
+
+    TRACELOG( LOG_INFO, "BINDLESS: Table initialized (%u textures, %u samplers, %u buffers)",
+              limits[BINDLESS_TEXTURES], limits[BINDLESS_SAMPLERS], limits[BINDLESS_BUFFERS] );
+}
+
+void
+CloseBindless( void )
+{
+    const VkDevice device = vGetDevice();
+
+    if( VK_NULL_HANDLE != device )
+        {
+            // The sets are freed with their pool, called once the device is idle
+            vkDestroyDescriptorPool( device, bindless.pool, NULL );
+            vkDestroyDescriptorSetLayout( device, bindless.setLayout, NULL );
+        }
+
+    memset( &bindless, 0, sizeof( bindless ) );
+}
+
+// The fence of the frame slot was waited on, its set is no longer read by the GPU
+void
+BeginBindlessFrame( void )
+{
+    if( 0 == bindless.setCount || VK_NULL_HANDLE == vGetFrameCommandBuffer() ) return;
+
+    for( int i = 0; i < BINDLESS_ARRAY_COUNT; ++i )
+        {
+            BindlessTable * table = &bindless.tables[i];
+
+            while( 0 < table->retiredCount ) table->free[table->freeCount++] = table->retired[--table->retiredCount];
+        }
+
+    WriteSet( vGetFrameIndex() % bindless.setCount );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Take a free index of an array, BINDLESS_INDEX_NONE when full
+static uint32_t
+AllocateIndex( BindlessArray array )
+{
+    BindlessTable * table = &bindless.tables[array];
+    uint32_t        index;
+
+    if( 0 == bindless.setCount ) return BINDLESS_INDEX_NONE;
+
+    if( 0 < table->freeCount ) index = table->free[--table->freeCount];
+    else if( table->count < table->capacity ) index = table->count++;
+    else
+        {
+            TRACELOG( LOG_WARNING, "BINDLESS: Table full (%u descriptors of type %d)", table->capacity,
+                      (int)table->type );
+            return BINDLESS_INDEX_NONE;
+        }
+
+    table->live[index / 64] |= 1ULL << ( index % 64 );
+
+    return index;
+}
+
+// Give an index back, the sets not written yet skip it
+static void
+ReleaseIndex( BindlessArray array, uint32_t index )
+{
+    BindlessTable * table = &bindless.tables[array];
+
+    if( !IsIndexLive( array, index ) ) return;
+
+    const uint64_t mask = ~( 1ULL << ( index % 64 ) );
+    table->live[index / 64] &= mask;
+    for( uint32_t slot = 0; slot < bindless.setCount; ++slot ) table->dirty[slot][index / 64] &= mask;
+
+    table->retired[table->retiredCount++] = index;
+}
+
+// Check if an index holds a descriptor
+static bool
+IsIndexLive( BindlessArray array, uint32_t index )
+{
+    const BindlessTable * table = &bindless.tables[array];
+
+    return ( index < table->count ) && ( 0 != ( table->live[index / 64] & ( 1ULL << ( index % 64 ) ) ) );
+}
+
+// Schedule the write of an index into every set, the set of the frame being recorded is written now
+static void
+MarkDirty( BindlessArray array, uint32_t index )
+{
+    BindlessTable * table = &bindless.tables[array];
+    const uint64_t  bit   = 1ULL << ( index % 64 );
+
+    for( uint32_t slot = 0; slot < bindless.setCount; ++slot ) table->dirty[slot][index / 64] |= bit;
+
+    // Outside of a frame the current slot may still be pending, it is written when it begins again
+    if( VK_NULL_HANDLE != vGetFrameCommandBuffer() ) WriteSet( vGetFrameIndex() % bindless.setCount );
+}
+
+// Write the dirty descriptors of a frame slot, runs of consecutive indices in one write
+static void
+WriteSet( uint32_t slot )
+{
+    VkWriteDescriptorSet writes[64];
+    uint32_t             writeCount = 0;
+
+    for( int i = 0; i < BINDLESS_ARRAY_COUNT; ++i )
+        {
+            BindlessTable * table = &bindless.tables[i];
+            uint64_t *      dirty = table->dirty[slot];
+
+            for( uint32_t word = 0; word < BINDLESS_WORDS( table->count ); ++word )
+                {
+                    while( 0 != dirty[word] )
+                        {
+                            // Run of set bits starting at the lowest one
+                            const uint32_t first = LowestBit( dirty[word] );
+                            uint32_t       count = 0;
+                            while( first + count < 64 && ( dirty[word] & ( 1ULL << ( first + count ) ) ) )
+                                {
+                                    dirty[word] &= ~( 1ULL << ( first + count ) );
+                                    ++count;
+                                }
+
+                            const uint32_t index = word * 64 + first;
+
+                            VkWriteDescriptorSet * write = &writes[writeCount++];
+                            memset( write, 0, sizeof( VkWriteDescriptorSet ) );
+                            write->sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                            write->dstSet          = bindless.sets[slot];
+                            write->dstBinding      = (uint32_t)i;
+                            write->dstArrayElement = index;
+                            write->descriptorCount = count;
+                            write->descriptorType  = table->type;
+                            if( BINDLESS_TEXTURES == i ) write->pImageInfo = &bindless.textures[index];
+                            else if( BINDLESS_SAMPLERS == i ) write->pImageInfo = &bindless.samplers[index];
+                            else write->pBufferInfo = &bindless.buffers[index];
+
+                            if( VUL_ARRAYSIZE( writes ) == (int)writeCount )
+                                {
+                                    vkUpdateDescriptorSets( vGetDevice(), writeCount, writes, 0, NULL );
+                                    writeCount = 0;
+                                }
+                        }
+                }
+        }
+
+    if( 0 < writeCount ) vkUpdateDescriptorSets( vGetDevice(), writeCount, writes, 0, NULL );
+}
+
+// Index of the lowest set bit, bits must not be 0
+static uint32_t
+LowestBit( uint64_t bits )
+{
+#if defined( __GNUC__ ) || defined( __clang__ )
+    return (uint32_t)__builtin_ctzll( bits );
+#else
+    uint32_t index = 0;
+    while( 0 == ( bits & 1ULL ) )
+        {
+            bits >>= 1;
+            ++index;
+        }
+    return index;
+#endif
+}
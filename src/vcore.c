@@ -40,6 +40,18 @@
 
 #include "vcore_context.h"
 
+#include <ctype.h>  /* isalnum */
+#include <stdio.h>  /* snprintf */
+#include <string.h> /* memcpy */
+
+#if defined( _WIN32 )
+#    include <direct.h> /* _mkdir */
+#    define MAKE_DIRECTORY( path ) _mkdir( path )
+#else
+#    include <sys/stat.h> /* mkdir */
+#    define MAKE_DIRECTORY( path ) mkdir( path, 0755 )
+#endif
+
 #define VVUL_IMPLEMENTATION
 #include "vultra/vvul.h"
 
@@ -54,18 +66,66 @@ CoreContext core = { 0 };
 extern int  InitPlatform( void );
 extern void ClosePlatform( void );
 
+// Transient memory
+extern void InitMemory( bool useHugePages );
+extern void CloseMemory( void );
+extern void ResetFrameMemory( void );
+
+// Worker threads
+extern void InitJobs( void );
+extern void CloseJobs( void );
+
+// Shader compiler
+extern void CloseShaders( void );
+
+// Bindless resource table
+extern void InitBindless( void );
+extern void CloseBindless( void );
+extern void BeginBindlessFrame( void );
+
+// 2D batch renderer
+extern void InitDraw( void );
+extern void CloseDraw( void );
+extern void BeginDrawBatch( void );
+extern void EndDrawBatch( void );
+
+// Texture streaming
+extern void CloseStreaming( void );
+extern void BeginStreamFrame( void );
+
+// Profiler
+extern void InitProfiler( void );
+extern void CloseProfiler( void );
+extern void BeginProfilerFrame( void );
+extern void EndProfilerFrame( void );
+extern void FlushProfiler( void );
+
 // Get all the required extensions for Vulkan instance
 extern const char ** ExtensionCallback( uint32_t * count );
 
+// Create the Vulkan surface of the main window
+extern VkResult CreateWindowSurface( VkInstance instance, VkSurfaceKHR * surface );
+
+// Window size getters
+extern int GetScreenWidth( void );
+extern int GetScreenHeight( void );
+
 // Initialize the Graphics backend
 static void InitGraphicsAPI( void );
 
+// Resolve and create the directory persistent caches are stored in
+static const char * InitCacheDirectory( void );
+
+// Store the last frame duration into the rolling history
+static void RecordFrameTime( double frameTime );
+
 //--------------------------------------------------------------------------------------------------------------
 // MODULE FUNCTIONS DEFINITONS
 //--------------------------------------------------------------------------------------------------------------
 void
 InitWindow( int width, int height, const char * title )
 {
+    PROFILE_ZONE_BEGIN( "InitWindow" );
     TRACELOG( LOG_INFO, "Initializing Vultra - %s", VULTRA_VERSION );
 
     // Initialize window data
@@ -79,29 +139,60 @@ InitWindow( int width, int height, const char * title )
     TRACELOG( LOG_INFO, "Initializing window: %s (%dx%d)", core.window.title, core.window.screen.width,
               core.window.screen.height );
 
+    // Initialize transient memory, before any subsystem can request frame allocations
+    //--------------------------------------------------------------
+    InitMemory( 0 != FLAG_CHECK( core.window.flags, FLAG_MEMORY_HUGE_PAGES ) );
+    InitJobs();
+
     // Initialize platform
     //--------------------------------------------------------------
-    if( 0 != InitPlatform() )
+    PROFILE_ZONE_BEGIN( "InitPlatform" );
+    const int platformResult = InitPlatform();
+    PROFILE_ZONE_END();
+
+    if( 0 != platformResult )
         {
             TRACELOG( LOG_FATAL, "SYSTEM: Failed to initialize Platform" );
+            PROFILE_ZONE_END();
             return;
         }
 
     // Initialize graphics backend
     //--------------------------------------------------------------
+    PROFILE_ZONE_BEGIN( "InitGraphicsAPI" );
     InitGraphicsAPI();
+    PROFILE_ZONE_END();
+    InitBindless();
+    InitDraw();
+    InitProfiler();
+
+    // Initialize frame pacing
+    //--------------------------------------------------------------
+    core.timing.previous = GetTime();
+    core.timing.deadline = core.timing.previous;
 
     TRACELOG( LOG_INFO, "Window initialized successfully" );
+    PROFILE_ZONE_END();
 }
 
 void
 CloseWindow( void )
 {
+    CloseProfiler();
+    CloseStreaming();
+    CloseDraw();
+    CloseBindless();
+    CloseShaders();
+
     vClose();
 
     ClosePlatform();
 
+    CloseJobs();
+    CloseMemory();
+
     TRACELOG( LOG_INFO, "Window closed" );
+    FlushTraceLog();
 }
 
 void
@@ -123,39 +214,185 @@ SetConfigFlags( unsigned int flags )
     FLAG_SET( core.window.flags, flags );
 }
 
+// Select the GPU by index or name substring, overrides the VULTRA_DEVICE environment variable
+void
+SetPreferredDevice( const char * device )
+{
+    core.graphics.device = device;
+}
+
+// Set how many frames the CPU may record ahead of the GPU, more hides GPU stalls at the cost of input latency
+void
+SetFramesInFlight( int count )
+{
+    core.graphics.framesInFlight = ( 0 < count ) ? (unsigned int)count : 0;
+}
+
+// Set the directory persistent caches (pipelines, shaders) are stored in, an empty path disables persistence
+void
+SetCacheDirectory( const char * path )
+{
+    core.graphics.cacheDirectory = path;
+}
+
 void
 BeginDrawing( void )
 {
+    // Resize is deferred to the frame boundary, the backend recreates its resources without draining the GPU
+    if( core.window.resized )
+        {
+            vResize( (uint32_t)GetScreenWidth(), (uint32_t)GetScreenHeight() );
+            core.window.resized = 0;
+        }
+
+    vBeginFrame();
+    BeginBindlessFrame();
+    BeginProfilerFrame();
+    BeginDrawBatch();
+    BeginStreamFrame();
 }
 
 void
 EndDrawing( void )
 {
-    core.timing.lastFrameTime = 0;
+    PROFILE_ZONE_BEGIN( "EndDrawing" );
+
+    BeginGpuZone( "Draw 2D" );
+    EndDrawBatch();
+    EndGpuZone();
+    EndProfilerFrame();
+    vEndFrame();
+
+    // Frame pacing
+    //--------------------------------------------------------------
+    double current   = GetTime();
+    core.timing.draw = current - core.timing.previous;
+
+    if( 0.0 < core.timing.targetFPS )
+        {
+            // Pace against an absolute deadline so sleep error does not accumulate across frames
+            core.timing.deadline += core.timing.targetFPS;
+
+            if( core.timing.deadline > current )
+                {
+                    PROFILE_ZONE_BEGIN( "WaitTime" );
+                    WaitTime( core.timing.deadline - current );
+                    PROFILE_ZONE_END();
+                    current = GetTime();
+                }
+            else
+                {
+                    // Missed the deadline, resynchronize instead of trying to catch up with short frames
+                    core.timing.deadline = current;
+                }
+        }
+
+    core.timing.lastFrameTime = current - core.timing.previous;
+    core.timing.previous      = current;
+
+    RecordFrameTime( core.timing.lastFrameTime );
     ++core.timing.frameCounter;
 
+    // Everything allocated with MemFrameAlloc() since the last frame is released at once
+    ResetFrameMemory();
+
+    PROFILE_ZONE_END();
+    PROFILE_FRAME_MARK();
+    FlushProfiler();
+
     PollInputEvents();
 }
 
+// Read back the last drawn frame as tightly packed RGBA8 pixels
+unsigned char *
+LoadScreenPixels( int * width, int * height )
+{
+    uint32_t        targetWidth  = 0;
+    uint32_t        targetHeight = 0;
+    unsigned char * pixels       = (unsigned char *)vReadTargetPixels( &targetWidth, &targetHeight );
+
+    if( NULL == pixels )
+        {
+            TRACELOG( LOG_WARNING, "SYSTEM: Failed to read back screen pixels" );
+            return NULL;
+        }
+
+    if( NULL != width ) *width = (int)targetWidth;
+    if( NULL != height ) *height = (int)targetHeight;
+
+    return pixels;
+}
+
+// Unload pixels loaded with LoadScreenPixels()
 void
-ClearBackground( Color color )
+UnloadScreenPixels( unsigned char * pixels )
 {
-    UNUSED( color );
-    NO_IMPL();
+    VUL_FREE( pixels );
 }
 
 float
 GetFrameTime( void )
 {
-    NO_IMPL();
-    return 0.0F;
+    return (float)core.timing.lastFrameTime;
 }
 
 int
 GetFPS( void )
 {
-    NO_IMPL();
-    return 0;
+    const FrameStats stats = GetFrameStats();
+    if( 0.0F >= stats.avgFrameTime ) return 0;
+
+    return (int)( 1.0F / stats.avgFrameTime + 0.5F );
+}
+
+// Get min/avg/p99/max frame times of the frame history
+FrameStats
+GetFrameStats( void )
+{
+    FrameStats   stats = { 0 };
+    float        sorted[FRAME_HISTORY_COUNT];
+    unsigned int count = core.timing.frameCounter;
+    if( FRAME_HISTORY_COUNT < count ) count = FRAME_HISTORY_COUNT;
+    if( 0 == count ) return stats;
+
+    // Once the history wraps, every slot holds a sample; before that samples are stored from index 0
+    memcpy( sorted, core.timing.history, count * sizeof( float ) );
+
+    // Insertion sort: the history is small and only sorted on query, never on the frame path
+    double sum = 0.0;
+    for( unsigned int i = 0; i < count; ++i )
+        {
+            const float  value = sorted[i];
+            unsigned int j     = i;
+
+            sum += value;
+            while( 0 < j && sorted[j - 1] > value )
+                {
+                    sorted[j] = sorted[j - 1];
+                    --j;
+                }
+            sorted[j] = value;
+        }
+
+    stats.sampleCount  = (int)count;
+    stats.minFrameTime = sorted[0];
+    stats.maxFrameTime = sorted[count - 1];
+    stats.avgFrameTime = (float)( sum / (double)count );
+    stats.p99FrameTime = sorted[( count * 99 + 99 ) / 100 - 1]; // Nearest-rank percentile
+
+    return stats;
+}
+
+//----------------------------------------------------------------------------------
+// MODULE FUNCTIONS DEFINITION: TIMING
+//----------------------------------------------------------------------------------
+
+// Store the last frame duration into the rolling history
+static void
+RecordFrameTime( double frameTime )
+{
+    core.timing.history[core.timing.historyIndex] = (float)frameTime;
+    core.timing.historyIndex                      = ( core.timing.historyIndex + 1 ) & ( FRAME_HISTORY_COUNT - 1 );
 }
 
 //----------------------------------------------------------------------------------
@@ -172,5 +409,92 @@ InitGraphicsAPI( void )
     uint32_t      extensionCount = 0;
     const char ** extensions     = ExtensionCallback( &extensionCount );
 
-    vInit( extensions, extensionCount );
+    vvulInitInfo initInfo   = { 0 };
+    initInfo.extensions     = extensions;
+    initInfo.extensionCount = extensionCount;
+    initInfo.width          = (uint32_t)GetScreenWidth();
+    initInfo.height         = (uint32_t)GetScreenHeight();
+    initInfo.headless       = ( 0 != FLAG_CHECK( core.window.flags, FLAG_WINDOW_HEADLESS ) );
+    initInfo.device         = core.graphics.device;
+    initInfo.createSurface  = CreateWindowSurface;
+    initInfo.framesInFlight = core.graphics.framesInFlight;
+    initInfo.cacheDirectory = InitCacheDirectory();
+
+    // Low latency unless vertical sync is requested, tearing only on explicit request
+    if( FLAG_CHECK( core.window.flags, FLAG_VSYNC_HINT ) ) initInfo.presentMode = VVUL_PRESENT_VSYNC;
+    else if( FLAG_CHECK( core.window.flags, FLAG_PRESENT_IMMEDIATE ) ) initInfo.presentMode = VVUL_PRESENT_IMMEDIATE;
+    else initInfo.presentMode = VVUL_PRESENT_LOW_LATENCY;
+
+    if( !vInit( &initInfo ) )
+        {
+            TRACELOG( LOG_FATAL, "SYSTEM: Failed to initialize Vulkan" );
+        }
+}
+
+// Resolve the cache directory, by default a per-user, per-application directory, and create it
+static const char *
+InitCacheDirectory( void )
+{
+    char * path = core.graphics.cachePath;
+
+    if( NULL != core.graphics.cacheDirectory )
+        {
+            if( '\0' == core.graphics.cacheDirectory[0] ) return NULL;
+            snprintf( path, CACHE_PATH_MAX, "%s", core.graphics.cacheDirectory );
+        }
+    else
+        {
+            // Applications are told apart by their window title, reduced to a portable directory name
+            char         application[64] = "default";
+            const char * title           = core.window.title;
+            if( STR_NONEMPTY( title ) )
+                {
+                    size_t length = 0;
+                    for( ; '\0' != title[length] && length < sizeof( application ) - 1; ++length )
+                        {
+                            const char c        = title[length];
+                            application[length] = ( isalnum( (unsigned char)c ) || '-' == c || '.' == c ) ? c : '_';
+                        }
+                    application[length] = '\0';
+                }
+
+#if defined( _WIN32 )
+            const char * base   = getenv( "LOCALAPPDATA" );
+            const char * suffix = "";
+#elif defined( __APPLE__ )
+            const char * base   = getenv( "HOME" );
+            const char * suffix = "/Library/Caches";
+#else
+            const char * base   = getenv( "XDG_CACHE_HOME" );
+            const char * suffix = "";
+            if( !STR_NONEMPTY( base ) )
+                {
+                    base   = getenv( "HOME" );
+                    suffix = "/.cache";
+                }
+#endif
+            if( !STR_NONEMPTY( base ) )
+                {
+                    TRACELOG( LOG_WARNING, "SYSTEM: No user cache directory, caches will not be persisted" );
+                    return NULL;
+                }
+
+            snprintf( path, CACHE_PATH_MAX, "%s%s/vultra/%s", base, suffix, application );
+        }
+
+    // Create every missing level, existing directories are fine
+    for( char * separator = path + 1; '\0' != *separator; ++separator )
+        {
+            if( '/' != *separator && '\\' != *separator ) continue;
+
+            const char saved = *separator;
+            *separator       = '\0';
+            MAKE_DIRECTORY( path );
+            *separator = saved;
+        }
+    MAKE_DIRECTORY( path );
+
+    TRACELOG( LOG_INFO, "SYSTEM: Cache directory: %s", path );
+
+    return path;
 }
@@ -24,8 +24,31 @@
 #ifndef LEVEGL_CORE_CONTEXT_H
 #define LEVEGL_CORE_CONTEXT_H
 
+#include "vultra/vultra.h"
+
+#include <stdint.h>
+
 #ifndef KEYBOARD_KEY_COUNT
-#    define KEYBOARD_KEY_COUNT 512 // The maximum number of supported keyboard keys
+#    define KEYBOARD_KEY_COUNT 512 // The maximum number of supported keyboard keys (multiple of 64)
+#endif
+
+#ifndef KEY_EVENT_QUEUE_SIZE
+#    define KEY_EVENT_QUEUE_SIZE 256 // Key transitions kept until drained, the oldest are overwritten (power of two)
+#endif
+
+#define KEY_STATE_WORDS ( KEYBOARD_KEY_COUNT / 64 ) // Key bitsets hold 64 keys per word
+
+// Key bitset accessors
+#define KEY_BIT_GET( set, key )   ( 0 != ( ( set )[( key ) >> 6] & ( 1ULL << ( ( key ) & 63 ) ) ) )
+#define KEY_BIT_SET( set, key )   ( ( set )[( key ) >> 6] |= ( 1ULL << ( ( key ) & 63 ) ) )
+#define KEY_BIT_CLEAR( set, key ) ( ( set )[( key ) >> 6] &= ~( 1ULL << ( ( key ) & 63 ) ) )
+
+#ifndef CACHE_PATH_MAX
+#    define CACHE_PATH_MAX 512 // Maximum length of the persistent cache directory path
+#endif
+
+#ifndef FRAME_HISTORY_COUNT
+#    define FRAME_HISTORY_COUNT 256 // Rolling frame time samples used for pacing statistics (power of two)
 #endif
 
 typedef struct Coordinate
@@ -49,6 +72,7 @@ typedef struct CoreContext
         const char * title;      /// Window title string (memory managed externally)
         unsigned int flags;      /// Configuration bits
         int          shouldQuit; /// Is main window closing?
+        int          resized;    /// Framebuffer size changed since the last frame
 
         Coordinate position;     /// Window Position
         Coordinate prevPosition; /// Window previous position
@@ -59,21 +83,41 @@ typedef struct CoreContext
     /// Timing configuration group for frame rate control
     struct timing
     {
-        double       lastFrameTime; /// Timestamp of last frame in seconds
-        double       targetFPS;     /// Target FPS for the application
+        double       previous;      /// Timestamp of the end of the previous frame in seconds
+        double       deadline;      /// Timestamp the current frame is paced against
+        double       draw;          /// Time spent between frame start and EndDrawing
+        double       lastFrameTime; /// Duration of last frame in seconds (work + wait)
+        double       targetFPS;     /// Target frame duration in seconds (0: unlimited)
         unsigned int frameCounter;
 
+        float        history[FRAME_HISTORY_COUNT]; /// Rolling frame durations in seconds
+        unsigned int historyIndex;                 /// Next history slot to be written
+
     } timing;
 
+    /// Graphics backend configuration
+    struct graphics
+    {
+        const char * device;         /// Preferred device, index or name substring (NULL: automatic)
+        unsigned int framesInFlight; /// Frames the CPU may record ahead of the GPU (0: backend default)
+        const char * cacheDirectory; /// Persistent caches directory (NULL: per-user default, empty: disabled)
+        char         cachePath[CACHE_PATH_MAX]; /// Resolved and created cache directory, empty when disabled
+
+    } graphics;
+
     struct input
     {
         struct keyboard
         {
-            char currKeyState[KEYBOARD_KEY_COUNT]; // Current frame's key states
-            char prevKeyState[KEYBOARD_KEY_COUNT]; // Previous frame's key states
-            char keyRepeats[KEYBOARD_KEY_COUNT];   // Key repeat states for current frame
+            uint64_t currKeyState[KEY_STATE_WORDS]; // Keys down, one bit per key
+            uint64_t prevKeyState[KEY_STATE_WORDS]; // Keys down at the end of the previous frame
+            uint64_t pressedKeys[KEY_STATE_WORDS];  // Keys pressed during the frame, even if released since
+            uint64_t releasedKeys[KEY_STATE_WORDS]; // Keys released during the frame, even if pressed since
+            uint64_t keyRepeats[KEY_STATE_WORDS];   // Keys repeated by the OS during the frame
 
-            int pressedKeyCount;                   // Number of pressed keys
+            KeyEvent     events[KEY_EVENT_QUEUE_SIZE]; // Ring of key transitions
+            unsigned int eventHead;                    // Oldest queued transition
+            unsigned int eventCount;                   // Transitions queued
 
         } keyboard;
 
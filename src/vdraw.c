@@ -0,0 +1,1268 @@
+/******************************** VDRAW **********************************
+ * vdraw: Batched 2D immediate-mode renderer (shapes and textures)
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - Every primitive is one 48 byte instance written straight into a persistently mapped buffer
+ *   chunk of the frame in flight; the vertex shader expands it into a quad (rectangle, line or
+ *   circle bounding box), so there is no vertex or index data at all.
+ * - Consecutive primitives sharing a texture merge into one instanced draw. Shapes sample a
+ *   white texture, so they merge with each other and with textured quads. Painter's order is
+ *   kept: primitives are never reordered, only runs are merged.
+ * - The batches are recorded into the frame by EndDrawing(), inside a single render pass. Other
+ *   modules recording their own passes (vscene.c) push a callback instead: the 2D pass is ended
+ *   around it and resumed after, so everything keeps the painter's order of the calls.
+ * - Textures loaded during a frame become drawable on the next one, once their upload is
+ *   acquired by the frame; draws of a texture that is not ready yet are dropped.
+ * - With the bindless table every instance carries its texture index and the table is bound
+ *   once, so runs merge across textures too; otherwise every texture owns a descriptor set.
+ * - Streamed textures (vstream.c) reserve a slot first and swap its image whenever their resident
+ *   mips change; the slot records the last frame the texture was drawn, to rank evictions.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#include "vultra/vbindless.h"
+#include "vultra/vshader.h"
+#include "vultra/vultra.h"
+#include "vultra/vutils.h"
+
+#include "vultra/vvul.h"
+
+#include "vdraw_internal.h"
+
+#include <stddef.h> /* offsetof */
+#include <string.h> /* memset */
+
+#ifndef DRAW_CHUNK_INSTANCES
+#    define DRAW_CHUNK_INSTANCES 65536 // Instances per mapped buffer chunk (3 MiB)
+#endif
+#ifndef DRAW_MAX_CHUNKS
+#    define DRAW_MAX_CHUNKS 64 // Chunks per frame in flight, primitives beyond them are dropped
+#endif
+#ifndef DRAW_MAX_TEXTURES
+#    define DRAW_MAX_TEXTURES 4096 // Textures loaded at once, the white texture included
+#endif
+
+#define DRAW_WHITE_TEXTURE 0 // Texture slot sampled by the shapes
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Primitive kinds, expanded by the vertex shader
+typedef enum
+{
+    DRAW_KIND_QUAD = 0,
+    DRAW_KIND_LINE,
+    DRAW_KIND_CIRCLE
+} DrawKind;
+
+// Per-instance vertex data of a primitive
+typedef struct DrawInstance
+{
+    float    points[4]; // Quad: x, y, width, height. Line: x0, y0, x1, y1. Circle: x, y, radius
+    float    uvs[4];    // Texture rectangle: u0, v0, u1, v1
+    uint32_t color;     // RGBA8
+    float    thickness; // Line width in pixels
+    uint32_t kind;      // DrawKind
+    uint32_t texture;   // Bindless index of the texture, unused without the bindless table
+} DrawInstance;
+
+// Command types, executed in order
+typedef enum
+{
+    DRAW_COMMAND_INSTANCES = 0,
+    DRAW_COMMAND_CLEAR,
+    DRAW_COMMAND_CALLBACK // Recorded outside of the render pass
+} DrawCommandType;
+
+// Run of instances sharing a texture, a clear or a callback (first indexes the callback list)
+typedef struct DrawCommand
+{
+    DrawCommandType   type;
+    VkDescriptorSet   set;   // Texture of the run, NULL with the bindless table
+    uint32_t          chunk; // Chunk holding the run
+    uint32_t          first; // First instance in the chunk
+    uint32_t          count;
+    VkClearColorValue clear;
+} DrawCommand;
+
+// Callback pushed by another module, with a copy of its parameters
+typedef struct DrawCallbackEntry
+{
+    DrawCallback callback;
+    void *       user;
+    float        params[16];
+} DrawCallbackEntry;
+
+// Mapped instance buffer
+typedef struct DrawChunk
+{
+    VkBuffer       buffer;
+    vvulAllocation memory;
+} DrawChunk;
+
+// Texture slot
+typedef struct TextureSlot
+{
+    VkImage         image;
+    VkImageView     view;
+    vvulAllocation  memory;
+    VkDescriptorSet set;        // Without the bindless table
+    uint32_t        index;      // Bindless index, 0 without the bindless table
+    uint64_t        readyFrame; // First frame the upload is visible to
+    uint64_t        usedFrame;  // Last frame the texture was drawn in
+    bool            used;
+} TextureSlot;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Variables Definition
+//----------------------------------------------------------------------------------------------------------------------
+static struct
+{
+    VkDescriptorSetLayout setLayout;
+    VkPipelineLayout      layout;
+    VkPipeline            pipeline;
+    VkDescriptorPool      descriptorPool;
+    VkSampler             sampler;
+    uint32_t              samplerIndex; // Bindless index of the sampler
+    bool                  bindless;     // Are textures sampled through the bindless table?
+
+    DrawChunk chunks[VVUL_MAX_FRAMES_IN_FLIGHT][DRAW_MAX_CHUNKS];
+    uint32_t  chunkCount[VVUL_MAX_FRAMES_IN_FLIGHT]; // Chunks created per frame slot, reused every frame
+
+    DrawInstance * base;   // First instance of the chunk being written
+    DrawInstance * cursor; // Next instance to write
+    DrawInstance * end;    // End of the chunk being written
+    uint32_t       chunk;  // Index of the chunk being written, in the frame slot
+    uint32_t       slot;   // Frame-in-flight slot being recorded
+
+    DrawCommand * commands;
+    uint32_t      commandCount;
+    uint32_t      commandCapacity;
+
+    DrawCallbackEntry * callbacks;
+    uint32_t            callbackCount;
+    uint32_t            callbackCapacity;
+
+    TextureSlot textures[DRAW_MAX_TEXTURES];
+    uint32_t    freeTextures[DRAW_MAX_TEXTURES]; // Stack of released slots
+    uint32_t    freeCount;
+    uint32_t    textureCount;                    // Slots ever used
+
+    uint64_t frame;         // Frames begun, textures compare their readyFrame against it
+    bool     active;        // Is a frame accepting primitives?
+    bool     instancesFull; // No instance buffer left for the frame, later primitives are dropped
+} draw = { 0 };
+
+// Vertex shader: expands every instance into a quad, strip order (0,0) (1,0) (0,1) (1,1)
+static const char * drawVertexShader
+    = "#version 450\n"
+      "layout( location = 0 ) in vec4 inPoints;\n"
+      "layout( location = 1 ) in vec4 inUvs;\n"
+      "layout( location = 2 ) in vec4 inColor;\n"
+      "layout( location = 3 ) in float inThickness;\n"
+      "layout( location = 4 ) in uint inKind;\n"
+      "layout( location = 5 ) in uint inTexture;\n"
+      "layout( push_constant ) uniform Push { vec2 scale; } push; // 2 / target size\n"
+      "layout( location = 0 ) out vec4 outColor;\n"
+      "layout( location = 1 ) out vec2 outUv;\n"
+      "layout( location = 2 ) out vec2 outLocal;\n"
+      "layout( location = 3 ) flat out float outRadius;\n"
+      "layout( location = 4 ) flat out uint outKind;\n"
+      "layout( location = 5 ) flat out uint outTexture;\n"
+      "void main()\n"
+      "{\n"
+      "    vec2 corner = vec2( gl_VertexIndex & 1, gl_VertexIndex >> 1 );\n"
+      "    vec2 position;\n"
+      "    outLocal  = vec2( 0.0 );\n"
+      "    outRadius = 0.0;\n"
+      "    if( 1u == inKind )\n"
+      "    {\n"
+      "        vec2  direction = inPoints.zw - inPoints.xy;\n"
+      "        float len       = length( direction );\n"
+      "        direction       = ( 0.0 < len ) ? direction / len : vec2( 1.0, 0.0 );\n"
+      "        vec2 normal     = vec2( -direction.y, direction.x ) * ( 0.5 * inThickness );\n"
+      "        position        = mix( inPoints.xy, inPoints.zw, corner.x ) + normal * ( corner.y * 2.0 - 1.0 );\n"
+      "    }\n"
+      "    else if( 2u == inKind )\n"
+      "    {\n"
+      "        float extent = inPoints.z + 1.0; // One pixel of antialiasing fringe\n"
+      "        outLocal     = ( corner * 2.0 - 1.0 ) * extent;\n"
+      "        outRadius    = inPoints.z;\n"
+      "        position     = inPoints.xy + outLocal;\n"
+      "    }\n"
+      "    else\n"
+      "    {\n"
+      "        position = inPoints.xy + corner * inPoints.zw;\n"
+      "    }\n"
+      "    outColor    = inColor;\n"
+      "    outUv       = mix( inUvs.xy, inUvs.zw, corner );\n"
+      "    outKind     = inKind;\n"
+      "    outTexture  = inTexture;\n"
+      "    gl_Position = vec4( position * push.scale - 1.0, 0.0, 1.0 );\n"
+      "}\n";
+
+// Fragment shader: tinted texture, circles fade out over their last pixel
+static const char * drawFragmentShader
+    = "#version 450\n"
+      "layout( set = 0, binding = 0 ) uniform sampler2D uTexture;\n"
+      "layout( location = 0 ) in vec4 inColor;\n"
+      "layout( location = 1 ) in vec2 inUv;\n"
+      "layout( location = 2 ) in vec2 inLocal;\n"
+      "layout( location = 3 ) flat in float inRadius;\n"
+      "layout( location = 4 ) flat in uint inKind;\n"
+      "layout( location = 0 ) out vec4 outColor;\n"
+      "void main()\n"
+      "{\n"
+      "    vec4 color = inColor * texture( uTexture, inUv );\n"
+      "    if( 2u == inKind ) color.a *= clamp( inRadius + 0.5 - length( inLocal ), 0.0, 1.0 );\n"
+      "    outColor = color;\n"
+      "}\n";
+
+// Fragment shader sampling the bindless table, the texture may change between the instances of a draw
+static const char * drawBindlessFragmentShader
+    = "#version 450\n"
+      "#extension GL_EXT_nonuniform_qualifier : require\n"
+      "layout( constant_id = 0 ) const uint SAMPLER = 0;\n"
+      "layout( set = 0, binding = 0 ) uniform texture2D uTextures[];\n"
+      "layout( set = 0, binding = 1 ) uniform sampler uSamplers[];\n"
+      "layout( location = 0 ) in vec4 inColor;\n"
+      "layout( location = 1 ) in vec2 inUv;\n"
+      "layout( location = 2 ) in vec2 inLocal;\n"
+      "layout( location = 3 ) flat in float inRadius;\n"
+      "layout( location = 4 ) flat in uint inKind;\n"
+      "layout( location = 5 ) flat in uint inTexture;\n"
+      "layout( location = 0 ) out vec4 outColor;\n"
+      "void main()\n"
+      "{\n"
+      "    vec4 texel = texture( sampler2D( uTextures[nonuniformEXT( inTexture )], uSamplers[SAMPLER] ), inUv );\n"
+      "    vec4 color = inColor * texel;\n"
+      "    if( 2u == inKind ) color.a *= clamp( inRadius + 0.5 - length( inLocal ), 0.0, 1.0 );\n"
+      "    outColor = color;\n"
+      "}\n";
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Declaration
+//----------------------------------------------------------------------------------------------------------------------
+void InitDraw( void );       // Create the pipeline and the white texture
+void CloseDraw( void );      // Destroy every drawing resource
+void BeginDrawBatch( void ); // Start accepting primitives for the frame begun
+void EndDrawBatch( void );   // Record the batches into the frame
+
+extern void ReleaseTextureStream( unsigned int id ); // Drop the streaming state of a texture, if any
+
+static bool           CreatePipeline( void );
+static void           BeginBatchPass( VkCommandBuffer cmd );
+static bool           NextChunk( void );
+static DrawCommand *  PushCommand( void );
+static DrawInstance * PushInstance( unsigned int texture );
+static uint32_t       PackColor( Color color );
+static uint32_t       ClaimTextureSlot( void );
+static Texture        LoadTextureSlot( const void * pixels, int width, int height );
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Shapes
+//----------------------------------------------------------------------------------------------------------------------
+// Clear the whole screen, shapes drawn before it in the frame are overwritten
+void
+ClearBackground( Color color )
+{
+    if( !draw.active ) return;
+
+    DrawCommand * command = PushCommand();
+    if( NULL == command ) return;
+
+    command->type             = DRAW_COMMAND_CLEAR;
+    command->clear.float32[0] = color.r;
+    command->clear.float32[1] = color.g;
+    command->clear.float32[2] = color.b;
+    command->clear.float32[3] = color.a;
+}
+
+// Draw a 1 pixel wide line, through the pixel centers
+void
+DrawLine( int startX, int startY, int endX, int endY, Color color )
+{
+    const Vector2 start = { (float)startX + 0.5F, (float)startY + 0.5F };
+    const Vector2 end   = { (float)endX + 0.5F, (float)endY + 0.5F };
+
+    DrawLineEx( start, end, 1.0F, color );
+}
+
+// Draw a line of any width
+void
+DrawLineEx( Vector2 start, Vector2 end, float thick, Color color )
+{
+    DrawInstance * instance = PushInstance( DRAW_WHITE_TEXTURE );
+    if( NULL == instance ) return;
+
+    const DrawInstance line = { { start.x, start.y, end.x, end.y },
+                                { 0.0F, 0.0F, 1.0F, 1.0F },
+                                PackColor( color ),
+                                thick,
+                                DRAW_KIND_LINE,
+                                draw.textures[DRAW_WHITE_TEXTURE].index };
+    *instance               = line;
+}
+
+// Draw a filled rectangle
+void
+DrawRectangle( int posX, int posY, int width, int height, Color color )
+{
+    const Rectangle rec = { (float)posX, (float)posY, (float)width, (float)height };
+
+    DrawRectangleRec( rec, color );
+}
+
+// Draw a filled rectangle
+void
+DrawRectangleRec( Rectangle rec, Color color )
+{
+    DrawInstance * instance = PushInstance( DRAW_WHITE_TEXTURE );
+    if( NULL == instance ) return;
+
+    const DrawInstance quad = { { rec.x, rec.y, rec.width, rec.height },
+                                { 0.0F, 0.0F, 1.0F, 1.0F },
+                                PackColor( color ),
+                                0.0F,
+                                DRAW_KIND_QUAD,
+                                draw.textures[DRAW_WHITE_TEXTURE].index };
+    *instance               = quad;
+}
+
+// Draw a 1 pixel wide rectangle outline, inside the rectangle
+void
+DrawRectangleLines( int posX, int posY, int width, int height, Color color )
+{
+    DrawRectangle( posX, posY, width, 1, color );
+    DrawRectangle( posX, posY + height - 1, width, 1, color );
+
+    // Side bars between the top and bottom ones, none when they overlap
+    const int sideHeight = ( 2 < height ) ? height - 2 : 0;
+    DrawRectangle( posX, posY + 1, 1, sideHeight, color );
+    DrawRectangle( posX + width - 1, posY + 1, 1, sideHeight, color );
+}
+
+// Draw a filled circle
+void
+DrawCircle( int centerX, int centerY, float radius, Color color )
+{
+    const Vector2 center = { (float)centerX, (float)centerY };
+
+    DrawCircleV( center, radius, color );
+}
+
+// Draw a filled circle, antialiased over its last pixel
+void
+DrawCircleV( Vector2 center, float radius, Color color )
+{
+    DrawInstance * instance = PushInstance( DRAW_WHITE_TEXTURE );
+    if( NULL == instance ) return;
+
+    const DrawInstance circle = { { center.x, center.y, radius, 0.0F },
+                                  { 0.5F, 0.5F, 0.5F, 0.5F },
+                                  PackColor( color ),
+                                  0.0F,
+                                  DRAW_KIND_CIRCLE,
+                                  draw.textures[DRAW_WHITE_TEXTURE].index };
+    *instance                 = circle;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Textures
+//----------------------------------------------------------------------------------------------------------------------
+// Load tightly packed RGBA8 pixels into a texture, drawable from the next frame on
+Texture
+LoadTextureFromPixels( const void * pixels, int width, int height )
+{
+    Texture texture = { 0 };
+
+    if( NULL == pixels || 0 >= width || 0 >= height )
+        {
+            TRACELOG( LOG_WARNING, "TEXTURE: Invalid pixel data (%dx%d)", width, height );
+            return texture;
+        }
+
+    if( VK_NULL_HANDLE == draw.pipeline )
+        {
+            TRACELOG( LOG_WARNING, "TEXTURE: Drawing is not initialized" );
+            return texture;
+        }
+
+    return LoadTextureSlot( pixels, width, height );
+}
+
+// Unload a texture, the GPU resources are released once the frames in flight drawing it complete
+void
+UnloadTexture( Texture texture )
+{
+    if( !IsTextureValid( texture ) ) return;
+
+    TextureSlot * slot = &draw.textures[texture.id];
+
+    ReleaseTextureStream( texture.id );
+
+    if( draw.bindless ) BindlessRemoveTexture( slot->index );
+    else
+        {
+            const vvulPooledSet pooled = { draw.descriptorPool, slot->set };
+            vDeferDestroy( VVUL_GARBAGE_DESCRIPTOR_SET, &pooled );
+        }
+    vDeferDestroyImage( slot->image, &slot->view, 1, &slot->memory );
+
+    memset( slot, 0, sizeof( TextureSlot ) );
+    draw.freeTextures[draw.freeCount++] = texture.id;
+}
+
+// Check if a texture is loaded
+bool
+IsTextureValid( Texture texture )
+{
+    return ( DRAW_WHITE_TEXTURE != texture.id && texture.id < draw.textureCount && draw.textures[texture.id].used );
+}
+
+// Get the bindless index shaders sample a texture with, 0xFFFFFFFF without the bindless table
+unsigned int
+GetTextureIndex( Texture texture )
+{
+    if( !draw.bindless || !IsTextureValid( texture ) ) return BINDLESS_INDEX_NONE;
+
+    return draw.textures[texture.id].index;
+}
+
+// Draw a texture
+void
+DrawTexture( Texture texture, int posX, int posY, Color tint )
+{
+    const Rectangle source = { 0.0F, 0.0F, (float)texture.width, (float)texture.height };
+    const Rectangle dest   = { (float)posX, (float)posY, (float)texture.width, (float)texture.height };
+
+    DrawTextureScaled( texture, source, dest, tint );
+}
+
+// Draw a part of a texture, defined by a rectangle in pixels
+void
+DrawTextureRec( Texture texture, Rectangle source, Vector2 position, Color tint )
+{
+    const Rectangle dest = { position.x, position.y, source.width, source.height };
+
+    DrawTextureScaled( texture, source, dest, tint );
+}
+
+// Draw a part of a texture scaled into a destination rectangle, negative source sizes flip it
+void
+DrawTextureScaled( Texture texture, Rectangle source, Rectangle dest, Color tint )
+{
+    if( !IsTextureValid( texture ) ) return;
+
+    DrawInstance * instance = PushInstance( texture.id );
+    if( NULL == instance ) return;
+
+    const float u0 = source.x / (float)texture.width;
+    const float v0 = source.y / (float)texture.height;
+    const float u1 = ( source.x + source.width ) / (float)texture.width;
+    const float v1 = ( source.y + source.height ) / (float)texture.height;
+
+    const DrawInstance quad = { { dest.x, dest.y, dest.width, dest.height },
+                                { u0, v0, u1, v1 },
+                                PackColor( tint ),
+                                0.0F,
+                                DRAW_KIND_QUAD,
+                                draw.textures[texture.id].index };
+    *instance               = quad;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Core
+//----------------------------------------------------------------------------------------------------------------------
+void
+InitDraw( void )
+{
+    const VkDevice device = vGetDevice();
+    VkResult       result;
+
+    VkSamplerCreateInfo samplerInfo = { 0 };
+    samplerInfo.sType               = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter           = VK_FILTER_LINEAR;
+    samplerInfo.minFilter           = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode          = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.addressModeU        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxLod              = VK_LOD_CLAMP_NONE; // Streamed textures carry mips
+
+    result = vkCreateSampler( device, &samplerInfo, NULL, &draw.sampler );
+
+    // The bindless table replaces the per-texture sets, the sampler is indexed as well
+    if( VK_SUCCESS == result && IsBindlessSupported() )
+        {
+            draw.samplerIndex = BindlessAddSampler( draw.sampler );
+            draw.bindless     = ( BINDLESS_INDEX_NONE != draw.samplerIndex );
+        }
+
+    if( VK_SUCCESS == result && !draw.bindless )
+        {
+            // Twice the slots: streaming swaps allocate a new set while the retired one waits for its frames
+            const VkDescriptorPoolSize poolSize = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 * DRAW_MAX_TEXTURES };
+
+            VkDescriptorPoolCreateInfo poolInfo = { 0 };
+            poolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            poolInfo.flags                      = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+            poolInfo.maxSets                    = 2 * DRAW_MAX_TEXTURES;
+            poolInfo.poolSizeCount              = 1;
+            poolInfo.pPoolSizes                 = &poolSize;
+
+            result = vkCreateDescriptorPool( device, &poolInfo, NULL, &draw.descriptorPool );
+        }
+
+    if( VK_SUCCESS != result || !CreatePipeline() )
+        {
+            TRACELOG( LOG_WARNING, "DRAW: Failed to initialize, drawing is disabled" );
+            return;
+        }
+
+    // Shapes sample a single white texel, so they batch with textured quads
+    const uint32_t white = 0xFFFFFFFFU;
+    if( DRAW_WHITE_TEXTURE != LoadTextureSlot( &white, 1, 1 ).id )
+        {
+            TRACELOG( LOG_WARNING, "DRAW: Failed to create the white texture, drawing is disabled" );
+            vkDestroyPipeline( device, draw.pipeline, NULL );
+            draw.pipeline = VK_NULL_HANDLE;
+            return;
+        }
+
+    TRACELOG( LOG_INFO, "DRAW: Batch renderer initialized (%d instances per chunk%s)", DRAW_CHUNK_INSTANCES,
+              draw.bindless ? ", bindless" : "" );
+}
+
+void
+CloseDraw( void )
+{
+    const VkDevice device = vGetDevice();
+
+    if( VK_NULL_HANDLE == device ) return;
+
+    // Runs once at shutdown, draining is simpler than deferring every resource
+    vkDeviceWaitIdle( device );
+
+    for( uint32_t i = 0; i < draw.textureCount; ++i )
+        {
+            TextureSlot * texture = &draw.textures[i];
+            if( !texture->used ) continue;
+
+            vkDestroyImageView( device, texture->view, NULL );
+            vkDestroyImage( device, texture->image, NULL );
+            vFreeMemory( &texture->memory );
+        }
+
+    for( uint32_t slot = 0; slot < VVUL_MAX_FRAMES_IN_FLIGHT; ++slot )
+        {
+            for( uint32_t i = 0; i < draw.chunkCount[slot]; ++i )
+                {
+                    vkDestroyBuffer( device, draw.chunks[slot][i].buffer, NULL );
+                    vFreeMemory( &draw.chunks[slot][i].memory );
+                }
+        }
+
+    if( draw.bindless ) BindlessRemoveSampler( draw.samplerIndex );
+
+    vkDestroyPipeline( device, draw.pipeline, NULL );
+    vkDestroyPipelineLayout( device, draw.layout, NULL );
+    vkDestroyDescriptorSetLayout( device, draw.setLayout, NULL ); // NULL with the bindless table
+    vkDestroyDescriptorPool( device, draw.descriptorPool, NULL );
+    vkDestroySampler( device, draw.sampler, NULL );
+
+    VUL_FREE( draw.commands );
+    VUL_FREE( draw.callbacks );
+    memset( &draw, 0, sizeof( draw ) );
+}
+
+// Start accepting primitives, the chunks of the frame slot are free again once its fence was waited on
+void
+BeginDrawBatch( void )
+{
+    ++draw.frame;
+
+    draw.active        = ( VK_NULL_HANDLE != draw.pipeline && VK_NULL_HANDLE != vGetFrameCommandBuffer() );
+    draw.slot          = vGetFrameIndex();
+    draw.commandCount  = 0;
+    draw.callbackCount = 0;
+    draw.base          = NULL;
+    draw.cursor        = NULL;
+    draw.end           = NULL;
+    draw.chunk         = UINT32_MAX; // NextChunk() starts at 0
+    draw.instancesFull = false;
+}
+
+// Record the batches into the frame command buffer, in one render pass between callbacks
+void
+EndDrawBatch( void )
+{
+    const VkCommandBuffer cmd = vGetFrameCommandBuffer();
+
+    if( !draw.active || VK_NULL_HANDLE == cmd || 0 == draw.commandCount )
+        {
+            draw.active = false;
+            return;
+        }
+
+    draw.active = false;
+
+    const VkRect2D scissor = { { 0, 0 }, vGetTargetExtent() };
+
+    VkDescriptorSet boundSet   = VK_NULL_HANDLE;
+    uint32_t        boundChunk = UINT32_MAX;
+    bool            inPass     = false;
+
+    for( uint32_t i = 0; i < draw.commandCount; ++i )
+        {
+            const DrawCommand * command = &draw.commands[i];
+
+            if( DRAW_COMMAND_CALLBACK == command->type )
+                {
+                    if( inPass ) vCmdEndTargetPass( cmd );
+                    inPass = false;
+
+                    const DrawCallbackEntry * entry = &draw.callbacks[command->first];
+                    entry->callback( cmd, entry->user, entry->params );
+                    continue;
+                }
+
+            // The pass is resumed after a callback, with every binding lost
+            if( !inPass )
+                {
+                    BeginBatchPass( cmd );
+                    inPass     = true;
+                    boundSet   = VK_NULL_HANDLE;
+                    boundChunk = UINT32_MAX;
+                }
+
+            if( DRAW_COMMAND_CLEAR == command->type )
+                {
+                    VkClearAttachment clear = { 0 };
+                    clear.aspectMask        = VK_IMAGE_ASPECT_COLOR_BIT;
+                    clear.colorAttachment   = 0;
+                    clear.clearValue.color  = command->clear;
+
+                    const VkClearRect rect = { scissor, 0, 1 };
+                    vkCmdClearAttachments( cmd, 1, &clear, 1, &rect );
+                    continue;
+                }
+
+            if( command->set != boundSet )
+                {
+                    boundSet = command->set;
+                    vkCmdBindDescriptorSets( cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, draw.layout, 0, 1, &boundSet, 0,
+                                             NULL );
+                }
+
+            if( command->chunk != boundChunk )
+                {
+                    const VkDeviceSize offset = 0;
+                    boundChunk                = command->chunk;
+                    vkCmdBindVertexBuffers( cmd, 0, 1, &draw.chunks[draw.slot][boundChunk].buffer, &offset );
+                }
+
+            vkCmdDraw( cmd, 4, command->count, 0, command->first );
+        }
+
+    if( inPass ) vCmdEndTargetPass( cmd );
+}
+
+// Record a callback in the draw order, it runs from EndDrawing() outside of any render pass
+bool
+PushDrawCallback( DrawCallback callback, void * user, const float * params, uint32_t paramCount )
+{
+    if( !draw.active || NULL == callback || 16 < paramCount ) return false;
+
+    if( draw.callbackCount == draw.callbackCapacity )
+        {
+            const uint32_t      capacity  = ( 0 == draw.callbackCapacity ) ? 16 : draw.callbackCapacity * 2;
+            DrawCallbackEntry * callbacks = (DrawCallbackEntry *)VUL_REALLOC( draw.callbacks,
+                                                                              capacity * sizeof( DrawCallbackEntry ) );
+            if( NULL == callbacks ) return false;
+
+            draw.callbacks        = callbacks;
+            draw.callbackCapacity = capacity;
+        }
+
+    DrawCommand * command = PushCommand();
+    if( NULL == command ) return false;
+
+    DrawCallbackEntry * entry = &draw.callbacks[draw.callbackCount];
+    memset( entry, 0, sizeof( DrawCallbackEntry ) );
+    entry->callback = callback;
+    entry->user     = user;
+    if( 0 < paramCount ) memcpy( entry->params, params, paramCount * sizeof( float ) );
+
+    command->type  = DRAW_COMMAND_CALLBACK;
+    command->first = draw.callbackCount++;
+
+    return true;
+}
+
+// Reserve a texture slot without an image, draws are dropped until SetTextureSlotImage(), 0 when full
+unsigned int
+ReserveTextureSlot( void )
+{
+    if( VK_NULL_HANDLE == draw.pipeline ) return DRAW_WHITE_TEXTURE;
+
+    const uint32_t id = ClaimTextureSlot();
+    if( UINT32_MAX == id ) return DRAW_WHITE_TEXTURE;
+
+    TextureSlot * slot = &draw.textures[id];
+    memset( slot, 0, sizeof( TextureSlot ) );
+
+    slot->index      = draw.bindless ? BINDLESS_INDEX_NONE : 0;
+    slot->readyFrame = UINT64_MAX;
+    slot->used       = true;
+
+    return id;
+}
+
+// Replace the image of a slot, drawable from the current frame on: the upload must have been acquired already.
+// The slot takes ownership of the resources, the previous ones are destroyed once no frame uses them.
+bool
+SetTextureSlotImage( unsigned int id, VkImage image, VkImageView view, const vvulAllocation * memory )
+{
+    if( DRAW_WHITE_TEXTURE == id || id >= draw.textureCount || !draw.textures[id].used ) return false;
+
+    const VkDevice device = vGetDevice();
+    TextureSlot *  slot   = &draw.textures[id];
+    VkDescriptorSet set   = VK_NULL_HANDLE;
+
+    if( draw.bindless )
+        {
+            // Update-after-bind: frames already recorded keep sampling the previous view
+            if( BINDLESS_INDEX_NONE == slot->index )
+                {
+                    slot->index = BindlessAddTexture( view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+                }
+            else
+                {
+                    BindlessUpdateTexture( slot->index, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+                }
+
+            if( BINDLESS_INDEX_NONE == slot->index ) return false;
+        }
+    else
+        {
+            // Sets cannot change while frames in flight use them, every swap gets a new one
+            VkDescriptorSetAllocateInfo allocInfo = { 0 };
+            allocInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocInfo.descriptorPool              = draw.descriptorPool;
+            allocInfo.descriptorSetCount          = 1;
+            allocInfo.pSetLayouts                 = &draw.setLayout;
+
+            if( VK_SUCCESS != vkAllocateDescriptorSets( device, &allocInfo, &set ) ) return false;
+
+            VkDescriptorImageInfo imageDescriptor = { 0 };
+            imageDescriptor.imageView             = view;
+            imageDescriptor.imageLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+            VkWriteDescriptorSet write = { 0 };
+            write.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet               = set;
+            write.descriptorCount      = 1;
+            write.descriptorType       = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            write.pImageInfo           = &imageDescriptor;
+
+            vkUpdateDescriptorSets( device, 1, &write, 0, NULL );
+
+            if( VK_NULL_HANDLE != slot->set )
+                {
+                    const vvulPooledSet pooled = { draw.descriptorPool, slot->set };
+                    vDeferDestroy( VVUL_GARBAGE_DESCRIPTOR_SET, &pooled );
+                }
+            slot->set = set;
+        }
+
+    vDeferDestroyImage( slot->image, &slot->view, 1, &slot->memory );
+
+    slot->image      = image;
+    slot->view       = view;
+    slot->memory     = *memory;
+    slot->readyFrame = draw.frame;
+
+    return true;
+}
+
+// Get the image of a slot, VK_NULL_HANDLE while it has none
+VkImage
+GetTextureSlotImage( unsigned int id )
+{
+    return ( id < draw.textureCount && draw.textures[id].used ) ? draw.textures[id].image : VK_NULL_HANDLE;
+}
+
+// Frames since a texture was last drawn, UINT64_MAX when it never was
+uint64_t
+GetTextureSlotIdleFrames( unsigned int id )
+{
+    if( id >= draw.textureCount || 0 == draw.textures[id].usedFrame ) return UINT64_MAX;
+
+    return draw.frame - draw.textures[id].usedFrame;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Compile the shaders and create the pipeline drawing every primitive
+static bool
+CreatePipeline( void )
+{
+    const VkDevice device = vGetDevice();
+    VkResult       result;
+
+    ShaderDesc shaders[2] = { 0 };
+    shaders[0].path       = "vultra/draw.vert";
+    shaders[0].source     = drawVertexShader;
+    shaders[0].stage      = SHADER_STAGE_VERTEX;
+    shaders[0].optimize   = true;
+    shaders[1].path       = draw.bindless ? "vultra/draw_bindless.frag" : "vultra/draw.frag";
+    shaders[1].source     = draw.bindless ? drawBindlessFragmentShader : drawFragmentShader;
+    shaders[1].stage      = SHADER_STAGE_FRAGMENT;
+    shaders[1].optimize   = true;
+
+    VkShaderModule modules[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+    if( 2 != LoadShaderModules( shaders, 2, modules ) )
+        {
+            UnloadShaderModule( modules[0] );
+            UnloadShaderModule( modules[1] );
+            return false;
+        }
+
+    // Layouts
+    //--------------------------------------------------------------
+    VkDescriptorSetLayoutBinding binding = { 0 };
+    binding.binding                      = 0;
+    binding.descriptorType               = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount              = 1;
+    binding.stageFlags                   = VK_SHADER_STAGE_FRAGMENT_BIT;
+    binding.pImmutableSamplers           = &draw.sampler;
+
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo = { 0 };
+    setLayoutInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.bindingCount                    = 1;
+    setLayoutInfo.pBindings                       = &binding;
+
+    const VkDescriptorSetLayout bindlessLayout = GetBindlessSetLayout();
+
+    result = draw.bindless ? VK_SUCCESS : vkCreateDescriptorSetLayout( device, &setLayoutInfo, NULL, &draw.setLayout );
+
+    const VkPushConstantRange pushRange = { VK_SHADER_STAGE_VERTEX_BIT, 0, 2 * sizeof( float ) };
+
+    VkPipelineLayoutCreateInfo layoutInfo = { 0 };
+    layoutInfo.sType                      = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount             = 1;
+    layoutInfo.pSetLayouts                = draw.bindless ? &bindlessLayout : &draw.setLayout;
+    layoutInfo.pushConstantRangeCount     = 1;
+    layoutInfo.pPushConstantRanges        = &pushRange;
+
+    if( VK_SUCCESS == result ) result = vkCreatePipelineLayout( device, &layoutInfo, NULL, &draw.layout );
+
+    // Pipeline
+    //--------------------------------------------------------------
+    VkPipelineShaderStageCreateInfo stages[2] = { 0 };
+    for( int i = 0; i < 2; ++i )
+        {
+            stages[i].sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            stages[i].stage  = ( 0 == i ) ? VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_FRAGMENT_BIT;
+            stages[i].module = modules[i];
+            stages[i].pName  = "main";
+        }
+
+    // Bindless sampler index, constant for the pipeline
+    const VkSpecializationMapEntry samplerEntry = { 0, 0, sizeof( uint32_t ) };
+
+    VkSpecializationInfo specialization = { 0 };
+    specialization.mapEntryCount        = 1;
+    specialization.pMapEntries          = &samplerEntry;
+    specialization.dataSize             = sizeof( uint32_t );
+    specialization.pData                = &draw.samplerIndex;
+
+    if( draw.bindless ) stages[1].pSpecializationInfo = &specialization;
+
+    // One binding, advanced per instance: every vertex of a quad reads the same primitive
+    const VkVertexInputBindingDescription vertexBinding = { 0, sizeof( DrawInstance ), VK_VERTEX_INPUT_RATE_INSTANCE };
+
+    const VkVertexInputAttributeDescription attributes[6] = {
+        { 0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof( DrawInstance, points ) },
+        { 1, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof( DrawInstance, uvs ) },
+        { 2, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof( DrawInstance, color ) },
+        { 3, 0, VK_FORMAT_R32_SFLOAT, offsetof( DrawInstance, thickness ) },
+        { 4, 0, VK_FORMAT_R32_UINT, offsetof( DrawInstance, kind ) },
+        { 5, 0, VK_FORMAT_R32_UINT, offsetof( DrawInstance, texture ) },
+    };
+
+    VkPipelineVertexInputStateCreateInfo vertexInput = { 0 };
+    vertexInput.sType                                = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInput.vertexBindingDescriptionCount        = 1;
+    vertexInput.pVertexBindingDescriptions           = &vertexBinding;
+    vertexInput.vertexAttributeDescriptionCount      = 6;
+    vertexInput.pVertexAttributeDescriptions         = attributes;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly = { 0 };
+    inputAssembly.sType    = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+
+    VkPipelineViewportStateCreateInfo viewportState = { 0 };
+    viewportState.sType                             = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount                     = 1;
+    viewportState.scissorCount                      = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterization = { 0 };
+    rasterization.sType       = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterization.cullMode    = VK_CULL_MODE_NONE; // Flipped quads and lines wind either way
+    rasterization.lineWidth   = 1.0F;
+
+    VkPipelineMultisampleStateCreateInfo multisample = { 0 };
+    multisample.sType                                = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisample.rasterizationSamples                 = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineColorBlendAttachmentState blendAttachment = { 0 };
+    blendAttachment.blendEnable                         = VK_TRUE;
+    blendAttachment.srcColorBlendFactor                 = VK_BLEND_FACTOR_SRC_ALPHA;
+    blendAttachment.dstColorBlendFactor                 = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    blendAttachment.colorBlendOp                        = VK_BLEND_OP_ADD;
+    blendAttachment.srcAlphaBlendFactor                 = VK_BLEND_FACTOR_ONE;
+    blendAttachment.dstAlphaBlendFactor                 = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    blendAttachment.alphaBlendOp                        = VK_BLEND_OP_ADD;
+    blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT
+                                   | VK_COLOR_COMPONENT_A_BIT;
+
+    VkPipelineColorBlendStateCreateInfo colorBlend = { 0 };
+    colorBlend.sType                               = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlend.attachmentCount                     = 1;
+    colorBlend.pAttachments                        = &blendAttachment;
+
+    const VkDynamicState dynamicStates[2] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+    VkPipelineDynamicStateCreateInfo dynamicState = { 0 };
+    dynamicState.sType                            = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount                = 2;
+    dynamicState.pDynamicStates                   = dynamicStates;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo = { 0 };
+    pipelineInfo.sType                        = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount                   = 2;
+    pipelineInfo.pStages                      = stages;
+    pipelineInfo.pVertexInputState            = &vertexInput;
+    pipelineInfo.pInputAssemblyState          = &inputAssembly;
+    pipelineInfo.pViewportState               = &viewportState;
+    pipelineInfo.pRasterizationState          = &rasterization;
+    pipelineInfo.pMultisampleState            = &multisample;
+    pipelineInfo.pColorBlendState             = &colorBlend;
+    pipelineInfo.pDynamicState                = &dynamicState;
+    pipelineInfo.layout                       = draw.layout;
+    pipelineInfo.renderPass                   = vGetTargetRenderPass();
+    pipelineInfo.subpass                      = 0;
+
+    if( VK_SUCCESS == result )
+        {
+            result = vkCreateGraphicsPipelines( device, vGetPipelineCache(), 1, &pipelineInfo, NULL, &draw.pipeline );
+        }
+
+    UnloadShaderModule( modules[0] );
+    UnloadShaderModule( modules[1] );
+
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_WARNING, "DRAW: Failed to create the pipeline (%d)", (int)result );
+            return false;
+        }
+
+    return true;
+}
+
+// Begin the target pass and bind the state shared by every batch
+static void
+BeginBatchPass( VkCommandBuffer cmd )
+{
+    const VkExtent2D extent = vGetTargetExtent();
+
+    vCmdBeginTargetPass( cmd, VK_SUBPASS_CONTENTS_INLINE );
+    vkCmdBindPipeline( cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, draw.pipeline );
+
+    const VkViewport viewport = { 0.0F, 0.0F, (float)extent.width, (float)extent.height, 0.0F, 1.0F };
+    const VkRect2D   scissor  = { { 0, 0 }, extent };
+    vkCmdSetViewport( cmd, 0, 1, &viewport );
+    vkCmdSetScissor( cmd, 0, 1, &scissor );
+
+    const float scale[2] = { 2.0F / (float)extent.width, 2.0F / (float)extent.height };
+    vkCmdPushConstants( cmd, draw.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof( scale ), scale );
+
+    // Bound once, the runs then carry no set
+    if( draw.bindless ) BindBindlessSet( cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, draw.layout, 0 );
+}
+
+// Move on to the next chunk of the frame slot, created on first use
+static bool
+NextChunk( void )
+{
+    const uint32_t next = draw.chunk + 1;
+
+    if( DRAW_MAX_CHUNKS <= next )
+        {
+            // Later primitives of the frame are dropped, so this warns once per frame
+            TRACELOG( LOG_WARNING, "DRAW: Instance limit reached (%d), later primitives of the frame dropped",
+                      DRAW_MAX_CHUNKS * DRAW_CHUNK_INSTANCES );
+            draw.instancesFull = true;
+            return false;
+        }
+
+    DrawChunk * chunk = &draw.chunks[draw.slot][next];
+
+    if( draw.chunkCount[draw.slot] <= next )
+        {
+            VkBufferCreateInfo bufferInfo = { 0 };
+            bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            bufferInfo.size               = (VkDeviceSize)DRAW_CHUNK_INSTANCES * sizeof( DrawInstance );
+            bufferInfo.usage              = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+            bufferInfo.sharingMode        = VK_SHARING_MODE_EXCLUSIVE;
+
+            if( VK_SUCCESS != vkCreateBuffer( vGetDevice(), &bufferInfo, NULL, &chunk->buffer ) )
+                {
+                    TRACELOG( LOG_WARNING, "DRAW: Failed to create an instance buffer, later primitives dropped" );
+                    draw.instancesFull = true;
+                    return false;
+                }
+
+            if( !vAllocateBufferMemory( chunk->buffer, VVUL_MEMORY_CPU_TO_GPU, &chunk->memory )
+                || NULL == chunk->memory.mapped )
+                {
+                    TRACELOG( LOG_WARNING, "DRAW: Failed to allocate an instance buffer, later primitives dropped" );
+                    vkDestroyBuffer( vGetDevice(), chunk->buffer, NULL );
+                    vFreeMemory( &chunk->memory );
+                    memset( chunk, 0, sizeof( DrawChunk ) );
+                    draw.instancesFull = true;
+                    return false;
+                }
+
+            draw.chunkCount[draw.slot] = next + 1;
+        }
+
+    draw.chunk  = next;
+    draw.base   = (DrawInstance *)chunk->memory.mapped;
+    draw.cursor = draw.base;
+    draw.end    = draw.base + DRAW_CHUNK_INSTANCES;
+
+    return true;
+}
+
+// Append a command, growing the list as needed
+static DrawCommand *
+PushCommand( void )
+{
+    if( draw.commandCount == draw.commandCapacity )
+        {
+            const uint32_t capacity = ( 0 == draw.commandCapacity ) ? 256 : draw.commandCapacity * 2;
+            DrawCommand *  commands = (DrawCommand *)VUL_REALLOC( draw.commands, capacity * sizeof( DrawCommand ) );
+            if( NULL == commands ) return NULL;
+
+            draw.commands        = commands;
+            draw.commandCapacity = capacity;
+        }
+
+    DrawCommand * command = &draw.commands[draw.commandCount++];
+    memset( command, 0, sizeof( DrawCommand ) );
+
+    return command;
+}
+
+// Reserve the instance of a primitive, extending the last run when it uses the same texture and chunk
+static DrawInstance *
+PushInstance( unsigned int texture )
+{
+    if( !draw.active ) return NULL;
+
+    // Drawing a texture counts as use even before it is resident, so streaming keeps loading it
+    draw.textures[texture].usedFrame = draw.frame;
+    if( draw.frame < draw.textures[texture].readyFrame ) return NULL;
+    if( draw.cursor == draw.end && ( draw.instancesFull || !NextChunk() ) ) return NULL;
+
+    const VkDescriptorSet set   = draw.textures[texture].set;
+    const uint32_t        index = (uint32_t)( draw.cursor - draw.base );
+
+    DrawCommand * last = ( 0 < draw.commandCount ) ? &draw.commands[draw.commandCount - 1] : NULL;
+    if( NULL == last || DRAW_COMMAND_INSTANCES != last->type || set != last->set || draw.chunk != last->chunk )
+        {
+            last = PushCommand();
+            if( NULL == last ) return NULL;
+
+            last->type  = DRAW_COMMAND_INSTANCES;
+            last->set   = set;
+            last->chunk = draw.chunk;
+            last->first = index;
+        }
+
+    ++last->count;
+
+    return draw.cursor++;
+}
+
+// Pack a normalized color into RGBA8
+static uint32_t
+PackColor( Color color )
+{
+    const float components[4] = { color.r, color.g, color.b, color.a };
+    uint32_t    packed        = 0;
+
+    for( int i = 0; i < 4; ++i )
+        {
+            const float c = ( components[i] < 0.0F ) ? 0.0F : ( 1.0F < components[i] ) ? 1.0F : components[i];
+            packed |= (uint32_t)( c * 255.0F + 0.5F ) << ( 8 * i );
+        }
+
+    return packed;
+}
+
+// Take a free texture slot, UINT32_MAX when every slot is in use
+static uint32_t
+ClaimTextureSlot( void )
+{
+    if( 0 < draw.freeCount ) return draw.freeTextures[--draw.freeCount];
+    if( DRAW_MAX_TEXTURES > draw.textureCount ) return draw.textureCount++;
+
+    TRACELOG( LOG_WARNING, "TEXTURE: Texture limit reached (%d)", DRAW_MAX_TEXTURES );
+
+    return UINT32_MAX;
+}
+
+// Create a texture in a free slot and queue the upload of its pixels
+static Texture
+LoadTextureSlot( const void * pixels, int width, int height )
+{
+    const VkDevice device  = vGetDevice();
+    Texture        texture = { 0 };
+    const uint32_t id      = ClaimTextureSlot();
+
+    if( UINT32_MAX == id ) return texture;
+
+    TextureSlot * slot   = &draw.textures[id];
+    VkResult      result = VK_SUCCESS;
+
+    slot->index = draw.bindless ? BINDLESS_INDEX_NONE : 0;
+
+    VkImageCreateInfo imageInfo = { 0 };
+    imageInfo.sType             = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType         = VK_IMAGE_TYPE_2D;
+    imageInfo.format            = VK_FORMAT_R8G8B8A8_UNORM;
+    imageInfo.extent.width      = (uint32_t)width;
+    imageInfo.extent.height     = (uint32_t)height;
+    imageInfo.extent.depth      = 1;
+    imageInfo.mipLevels         = 1;
+    imageInfo.arrayLayers       = 1;
+    imageInfo.samples           = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling            = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage             = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    imageInfo.sharingMode       = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    result = vkCreateImage( device, &imageInfo, NULL, &slot->image );
+
+    if( VK_SUCCESS == result && !vAllocateImageMemory( slot->image, VVUL_MEMORY_GPU_ONLY, &slot->memory ) )
+        {
+            result = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+
+    if( VK_SUCCESS == result )
+        {
+            VkImageViewCreateInfo viewInfo       = { 0 };
+            viewInfo.sType                       = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image                       = slot->image;
+            viewInfo.viewType                    = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format                      = VK_FORMAT_R8G8B8A8_UNORM;
+            viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            viewInfo.subresourceRange.levelCount = 1;
+            viewInfo.subresourceRange.layerCount = 1;
+
+            result = vkCreateImageView( device, &viewInfo, NULL, &slot->view );
+        }
+
+    if( VK_SUCCESS == result && draw.bindless )
+        {
+            slot->index = BindlessAddTexture( slot->view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+            if( BINDLESS_INDEX_NONE == slot->index ) result = VK_ERROR_TOO_MANY_OBJECTS;
+        }
+    else if( VK_SUCCESS == result )
+        {
+            VkDescriptorSetAllocateInfo allocInfo = { 0 };
+            allocInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocInfo.descriptorPool              = draw.descriptorPool;
+            allocInfo.descriptorSetCount          = 1;
+            allocInfo.pSetLayouts                 = &draw.setLayout;
+
+            result = vkAllocateDescriptorSets( device, &allocInfo, &slot->set );
+        }
+
+    if( VK_SUCCESS == result
+        && VVUL_UPLOAD_FAILED == vUploadImage( slot->image, 0, (uint32_t)width, (uint32_t)height, 4, pixels,
+                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL ) )
+        {
+            result = VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
+
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_WARNING, "TEXTURE: Failed to load texture (%dx%d)", width, height );
+
+            if( VK_NULL_HANDLE != slot->set ) vkFreeDescriptorSets( device, draw.descriptorPool, 1, &slot->set );
+            if( draw.bindless && BINDLESS_INDEX_NONE != slot->index ) BindlessRemoveTexture( slot->index );
+
+            // A partial upload may still be copying into the image
+            vDeferDestroyImage( slot->image, &slot->view, 1, &slot->memory );
+            memset( slot, 0, sizeof( TextureSlot ) );
+            draw.freeTextures[draw.freeCount++] = id;
+
+            return texture;
+        }
+
+    if( !draw.bindless )
+        {
+            VkDescriptorImageInfo imageDescriptor = { 0 };
+            imageDescriptor.imageView             = slot->view;
+            imageDescriptor.imageLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+            VkWriteDescriptorSet write = { 0 };
+            write.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet               = slot->set;
+            write.descriptorCount      = 1;
+            write.descriptorType       = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            write.pImageInfo           = &imageDescriptor;
+
+            vkUpdateDescriptorSets( device, 1, &write, 0, NULL );
+        }
+
+    // The upload is acquired by the next vBeginFrame(), frames begun before it cannot sample the texture
+    slot->readyFrame = draw.frame + 1;
+    slot->used       = true;
+
+    texture.id     = id;
+    texture.width  = width;
+    texture.height = height;
+
+    TRACELOG( LOG_DEBUG, "TEXTURE: [ID %u] Texture loaded (%dx%d)", id, width, height );
+
+    return texture;
+}
@@ -0,0 +1,47 @@
+/**************************** VDRAW_INTERNAL *****************************
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#ifndef VDRAW_INTERNAL_H
+#define VDRAW_INTERNAL_H
+
+#include "vultra/vvul.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+// Draw Internals, shared by the modules recording through the 2D batcher (vdraw.c)
+//----------------------------------------------------------------------------------------------------------------------
+// Callback recording into the frame, outside of any render pass
+typedef void ( *DrawCallback )( VkCommandBuffer cmd, void * user, const float * params );
+
+// Record a callback in the draw order, params (up to 16 floats, may be NULL) are copied
+bool PushDrawCallback( DrawCallback callback, void * user, const float * params, uint32_t paramCount );
+
+// Texture slots filled by the streaming
+unsigned int ReserveTextureSlot( void );
+bool         SetTextureSlotImage( unsigned int id, VkImage image, VkImageView view, const vvulAllocation * memory );
+VkImage      GetTextureSlotImage( unsigned int id );
+uint64_t     GetTextureSlotIdleFrames( unsigned int id );
+
+#endif // !VDRAW_INTERNAL_H
@@ -0,0 +1,1106 @@
+/******************************** VGRAPH *********************************
+ * vgraph: Render graph, automatic barriers and transient memory aliasing
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - Culling walks the passes backwards: a pass is kept when it has side effects, writes an
+ *   imported resource, or writes a resource a kept pass reads. Writes are assumed partial, an
+ *   earlier writer of a resource read later is always kept.
+ * - Every resource tracks the stages that wrote it last, the stages and accesses that already
+ *   waited on that write and the stages that read it since. A barrier is emitted only for a
+ *   layout change, a write (waits on the previous readers and writer) or a read the previous
+ *   write was not made visible to yet.
+ * - Transients are placed greedily, largest first, at the lowest offset not used by a transient
+ *   alive during an overlapping range of passes. The first use of a placed transient waits on
+ *   the transients that occupied its memory before (and on the previous execution), with an
+ *   UNDEFINED old layout.
+ * - Without synchronization2 the same barriers are recorded with vkCmdPipelineBarrier, every
+ *   stage and access bit used here has the same value in both.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#include "vultra/vgraph.h"
+#include "vultra/vultra.h"
+#include "vultra/vutils.h"
+
+#include "vultra/vvul.h"
+
+#include <string.h> /* memcmp, memset */
+
+#ifndef GRAPH_MAX_RESOURCES
+#    define GRAPH_MAX_RESOURCES 128 // Resources declared per frame, imported ones included
+#endif
+#ifndef GRAPH_MAX_PASSES
+#    define GRAPH_MAX_PASSES 64 // Passes declared per frame
+#endif
+#ifndef GRAPH_MAX_PASS_ACCESSES
+#    define GRAPH_MAX_PASS_ACCESSES 16 // Resources accessed by a single pass
+#endif
+
+// Access flags writing memory, the others only read it
+#define GRAPH_WRITE_ACCESS                                                                                             \
+    ( VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT \
+      | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT )
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Synchronization scope and layout of an access kind
+typedef struct GraphAccessInfo
+{
+    VkPipelineStageFlags stages;
+    VkAccessFlags        read;
+    VkAccessFlags        write;       // 0 when the access cannot write
+    VkImageLayout        readLayout;  // Layout when only read
+    VkImageLayout        writeLayout; // Layout when written
+    VkImageUsageFlags    imageUsage;
+    VkBufferUsageFlags   bufferUsage;
+} GraphAccessInfo;
+
+// Resource accessed by a pass, accesses of the same resource are merged
+typedef struct GraphPassAccess
+{
+    GraphResource        resource;
+    VkPipelineStageFlags stages;
+    VkAccessFlags        access;
+    VkImageLayout        layout;
+    bool                 write;
+} GraphPassAccess;
+
+typedef struct GraphPass
+{
+    const char *      name;
+    GraphPassCallback callback;
+    void *            user;
+    GraphPassAccess   accesses[GRAPH_MAX_PASS_ACCESSES];
+    uint32_t          accessCount;
+    bool              sideEffect;
+    bool              alive;
+} GraphPass;
+
+// Synchronization state of a resource while the passes are recorded
+typedef struct GraphState
+{
+    VkImageLayout        layout;
+    VkPipelineStageFlags writeStages;   // Stages of the last write, 0 when never written
+    VkAccessFlags        writeAccess;   // Accesses of the last write
+    VkPipelineStageFlags visibleStages; // Stages that already waited on the last write
+    VkAccessFlags        visibleAccess; // Accesses the last write was made visible to
+    VkPipelineStageFlags readStages;    // Stages reading since the last write
+} GraphState;
+
+typedef enum
+{
+    GRAPH_RESOURCE_TEXTURE = 0,
+    GRAPH_RESOURCE_BUFFER
+} GraphResourceType;
+
+// Declared resource
+typedef struct GraphResourceData
+{
+    const char *       name;
+    GraphResourceType  type;
+    bool               imported;
+    GraphTextureDesc   texture;
+    GraphBufferDesc    buffer;
+    VkImageAspectFlags aspect;
+    VkImageLayout      finalLayout; // Imported textures, UNDEFINED: left in the last used layout
+    VkImage            image;
+    VkImageView        view;
+    VkBuffer           handle;
+    uint32_t           first;    // First alive pass accessing it, UINT32_MAX when unused
+    uint32_t           last;     // Last alive pass accessing it
+    uint32_t           physical; // Slot of a transient in the physical cache
+    GraphState         state;
+    VkPipelineStageFlags usedStages; // Every stage it was accessed in during the execution
+    VkAccessFlags        usedWrites; // Every write access of the execution
+    bool               needed;       // Read by a kept pass, culling only
+} GraphResourceData;
+
+// What a physical transient was created for, the cache is reused while it matches exactly
+typedef struct GraphSignature
+{
+    GraphResourceType  type;
+    GraphTextureDesc   texture;
+    GraphBufferDesc    buffer;
+    uint32_t           first;
+    uint32_t           last;
+} GraphSignature;
+
+// Physical transient
+typedef struct GraphPhysical
+{
+    VkImage        image;
+    VkImageView    view;
+    VkBuffer       buffer;
+    VkDeviceSize   offset;  // In the shared allocation
+    VkDeviceSize   size;
+    vvulAllocation memory;  // Own allocation when the transients cannot share one
+    bool           shared;
+    uint32_t       first;
+    uint32_t       last;
+} GraphPhysical;
+
+struct RenderGraph
+{
+    GraphResourceData resources[GRAPH_MAX_RESOURCES];
+    uint32_t          resourceCount;
+    GraphPass         passes[GRAPH_MAX_PASSES];
+    uint32_t          passCount;
+
+    // Physical transients, kept across executions
+    GraphSignature       signatures[GRAPH_MAX_RESOURCES];
+    GraphPhysical        physical[GRAPH_MAX_RESOURCES];
+    uint32_t             physicalCount;
+    vvulAllocation       heap;       // Shared by the aliased transients
+    VkPipelineStageFlags heapStages; // Stages the transients were used in by the previous execution
+    VkAccessFlags        heapWrites;
+};
+
+// Barriers recorded before a pass
+typedef struct GraphBarriers
+{
+    VkImageMemoryBarrier2  images[GRAPH_MAX_PASS_ACCESSES];
+    VkBufferMemoryBarrier2 buffers[GRAPH_MAX_PASS_ACCESSES];
+    uint32_t               imageCount;
+    uint32_t               bufferCount;
+} GraphBarriers;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Variables Definition
+//----------------------------------------------------------------------------------------------------------------------
+#define GRAPH_SHADER_STAGES                                                                                            \
+    ( VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT                                      \
+      | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT )
+#define GRAPH_DEPTH_STAGES ( VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT )
+
+static const GraphAccessInfo accessInfos[GRAPH_ACCESS_COUNT] = {
+    [GRAPH_ACCESS_COLOR_ATTACHMENT] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                        VK_ACCESS_COLOR_ATTACHMENT_READ_BIT,
+                                        VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                                        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, 0 },
+    [GRAPH_ACCESS_DEPTH_ATTACHMENT] = { GRAPH_DEPTH_STAGES, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+                                        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT
+                                            | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                                        VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+                                        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                                        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, 0 },
+    [GRAPH_ACCESS_SAMPLED]          = { GRAPH_SHADER_STAGES, VK_ACCESS_SHADER_READ_BIT, 0,
+                                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_UNDEFINED,
+                                        VK_IMAGE_USAGE_SAMPLED_BIT, VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT },
+    [GRAPH_ACCESS_STORAGE]          = { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                        VK_ACCESS_SHADER_READ_BIT,
+                                        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                                        VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT,
+                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT },
+    [GRAPH_ACCESS_TRANSFER_SRC]     = { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, 0,
+                                        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_UNDEFINED,
+                                        VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_BUFFER_USAGE_TRANSFER_SRC_BIT },
+    [GRAPH_ACCESS_TRANSFER_DST]     = { VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                        VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_BUFFER_USAGE_TRANSFER_DST_BIT },
+    [GRAPH_ACCESS_VERTEX_BUFFER]    = { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, 0,
+                                        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED, 0,
+                                        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT },
+    [GRAPH_ACCESS_INDEX_BUFFER]     = { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT, 0,
+                                        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED, 0,
+                                        VK_BUFFER_USAGE_INDEX_BUFFER_BIT },
+    [GRAPH_ACCESS_INDIRECT_BUFFER]  = { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, 0,
+                                        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED, 0,
+                                        VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT },
+    [GRAPH_ACCESS_UNIFORM_BUFFER]   = { GRAPH_SHADER_STAGES, VK_ACCESS_UNIFORM_READ_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED,
+                                        VK_IMAGE_LAYOUT_UNDEFINED, 0, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT },
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Declaration
+//----------------------------------------------------------------------------------------------------------------------
+static void          AddAccess( RenderGraph * graph, uint32_t pass, GraphResource resource, GraphAccess access,
+                                bool write );
+static void          CullPasses( RenderGraph * graph );
+static bool          RealizeTransients( RenderGraph * graph );
+static bool          CreatePhysical( RenderGraph * graph, uint32_t count, const uint32_t * order );
+static void          RetirePhysical( RenderGraph * graph );
+static void          SyncAccess( RenderGraph * graph, GraphResourceData * resource, const GraphPassAccess * access,
+                                 GraphBarriers * barriers );
+static void          FlushBarriers( VkCommandBuffer cmd, GraphBarriers * barriers );
+static VkImageAspectFlags FormatAspect( VkFormat format );
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Graph
+//----------------------------------------------------------------------------------------------------------------------
+// Create an empty render graph
+RenderGraph *
+LoadRenderGraph( void )
+{
+    RenderGraph * graph = (RenderGraph *)VUL_CALLOC( 1, sizeof( RenderGraph ) );
+    if( NULL == graph ) TRACELOG( LOG_ERROR, "GRAPH: Failed to allocate render graph" );
+
+    return graph;
+}
+
+// Unload a graph, its physical transients are released once the frames in flight completed
+void
+UnloadRenderGraph( RenderGraph * graph )
+{
+    if( NULL == graph ) return;
+
+    RetirePhysical( graph );
+    VUL_FREE( graph );
+}
+
+// Clear the declared passes and resources, the physical transients are kept for the next declaration
+void
+ResetRenderGraph( RenderGraph * graph )
+{
+    graph->resourceCount = 0;
+    graph->passCount     = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Resources
+//----------------------------------------------------------------------------------------------------------------------
+// Declare a transient texture, created (or reused) by ExecuteRenderGraph()
+GraphResource
+GraphCreateTexture( RenderGraph * graph, const char * name, const GraphTextureDesc * desc )
+{
+    if( GRAPH_MAX_RESOURCES <= graph->resourceCount ) return GRAPH_RESOURCE_NONE;
+
+    GraphResourceData * resource = &graph->resources[graph->resourceCount];
+    memset( resource, 0, sizeof( GraphResourceData ) );
+    resource->name    = name;
+    resource->type    = GRAPH_RESOURCE_TEXTURE;
+    resource->texture = *desc;
+    resource->aspect  = FormatAspect( desc->format );
+
+    return graph->resourceCount++;
+}
+
+// Declare a transient buffer, created (or reused) by ExecuteRenderGraph()
+GraphResource
+GraphCreateBuffer( RenderGraph * graph, const char * name, const GraphBufferDesc * desc )
+{
+    if( GRAPH_MAX_RESOURCES <= graph->resourceCount ) return GRAPH_RESOURCE_NONE;
+
+    GraphResourceData * resource = &graph->resources[graph->resourceCount];
+    memset( resource, 0, sizeof( GraphResourceData ) );
+    resource->name   = name;
+    resource->type   = GRAPH_RESOURCE_BUFFER;
+    resource->buffer = *desc;
+
+    return graph->resourceCount++;
+}
+
+// Declare a texture owned by the caller, currently in layout, transitioned to finalLayout after the last pass
+// (UNDEFINED: left in the layout of its last access)
+GraphResource
+GraphImportTexture( RenderGraph * graph, const char * name, VkImage image, VkImageView view, VkFormat format,
+                    VkImageLayout layout, VkImageLayout finalLayout )
+{
+    if( GRAPH_MAX_RESOURCES <= graph->resourceCount ) return GRAPH_RESOURCE_NONE;
+
+    GraphResourceData * resource = &graph->resources[graph->resourceCount];
+    memset( resource, 0, sizeof( GraphResourceData ) );
+    resource->name           = name;
+    resource->type           = GRAPH_RESOURCE_TEXTURE;
+    resource->imported       = true;
+    resource->texture.format = format;
+    resource->aspect         = FormatAspect( format );
+    resource->image          = image;
+    resource->view           = view;
+    resource->state.layout   = layout;
+    resource->finalLayout    = finalLayout;
+
+    return graph->resourceCount++;
+}
+
+// Declare a buffer owned by the caller
+GraphResource
+GraphImportBuffer( RenderGraph * graph, const char * name, VkBuffer buffer )
+{
+    if( GRAPH_MAX_RESOURCES <= graph->resourceCount ) return GRAPH_RESOURCE_NONE;
+
+    GraphResourceData * resource = &graph->resources[graph->resourceCount];
+    memset( resource, 0, sizeof( GraphResourceData ) );
+    resource->name     = name;
+    resource->type     = GRAPH_RESOURCE_BUFFER;
+    resource->imported = true;
+    resource->handle   = buffer;
+
+    return graph->resourceCount++;
+}
+
+// Get the image of a texture
+VkImage
+GraphGetImage( const RenderGraph * graph, GraphResource resource )
+{
+    return ( resource < graph->resourceCount ) ? graph->resources[resource].image : VK_NULL_HANDLE;
+}
+
+// Get the view of a texture, covering its single mip level and layer
+VkImageView
+GraphGetImageView( const RenderGraph * graph, GraphResource resource )
+{
+    return ( resource < graph->resourceCount ) ? graph->resources[resource].view : VK_NULL_HANDLE;
+}
+
+// Get the buffer of a buffer resource
+VkBuffer
+GraphGetBuffer( const RenderGraph * graph, GraphResource resource )
+{
+    return ( resource < graph->resourceCount ) ? graph->resources[resource].handle : VK_NULL_HANDLE;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Passes
+//----------------------------------------------------------------------------------------------------------------------
+// Add a pass after the previous ones, returns its index
+uint32_t
+GraphAddPass( RenderGraph * graph, const char * name, GraphPassCallback callback, void * user )
+{
+    if( GRAPH_MAX_PASSES <= graph->passCount )
+        {
+            TRACELOG( LOG_WARNING, "GRAPH: [%s] Too many passes, the pass is ignored", name );
+            return UINT32_MAX;
+        }
+
+    GraphPass * pass = &graph->passes[graph->passCount];
+    memset( pass, 0, sizeof( GraphPass ) );
+    pass->name     = name;
+    pass->callback = callback;
+    pass->user     = user;
+
+    return graph->passCount++;
+}
+
+// Declare that a pass reads a resource
+void
+GraphRead( RenderGraph * graph, uint32_t pass, GraphResource resource, GraphAccess access )
+{
+    AddAccess( graph, pass, resource, access, false );
+}
+
+// Declare that a pass writes a resource
+void
+GraphWrite( RenderGraph * graph, uint32_t pass, GraphResource resource, GraphAccess access )
+{
+    AddAccess( graph, pass, resource, access, true );
+}
+
+// Keep a pass even when nothing reads what it writes (readbacks, presentation, ...)
+void
+GraphSetSideEffect( RenderGraph * graph, uint32_t pass )
+{
+    if( pass < graph->passCount ) graph->passes[pass].sideEffect = true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Execution
+//----------------------------------------------------------------------------------------------------------------------
+// Cull the unused passes, realize the transients and record the passes with their barriers
+bool
+ExecuteRenderGraph( RenderGraph * graph, VkCommandBuffer cmd )
+{
+    if( VK_NULL_HANDLE == cmd ) return false;
+
+    CullPasses( graph );
+    if( !RealizeTransients( graph ) ) return false;
+
+    const bool profiled = ( cmd == vGetFrameCommandBuffer() );
+
+    for( uint32_t p = 0; p < graph->passCount; ++p )
+        {
+            const GraphPass * pass = &graph->passes[p];
+            if( !pass->alive ) continue;
+
+            // Every dependency of the pass in a single batch
+            GraphBarriers barriers;
+            barriers.imageCount  = 0;
+            barriers.bufferCount = 0;
+            for( uint32_t a = 0; a < pass->accessCount; ++a )
+                {
+                    const GraphPassAccess * access = &pass->accesses[a];
+                    SyncAccess( graph, &graph->resources[access->resource], access, &barriers );
+                }
+            FlushBarriers( cmd, &barriers );
+
+            if( profiled ) BeginGpuZone( pass->name );
+            if( NULL != pass->callback ) pass->callback( cmd, graph, pass->user );
+            if( profiled ) EndGpuZone();
+        }
+
+    // Hand the imported textures back in the layout their owner expects
+    GraphBarriers barriers;
+    barriers.imageCount  = 0;
+    barriers.bufferCount = 0;
+    for( uint32_t i = 0; i < graph->resourceCount; ++i )
+        {
+            GraphResourceData * resource = &graph->resources[i];
+            if( !resource->imported || GRAPH_RESOURCE_TEXTURE != resource->type ) continue;
+            if( VK_IMAGE_LAYOUT_UNDEFINED == resource->finalLayout || resource->state.layout == resource->finalLayout )
+                {
+                    continue;
+                }
+
+            GraphPassAccess release = { 0 };
+            release.resource        = i;
+            release.stages          = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            release.access          = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+            release.layout          = resource->finalLayout;
+            release.write           = true;
+            SyncAccess( graph, resource, &release, &barriers );
+
+            if( GRAPH_MAX_PASS_ACCESSES == barriers.imageCount ) FlushBarriers( cmd, &barriers );
+        }
+    FlushBarriers( cmd, &barriers );
+
+    // The next execution reuses the transients, its first accesses wait on everything done to them here
+    graph->heapStages = 0;
+    graph->heapWrites = 0;
+    for( uint32_t i = 0; i < graph->resourceCount; ++i )
+        {
+            const GraphResourceData * resource = &graph->resources[i];
+            if( resource->imported || UINT32_MAX == resource->first ) continue;
+
+            graph->heapStages |= resource->usedStages;
+            graph->heapWrites |= resource->usedWrites;
+        }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Record an access of a pass, merged with a previous access of the same resource
+static void
+AddAccess( RenderGraph * graph, uint32_t pass, GraphResource resource, GraphAccess access, bool write )
+{
+    if( pass >= graph->passCount || resource >= graph->resourceCount || GRAPH_ACCESS_COUNT <= (int)access ) return;
+
+    GraphPass *             data = &graph->passes[pass];
+    const GraphAccessInfo * info = &accessInfos[access];
+
+    if( write && 0 == info->write )
+        {
+            TRACELOG( LOG_WARNING, "GRAPH: [%s] Access %d of %s cannot write, declared as a read", data->name,
+                      (int)access, graph->resources[resource].name );
+            write = false;
+        }
+
+    const VkImageLayout layout = write ? info->writeLayout : info->readLayout;
+
+    GraphPassAccess * entry = NULL;
+    for( uint32_t i = 0; i < data->accessCount; ++i )
+        {
+            if( resource == data->accesses[i].resource ) entry = &data->accesses[i];
+        }
+
+    if( NULL == entry )
+        {
+            if( GRAPH_MAX_PASS_ACCESSES <= data->accessCount )
+                {
+                    TRACELOG( LOG_WARNING, "GRAPH: [%s] Too many accesses, %s is ignored", data->name,
+                              graph->resources[resource].name );
+                    return;
+                }
+
+            entry           = &data->accesses[data->accessCount++];
+            entry->resource = resource;
+            entry->stages   = 0;
+            entry->access   = 0;
+            entry->layout   = layout;
+            entry->write    = false;
+        }
+    else if( entry->layout != layout )
+        {
+            // One image, two layouts in the same pass: only GENERAL satisfies both
+            entry->layout = VK_IMAGE_LAYOUT_GENERAL;
+        }
+
+    entry->stages |= info->stages;
+    entry->access |= write ? info->write : info->read;
+    entry->write = entry->write || write;
+
+    GraphResourceData * target = &graph->resources[resource];
+    if( GRAPH_RESOURCE_TEXTURE == target->type ) target->texture.usage |= info->imageUsage;
+    else target->buffer.usage |= info->bufferUsage;
+}
+
+// Keep only the passes contributing to a side effect or an imported resource
+static void
+CullPasses( RenderGraph * graph )
+{
+    for( uint32_t i = 0; i < graph->resourceCount; ++i ) graph->resources[i].needed = false;
+
+    uint32_t culled = 0;
+    for( uint32_t p = graph->passCount; 0 < p--; )
+        {
+            GraphPass * pass = &graph->passes[p];
+
+            pass->alive = pass->sideEffect;
+            for( uint32_t a = 0; a < pass->accessCount && !pass->alive; ++a )
+                {
+                    const GraphPassAccess *   access   = &pass->accesses[a];
+                    const GraphResourceData * resource = &graph->resources[access->resource];
+                    if( access->write && ( resource->imported || resource->needed ) ) pass->alive = true;
+                }
+
+            if( !pass->alive )
+                {
+                    ++culled;
+                    continue;
+                }
+
+            for( uint32_t a = 0; a < pass->accessCount; ++a )
+                {
+                    // Writes included: a partial write keeps the previous contents alive
+                    graph->resources[pass->accesses[a].resource].needed = true;
+                }
+        }
+
+    // Lifetimes over the kept passes
+    for( uint32_t i = 0; i < graph->resourceCount; ++i )
+        {
+            GraphResourceData * resource = &graph->resources[i];
+            resource->first              = UINT32_MAX;
+            resource->last               = 0;
+            resource->usedStages         = 0;
+            resource->usedWrites         = 0;
+        }
+
+    for( uint32_t p = 0; p < graph->passCount; ++p )
+        {
+            const GraphPass * pass = &graph->passes[p];
+            if( !pass->alive ) continue;
+
+            for( uint32_t a = 0; a < pass->accessCount; ++a )
+                {
+                    GraphResourceData * resource = &graph->resources[pass->accesses[a].resource];
+                    if( UINT32_MAX == resource->first ) resource->first = p;
+                    resource->last = p;
+                }
+        }
+
+    if( 0 < culled ) TRACELOGD( "GRAPH: %u of %u passes culled", culled, graph->passCount );
+}
+
+// Bind the transients to physical resources, recreated only when the declaration changed
+static bool
+RealizeTransients( RenderGraph * graph )
+{
+    GraphSignature signatures[GRAPH_MAX_RESOURCES];
+    uint32_t       order[GRAPH_MAX_RESOURCES];
+    uint32_t       count = 0;
+
+    for( uint32_t i = 0; i < graph->resourceCount; ++i )
+        {
+            const GraphResourceData * resource = &graph->resources[i];
+            if( resource->imported || UINT32_MAX == resource->first ) continue;
+
+            GraphSignature * signature = &signatures[count];
+            memset( signature, 0, sizeof( GraphSignature ) );
+            signature->type  = resource->type;
+            signature->first = resource->first;
+            signature->last  = resource->last;
+            // Field by field, the signatures are compared with their padding
+            if( GRAPH_RESOURCE_TEXTURE == resource->type )
+                {
+                    signature->texture.width  = resource->texture.width;
+                    signature->texture.height = resource->texture.height;
+                    signature->texture.format = resource->texture.format;
+                    signature->texture.usage  = resource->texture.usage;
+                }
+            else
+                {
+                    signature->buffer.size  = resource->buffer.size;
+                    signature->buffer.usage = resource->buffer.usage;
+                }
+
+            order[count++] = i;
+        }
+
+    const size_t signatureSize = count * sizeof( GraphSignature );
+    const bool   cached        = ( count == graph->physicalCount )
+                        && ( 0 == count || 0 == memcmp( signatures, graph->signatures, signatureSize ) );
+    if( !cached )
+        {
+            RetirePhysical( graph );
+            memcpy( graph->signatures, signatures, signatureSize );
+            if( !CreatePhysical( graph, count, order ) )
+                {
+                    RetirePhysical( graph );
+                    return false;
+                }
+        }
+
+    for( uint32_t k = 0; k < count; ++k )
+        {
+            GraphResourceData *   resource = &graph->resources[order[k]];
+            const GraphPhysical * physical = &graph->physical[k];
+            resource->physical             = k;
+            resource->image                = physical->image;
+            resource->view                 = physical->view;
+            resource->handle               = physical->buffer;
+
+            // Contents are undefined on first use
+            memset( &resource->state, 0, sizeof( GraphState ) );
+            resource->state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        }
+
+    return true;
+}
+
+// Create the physical transients and place them into one allocation, where their lifetimes allow it
+static bool
+CreatePhysical( RenderGraph * graph, uint32_t count, const uint32_t * order )
+{
+    const VkDevice device = vGetDevice();
+
+    VkMemoryRequirements requirements[GRAPH_MAX_RESOURCES];
+    uint32_t             typeBits  = UINT32_MAX;
+    VkDeviceSize         alignment = 1;
+
+    // Images and buffers sharing the allocation must not share a granularity page either
+    const VkDeviceSize granularity = vGetDeviceProperties()->limits.bufferImageGranularity;
+    if( granularity > alignment ) alignment = granularity;
+
+    for( uint32_t k = 0; k < count; ++k )
+        {
+            const GraphResourceData * resource = &graph->resources[order[k]];
+            GraphPhysical *           physical = &graph->physical[k];
+            VkResult                  result;
+
+            // Counted once cleared, a failure below retires only what was created
+            memset( physical, 0, sizeof( GraphPhysical ) );
+            graph->physicalCount = k + 1;
+            physical->first      = resource->first;
+            physical->last       = resource->last;
+
+            if( GRAPH_RESOURCE_TEXTURE == resource->type )
+                {
+                    VkImageCreateInfo imageInfo = { 0 };
+                    imageInfo.sType             = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+                    imageInfo.flags             = VK_IMAGE_CREATE_ALIAS_BIT;
+                    imageInfo.imageType         = VK_IMAGE_TYPE_2D;
+                    imageInfo.format            = resource->texture.format;
+                    imageInfo.extent.width      = resource->texture.width;
+                    imageInfo.extent.height     = resource->texture.height;
+                    imageInfo.extent.depth      = 1;
+                    imageInfo.mipLevels         = 1;
+                    imageInfo.arrayLayers       = 1;
+                    imageInfo.samples           = VK_SAMPLE_COUNT_1_BIT;
+                    imageInfo.tiling            = VK_IMAGE_TILING_OPTIMAL;
+                    imageInfo.usage             = resource->texture.usage;
+                    imageInfo.sharingMode       = VK_SHARING_MODE_EXCLUSIVE;
+                    imageInfo.initialLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+
+                    result = vkCreateImage( device, &imageInfo, NULL, &physical->image );
+                    if( VK_SUCCESS == result )
+                        {
+                            vkGetImageMemoryRequirements( device, physical->image, &requirements[k] );
+                        }
+                }
+            else
+                {
+                    VkBufferCreateInfo bufferInfo = { 0 };
+                    bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+                    bufferInfo.size               = resource->buffer.size;
+                    bufferInfo.usage              = resource->buffer.usage;
+                    bufferInfo.sharingMode        = VK_SHARING_MODE_EXCLUSIVE;
+
+                    result = vkCreateBuffer( device, &bufferInfo, NULL, &physical->buffer );
+                    if( VK_SUCCESS == result )
+                        {
+                            vkGetBufferMemoryRequirements( device, physical->buffer, &requirements[k] );
+                        }
+                }
+
+            if( VK_SUCCESS != result )
+                {
+                    TRACELOG( LOG_ERROR, "GRAPH: [%s] Failed to create transient (%d)", resource->name, (int)result );
+                    return false;
+                }
+
+            typeBits &= requirements[k].memoryTypeBits;
+            if( requirements[k].alignment > alignment ) alignment = requirements[k].alignment;
+        }
+
+    // Largest first, each at the lowest offset free during its lifetime
+    uint32_t sorted[GRAPH_MAX_RESOURCES];
+    for( uint32_t k = 0; k < count; ++k )
+        {
+            uint32_t j = k;
+            while( 0 < j && requirements[sorted[j - 1]].size < requirements[k].size )
+                {
+                    sorted[j] = sorted[j - 1];
+                    --j;
+                }
+            sorted[j] = k;
+        }
+
+    VkDeviceSize heapSize = 0;
+    VkDeviceSize naive    = 0;
+    if( 0 != typeBits )
+        {
+            for( uint32_t s = 0; s < count; ++s )
+                {
+                    GraphPhysical *    physical = &graph->physical[sorted[s]];
+                    const VkDeviceSize size     = requirements[sorted[s]].size;
+                    VkDeviceSize       offset   = 0;
+
+                    // Move past every placed transient that overlaps in time and address, until none does
+                    for( bool moved = true; moved; )
+                        {
+                            moved = false;
+                            for( uint32_t t = 0; t < s; ++t )
+                                {
+                                    const GraphPhysical * other = &graph->physical[sorted[t]];
+                                    if( other->last < physical->first || physical->last < other->first ) continue;
+                                    if( other->offset + other->size <= offset || offset + size <= other->offset )
+                                        {
+                                            continue;
+                                        }
+
+                                    offset = ( other->offset + other->size + alignment - 1 ) & ~( alignment - 1 );
+                                    moved  = true;
+                                }
+                        }
+
+                    physical->offset = offset;
+                    physical->size   = size;
+                    physical->shared = true;
+                    if( offset + size > heapSize ) heapSize = offset + size;
+                    naive += ( size + alignment - 1 ) & ~( alignment - 1 );
+                }
+
+            VkMemoryRequirements heapRequirements = { 0 };
+            heapRequirements.size                 = heapSize;
+            heapRequirements.alignment            = alignment;
+            heapRequirements.memoryTypeBits       = typeBits;
+
+            if( 0 < heapSize && !vAllocateMemory( &heapRequirements, VVUL_MEMORY_GPU_ONLY, true, &graph->heap ) )
+                {
+                    TRACELOG( LOG_ERROR, "GRAPH: Failed to allocate %llu bytes of transient memory",
+                              (unsigned long long)heapSize );
+                    return false;
+                }
+        }
+    else
+        {
+            TRACELOG( LOG_DEBUG, "GRAPH: Transients share no memory type, aliasing disabled" );
+        }
+
+    // Bind, then create the views
+    for( uint32_t k = 0; k < count; ++k )
+        {
+            const GraphResourceData * resource = &graph->resources[order[k]];
+            GraphPhysical *           physical = &graph->physical[k];
+            VkDeviceMemory            memory   = graph->heap.memory;
+            VkDeviceSize              offset   = graph->heap.offset + physical->offset;
+            VkResult                  result   = VK_SUCCESS;
+
+            if( !physical->shared )
+                {
+                    if( !vAllocateMemory( &requirements[k], VVUL_MEMORY_GPU_ONLY,
+                                          GRAPH_RESOURCE_TEXTURE == resource->type, &physical->memory ) )
+                        {
+                            return false;
+                        }
+                    memory = physical->memory.memory;
+                    offset = physical->memory.offset;
+                }
+
+            if( GRAPH_RESOURCE_TEXTURE == resource->type )
+                {
+                    result = vkBindImageMemory( device, physical->image, memory, offset );
+
+                    if( VK_SUCCESS == result )
+                        {
+                            VkImageViewCreateInfo viewInfo       = { 0 };
+                            viewInfo.sType                       = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+                            viewInfo.image                       = physical->image;
+                            viewInfo.viewType                    = VK_IMAGE_VIEW_TYPE_2D;
+                            viewInfo.format                      = resource->texture.format;
+                            viewInfo.subresourceRange.aspectMask = resource->aspect;
+                            viewInfo.subresourceRange.levelCount = 1;
+                            viewInfo.subresourceRange.layerCount = 1;
+
+                            result = vkCreateImageView( device, &viewInfo, NULL, &physical->view );
+                        }
+                }
+            else
+                {
+                    result = vkBindBufferMemory( device, physical->buffer, memory, offset );
+                }
+
+            if( VK_SUCCESS != result )
+                {
+                    TRACELOG( LOG_ERROR, "GRAPH: [%s] Failed to bind transient (%d)", resource->name, (int)result );
+                    return false;
+                }
+        }
+
+    // New memory, nothing to wait on: the retired one is released after the frames using it completed
+    graph->heapStages = 0;
+    graph->heapWrites = 0;
+
+    TRACELOG( LOG_DEBUG, "GRAPH: %u transients placed in %llu KiB (%llu KiB without aliasing)", count,
+              (unsigned long long)( heapSize / 1024 ), (unsigned long long)( naive / 1024 ) );
+
+    return true;
+}
+
+// Release the physical transients once the frames in flight completed
+static void
+RetirePhysical( RenderGraph * graph )
+{
+    for( uint32_t k = 0; k < graph->physicalCount; ++k )
+        {
+            GraphPhysical * physical = &graph->physical[k];
+
+            if( VK_NULL_HANDLE != physical->view ) vDeferDestroy( VVUL_GARBAGE_IMAGE_VIEW, &physical->view );
+            if( VK_NULL_HANDLE != physical->image ) vDeferDestroy( VVUL_GARBAGE_IMAGE, &physical->image );
+            if( VK_NULL_HANDLE != physical->buffer ) vDeferDestroy( VVUL_GARBAGE_BUFFER, &physical->buffer );
+            if( VK_NULL_HANDLE != physical->memory.memory ) vDeferDestroy( VVUL_GARBAGE_ALLOCATION, &physical->memory );
+        }
+
+    if( VK_NULL_HANDLE != graph->heap.memory ) vDeferDestroy( VVUL_GARBAGE_ALLOCATION, &graph->heap );
+
+    // No stale handle is left behind to be retired twice
+    memset( graph->physical, 0, graph->physicalCount * sizeof( GraphPhysical ) );
+    memset( &graph->heap, 0, sizeof( vvulAllocation ) );
+    graph->physicalCount = 0;
+}
+
+// Add the barrier an access needs, if any, and update the state of the resource
+static void
+SyncAccess( RenderGraph * graph, GraphResourceData * resource, const GraphPassAccess * access,
+            GraphBarriers * barriers )
+{
+    GraphState *         state     = &resource->state;
+    const bool           isTexture = ( GRAPH_RESOURCE_TEXTURE == resource->type );
+    const VkImageLayout  layout    = isTexture ? access->layout : VK_IMAGE_LAYOUT_UNDEFINED;
+    VkPipelineStageFlags srcStages = 0;
+    VkAccessFlags        srcAccess = 0;
+    bool                 needed    = false;
+
+    // First use of a transient: wait on whoever used its memory before, in this execution or the previous one
+    if( !resource->imported && 0 == resource->usedStages )
+        {
+            srcStages = graph->heapStages;
+            srcAccess = graph->heapWrites;
+            for( uint32_t i = 0; i < graph->resourceCount; ++i )
+                {
+                    const GraphResourceData * other = &graph->resources[i];
+                    if( other->imported || UINT32_MAX == other->first || other->last >= resource->first ) continue;
+
+                    const GraphPhysical * a = &graph->physical[other->physical];
+                    const GraphPhysical * b = &graph->physical[resource->physical];
+                    if( !a->shared || !b->shared ) continue;
+                    if( a->offset + a->size <= b->offset || b->offset + b->size <= a->offset ) continue;
+
+                    srcStages |= other->usedStages;
+                    srcAccess |= other->usedWrites;
+                }
+            needed = ( 0 != srcStages ) || isTexture;
+        }
+    // First use of an imported resource: its previous use is unknown
+    else if( resource->imported && 0 == resource->usedStages )
+        {
+            srcStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            srcAccess = VK_ACCESS_MEMORY_WRITE_BIT;
+            needed    = true;
+        }
+    else if( isTexture && layout != state->layout )
+        {
+            srcStages = state->writeStages | state->readStages;
+            srcAccess = state->writeAccess;
+            needed    = true;
+        }
+    else if( access->write )
+        {
+            // Write after write and write after read
+            srcStages = state->writeStages | state->readStages;
+            srcAccess = state->writeAccess;
+            needed    = ( 0 != srcStages );
+        }
+    else if( 0 != state->writeStages )
+        {
+            // Read after write, once per stage and access
+            const bool visible = ( access->stages == ( access->stages & state->visibleStages ) )
+                                 && ( access->access == ( access->access & state->visibleAccess ) );
+            srcStages = state->writeStages;
+            srcAccess = state->writeAccess;
+            needed    = !visible;
+        }
+
+    if( needed )
+        {
+            if( isTexture )
+                {
+                    VkImageMemoryBarrier2 * barrier       = &barriers->images[barriers->imageCount++];
+                    memset( barrier, 0, sizeof( VkImageMemoryBarrier2 ) );
+                    barrier->sType                        = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+                    barrier->srcStageMask                 = srcStages;
+                    barrier->srcAccessMask                = srcAccess;
+                    barrier->dstStageMask                 = access->stages;
+                    barrier->dstAccessMask                = access->access;
+                    barrier->oldLayout                    = ( 0 == resource->usedStages && !resource->imported )
+                                                                ? VK_IMAGE_LAYOUT_UNDEFINED
+                                                                : state->layout;
+                    barrier->newLayout                    = layout;
+                    barrier->srcQueueFamilyIndex          = VK_QUEUE_FAMILY_IGNORED;
+                    barrier->dstQueueFamilyIndex          = VK_QUEUE_FAMILY_IGNORED;
+                    barrier->image                        = resource->image;
+                    barrier->subresourceRange.aspectMask  = resource->aspect;
+                    barrier->subresourceRange.levelCount  = VK_REMAINING_MIP_LEVELS;
+                    barrier->subresourceRange.layerCount  = VK_REMAINING_ARRAY_LAYERS;
+                }
+            else
+                {
+                    VkBufferMemoryBarrier2 * barrier = &barriers->buffers[barriers->bufferCount++];
+                    memset( barrier, 0, sizeof( VkBufferMemoryBarrier2 ) );
+                    barrier->sType                   = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+                    barrier->srcStageMask            = srcStages;
+                    barrier->srcAccessMask           = srcAccess;
+                    barrier->dstStageMask            = access->stages;
+                    barrier->dstAccessMask           = access->access;
+                    barrier->srcQueueFamilyIndex     = VK_QUEUE_FAMILY_IGNORED;
+                    barrier->dstQueueFamilyIndex     = VK_QUEUE_FAMILY_IGNORED;
+                    barrier->buffer                  = resource->handle;
+                    barrier->size                    = VK_WHOLE_SIZE;
+                }
+        }
+
+    // A layout transition is a write the destination stages already waited on
+    if( access->write || ( isTexture && layout != state->layout ) || 0 == resource->usedStages )
+        {
+            state->writeStages   = access->stages;
+            state->writeAccess   = access->access & GRAPH_WRITE_ACCESS;
+            state->visibleStages = access->write ? 0 : access->stages;
+            state->visibleAccess = access->write ? 0 : access->access;
+            state->readStages    = access->write ? 0 : access->stages;
+        }
+    else
+        {
+            if( needed )
+                {
+                    state->visibleStages |= access->stages;
+                    state->visibleAccess |= access->access;
+                }
+            state->readStages |= access->stages;
+        }
+
+    state->layout = layout;
+    resource->usedStages |= access->stages;
+    resource->usedWrites |= access->access & GRAPH_WRITE_ACCESS;
+}
+
+// Record the collected barriers as one dependency
+static void
+FlushBarriers( VkCommandBuffer cmd, GraphBarriers * barriers )
+{
+    if( 0 == barriers->imageCount && 0 == barriers->bufferCount ) return;
+
+    if( vGetDeviceFeatures()->synchronization2 )
+        {
+            VkDependencyInfo dependency         = { 0 };
+            dependency.sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+            dependency.imageMemoryBarrierCount  = barriers->imageCount;
+            dependency.pImageMemoryBarriers     = barriers->images;
+            dependency.bufferMemoryBarrierCount = barriers->bufferCount;
+            dependency.pBufferMemoryBarriers    = barriers->buffers;
+
+            vkCmdPipelineBarrier2( cmd, &dependency );
+        }
+    else
+        {
+            // Legacy barriers share their stage masks, the union of the batch
+            VkImageMemoryBarrier  images[GRAPH_MAX_PASS_ACCESSES];
+            VkBufferMemoryBarrier buffers[GRAPH_MAX_PASS_ACCESSES];
+            VkPipelineStageFlags  srcStages = 0;
+            VkPipelineStageFlags  dstStages = 0;
+
+            for( uint32_t i = 0; i < barriers->imageCount; ++i )
+                {
+                    const VkImageMemoryBarrier2 * source = &barriers->images[i];
+                    VkImageMemoryBarrier *        target = &images[i];
+                    memset( target, 0, sizeof( VkImageMemoryBarrier ) );
+                    target->sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                    target->srcAccessMask       = (VkAccessFlags)source->srcAccessMask;
+                    target->dstAccessMask       = (VkAccessFlags)source->dstAccessMask;
+                    target->oldLayout           = source->oldLayout;
+                    target->newLayout           = source->newLayout;
+                    target->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    target->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    target->image               = source->image;
+                    target->subresourceRange    = source->subresourceRange;
+                    srcStages |= (VkPipelineStageFlags)source->srcStageMask;
+                    dstStages |= (VkPipelineStageFlags)source->dstStageMask;
+                }
+
+            for( uint32_t i = 0; i < barriers->bufferCount; ++i )
+                {
+                    const VkBufferMemoryBarrier2 * source = &barriers->buffers[i];
+                    VkBufferMemoryBarrier *        target = &buffers[i];
+                    memset( target, 0, sizeof( VkBufferMemoryBarrier ) );
+                    target->sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                    target->srcAccessMask       = (VkAccessFlags)source->srcAccessMask;
+                    target->dstAccessMask       = (VkAccessFlags)source->dstAccessMask;
+                    target->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    target->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    target->buffer              = source->buffer;
+                    target->size                = VK_WHOLE_SIZE;
+                    srcStages |= (VkPipelineStageFlags)source->srcStageMask;
+                    dstStages |= (VkPipelineStageFlags)source->dstStageMask;
+                }
+
+            if( 0 == srcStages ) srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+
+            vkCmdPipelineBarrier( cmd, srcStages, dstStages, 0, 0, NULL, barriers->bufferCount, buffers,
+                                  barriers->imageCount, images );
+        }
+
+    barriers->imageCount  = 0;
+    barriers->bufferCount = 0;
+}
+
+// Get the aspects a view of the format covers
+static VkImageAspectFlags
+FormatAspect( VkFormat format )
+{
+    switch( format )
+        {
+        case VK_FORMAT_D16_UNORM:
+        case VK_FORMAT_X8_D24_UNORM_PACK32:
+        case VK_FORMAT_D32_SFLOAT:          return VK_IMAGE_ASPECT_DEPTH_BIT;
+        case VK_FORMAT_S8_UINT:             return VK_IMAGE_ASPECT_STENCIL_BIT;
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:  return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        default:                            return VK_IMAGE_ASPECT_COLOR_BIT;
+        }
+}
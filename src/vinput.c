@@ -48,7 +48,10 @@ extern CoreContext core;
 INLINE bool
 IsAnyKeyPressed( void )
 {
-    return ( 0 < core.input.keyboard.pressedKeyCount );
+    uint64_t pressed = 0;
+    for( int i = 0; i < KEY_STATE_WORDS; ++i ) pressed |= core.input.keyboard.pressedKeys[i];
+
+    return ( 0 != pressed );
 }
 
 // Check if the given key is been pressed
@@ -57,7 +60,7 @@ IsKeyPressed( const int key )
 {
     if( UNLIKELY( KEY_NULL >= key || KEYBOARD_KEY_COUNT <= key ) ) return false;
 
-    return ( !core.input.keyboard.prevKeyState[key] && core.input.keyboard.currKeyState[key] );
+    return KEY_BIT_GET( core.input.keyboard.pressedKeys, key );
 }
 
 // Check if the given key is repeated across frames
@@ -66,7 +69,7 @@ IsKeyPressedRepeated( const int key )
 {
     if( UNLIKELY( KEY_NULL >= key || KEYBOARD_KEY_COUNT <= key ) ) return false;
 
-    return (bool)( core.input.keyboard.keyRepeats[key] );
+    return KEY_BIT_GET( core.input.keyboard.keyRepeats, key );
 }
 
 // Check if the given key is being pressed
@@ -75,7 +78,7 @@ IsKeyDown( const int key )
 {
     if( UNLIKELY( KEY_NULL >= key || KEYBOARD_KEY_COUNT <= key ) ) return false;
 
-    return (bool)( core.input.keyboard.currKeyState[key] );
+    return KEY_BIT_GET( core.input.keyboard.currKeyState, key );
 }
 
 // Check if the given key has been released once
@@ -84,7 +87,7 @@ IsKeyReleased( const int key )
 {
     if( UNLIKELY( KEY_NULL >= key || KEYBOARD_KEY_COUNT <= key ) ) return false;
 
-    return ( core.input.keyboard.prevKeyState[key] && !core.input.keyboard.currKeyState[key] );
+    return KEY_BIT_GET( core.input.keyboard.releasedKeys, key );
 }
 
 // Check if the key is NOT being pressed
@@ -93,5 +96,22 @@ IsKeyUp( const int key )
 {
     if( UNLIKELY( KEY_NULL >= key || KEYBOARD_KEY_COUNT <= key ) ) return false;
 
-    return !core.input.keyboard.currKeyState[key];
+    return !KEY_BIT_GET( core.input.keyboard.currKeyState, key );
+}
+
+// Drain the queued key transitions into events, oldest first, returns how many were copied.
+// Transitions that do not fit stay queued for the next call
+int
+GetKeyEvents( KeyEvent * events, int capacity )
+{
+    int count = 0;
+
+    while( count < capacity && 0 < core.input.keyboard.eventCount )
+        {
+            events[count++]               = core.input.keyboard.events[core.input.keyboard.eventHead];
+            core.input.keyboard.eventHead = ( core.input.keyboard.eventHead + 1 ) & ( KEY_EVENT_QUEUE_SIZE - 1 );
+            --core.input.keyboard.eventCount;
+        }
+
+    return count;
 }
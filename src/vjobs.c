@@ -0,0 +1,403 @@
+/******************************** VJOBS **********************************
+ * vjobs: Worker thread pool for data parallel jobs
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - Workers are started once by InitWindow() (one per logical core, minus the main thread) and
+ *   sleep on a condition variable between jobs, so an idle pool costs nothing.
+ * - ParallelFor() hands out indices through an atomic counter; the calling thread takes indices
+ *   too, so a job always completes even without workers. Jobs started from inside a job, or
+ *   while another thread runs one, execute inline on the calling thread.
+ * - GetWorkerIndex() identifies the calling thread, so per-thread resources (command pools, ...)
+ *   can be indexed without locking.
+ * - SubmitJob() queues a single background job (file decoding, ...) that the first idle worker
+ *   picks up; data parallel jobs take precedence over the queue. Without workers, or with a
+ *   full queue, the job runs on the calling thread.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#if !defined( _WIN32 ) && !defined( _DEFAULT_SOURCE )
+#    define _DEFAULT_SOURCE // sysconf( _SC_NPROCESSORS_ONLN )
+#endif
+
+#include "vultra/vultra.h"
+#include "vultra/vutils.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined( _WIN32 )
+#    include <process.h> /* _beginthreadex */
+// Declared manually to avoid pulling <windows.h> and its symbol clashes (CloseWindow, ...)
+typedef struct JobsLock
+{
+    void * ptr;
+} JobsLock; // SRWLOCK
+typedef struct JobsCondition
+{
+    void * ptr;
+} JobsCondition; // CONDITION_VARIABLE
+__declspec( dllimport ) void __stdcall AcquireSRWLockExclusive( JobsLock * lock );
+__declspec( dllimport ) void __stdcall ReleaseSRWLockExclusive( JobsLock * lock );
+__declspec( dllimport ) int __stdcall SleepConditionVariableSRW( JobsCondition * condition, JobsLock * lock,
+                                                                 unsigned long milliseconds, unsigned long flags );
+__declspec( dllimport ) void __stdcall WakeConditionVariable( JobsCondition * condition );
+__declspec( dllimport ) void __stdcall WakeAllConditionVariable( JobsCondition * condition );
+__declspec( dllimport ) unsigned long __stdcall WaitForSingleObject( void * handle, unsigned long milliseconds );
+__declspec( dllimport ) int __stdcall CloseHandle( void * handle );
+__declspec( dllimport ) unsigned long __stdcall GetActiveProcessorCount( unsigned short group );
+#    define JOBS_INFINITE       0xFFFFFFFFUL
+#    define JOBS_ALL_GROUPS     0xFFFF
+#    define JOBS_LOCK( l )      AcquireSRWLockExclusive( l )
+#    define JOBS_UNLOCK( l )    ReleaseSRWLockExclusive( l )
+#    define JOBS_WAIT( c, l )   SleepConditionVariableSRW( ( c ), ( l ), JOBS_INFINITE, 0 )
+#    define JOBS_SIGNAL( c )    WakeConditionVariable( c )
+#    define JOBS_BROADCAST( c ) WakeAllConditionVariable( c )
+typedef void * JobsThread;
+#else
+#    include <pthread.h>
+#    include <unistd.h> /* sysconf */
+typedef pthread_mutex_t JobsLock;
+typedef pthread_cond_t  JobsCondition;
+typedef pthread_t       JobsThread;
+#    define JOBS_LOCK( l )      pthread_mutex_lock( l )
+#    define JOBS_UNLOCK( l )    pthread_mutex_unlock( l )
+#    define JOBS_WAIT( c, l )   pthread_cond_wait( ( c ), ( l ) )
+#    define JOBS_SIGNAL( c )    pthread_cond_signal( c )
+#    define JOBS_BROADCAST( c ) pthread_cond_broadcast( c )
+#endif
+
+#ifndef JOBS_MAX_WORKERS
+#    define JOBS_MAX_WORKERS 63 // Worker threads, the main thread is not counted
+#endif
+#ifndef JOBS_MAX_TASKS
+#    define JOBS_MAX_TASKS 1024 // Background jobs queued at once
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Job being executed, indices are claimed by every participating thread
+typedef struct Job
+{
+    JobCallback callback;
+    void *      user;
+    long        count;
+    long        next;     // Next unclaimed index (atomic)
+    long        finished; // Indices completed, guarded by the pool lock
+} Job;
+
+// Background job, run once by a single worker
+typedef struct Task
+{
+    JobCallback callback;
+    void *      user;
+    int         index;
+} Task;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Variables Definition
+//----------------------------------------------------------------------------------------------------------------------
+static struct
+{
+    JobsThread    threads[JOBS_MAX_WORKERS];
+    int           workerCount;
+    JobsLock      lock;
+    JobsCondition wake;       // Signaled when a job is posted or the pool shuts down
+    JobsCondition done;       // Signaled when the posted job completed and no worker references it
+    Job *         job;        // Posted job, NULL while the pool is idle
+    int           active;     // Workers holding a reference to the posted job
+    uint64_t      generation; // Incremented for every posted job, so workers never run a job twice
+    bool          running;
+
+    Task          tasks[JOBS_MAX_TASKS]; // Background jobs, FIFO ring guarded by the pool lock
+    uint32_t      taskHead;
+    uint32_t      taskCount;
+    int           taskActive; // Background jobs being executed
+    JobsCondition idle;       // Signaled when the last background job completed
+} pool = { 0 };
+
+static THREAD_LOCAL bool insideJob   = false; // Is the calling thread executing a job index?
+static THREAD_LOCAL int  workerIndex = 0;     // 0 on the main (or any foreign) thread, 1..workerCount on workers
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Declaration
+//----------------------------------------------------------------------------------------------------------------------
+void InitJobs( void );  // Start the worker threads
+void CloseJobs( void ); // Stop and join the worker threads
+
+static long RunJob( Job * job );
+#if defined( _WIN32 )
+static unsigned __stdcall WorkerMain( void * argument );
+#else
+static void * WorkerMain( void * argument );
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Jobs
+//----------------------------------------------------------------------------------------------------------------------
+// Get the number of threads jobs are spread across, the calling thread included
+int
+GetWorkerCount( void )
+{
+    return pool.workerCount + 1;
+}
+
+// Get the index of the calling thread in [0, GetWorkerCount()), stable for the lifetime of the pool
+int
+GetWorkerIndex( void )
+{
+    return workerIndex;
+}
+
+// Call callback for every index in [0, count) across the worker threads, returns once all of them completed
+void
+ParallelFor( int count, JobCallback callback, void * user )
+{
+    if( 0 >= count ) return;
+
+    Job job      = { 0 };
+    job.callback = callback;
+    job.user     = user;
+    job.count    = count;
+
+    // Nested jobs, single indices and busy pools run inline, a worker must never wait on its own pool
+    bool posted = false;
+    if( 1 < count && 0 < pool.workerCount && !insideJob )
+        {
+            JOBS_LOCK( &pool.lock );
+            if( NULL == pool.job )
+                {
+                    pool.job = &job;
+                    ++pool.generation;
+                    posted = true;
+                    JOBS_BROADCAST( &pool.wake );
+                }
+            JOBS_UNLOCK( &pool.lock );
+        }
+
+    if( !posted )
+        {
+            const bool nested = insideJob;
+            insideJob         = true;
+            for( int i = 0; i < count; ++i ) callback( user, i );
+            insideJob = nested;
+            return;
+        }
+
+    const long completed = RunJob( &job );
+
+    // Workers still holding the job must let go of it before it leaves this stack frame
+    JOBS_LOCK( &pool.lock );
+    job.finished += completed;
+    while( job.finished < job.count || 0 < pool.active ) JOBS_WAIT( &pool.done, &pool.lock );
+    pool.job = NULL;
+    JOBS_UNLOCK( &pool.lock );
+}
+
+// Queue callback( user, index ) for a single idle worker, returns immediately (see WaitJobs())
+void
+SubmitJob( JobCallback callback, void * user, int index )
+{
+    bool queued = false;
+
+    if( 0 < pool.workerCount )
+        {
+            JOBS_LOCK( &pool.lock );
+            if( JOBS_MAX_TASKS > pool.taskCount )
+                {
+                    Task * task     = &pool.tasks[( pool.taskHead + pool.taskCount ) % JOBS_MAX_TASKS];
+                    task->callback  = callback;
+                    task->user      = user;
+                    task->index     = index;
+                    ++pool.taskCount;
+                    queued = true;
+                    JOBS_SIGNAL( &pool.wake );
+                }
+            JOBS_UNLOCK( &pool.lock );
+        }
+
+    if( !queued )
+        {
+            const bool nested = insideJob;
+            insideJob         = true;
+            callback( user, index );
+            insideJob = nested;
+        }
+}
+
+// Block until every submitted job completed, never call it from a job
+void
+WaitJobs( void )
+{
+    JOBS_LOCK( &pool.lock );
+    while( 0 < pool.taskCount || 0 < pool.taskActive ) JOBS_WAIT( &pool.idle, &pool.lock );
+    JOBS_UNLOCK( &pool.lock );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Core
+//----------------------------------------------------------------------------------------------------------------------
+void
+InitJobs( void )
+{
+#if defined( _WIN32 )
+    long cores = (long)GetActiveProcessorCount( JOBS_ALL_GROUPS );
+#else
+    long cores = sysconf( _SC_NPROCESSORS_ONLN );
+    pthread_mutex_init( &pool.lock, NULL );
+    pthread_cond_init( &pool.wake, NULL );
+    pthread_cond_init( &pool.done, NULL );
+    pthread_cond_init( &pool.idle, NULL );
+#endif
+
+    int workers = ( 1 < cores ) ? (int)( cores - 1 ) : 0;
+    if( JOBS_MAX_WORKERS < workers ) workers = JOBS_MAX_WORKERS;
+
+    pool.running = true;
+    for( int i = 0; i < workers; ++i )
+        {
+#if defined( _WIN32 )
+            pool.threads[i]
+                = (JobsThread)_beginthreadex( NULL, 0, WorkerMain, (void *)( intptr_t )( i + 1 ), 0, NULL );
+            if( NULL == pool.threads[i] ) break;
+#else
+            if( 0 != pthread_create( &pool.threads[i], NULL, WorkerMain, (void *)( intptr_t )( i + 1 ) ) ) break;
+#endif
+            ++pool.workerCount;
+        }
+
+    TRACELOG( LOG_INFO, "JOBS: %d worker threads started", pool.workerCount );
+}
+
+void
+CloseJobs( void )
+{
+    JOBS_LOCK( &pool.lock );
+    pool.running = false;
+    JOBS_BROADCAST( &pool.wake );
+    JOBS_UNLOCK( &pool.lock );
+
+    for( int i = 0; i < pool.workerCount; ++i )
+        {
+#if defined( _WIN32 )
+            WaitForSingleObject( pool.threads[i], JOBS_INFINITE );
+            CloseHandle( pool.threads[i] );
+#else
+            pthread_join( pool.threads[i], NULL );
+#endif
+        }
+
+    pool.workerCount = 0;
+
+#if !defined( _WIN32 )
+    pthread_cond_destroy( &pool.idle );
+    pthread_cond_destroy( &pool.done );
+    pthread_cond_destroy( &pool.wake );
+    pthread_mutex_destroy( &pool.lock );
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Claim and execute indices until none is left, returns how many this thread completed
+static long
+RunJob( Job * job )
+{
+    long completed = 0;
+
+    insideJob = true;
+    for( long index = ATOMIC_FETCH_ADD( &job->next, 1 ); index < job->count; index = ATOMIC_FETCH_ADD( &job->next, 1 ) )
+        {
+            job->callback( job->user, (int)index );
+            ++completed;
+        }
+    insideJob = false;
+
+    return completed;
+}
+
+// Worker loop: sleep until a new job is posted or queued, help with it, repeat
+#if defined( _WIN32 )
+static unsigned __stdcall WorkerMain( void * argument )
+#else
+static void *
+WorkerMain( void * argument )
+#endif
+{
+    uint64_t seen = 0;
+
+    workerIndex = (int)(intptr_t)argument;
+
+    JOBS_LOCK( &pool.lock );
+    for( ;; )
+        {
+            while( pool.running && ( NULL == pool.job || seen == pool.generation ) && 0 == pool.taskCount )
+                {
+                    JOBS_WAIT( &pool.wake, &pool.lock );
+                }
+            if( !pool.running ) break;
+
+            // Background jobs only run while no data parallel job is waiting for help
+            if( NULL == pool.job || seen == pool.generation )
+                {
+                    const Task task = pool.tasks[pool.taskHead];
+                    pool.taskHead   = ( pool.taskHead + 1 ) % JOBS_MAX_TASKS;
+                    --pool.taskCount;
+                    ++pool.taskActive;
+                    JOBS_UNLOCK( &pool.lock );
+
+                    insideJob = true;
+                    task.callback( task.user, task.index );
+                    insideJob = false;
+
+                    JOBS_LOCK( &pool.lock );
+                    --pool.taskActive;
+                    if( 0 == pool.taskCount && 0 == pool.taskActive ) JOBS_BROADCAST( &pool.idle );
+                    continue;
+                }
+
+            Job * job = pool.job;
+            seen      = pool.generation;
+            ++pool.active;
+            JOBS_UNLOCK( &pool.lock );
+
+            const long completed = RunJob( job );
+
+            JOBS_LOCK( &pool.lock );
+            job->finished += completed;
+            --pool.active;
+            if( 0 == pool.active && job->finished == job->count ) JOBS_SIGNAL( &pool.done );
+        }
+    JOBS_UNLOCK( &pool.lock );
+
+    // Scratch arenas are per thread, release the one this worker may have used
+    UnloadScratchArena();
+
+#if defined( _WIN32 )
+    return 0;
+#else
+    return NULL;
+#endif
+}
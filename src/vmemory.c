@@ -0,0 +1,322 @@
+/******************************* VMEMORY *********************************
+ * vmemory: Linear arenas for transient allocations
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - Arenas reserve their whole capacity as virtual memory up front, physical pages are only
+ *   committed when first touched, so generous capacities cost nothing until they are used.
+ * - The frame arena is reset by EndDrawing(), scratch arenas are thread-local and rewound by
+ *   their users with ArenaMark()/ArenaRewind().
+ * - FLAG_MEMORY_HUGE_PAGES backs arenas with transparent huge pages (Linux, madvise), reducing
+ *   TLB misses when large transient buffers are walked every frame.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#if !defined( _WIN32 ) && !defined( _DEFAULT_SOURCE )
+#    define _DEFAULT_SOURCE // MAP_ANONYMOUS, madvise()
+#endif
+
+#include "vultra/vultra.h"
+#include "vultra/vutils.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined( _WIN32 )
+// Declared manually to avoid pulling <windows.h> and its symbol clashes (CloseWindow, ...)
+__declspec( dllimport ) void * __stdcall VirtualAlloc( void * address, size_t size, unsigned long type,
+                                                       unsigned long protect );
+__declspec( dllimport ) int __stdcall VirtualFree( void * address, size_t size, unsigned long type );
+#    define ARENA_MEM_COMMIT      0x00001000UL
+#    define ARENA_MEM_RESERVE     0x00002000UL
+#    define ARENA_MEM_RELEASE     0x00008000UL
+#    define ARENA_PAGE_READWRITE  0x04UL
+#    define ARENA_COMMIT_GRANULE  ( (size_t)64 << 10 ) // Commit in allocation granularity steps
+#elif defined( __unix__ ) || defined( __APPLE__ )
+#    include <sys/mman.h> /* mmap, munmap, madvise */
+#    define ARENA_VIRTUAL_MEMORY
+#endif
+
+#ifndef FRAME_ARENA_SIZE
+#    define FRAME_ARENA_SIZE ( (size_t)64 << 20 ) // Reserved size of the frame arena
+#endif
+
+#ifndef SCRATCH_ARENA_SIZE
+#    define SCRATCH_ARENA_SIZE ( (size_t)16 << 20 ) // Reserved size of every thread scratch arena
+#endif
+
+#define ARENA_ALIGNMENT ( (size_t)16 )      // Alignment of every arena allocation
+#define HUGE_PAGE_SIZE  ( (size_t)2 << 20 ) // Transparent huge page size on x86-64 and most arm64 kernels
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Arena header, stored at the start of its own reservation
+struct Arena
+{
+    unsigned char * base;      // First allocatable byte
+    size_t          capacity;  // Allocatable bytes after the header
+    size_t          offset;    // Bytes in use
+    size_t          peak;      // Highest offset since the arena was loaded
+    size_t          committed; // Bytes backed by physical memory (Windows only)
+    size_t          reserved;  // Size of the whole reservation, header included
+    void *          mapping;   // Start of the reservation as returned by the OS
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// Variables Definition
+//----------------------------------------------------------------------------------------------------------------------
+static Arena *              frameArena   = NULL;  // Reset by EndDrawing()
+static bool                 hugePages    = false; // Back new arenas with transparent huge pages
+static THREAD_LOCAL Arena * scratchArena = NULL;  // Lazily loaded per thread
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Declaration
+//----------------------------------------------------------------------------------------------------------------------
+void InitMemory( bool useHugePages ); // Load the frame arena
+void CloseMemory( void );             // Unload the frame arena and the calling thread scratch arena
+void ResetFrameMemory( void );        // Release every frame allocation
+
+static void * ReserveMemory( size_t size, void ** mapping, size_t * reserved );
+static void   ReleaseMemory( void * mapping, size_t reserved );
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Arenas
+//----------------------------------------------------------------------------------------------------------------------
+// Reserve a linear allocator, pages are committed on first use
+Arena *
+LoadArena( size_t capacity )
+{
+    const size_t headerSize = ( sizeof( Arena ) + ARENA_ALIGNMENT - 1 ) & ~( ARENA_ALIGNMENT - 1 );
+    void *       mapping    = NULL;
+    size_t       reserved   = 0;
+
+    unsigned char * memory = (unsigned char *)ReserveMemory( headerSize + capacity, &mapping, &reserved );
+    if( NULL == memory )
+        {
+            TRACELOG( LOG_ERROR, "MEMORY: Failed to reserve arena of %zu bytes", capacity );
+            return NULL;
+        }
+
+    Arena * arena    = (Arena *)memory;
+    arena->base      = memory + headerSize;
+    arena->capacity  = capacity;
+    arena->offset    = 0;
+    arena->peak      = 0;
+    arena->committed = headerSize;
+    arena->reserved  = reserved;
+    arena->mapping   = mapping;
+
+    return arena;
+}
+
+// Release an arena and every allocation made from it
+void
+UnloadArena( Arena * arena )
+{
+    if( NULL == arena ) return;
+
+    ReleaseMemory( arena->mapping, arena->reserved );
+}
+
+// Allocate from an arena, 16 byte aligned, NULL when the arena is exhausted
+void *
+ArenaAlloc( Arena * arena, size_t size )
+{
+    const size_t offset = arena->offset;
+    const size_t end    = offset + ( ( size + ARENA_ALIGNMENT - 1 ) & ~( ARENA_ALIGNMENT - 1 ) );
+
+    if( UNLIKELY( end > arena->capacity || end < offset ) )
+        {
+            TRACELOG( LOG_ERROR, "MEMORY: Arena exhausted (%zu of %zu bytes used, %zu requested)", offset,
+                      arena->capacity, size );
+            return NULL;
+        }
+
+#if defined( _WIN32 )
+    // Reserved pages must be committed explicitly before they can be touched
+    const size_t used = (size_t)( arena->base - (unsigned char *)arena ) + end;
+    if( UNLIKELY( used > arena->committed ) )
+        {
+            size_t commit = ( used + ARENA_COMMIT_GRANULE - 1 ) & ~( ARENA_COMMIT_GRANULE - 1 );
+            if( commit > arena->reserved ) commit = arena->reserved;
+
+            if( NULL == VirtualAlloc( arena, commit, ARENA_MEM_COMMIT, ARENA_PAGE_READWRITE ) )
+                {
+                    TRACELOG( LOG_ERROR, "MEMORY: Failed to commit %zu arena bytes", commit );
+                    return NULL;
+                }
+            arena->committed = commit;
+        }
+#endif
+
+    arena->offset = end;
+    if( end > arena->peak ) arena->peak = end;
+
+    return arena->base + offset;
+}
+
+// Get the current arena position, to be restored later with ArenaRewind()
+size_t
+ArenaMark( const Arena * arena )
+{
+    return arena->offset;
+}
+
+// Release every allocation made after the given mark
+void
+ArenaRewind( Arena * arena, size_t mark )
+{
+    if( mark < arena->offset ) arena->offset = mark;
+}
+
+// Get the highest number of bytes an arena had in use
+size_t
+GetArenaPeakUsage( const Arena * arena )
+{
+    return arena->peak;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Frame and scratch arenas
+//----------------------------------------------------------------------------------------------------------------------
+// Allocate memory valid until the end of the current frame, released in bulk by EndDrawing()
+void *
+MemFrameAlloc( size_t size )
+{
+    return ( NULL != frameArena ) ? ArenaAlloc( frameArena, size ) : NULL;
+}
+
+// Get the scratch arena of the calling thread, rewind it to a previous mark when done
+Arena *
+GetScratchArena( void )
+{
+    if( UNLIKELY( NULL == scratchArena ) ) scratchArena = LoadArena( SCRATCH_ARENA_SIZE );
+
+    return scratchArena;
+}
+
+// Unload the scratch arena of the calling thread, worker threads call it before exiting
+void
+UnloadScratchArena( void )
+{
+    UnloadArena( scratchArena );
+    scratchArena = NULL;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Core
+//----------------------------------------------------------------------------------------------------------------------
+void
+InitMemory( bool useHugePages )
+{
+    hugePages  = useHugePages;
+    frameArena = LoadArena( FRAME_ARENA_SIZE );
+
+    if( NULL == frameArena ) TRACELOG( LOG_FATAL, "MEMORY: Failed to create frame arena" );
+
+    TRACELOG( LOG_INFO, "MEMORY: Frame arena reserved (%zu MiB%s)", (size_t)( FRAME_ARENA_SIZE >> 20 ),
+              hugePages ? ", huge pages" : "" );
+}
+
+void
+CloseMemory( void )
+{
+    if( NULL != frameArena )
+        {
+            TRACELOG( LOG_INFO, "MEMORY: Frame arena peak usage: %zu bytes", frameArena->peak );
+        }
+
+    UnloadArena( frameArena );
+    frameArena = NULL;
+
+    UnloadScratchArena();
+}
+
+// O(1), frame allocations are never freed individually
+void
+ResetFrameMemory( void )
+{
+    if( NULL != frameArena ) frameArena->offset = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Reserve address space for an arena, the returned pointer is where the arena header lives
+static void *
+ReserveMemory( size_t size, void ** mapping, size_t * reserved )
+{
+#if defined( _WIN32 )
+    *reserved = ( size + ARENA_COMMIT_GRANULE - 1 ) & ~( ARENA_COMMIT_GRANULE - 1 );
+    *mapping  = VirtualAlloc( NULL, *reserved, ARENA_MEM_RESERVE, ARENA_PAGE_READWRITE );
+    if( NULL == *mapping ) return NULL;
+
+    // Only the header is committed up front
+    if( NULL == VirtualAlloc( *mapping, sizeof( Arena ), ARENA_MEM_COMMIT, ARENA_PAGE_READWRITE ) )
+        {
+            VirtualFree( *mapping, 0, ARENA_MEM_RELEASE );
+            return NULL;
+        }
+
+    return *mapping;
+#elif defined( ARENA_VIRTUAL_MEMORY )
+    // Huge pages need a 2MiB aligned range, over-reserve and align inside the mapping
+    const size_t alignment = hugePages ? HUGE_PAGE_SIZE : 1;
+    *reserved              = size + alignment - 1;
+
+    void * memory = mmap( NULL, *reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if( MAP_FAILED == memory ) return NULL;
+    *mapping = memory;
+
+    uintptr_t aligned = ( (uintptr_t)memory + alignment - 1 ) & ~( (uintptr_t)alignment - 1 );
+
+#    if defined( MADV_HUGEPAGE )
+    if( hugePages && 0 != madvise( (void *)aligned, size & ~( HUGE_PAGE_SIZE - 1 ), MADV_HUGEPAGE ) )
+        {
+            TRACELOG( LOG_WARNING, "MEMORY: Transparent huge pages unavailable, using regular pages" );
+        }
+#    endif
+
+    return (void *)aligned;
+#else
+    *reserved = size;
+    *mapping  = VUL_MALLOC( size );
+    return *mapping;
+#endif
+}
+
+// Release an arena reservation
+static void
+ReleaseMemory( void * mapping, size_t reserved )
+{
+#if defined( _WIN32 )
+    UNUSED( reserved );
+    VirtualFree( mapping, 0, ARENA_MEM_RELEASE );
+#elif defined( ARENA_VIRTUAL_MEMORY )
+    munmap( mapping, reserved );
+#else
+    UNUSED( reserved );
+    VUL_FREE( mapping );
+#endif
+}
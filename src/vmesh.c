@@ -0,0 +1,85 @@
+/******************************** VMESH **********************************
+ * vmesh: Cooked meshes, ready for the GPU
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - Parsing only validates and points into the data, the cooked arrays are never copied nor
+ *   converted. Every index is checked against the vertex count once, so a corrupt file cannot
+ *   make the GPU read past the vertex buffer.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#include "vultra/vmesh.h"
+#include "vultra/vultra.h"
+#include "vultra/vutils.h"
+
+#include <string.h> /* memset */
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Check cooked data and point into it, false if invalid
+bool
+ParseCookedMesh( const void * data, uint64_t size, CookedMesh * mesh )
+{
+    const MeshHeader * header = (const MeshHeader *)data;
+
+    if( NULL == mesh ) return false;
+    memset( mesh, 0, sizeof( CookedMesh ) );
+
+    if( NULL == data || 0 != ( (uintptr_t)data & 3 ) || sizeof( MeshHeader ) > size ) return false;
+
+    if( MESH_MAGIC != header->magic || MESH_VERSION != header->version
+        || ( 2 != header->indexSize && 4 != header->indexSize ) || 0 != header->indexCount % 3 )
+        {
+            TRACELOG( LOG_WARNING, "MESH: Invalid cooked mesh header" );
+            return false;
+        }
+
+    const uint64_t vertexBytes = (uint64_t)header->vertexCount * sizeof( MeshVertex );
+    const uint64_t indexBytes  = (uint64_t)header->indexCount * header->indexSize;
+    if( vertexBytes + indexBytes > size - sizeof( MeshHeader ) )
+        {
+            TRACELOG( LOG_WARNING, "MESH: Cooked mesh truncated (%u vertices, %u indices)", header->vertexCount,
+                      header->indexCount );
+            return false;
+        }
+
+    const unsigned char * indices = (const unsigned char *)data + sizeof( MeshHeader ) + vertexBytes;
+    for( uint32_t i = 0; i < header->indexCount; ++i )
+        {
+            const uint32_t index = ( 2 == header->indexSize ) ? ( (const uint16_t *)indices )[i]
+                                                              : ( (const uint32_t *)indices )[i];
+            if( index >= header->vertexCount )
+                {
+                    TRACELOG( LOG_WARNING, "MESH: Cooked mesh index %u out of range", index );
+                    return false;
+                }
+        }
+
+    mesh->header   = header;
+    mesh->vertices = (const MeshVertex *)( (const unsigned char *)data + sizeof( MeshHeader ) );
+    mesh->indices  = indices;
+
+    return true;
+}
@@ -0,0 +1,953 @@
+/******************************** VPACK **********************************
+ * vpack: Memory-mapped asset packs
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - Layout, little endian: PackHeader, the entry blobs, then the index (PackEntry sorted by name
+ *   hash, 8 byte aligned) followed by the NUL terminated names. The index is written last, so
+ *   the writer streams blobs straight to disk and only keeps the index in memory.
+ * - Compressed blobs start with the end offset of every chunk (uint32_t, relative to the chunk
+ *   data, read byte by byte as blobs are not aligned), then the chunks. Every chunk holds
+ *   PACK_CHUNK_SIZE bytes of the entry (the last one less); a chunk that did not shrink is
+ *   stored as is, recognized by its size.
+ * - The chunk codec writes the LZ4 block format (greedy, single hash probe): decoding is a few
+ *   memory copies per sequence, which keeps reading bound by the disk.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#if !defined( _WIN32 ) && !defined( _DEFAULT_SOURCE )
+#    define _DEFAULT_SOURCE // madvise(), sysconf( _SC_PAGESIZE )
+#endif
+
+#include "vultra/vpack.h"
+#include "vultra/vultra.h"
+#include "vultra/vutils.h"
+
+#include <limits.h> /* INT_MAX */
+#include <stddef.h>
+#include <stdio.h>  /* fopen, fwrite */
+#include <stdlib.h> /* qsort */
+#include <string.h> /* memcpy, strcmp */
+
+#if defined( _WIN32 )
+// Declared manually to avoid pulling <windows.h> and its symbol clashes (CloseWindow, ...)
+typedef struct PackMemoryRange
+{
+    void * address;
+    size_t size;
+} PackMemoryRange; // WIN32_MEMORY_RANGE_ENTRY
+__declspec( dllimport ) void * __stdcall CreateFileA( const char * name, unsigned long access, unsigned long share,
+                                                      void * security, unsigned long disposition, unsigned long flags,
+                                                      void * templateFile );
+__declspec( dllimport ) int __stdcall GetFileSizeEx( void * file, long long * size );
+__declspec( dllimport ) void * __stdcall CreateFileMappingA( void * file, void * security, unsigned long protect,
+                                                             unsigned long sizeHigh, unsigned long sizeLow,
+                                                             const char * name );
+__declspec( dllimport ) void * __stdcall MapViewOfFile( void * mapping, unsigned long access, unsigned long offsetHigh,
+                                                        unsigned long offsetLow, size_t size );
+__declspec( dllimport ) int __stdcall UnmapViewOfFile( const void * address );
+__declspec( dllimport ) int __stdcall CloseHandle( void * handle );
+__declspec( dllimport ) void * __stdcall GetCurrentProcess( void );
+__declspec( dllimport ) int __stdcall PrefetchVirtualMemory( void * process, size_t count, PackMemoryRange * ranges,
+                                                             unsigned long flags );
+#    define PACK_INVALID_HANDLE   ( (void *)(intptr_t)-1 )
+#    define PACK_GENERIC_READ     0x80000000UL
+#    define PACK_FILE_SHARE_READ  0x00000001UL
+#    define PACK_OPEN_EXISTING    3UL
+#    define PACK_FILE_ATTRIBUTE   0x00000080UL // FILE_ATTRIBUTE_NORMAL
+#    define PACK_PAGE_READONLY    0x02UL
+#    define PACK_FILE_MAP_READ    0x0004UL
+#    define PACK_PAGE_SIZE        ( (size_t)4096 )
+#elif defined( __unix__ ) || defined( __APPLE__ )
+#    include <fcntl.h>    /* open */
+#    include <sys/mman.h> /* mmap, munmap, madvise */
+#    include <sys/stat.h> /* fstat */
+#    include <unistd.h>   /* close, sysconf */
+#    define PACK_MEMORY_MAP
+#    define PACK_PAGE_SIZE ( (size_t)sysconf( _SC_PAGESIZE ) )
+#endif
+
+#define PACK_MAGIC          0x4B415056U // "VPAK"
+#define PACK_VERSION        1           // Bumped whenever the layout changes
+#define PACK_ALIGNMENT      ( (uint64_t)64 << 10 ) // Blob alignment, small blobs never cross it
+#define PACK_BLOB_ALIGNMENT 16                      // Alignment of the small blobs
+#define PACK_CHUNK_SIZE     ( (uint32_t)64 << 10 ) // Uncompressed bytes per chunk
+#define PACK_MAX_COMPRESSED ( (uint64_t)1 << 31 )  // Larger entries are stored uncompressed
+
+#define PACK_ENTRY_COMPRESSED 0x1U // PackEntry flag
+
+#define LZ4_MIN_MATCH     4  // Shortest match encoded
+#define LZ4_LAST_LITERALS 5  // Bytes at the end of a block always stored as literals
+#define LZ4_MATCH_LIMIT   12 // Matches start at least this far from the end of a block
+#define LZ4_MAX_OFFSET    65535
+#define LZ4_HASH_BITS     14
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// File header, at offset 0
+typedef struct PackHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t chunkSize;   // Uncompressed bytes per chunk of the compressed entries
+    uint64_t indexOffset; // Entries, then names
+    uint64_t namesSize;
+} PackHeader;
+
+// Index entry
+typedef struct PackEntry
+{
+    uint64_t hash;    // FNV-1a of the name
+    uint64_t offset;  // Blob offset in the file
+    uint64_t size;    // Blob size, as stored
+    uint64_t rawSize; // Entry size, uncompressed
+    uint32_t name;    // Offset of the name in the name table
+    uint32_t flags;
+} PackEntry;
+
+struct AssetPack
+{
+    const unsigned char * base; // Whole file
+    uint64_t              size;
+    const PackEntry *     entries;
+    const char *          names;
+    uint32_t              count;
+    uint32_t              chunkSize;
+    bool                  mapped; // Memory mapped, else read into memory
+};
+
+struct AssetPackWriter
+{
+    FILE *          file;
+    char *          fileName;
+    uint64_t        position; // End of the file written so far
+    PackEntry *     entries;
+    uint32_t        count;
+    uint32_t        capacity;
+    char *          names;
+    uint64_t        namesSize;
+    uint64_t        namesCapacity;
+    unsigned char * scratch; // Compressed blob
+    uint64_t        scratchSize;
+    bool            failed;
+};
+
+// Chunks of an entry decompressed in parallel
+typedef struct PackDecode
+{
+    const unsigned char * ends;   // End offset of every chunk in data, little endian uint32_t
+    const unsigned char * data;   // First chunk
+    uint64_t              stored; // Bytes of chunk data
+    unsigned char *       buffer;
+    uint64_t              rawSize;
+    uint32_t              chunkSize;
+    long                  failed;
+} PackDecode;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Declaration
+//----------------------------------------------------------------------------------------------------------------------
+static const PackEntry * GetEntry( const AssetPack * pack, uint32_t entry );
+static bool              ValidatePack( AssetPack * pack );
+static void              AdviseRange( const AssetPack * pack, const PackEntry * entry, bool willNeed );
+static void              DecodeChunk( void * user, int index );
+static bool              WriteBytes( AssetPackWriter * writer, const void * data, uint64_t size );
+static bool              WritePadding( AssetPackWriter * writer, uint64_t offset );
+static uint64_t          PlaceBlob( uint64_t position, uint64_t size );
+static int               CompareEntries( const void * a, const void * b );
+static uint32_t          ReadU32( const unsigned char * data );
+static void              WriteU32( unsigned char * data, uint32_t value );
+static uint64_t          HashName( const char * name );
+static size_t Compress( const unsigned char * source, size_t size, unsigned char * destination, size_t capacity );
+static bool   Decompress( const unsigned char * source, size_t size, unsigned char * destination, size_t capacity );
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Reading
+//----------------------------------------------------------------------------------------------------------------------
+// Map a pack and validate its index, entries are only read when used
+AssetPack *
+OpenAssetPack( const char * fileName )
+{
+    if( !STR_NONEMPTY( fileName ) ) return NULL;
+
+    AssetPack * pack = (AssetPack *)VUL_CALLOC( 1, sizeof( AssetPack ) );
+    if( NULL == pack ) return NULL;
+
+#if defined( _WIN32 )
+    void * file = CreateFileA( fileName, PACK_GENERIC_READ, PACK_FILE_SHARE_READ, NULL, PACK_OPEN_EXISTING,
+                               PACK_FILE_ATTRIBUTE, NULL );
+    if( PACK_INVALID_HANDLE != file )
+        {
+            long long size = 0;
+            if( GetFileSizeEx( file, &size ) && 0 < size )
+                {
+                    // The view keeps the mapping alive, both handles can go
+                    void * mapping = CreateFileMappingA( file, NULL, PACK_PAGE_READONLY, 0, 0, NULL );
+                    if( NULL != mapping )
+                        {
+                            pack->base = (const unsigned char *)MapViewOfFile( mapping, PACK_FILE_MAP_READ, 0, 0, 0 );
+                            pack->size = (uint64_t)size;
+                            CloseHandle( mapping );
+                        }
+                }
+            CloseHandle( file );
+        }
+    pack->mapped = ( NULL != pack->base );
+#elif defined( PACK_MEMORY_MAP )
+    const int file = open( fileName, O_RDONLY );
+    if( 0 <= file )
+        {
+            struct stat info;
+            if( 0 == fstat( file, &info ) && 0 < info.st_size )
+                {
+                    void * memory = mmap( NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0 );
+                    if( MAP_FAILED != memory )
+                        {
+                            pack->base = (const unsigned char *)memory;
+                            pack->size = (uint64_t)info.st_size;
+
+                            // Entries are read in any order, readahead would only pull their neighbors in
+                            madvise( memory, (size_t)info.st_size, MADV_RANDOM );
+                        }
+                }
+            close( file );
+        }
+    pack->mapped = ( NULL != pack->base );
+#else
+    FILE * file = fopen( fileName, "rb" );
+    long   length;
+    if( NULL != file )
+        {
+            if( 0 == fseek( file, 0, SEEK_END ) && 0 < ( length = ftell( file ) ) && 0 == fseek( file, 0, SEEK_SET ) )
+                {
+                    unsigned char * data = (unsigned char *)VUL_MALLOC( (size_t)length );
+                    if( NULL != data && (size_t)length == fread( data, 1, (size_t)length, file ) )
+                        {
+                            pack->base = data;
+                            pack->size = (uint64_t)length;
+                        }
+                    else VUL_FREE( data );
+                }
+            fclose( file );
+        }
+#endif
+
+    if( NULL == pack->base )
+        {
+            TRACELOG( LOG_WARNING, "PACK: [%s] Failed to open asset pack", fileName );
+            VUL_FREE( pack );
+            return NULL;
+        }
+
+    if( !ValidatePack( pack ) )
+        {
+            TRACELOG( LOG_WARNING, "PACK: [%s] Invalid or corrupt asset pack", fileName );
+            CloseAssetPack( pack );
+            return NULL;
+        }
+
+    TRACELOG( LOG_INFO, "PACK: [%s] Asset pack opened (%u entries, %llu KiB%s)", fileName, pack->count,
+              (unsigned long long)( pack->size >> 10 ), pack->mapped ? ", mapped" : "" );
+
+    return pack;
+}
+
+void
+CloseAssetPack( AssetPack * pack )
+{
+    if( NULL == pack ) return;
+
+#if defined( _WIN32 )
+    UnmapViewOfFile( pack->base );
+#elif defined( PACK_MEMORY_MAP )
+    munmap( (void *)pack->base, (size_t)pack->size );
+#else
+    VUL_FREE( (void *)pack->base );
+#endif
+
+    VUL_FREE( pack );
+}
+
+uint32_t
+GetPackEntryCount( const AssetPack * pack )
+{
+    return ( NULL != pack ) ? pack->count : 0;
+}
+
+// Binary search on the name hash, then the names resolve collisions
+uint32_t
+FindPackEntry( const AssetPack * pack, const char * name )
+{
+    if( NULL == pack || NULL == name ) return PACK_ENTRY_NONE;
+
+    const uint64_t hash  = HashName( name );
+    uint32_t       first = 0;
+    uint32_t       count = pack->count;
+
+    while( 0 < count )
+        {
+            const uint32_t half = count / 2;
+            if( pack->entries[first + half].hash < hash )
+                {
+                    first += half + 1;
+                    count -= half + 1;
+                }
+            else count = half;
+        }
+
+    for( uint32_t i = first; i < pack->count && hash == pack->entries[i].hash; ++i )
+        {
+            if( 0 == strcmp( pack->names + pack->entries[i].name, name ) ) return i;
+        }
+
+    return PACK_ENTRY_NONE;
+}
+
+const char *
+GetPackEntryName( const AssetPack * pack, uint32_t entry )
+{
+    const PackEntry * record = GetEntry( pack, entry );
+
+    return ( NULL != record ) ? pack->names + record->name : NULL;
+}
+
+uint64_t
+GetPackEntrySize( const AssetPack * pack, uint32_t entry )
+{
+    const PackEntry * record = GetEntry( pack, entry );
+
+    return ( NULL != record ) ? record->rawSize : 0;
+}
+
+// Entry bytes inside the mapping, valid until CloseAssetPack(), NULL for compressed entries
+const void *
+GetPackEntryData( const AssetPack * pack, uint32_t entry )
+{
+    const PackEntry * record = GetEntry( pack, entry );
+    if( NULL == record || 0 != ( record->flags & PACK_ENTRY_COMPRESSED ) ) return NULL;
+
+    return pack->base + record->offset;
+}
+
+// Copy an entry into buffer, which holds at least GetPackEntrySize() bytes; compressed chunks decode in parallel
+bool
+ReadPackEntry( const AssetPack * pack, uint32_t entry, void * buffer, uint64_t size )
+{
+    const PackEntry * record = GetEntry( pack, entry );
+    if( NULL == record || NULL == buffer || size < record->rawSize ) return false;
+
+    if( 0 == ( record->flags & PACK_ENTRY_COMPRESSED ) )
+        {
+            memcpy( buffer, pack->base + record->offset, (size_t)record->rawSize );
+            return true;
+        }
+
+    // Counts come from the file: every chunk needs its end in the table, and the jobs are indexed by int
+    const uint64_t tail       = ( 0 != record->rawSize % pack->chunkSize ) ? 1 : 0;
+    const uint64_t chunkCount = record->rawSize / pack->chunkSize + tail;
+    if( chunkCount > record->size / sizeof( uint32_t ) || chunkCount > INT_MAX ) return false;
+
+    const uint64_t tableSize = chunkCount * sizeof( uint32_t );
+
+    PackDecode decode = { 0 };
+    decode.ends       = pack->base + record->offset;
+    decode.data       = pack->base + record->offset + tableSize;
+    decode.stored     = record->size - tableSize;
+    decode.buffer     = (unsigned char *)buffer;
+    decode.rawSize    = record->rawSize;
+    decode.chunkSize  = pack->chunkSize;
+
+    ParallelFor( (int)chunkCount, DecodeChunk, &decode );
+
+    return ( 0 == decode.failed );
+}
+
+// Ask the kernel to read an entry in the background (MADV_WILLNEED, PrefetchVirtualMemory)
+void
+PrefetchPackEntry( const AssetPack * pack, uint32_t entry )
+{
+    const PackEntry * record = GetEntry( pack, entry );
+
+    if( NULL != record && pack->mapped ) AdviseRange( pack, record, true );
+}
+
+// Let the kernel drop the pages of an entry, they are read from disk again on the next access
+void
+EvictPackEntry( const AssetPack * pack, uint32_t entry )
+{
+    const PackEntry * record = GetEntry( pack, entry );
+
+    if( NULL != record && pack->mapped ) AdviseRange( pack, record, false );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Writing
+//----------------------------------------------------------------------------------------------------------------------
+// Create a pack file, entries are written as they are added
+AssetPackWriter *
+BeginAssetPack( const char * fileName )
+{
+    if( !STR_NONEMPTY( fileName ) ) return NULL;
+
+    AssetPackWriter * writer = (AssetPackWriter *)VUL_CALLOC( 1, sizeof( AssetPackWriter ) );
+    if( NULL == writer ) return NULL;
+
+    const size_t length = strlen( fileName ) + 1;
+    writer->fileName    = (char *)VUL_MALLOC( length );
+    writer->file        = fopen( fileName, "wb" );
+
+    // The header is rewritten by EndAssetPack(), once the index offset is known
+    const PackHeader header = { 0 };
+    if( NULL == writer->fileName || NULL == writer->file || !WriteBytes( writer, &header, sizeof( header ) ) )
+        {
+            TRACELOG( LOG_WARNING, "PACK: [%s] Failed to create asset pack", fileName );
+            if( NULL != writer->file ) fclose( writer->file );
+            VUL_FREE( writer->fileName );
+            VUL_FREE( writer );
+            return NULL;
+        }
+
+    memcpy( writer->fileName, fileName, length );
+
+    return writer;
+}
+
+// Append an entry, compressed when asked and worth it (every chunk that does not shrink is stored as is)
+bool
+AddPackEntry( AssetPackWriter * writer, const char * name, const void * data, uint64_t size, bool compress )
+{
+    if( NULL == writer || writer->failed ) return false;
+    if( !STR_NONEMPTY( name ) || ( NULL == data && 0 < size ) )
+        {
+            TRACELOG( LOG_WARNING, "PACK: Invalid entry" );
+            writer->failed = true;
+            return false;
+        }
+
+    // Grow the index and the name table
+    const uint64_t nameLength = strlen( name ) + 1;
+    if( writer->count == writer->capacity )
+        {
+            const uint32_t capacity = ( 0 == writer->capacity ) ? 256 : writer->capacity * 2;
+            PackEntry *    entries  = (PackEntry *)VUL_REALLOC( writer->entries, capacity * sizeof( PackEntry ) );
+            if( NULL == entries ) writer->failed = true;
+            else
+                {
+                    writer->entries  = entries;
+                    writer->capacity = capacity;
+                }
+        }
+    if( !writer->failed && writer->namesSize + nameLength > writer->namesCapacity )
+        {
+            uint64_t capacity = ( 0 == writer->namesCapacity ) ? 4096 : writer->namesCapacity;
+            while( writer->namesSize + nameLength > capacity ) capacity *= 2;
+
+            // Name offsets are 32 bits
+            char * names = ( UINT32_MAX >= capacity ) ? (char *)VUL_REALLOC( writer->names, (size_t)capacity ) : NULL;
+            if( NULL == names ) writer->failed = true;
+            else
+                {
+                    writer->names         = names;
+                    writer->namesCapacity = capacity;
+                }
+        }
+
+    const unsigned char * blob       = (const unsigned char *)data;
+    uint64_t              stored     = size;
+    uint32_t              flags      = 0;
+    const uint64_t        chunkCount = ( size + PACK_CHUNK_SIZE - 1 ) / PACK_CHUNK_SIZE;
+
+    if( !writer->failed && compress && 0 < size && PACK_MAX_COMPRESSED > size )
+        {
+            // Chunk table followed by the chunks, never larger than the table plus the raw entry
+            const uint64_t tableSize = chunkCount * sizeof( uint32_t );
+            if( writer->scratchSize < tableSize + size )
+                {
+                    unsigned char * scratch
+                        = (unsigned char *)VUL_REALLOC( writer->scratch, (size_t)( tableSize + size ) );
+                    if( NULL != scratch )
+                        {
+                            writer->scratch     = scratch;
+                            writer->scratchSize = tableSize + size;
+                        }
+                }
+
+            if( writer->scratchSize >= tableSize + size )
+                {
+                    unsigned char * chunks = writer->scratch + tableSize;
+                    uint32_t        end    = 0;
+
+                    for( uint64_t i = 0; i < chunkCount; ++i )
+                        {
+                            const uint64_t        start  = i * PACK_CHUNK_SIZE;
+                            const unsigned char * source = blob + start;
+                            const size_t length = ( PACK_CHUNK_SIZE < size - start ) ? PACK_CHUNK_SIZE
+                                                                                      : (size_t)( size - start );
+
+                            // One byte short of the chunk: anything that does not shrink is stored raw
+                            size_t packed = Compress( source, length, chunks + end, length - 1 );
+                            if( 0 == packed )
+                                {
+                                    memcpy( chunks + end, source, length );
+                                    packed = length;
+                                }
+
+                            end += (uint32_t)packed;
+                            WriteU32( writer->scratch + i * sizeof( uint32_t ), end );
+                        }
+
+                    if( tableSize + end < size )
+                        {
+                            blob   = writer->scratch;
+                            stored = tableSize + end;
+                            flags  = PACK_ENTRY_COMPRESSED;
+                        }
+                }
+        }
+
+    const uint64_t offset = PlaceBlob( writer->position, stored );
+    if( !writer->failed && ( !WritePadding( writer, offset ) || !WriteBytes( writer, blob, stored ) ) )
+        {
+            writer->failed = true;
+        }
+
+    if( writer->failed )
+        {
+            TRACELOG( LOG_WARNING, "PACK: [%s] Failed to write entry %s", writer->fileName, name );
+            return false;
+        }
+
+    PackEntry * entry = &writer->entries[writer->count++];
+    entry->hash       = HashName( name );
+    entry->offset     = offset;
+    entry->size       = stored;
+    entry->rawSize    = size;
+    entry->name       = (uint32_t)writer->namesSize;
+    entry->flags      = flags;
+
+    memcpy( writer->names + writer->namesSize, name, (size_t)nameLength );
+    writer->namesSize += nameLength;
+
+    return true;
+}
+
+// Sort and write the index, then the final header; a failed pack is deleted
+bool
+EndAssetPack( AssetPackWriter * writer )
+{
+    if( NULL == writer ) return false;
+
+    if( 1 < writer->count ) qsort( writer->entries, writer->count, sizeof( PackEntry ), CompareEntries );
+
+    // Equal hashes are adjacent once sorted, only those need a name comparison
+    for( uint32_t i = 1; i < writer->count && !writer->failed; ++i )
+        {
+            const PackEntry * entry = &writer->entries[i];
+            for( uint32_t j = i; 0 < j && writer->entries[j - 1].hash == entry->hash && !writer->failed; --j )
+                {
+                    if( 0 == strcmp( writer->names + writer->entries[j - 1].name, writer->names + entry->name ) )
+                        {
+                            TRACELOG( LOG_WARNING, "PACK: [%s] Duplicate entry %s", writer->fileName,
+                                      writer->names + entry->name );
+                            writer->failed = true;
+                        }
+                }
+        }
+
+    PackHeader header  = { 0 };
+    header.magic       = PACK_MAGIC;
+    header.version     = PACK_VERSION;
+    header.entryCount  = writer->count;
+    header.chunkSize   = PACK_CHUNK_SIZE;
+    header.indexOffset = ( writer->position + 7 ) & ~(uint64_t)7;
+    header.namesSize   = writer->namesSize;
+
+    if( !writer->failed
+        && ( !WritePadding( writer, header.indexOffset )
+             || !WriteBytes( writer, writer->entries, (uint64_t)writer->count * sizeof( PackEntry ) )
+             || !WriteBytes( writer, writer->names, writer->namesSize ) || 0 != fseek( writer->file, 0, SEEK_SET )
+             || 1 != fwrite( &header, sizeof( header ), 1, writer->file ) ) )
+        {
+            writer->failed = true;
+        }
+
+    if( 0 != fclose( writer->file ) ) writer->failed = true;
+
+    const bool success = !writer->failed;
+    if( success )
+        {
+            TRACELOG( LOG_INFO, "PACK: [%s] Asset pack written (%u entries, %llu KiB)", writer->fileName,
+                      writer->count, (unsigned long long)( writer->position >> 10 ) );
+        }
+    else
+        {
+            TRACELOG( LOG_WARNING, "PACK: [%s] Failed to write asset pack", writer->fileName );
+            remove( writer->fileName );
+        }
+
+    VUL_FREE( writer->scratch );
+    VUL_FREE( writer->names );
+    VUL_FREE( writer->entries );
+    VUL_FREE( writer->fileName );
+    VUL_FREE( writer );
+
+    return success;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+static const PackEntry *
+GetEntry( const AssetPack * pack, uint32_t entry )
+{
+    return ( NULL != pack && entry < pack->count ) ? &pack->entries[entry] : NULL;
+}
+
+// Check the header and every index entry once, so the accessors only bound check the entry index
+static bool
+ValidatePack( AssetPack * pack )
+{
+    PackHeader header;
+
+    if( sizeof( header ) > pack->size ) return false;
+    memcpy( &header, pack->base, sizeof( header ) );
+
+    if( PACK_MAGIC != header.magic || PACK_VERSION != header.version || 0 == header.chunkSize ) return false;
+    if( 0 != ( header.indexOffset & 7 ) || header.indexOffset > pack->size ) return false;
+
+    const uint64_t indexSize = (uint64_t)header.entryCount * sizeof( PackEntry );
+    if( indexSize > pack->size - header.indexOffset ) return false;
+    if( header.namesSize > pack->size - header.indexOffset - indexSize ) return false;
+
+    pack->entries   = (const PackEntry *)( pack->base + header.indexOffset );
+    pack->names     = (const char *)( pack->base + header.indexOffset + indexSize );
+    pack->count     = header.entryCount;
+    pack->chunkSize = header.chunkSize;
+
+    if( 0 < header.namesSize && '\0' != pack->names[header.namesSize - 1] ) return false;
+
+    for( uint32_t i = 0; i < pack->count; ++i )
+        {
+            const PackEntry * entry = &pack->entries[i];
+
+            if( entry->name >= header.namesSize || entry->offset > header.indexOffset ) return false;
+            if( entry->size > header.indexOffset - entry->offset ) return false;
+            if( 0 == ( entry->flags & PACK_ENTRY_COMPRESSED ) && entry->size != entry->rawSize ) return false;
+            if( 0 < i && entry->hash < pack->entries[i - 1].hash ) return false;
+        }
+
+    return true;
+}
+
+// Pass the pages of an entry to the kernel, rounded out to whole pages
+static void
+AdviseRange( const AssetPack * pack, const PackEntry * entry, bool willNeed )
+{
+    if( 0 == entry->size ) return;
+
+    const uintptr_t page  = (uintptr_t)PACK_PAGE_SIZE;
+    const uintptr_t start = (uintptr_t)( pack->base + entry->offset ) & ~( page - 1 );
+    const uintptr_t end   = (uintptr_t)( pack->base + entry->offset + entry->size );
+
+#if defined( _WIN32 )
+    // No counterpart to MADV_DONTNEED for file views, the memory manager trims them under pressure
+    if( willNeed )
+        {
+            PackMemoryRange range = { (void *)start, (size_t)( end - start ) };
+            PrefetchVirtualMemory( GetCurrentProcess(), 1, &range, 0 );
+        }
+#elif defined( PACK_MEMORY_MAP )
+    madvise( (void *)start, (size_t)( end - start ), willNeed ? MADV_WILLNEED : MADV_DONTNEED );
+#else
+    UNUSED( start );
+    UNUSED( end );
+    UNUSED( willNeed );
+#endif
+}
+
+// Decompress one chunk of an entry, on any worker
+static void
+DecodeChunk( void * user, int index )
+{
+    PackDecode *   decode = (PackDecode *)user;
+    const uint64_t offset = (uint64_t)index * decode->chunkSize;
+    const uint64_t length = ( decode->rawSize - offset < decode->chunkSize ) ? decode->rawSize - offset
+                                                                             : decode->chunkSize;
+    const uint32_t begin  = ( 0 < index ) ? ReadU32( decode->ends + ( index - 1 ) * sizeof( uint32_t ) ) : 0;
+    const uint32_t end    = ReadU32( decode->ends + index * sizeof( uint32_t ) );
+
+    if( 0 != ATOMIC_LOAD( &decode->failed ) ) return;
+
+    bool valid = ( begin <= end && end <= decode->stored );
+    if( valid && end - begin == length ) memcpy( decode->buffer + offset, decode->data + begin, (size_t)length );
+    else if( valid ) valid = Decompress( decode->data + begin, end - begin, decode->buffer + offset, (size_t)length );
+
+    if( !valid ) ATOMIC_STORE( &decode->failed, 1 );
+}
+
+static bool
+WriteBytes( AssetPackWriter * writer, const void * data, uint64_t size )
+{
+    if( 0 < size && 1 != fwrite( data, (size_t)size, 1, writer->file ) ) return false;
+
+    writer->position += size;
+
+    return true;
+}
+
+// Zero fill the file up to offset
+static bool
+WritePadding( AssetPackWriter * writer, uint64_t offset )
+{
+    static const unsigned char zeros[4096] = { 0 };
+
+    while( writer->position < offset )
+        {
+            const uint64_t remaining = offset - writer->position;
+            const uint64_t size      = ( remaining < sizeof( zeros ) ) ? remaining : sizeof( zeros );
+            if( !WriteBytes( writer, zeros, size ) ) return false;
+        }
+
+    return true;
+}
+
+// Offset of a blob: large blobs on PACK_ALIGNMENT, small ones packed without crossing it
+static uint64_t
+PlaceBlob( uint64_t position, uint64_t size )
+{
+    if( PACK_ALIGNMENT <= size ) return ( position + PACK_ALIGNMENT - 1 ) & ~( PACK_ALIGNMENT - 1 );
+
+    uint64_t offset = ( position + PACK_BLOB_ALIGNMENT - 1 ) & ~(uint64_t)( PACK_BLOB_ALIGNMENT - 1 );
+    if( 0 < size && offset / PACK_ALIGNMENT != ( offset + size - 1 ) / PACK_ALIGNMENT )
+        {
+            offset = ( offset + PACK_ALIGNMENT - 1 ) & ~( PACK_ALIGNMENT - 1 );
+        }
+
+    return offset;
+}
+
+static int
+CompareEntries( const void * a, const void * b )
+{
+    const uint64_t hashA = ( (const PackEntry *)a )->hash;
+    const uint64_t hashB = ( (const PackEntry *)b )->hash;
+
+    return ( hashA < hashB ) ? -1 : ( hashA > hashB ) ? 1 : 0;
+}
+
+// Little endian, any alignment
+static uint32_t
+ReadU32( const unsigned char * data )
+{
+    return (uint32_t)data[0] | ( (uint32_t)data[1] << 8 ) | ( (uint32_t)data[2] << 16 ) | ( (uint32_t)data[3] << 24 );
+}
+
+static void
+WriteU32( unsigned char * data, uint32_t value )
+{
+    data[0] = (unsigned char)value;
+    data[1] = (unsigned char)( value >> 8 );
+    data[2] = (unsigned char)( value >> 16 );
+    data[3] = (unsigned char)( value >> 24 );
+}
+
+// FNV-1a, 64 bits
+static uint64_t
+HashName( const char * name )
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for( const unsigned char * c = (const unsigned char *)name; '\0' != *c; ++c )
+        {
+            hash ^= *c;
+            hash *= 1099511628211ULL;
+        }
+
+    return hash;
+}
+
+// Encode an LZ4 block, 0 when the result does not fit in capacity
+static size_t
+Compress( const unsigned char * source, size_t size, unsigned char * destination, size_t capacity )
+{
+    uint32_t              table[1 << LZ4_HASH_BITS] = { 0 }; // Last position of every 4 byte hash
+    const unsigned char * ip                        = source;
+    const unsigned char * anchor                    = source; // First literal not emitted
+    const unsigned char * end                       = source + size;
+    unsigned char *       op                        = destination;
+    unsigned char *       oend                      = destination + capacity;
+
+    if( LZ4_MATCH_LIMIT < size )
+        {
+            const unsigned char * matchLimit = end - LZ4_MATCH_LIMIT;
+
+            while( ip < matchLimit )
+                {
+                    uint32_t sequence;
+                    memcpy( &sequence, ip, sizeof( sequence ) );
+
+                    const uint32_t        hash  = ( sequence * 2654435761U ) >> ( 32 - LZ4_HASH_BITS );
+                    const unsigned char * match = source + table[hash];
+                    table[hash]                 = (uint32_t)( ip - source );
+
+                    uint32_t candidate;
+                    memcpy( &candidate, match, sizeof( candidate ) );
+                    if( match >= ip || LZ4_MAX_OFFSET < ip - match || candidate != sequence )
+                        {
+                            ++ip;
+                            continue;
+                        }
+
+                    // Extend the match, the last literals stay out of it
+                    const unsigned char * matchEnd = ip + LZ4_MIN_MATCH;
+                    const unsigned char * ref      = match + LZ4_MIN_MATCH;
+                    while( matchEnd < end - LZ4_LAST_LITERALS && *matchEnd == *ref )
+                        {
+                            ++matchEnd;
+                            ++ref;
+                        }
+
+                    const size_t literals    = (size_t)( ip - anchor );
+                    const size_t matchLength = (size_t)( matchEnd - ip ) - LZ4_MIN_MATCH;
+
+                    // Token, literal length bytes, literals, offset, match length bytes
+                    const size_t worst = 1 + literals / 255 + 1 + literals + 2 + matchLength / 255 + 1;
+                    if( (size_t)( oend - op ) < worst ) return 0;
+
+                    unsigned char * token = op++;
+                    *token                = 0;
+
+                    if( 15 <= literals )
+                        {
+                            *token = 15 << 4;
+                            size_t rest;
+                            for( rest = literals - 15; 255 <= rest; rest -= 255 ) *op++ = 255;
+                            *op++ = (unsigned char)rest;
+                        }
+                    else *token = (unsigned char)( literals << 4 );
+
+                    memcpy( op, anchor, literals );
+                    op += literals;
+
+                    const uint32_t offset = (uint32_t)( ip - match );
+                    *op++                 = (unsigned char)( offset & 0xFF );
+                    *op++                 = (unsigned char)( offset >> 8 );
+
+                    if( 15 <= matchLength )
+                        {
+                            *token |= 15;
+                            size_t rest;
+                            for( rest = matchLength - 15; 255 <= rest; rest -= 255 ) *op++ = 255;
+                            *op++ = (unsigned char)rest;
+                        }
+                    else *token |= (unsigned char)matchLength;
+
+                    ip     = matchEnd;
+                    anchor = ip;
+                }
+        }
+
+    // Last literals, a sequence without a match
+    const size_t literals = (size_t)( end - anchor );
+    if( (size_t)( oend - op ) < 1 + literals / 255 + 1 + literals ) return 0;
+
+    if( 15 <= literals )
+        {
+            *op++ = 15 << 4;
+            size_t rest;
+            for( rest = literals - 15; 255 <= rest; rest -= 255 ) *op++ = 255;
+            *op++ = (unsigned char)rest;
+        }
+    else *op++ = (unsigned char)( literals << 4 );
+
+    memcpy( op, anchor, literals );
+    op += literals;
+
+    return (size_t)( op - destination );
+}
+
+// Decode an LZ4 block that must expand to exactly capacity bytes, every read and write is bound checked
+static bool
+Decompress( const unsigned char * source, size_t size, unsigned char * destination, size_t capacity )
+{
+    const unsigned char * ip   = source;
+    const unsigned char * iend = source + size;
+    unsigned char *       op   = destination;
+    unsigned char *       oend = destination + capacity;
+
+    while( ip < iend )
+        {
+            const unsigned char token    = *ip++;
+            size_t              literals = token >> 4;
+
+            if( 15 == literals )
+                {
+                    unsigned char byte;
+                    do
+                        {
+                            if( ip >= iend ) return false;
+                            byte = *ip++;
+                            literals += byte;
+                        }
+                    while( 255 == byte );
+                }
+
+            if( literals > (size_t)( iend - ip ) || literals > (size_t)( oend - op ) ) return false;
+            memcpy( op, ip, literals );
+            ip += literals;
+            op += literals;
+
+            // The last sequence has no match
+            if( ip == iend ) break;
+
+            if( 2 > iend - ip ) return false;
+            const size_t offset = (size_t)ip[0] | ( (size_t)ip[1] << 8 );
+            ip += 2;
+            if( 0 == offset || offset > (size_t)( op - destination ) ) return false;
+
+            size_t length = token & 15;
+            if( 15 == length )
+                {
+                    unsigned char byte;
+                    do
+                        {
+                            if( ip >= iend ) return false;
+                            byte = *ip++;
+                            length += byte;
+                        }
+                    while( 255 == byte );
+                }
+            length += LZ4_MIN_MATCH;
+
+            if( length > (size_t)( oend - op ) ) return false;
+
+            // Byte by byte: the match may overlap the bytes it produces
+            const unsigned char * match = op - offset;
+            for( size_t i = 0; i < length; ++i ) op[i] = match[i];
+            op += length;
+        }
+
+    return op == oend;
+}
@@ -0,0 +1,728 @@
+/******************************* VPROFILE ********************************
+ * vprofile: CPU and GPU profiling zones and trace capture
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - BeginGpuZone()/EndGpuZone() write a timestamp into the query pool of the frame in flight,
+ *   around the commands recorded in between into the frame command buffer. The 2D batch is
+ *   recorded by EndDrawing(), it is measured by its own "Draw 2D" zone.
+ * - Results are read back when the frame slot comes around again, after BeginDrawing() waited
+ *   on its fence, so the readback never stalls: GetGpuZones() describes the frame submitted
+ *   GetFramesInFlight() frames ago. Zone 0 always spans the whole frame.
+ * - CPU zones, counters and frame marks (PROFILE_* macros, see vutils.h) are stamped with the
+ *   cycle counter (RDTSC, CNTVCT on ARM64) and appended to a buffer owned by the calling thread,
+ *   a single-producer ring drained by the main thread once per frame: no lock, no syscall. They
+ *   are only recorded during a trace capture, otherwise a zone costs one load. Buffers are kept
+ *   for the process lifetime, meant for long-lived threads (main thread, job workers).
+ * - BeginTraceCapture() streams every event to a Chrome trace / Perfetto JSON file (open it in
+ *   ui.perfetto.dev or chrome://tracing). Start it before InitWindow() to capture initialization.
+ *   GPU time is anchored on the CPU time the first captured frame was submitted at, so it only
+ *   lines up approximately with CPU events.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#if !defined( _WIN32 ) && !defined( _DEFAULT_SOURCE )
+#    define _DEFAULT_SOURCE // clock_gettime
+#endif
+
+#include "vultra/vultra.h"
+#include "vultra/vutils.h"
+
+#include "vultra/vvul.h"
+
+#include <stdint.h>
+#include <stdio.h> /* FILE, fopen, fprintf */
+
+#if defined( _WIN32 )
+__declspec( dllimport ) int __stdcall QueryPerformanceCounter( int64_t * count );
+__declspec( dllimport ) int __stdcall QueryPerformanceFrequency( int64_t * frequency );
+#else
+#    include <time.h> /* clock_gettime */
+#endif
+
+#if !defined( _MSC_VER ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#    include <x86intrin.h> /* __rdtsc, <intrin.h> comes with vutils.h on MSVC */
+#endif
+
+#ifndef GPU_PROFILER_MAX_ZONES
+#    define GPU_PROFILER_MAX_ZONES 256 // Zones per frame, the frame zone included
+#endif
+#ifndef GPU_PROFILER_MAX_DEPTH
+#    define GPU_PROFILER_MAX_DEPTH 32 // Nesting depth of open zones
+#endif
+
+#ifndef PROFILE_THREAD_EVENTS
+#    define PROFILE_THREAD_EVENTS 16384 // CPU events buffered per thread between two frames (power of two)
+#endif
+#ifndef PROFILE_MAX_THREADS
+#    define PROFILE_MAX_THREADS 128 // Threads recording CPU events, including the main thread
+#endif
+
+#define GPU_PROFILER_NO_ZONE UINT32_MAX // Open zone that did not fit in the query pool
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Zones recorded into a frame in flight, zone i owns queries 2i (begin) and 2i + 1 (end)
+typedef struct GpuFrame
+{
+    VkQueryPool  pool;
+    const char * names[GPU_PROFILER_MAX_ZONES];
+    uint8_t      depths[GPU_PROFILER_MAX_ZONES];
+    uint32_t     count;
+    uint64_t     submitted; // CPU tick the frame was submitted at
+    bool         pending;   // Submitted, results not read back yet
+} GpuFrame;
+
+// CPU event kinds
+typedef enum
+{
+    PROFILE_EVENT_ZONE_BEGIN = 0,
+    PROFILE_EVENT_ZONE_END,
+    PROFILE_EVENT_COUNTER,
+    PROFILE_EVENT_FRAME
+} ProfileEventType;
+
+// CPU event, stamped with the cycle counter
+typedef struct ProfileEvent
+{
+    uint64_t         tick;
+    const char *     name;
+    double           value; // Counter value
+    ProfileEventType type;
+} ProfileEvent;
+
+// Events of one thread, written by the thread and drained by the main thread
+typedef struct ProfileThread
+{
+    ProfileEvent events[PROFILE_THREAD_EVENTS];
+    long         head;    // Next event written (atomic, written by the owner only)
+    long         tail;    // Next event drained (atomic, written by the drain only)
+    long         capture; // Capture the open zones below belong to, owner only
+    uint32_t     depth;   // Zones opened and recorded during the capture, owner only
+    uint32_t     skipped; // Zones opened while the buffer was full, their end is dropped too, owner only
+    long         named;   // Last capture the thread name was written to (drain only)
+    int          id;      // Trace thread id, the GPU is 0
+    char         name[32];
+} ProfileThread;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Variables Definition
+//----------------------------------------------------------------------------------------------------------------------
+static struct
+{
+    GpuFrame frames[VVUL_MAX_FRAMES_IN_FLIGHT];
+    uint32_t frameCount;
+    uint32_t slot;      // Frame being recorded
+    bool     supported; // Does the graphics queue write timestamps?
+    bool     recording; // Is a frame being recorded?
+    double   period;    // Nanoseconds per tick
+    uint64_t mask;      // Valid timestamp bits
+
+    uint32_t stack[GPU_PROFILER_MAX_DEPTH]; // Open zones
+    uint32_t depth;
+    uint32_t overflow; // Open zones nested deeper than the stack, ignored
+
+    GpuZone zones[GPU_PROFILER_MAX_ZONES]; // Last frame read back
+    int     zoneCount;
+
+    struct
+    {
+        FILE *   file;
+        long     capture;   // Capture number, odd while capturing (atomic)
+        uint64_t start;     // CPU tick the capture began at
+        double   frequency; // CPU ticks per second
+        uint64_t gpuBase;   // First GPU tick captured, anchored on gpuTime
+        double   gpuTime;   // Microseconds into the capture the first GPU frame was submitted at
+        bool     gpuAnchored;
+    } trace;
+
+    ProfileThread * threads[PROFILE_MAX_THREADS]; // Published once registered, never released
+    long            threadCount;                  // Slots claimed (atomic)
+} profiler = { 0 };
+
+static THREAD_LOCAL ProfileThread * threadEvents = NULL; // Event buffer of the calling thread
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Declaration
+//----------------------------------------------------------------------------------------------------------------------
+void InitProfiler( void );       // Create the query pools of the frames in flight
+void CloseProfiler( void );      // Destroy the query pools, ends a trace capture
+void BeginProfilerFrame( void ); // Read back the frame slot results, open the frame zone
+void EndProfilerFrame( void );   // Close the zones left open and the frame zone
+void FlushProfiler( void );      // Write the CPU events recorded since the last flush into the trace
+
+static void            RecordEvent( ProfileEventType type, const char * name, double value );
+static ProfileThread * RegisterThread( void );
+static uint64_t        ProfileTicks( void );
+static double          ProfileClock( void );
+static double          CalibrateTicks( void );
+static double          TicksToTrace( uint64_t tick );
+static void            ResolveFrame( GpuFrame * frame );
+static void            WriteTraceName( const char * name );
+static void WriteTraceEvent( const char * name, const char * category, int thread, double start, double duration );
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: GPU zones
+//----------------------------------------------------------------------------------------------------------------------
+// Open a zone, name must stay valid until the zone is read back (string literals)
+void
+BeginGpuZone( const char * name )
+{
+    if( !profiler.recording ) return;
+
+    if( GPU_PROFILER_MAX_DEPTH <= profiler.depth )
+        {
+            ++profiler.overflow;
+            return;
+        }
+
+    GpuFrame * frame = &profiler.frames[profiler.slot];
+    uint32_t   zone  = GPU_PROFILER_NO_ZONE;
+
+    if( GPU_PROFILER_MAX_ZONES > frame->count )
+        {
+            zone                = frame->count++;
+            frame->names[zone]  = name;
+            frame->depths[zone] = (uint8_t)profiler.depth;
+            vkCmdWriteTimestamp( vGetFrameCommandBuffer(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame->pool, 2 * zone );
+        }
+
+    profiler.stack[profiler.depth++] = zone;
+}
+
+// Close the innermost open zone
+void
+EndGpuZone( void )
+{
+    if( !profiler.recording || 0 == profiler.depth ) return;
+
+    if( 0 < profiler.overflow )
+        {
+            --profiler.overflow;
+            return;
+        }
+
+    const uint32_t zone = profiler.stack[--profiler.depth];
+    if( GPU_PROFILER_NO_ZONE == zone ) return;
+
+    vkCmdWriteTimestamp( vGetFrameCommandBuffer(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         profiler.frames[profiler.slot].pool, 2 * zone + 1 );
+}
+
+// Get the zones of the last frame read back, in the order they were opened, returns how many were written
+int
+GetGpuZones( GpuZone * zones, int capacity )
+{
+    const int count = ( capacity < profiler.zoneCount ) ? capacity : profiler.zoneCount;
+    for( int i = 0; i < count; ++i ) zones[i] = profiler.zones[i];
+
+    return count;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: CPU zones
+//----------------------------------------------------------------------------------------------------------------------
+// Open a zone on the calling thread, name must stay valid until the capture ends (string literals)
+void
+ProfileZoneBegin( const char * name )
+{
+    RecordEvent( PROFILE_EVENT_ZONE_BEGIN, name, 0.0 );
+}
+
+// Close the innermost zone of the calling thread
+void
+ProfileZoneEnd( void )
+{
+    RecordEvent( PROFILE_EVENT_ZONE_END, NULL, 0.0 );
+}
+
+// Record the value of a counter, plotted over time
+void
+ProfileCounter( const char * name, double value )
+{
+    RecordEvent( PROFILE_EVENT_COUNTER, name, value );
+}
+
+// Mark the end of a frame
+void
+ProfileFrameMark( void )
+{
+    RecordEvent( PROFILE_EVENT_FRAME, "Frame", 0.0 );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Trace capture
+//----------------------------------------------------------------------------------------------------------------------
+// Stream profiling events into a Chrome trace JSON file until EndTraceCapture()
+bool
+BeginTraceCapture( const char * path )
+{
+    if( NULL != profiler.trace.file ) EndTraceCapture();
+
+    profiler.trace.file = fopen( path, "w" );
+    if( NULL == profiler.trace.file )
+        {
+            TRACELOG( LOG_WARNING, "PROFILE: Failed to open trace file %s", path );
+            return false;
+        }
+
+    if( 0.0 >= profiler.trace.frequency ) profiler.trace.frequency = CalibrateTicks();
+    profiler.trace.start       = ProfileTicks();
+    profiler.trace.gpuAnchored = false;
+
+    fputs( "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", profiler.trace.file );
+    fputs( "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Vultra\"}}", profiler.trace.file );
+    fputs( ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}",
+           profiler.trace.file );
+
+    // Events left over from a previous capture are discarded, recording starts now
+    const long threadCount = ATOMIC_LOAD( &profiler.threadCount );
+    for( long i = 0; i < threadCount && i < PROFILE_MAX_THREADS; ++i )
+        {
+            ProfileThread * thread = ATOMIC_LOAD_PTR( &profiler.threads[i] );
+            if( NULL != thread ) ATOMIC_STORE( &thread->tail, ATOMIC_LOAD( &thread->head ) );
+        }
+    ATOMIC_FETCH_ADD( &profiler.trace.capture, 1 );
+
+    TRACELOG( LOG_INFO, "PROFILE: Capturing trace into %s", path );
+    return true;
+}
+
+// Finish the trace file, zones still in flight are not captured
+void
+EndTraceCapture( void )
+{
+    if( NULL == profiler.trace.file ) return;
+
+    ATOMIC_FETCH_ADD( &profiler.trace.capture, 1 );
+    FlushProfiler();
+
+    fputs( "\n]}\n", profiler.trace.file );
+    fclose( profiler.trace.file );
+    profiler.trace.file = NULL;
+
+    TRACELOG( LOG_INFO, "PROFILE: Trace capture finished" );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Core
+//----------------------------------------------------------------------------------------------------------------------
+void
+InitProfiler( void )
+{
+    const VkDevice device = vGetDevice();
+    if( VK_NULL_HANDLE == device ) return;
+
+    // Timestamps are only written on queues reporting valid bits
+    VkQueueFamilyProperties families[32];
+    uint32_t                familyCount = 32;
+    vkGetPhysicalDeviceQueueFamilyProperties( vGetPhysicalDevice(), &familyCount, families );
+
+    const uint32_t family = vGetQueueFamily( VVUL_QUEUE_GRAPHICS );
+    const uint32_t bits   = ( family < familyCount ) ? families[family].timestampValidBits : 0;
+    const float    ticks  = vGetDeviceProperties()->limits.timestampPeriod;
+    if( 0 == bits || 0.0f >= ticks )
+        {
+            TRACELOG( LOG_WARNING, "PROFILE: GPU timestamps not supported, GPU zones are disabled" );
+            return;
+        }
+
+    profiler.mask       = ( 64 <= bits ) ? UINT64_MAX : ( ( (uint64_t)1 << bits ) - 1 );
+    profiler.period     = (double)ticks;
+    profiler.frameCount = vGetFramesInFlight();
+
+    VkQueryPoolCreateInfo poolInfo = { 0 };
+    poolInfo.sType                 = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType             = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount            = 2 * GPU_PROFILER_MAX_ZONES;
+
+    for( uint32_t i = 0; i < profiler.frameCount; ++i )
+        {
+            const VkResult result = vkCreateQueryPool( device, &poolInfo, NULL, &profiler.frames[i].pool );
+            if( VK_SUCCESS != result )
+                {
+                    TRACELOG( LOG_WARNING, "PROFILE: Failed to create timestamp query pool" );
+                    CloseProfiler();
+                    return;
+                }
+        }
+
+    profiler.supported = true;
+    TRACELOG( LOG_INFO, "PROFILE: GPU timestamps enabled (%u valid bits, %.3f ns per tick)", bits, profiler.period );
+}
+
+void
+CloseProfiler( void )
+{
+    EndTraceCapture();
+
+    const VkDevice device = vGetDevice();
+    if( VK_NULL_HANDLE == device ) return;
+
+    // Runs once at shutdown, the frames in flight may still write timestamps
+    vkDeviceWaitIdle( device );
+
+    for( uint32_t i = 0; i < profiler.frameCount; ++i )
+        {
+            vkDestroyQueryPool( device, profiler.frames[i].pool, NULL );
+            profiler.frames[i].pool = VK_NULL_HANDLE;
+        }
+
+    profiler.supported  = false;
+    profiler.frameCount = 0;
+}
+
+// Called once the frame fence was waited on, so the results of the slot are available
+void
+BeginProfilerFrame( void )
+{
+    const VkCommandBuffer cmd = vGetFrameCommandBuffer();
+
+    profiler.recording = false;
+    profiler.depth     = 0;
+    profiler.overflow  = 0;
+    if( !profiler.supported || VK_NULL_HANDLE == cmd ) return;
+
+    profiler.slot    = vGetFrameIndex();
+    GpuFrame * frame = &profiler.frames[profiler.slot];
+
+    if( frame->pending ) ResolveFrame( frame );
+
+    frame->count   = 0;
+    frame->pending = false;
+    vkCmdResetQueryPool( cmd, frame->pool, 0, 2 * GPU_PROFILER_MAX_ZONES );
+
+    profiler.recording = true;
+    BeginGpuZone( "Frame" );
+}
+
+// Called right before the frame is submitted
+void
+EndProfilerFrame( void )
+{
+    if( !profiler.recording ) return;
+
+    if( 1 < profiler.depth + profiler.overflow )
+        {
+            TRACELOG( LOG_WARNING, "PROFILE: %u GPU zones left open", profiler.depth + profiler.overflow - 1 );
+        }
+    while( 0 < profiler.depth ) EndGpuZone();
+
+    GpuFrame * frame   = &profiler.frames[profiler.slot];
+    frame->submitted   = ProfileTicks();
+    frame->pending     = true;
+    profiler.recording = false;
+}
+
+// Called by the main thread once per frame, the buffers are sized for a frame of events
+void
+FlushProfiler( void )
+{
+    FILE * file = profiler.trace.file;
+    if( NULL == file ) return;
+
+    const long capture     = ATOMIC_LOAD( &profiler.trace.capture );
+    const long threadCount = ATOMIC_LOAD( &profiler.threadCount );
+    for( long i = 0; i < threadCount && i < PROFILE_MAX_THREADS; ++i )
+        {
+            ProfileThread * thread = ATOMIC_LOAD_PTR( &profiler.threads[i] );
+            if( NULL == thread ) continue;
+
+            const long head = ATOMIC_LOAD( &thread->head );
+            long       tail = thread->tail;
+            if( head == tail ) continue;
+
+            if( thread->named != capture )
+                {
+                    fprintf( file,
+                             ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                             "\"args\":{\"name\":\"%s\"}}",
+                             thread->id, thread->name );
+                    thread->named = capture;
+                }
+
+            for( ; tail != head; ++tail )
+                {
+                    const ProfileEvent * event = &thread->events[(unsigned long)tail & ( PROFILE_THREAD_EVENTS - 1 )];
+
+                    // Recorded by a thread that had not seen the capture start yet
+                    if( event->tick < profiler.trace.start ) continue;
+
+                    const double time = TicksToTrace( event->tick );
+                    switch( event->type )
+                        {
+                        case PROFILE_EVENT_ZONE_BEGIN:
+                            {
+                                fputs( ",\n{\"name\":\"", file );
+                                WriteTraceName( event->name );
+                                fprintf( file, "\",\"cat\":\"cpu\",\"ph\":\"B\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}",
+                                         thread->id, time );
+                                break;
+                            }
+                        case PROFILE_EVENT_ZONE_END:
+                            {
+                                fprintf( file, ",\n{\"ph\":\"E\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", thread->id, time );
+                                break;
+                            }
+                        case PROFILE_EVENT_COUNTER:
+                            {
+                                fputs( ",\n{\"name\":\"", file );
+                                WriteTraceName( event->name );
+                                fprintf( file, "\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"value\":%g}}", time,
+                                         event->value );
+                                break;
+                            }
+                        case PROFILE_EVENT_FRAME:
+                            {
+                                fprintf( file,
+                                         ",\n{\"name\":\"Frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":%d,"
+                                         "\"ts\":%.3f}",
+                                         thread->id, time );
+                                break;
+                            }
+                        }
+                }
+
+            // Hand the drained slots back to the owner
+            ATOMIC_STORE( &thread->tail, head );
+        }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Append a CPU event to the buffer of the calling thread, only while capturing
+static void
+RecordEvent( ProfileEventType type, const char * name, double value )
+{
+    const long capture = ATOMIC_LOAD( &profiler.trace.capture );
+    if( 0 == ( capture & 1 ) ) return;
+
+    ProfileThread * thread = ( NULL != threadEvents ) ? threadEvents : RegisterThread();
+    if( NULL == thread ) return;
+
+    // Zones opened before this capture must not close zones inside it
+    if( thread->capture != capture )
+        {
+            thread->capture = capture;
+            thread->depth   = 0;
+            thread->skipped = 0;
+        }
+
+    if( PROFILE_EVENT_ZONE_END == type )
+        {
+            if( 0 < thread->skipped )
+                {
+                    --thread->skipped;
+                    return;
+                }
+            if( 0 == thread->depth ) return;
+        }
+
+    const long head = thread->head;
+    if( PROFILE_THREAD_EVENTS <= head - ATOMIC_LOAD( &thread->tail ) )
+        {
+            if( PROFILE_EVENT_ZONE_BEGIN == type ) ++thread->skipped;
+            return;
+        }
+
+    ProfileEvent * event = &thread->events[(unsigned long)head & ( PROFILE_THREAD_EVENTS - 1 )];
+    event->tick          = ProfileTicks();
+    event->name          = name;
+    event->value         = value;
+    event->type          = type;
+
+    if( PROFILE_EVENT_ZONE_BEGIN == type ) ++thread->depth;
+    else if( PROFILE_EVENT_ZONE_END == type ) --thread->depth;
+
+    // Publish to the drain
+    ATOMIC_STORE( &thread->head, head + 1 );
+}
+
+// Allocate the event buffer of the calling thread, NULL once every slot is taken
+static ProfileThread *
+RegisterThread( void )
+{
+    const long slot = ATOMIC_FETCH_ADD( &profiler.threadCount, 1 );
+    if( PROFILE_MAX_THREADS <= slot ) return NULL;
+
+    ProfileThread * thread = (ProfileThread *)VUL_CALLOC( 1, sizeof( ProfileThread ) );
+    if( NULL == thread ) return NULL;
+
+    thread->id    = (int)slot + 1;
+    thread->named = -1;
+
+    const int worker = GetWorkerIndex();
+    if( 0 < worker ) snprintf( thread->name, sizeof( thread->name ), "Worker %d", worker );
+    else snprintf( thread->name, sizeof( thread->name ), 0 == slot ? "Main" : "Thread %d", (int)slot );
+
+    threadEvents = thread;
+    ATOMIC_STORE_PTR( &profiler.threads[slot], thread );
+    return thread;
+}
+
+// Read the cycle counter, or the finest clock available
+static uint64_t
+ProfileTicks( void )
+{
+#if defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_IX86 ) )
+    return __rdtsc();
+#elif defined( __x86_64__ ) || defined( __i386__ )
+    return __rdtsc();
+#elif defined( __aarch64__ )
+    uint64_t ticks;
+    __asm__ __volatile__( "mrs %0, cntvct_el0" : "=r"( ticks ) );
+    return ticks;
+#elif defined( _WIN32 )
+    int64_t count;
+    QueryPerformanceCounter( &count );
+    return (uint64_t)count;
+#else
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+#endif
+}
+
+// Get a monotonic time in seconds, usable before the platform is initialized
+static double
+ProfileClock( void )
+{
+#if defined( _WIN32 )
+    int64_t count, frequency;
+    QueryPerformanceCounter( &count );
+    QueryPerformanceFrequency( &frequency );
+    return (double)count / (double)frequency;
+#else
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#endif
+}
+
+// Measure how many ticks ProfileTicks() advances per second
+static double
+CalibrateTicks( void )
+{
+#if defined( __aarch64__ ) && !defined( _MSC_VER )
+    uint64_t frequency;
+    __asm__ __volatile__( "mrs %0, cntfrq_el0" : "=r"( frequency ) );
+    return (double)frequency;
+#elif( defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_IX86 ) ) ) || defined( __x86_64__ ) \
+    || defined( __i386__ )
+    // Invariant TSC, counted against the monotonic clock for 10ms, once per process
+    const double   begin = ProfileClock();
+    const uint64_t first = ProfileTicks();
+    double         now;
+    do now = ProfileClock();
+    while( now - begin < 0.01 );
+    return (double)( ProfileTicks() - first ) / ( now - begin );
+#elif defined( _WIN32 )
+    int64_t frequency;
+    QueryPerformanceFrequency( &frequency );
+    return (double)frequency;
+#else
+    return 1e9;
+#endif
+}
+
+// Convert a CPU tick to microseconds into the capture
+static double
+TicksToTrace( uint64_t tick )
+{
+    return (double)(int64_t)( tick - profiler.trace.start ) * 1e6 / profiler.trace.frequency;
+}
+
+// Convert the timestamps of a completed frame into zones, and stream them into the trace
+static void
+ResolveFrame( GpuFrame * frame )
+{
+    uint64_t ticks[2 * GPU_PROFILER_MAX_ZONES];
+
+    // The fence of the frame was waited on, results are either there or were never written
+    const VkResult result
+        = vkGetQueryPoolResults( vGetDevice(), frame->pool, 0, 2 * frame->count, 2 * frame->count * sizeof( uint64_t ),
+                                 ticks, sizeof( uint64_t ), VK_QUERY_RESULT_64_BIT );
+    if( VK_SUCCESS != result ) return;
+
+    const uint64_t origin = ticks[0] & profiler.mask;
+    const double   toMs   = profiler.period * 1e-6;
+
+    for( uint32_t i = 0; i < frame->count; ++i )
+        {
+            // Masked differences stay correct across a wrap of the valid bits
+            const uint64_t begin = ( ( ticks[2 * i] & profiler.mask ) - origin ) & profiler.mask;
+            const uint64_t end   = ( ( ticks[2 * i + 1] & profiler.mask ) - origin ) & profiler.mask;
+
+            GpuZone * zone = &profiler.zones[i];
+            zone->name     = frame->names[i];
+            zone->depth    = frame->depths[i];
+            zone->start    = (double)begin * toMs;
+            zone->duration = ( end > begin ) ? (double)( end - begin ) * toMs : 0.0;
+        }
+    profiler.zoneCount = (int)frame->count;
+
+    if( NULL == profiler.trace.file ) return;
+
+    // Anchor the GPU timeline once per capture, ticks are monotonic from there
+    if( !profiler.trace.gpuAnchored )
+        {
+            profiler.trace.gpuBase     = origin;
+            profiler.trace.gpuTime     = TicksToTrace( frame->submitted );
+            profiler.trace.gpuAnchored = true;
+        }
+
+    const uint64_t elapsed    = ( origin - profiler.trace.gpuBase ) & profiler.mask;
+    const double   frameStart = profiler.trace.gpuTime + (double)elapsed * profiler.period * 1e-3;
+    for( int i = 0; i < profiler.zoneCount; ++i )
+        {
+            const GpuZone * zone = &profiler.zones[i];
+            WriteTraceEvent( zone->name, "gpu", 0, frameStart + zone->start * 1e3, zone->duration * 1e3 );
+        }
+}
+
+// Append a complete event to the trace, times in microseconds
+static void
+WriteTraceEvent( const char * name, const char * category, int thread, double start, double duration )
+{
+    FILE * file = profiler.trace.file;
+
+    fputs( ",\n{\"name\":\"", file );
+    WriteTraceName( name );
+    fprintf( file, "\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", category, thread,
+             start, duration );
+}
+
+// Write a zone name into a JSON string, names are code identifiers so only what breaks the string is escaped
+static void
+WriteTraceName( const char * name )
+{
+    FILE * file = profiler.trace.file;
+
+    for( const char * c = ( NULL != name ) ? name : "?"; '\0' != *c; ++c )
+        {
+            if( '"' == *c || '\\' == *c ) fputc( '\\', file );
+            if( 0x20 <= (unsigned char)*c ) fputc( *c, file );
+        }
+}
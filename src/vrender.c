@@ -0,0 +1,145 @@
+/******************************* VRENDER *********************************
+ * vrender: Frame recording helpers on top of the Vulkan backend
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - A draw list is cut in a few batches per worker rather than one, the atomic index counter of
+ *   ParallelFor() then balances uneven batches: a worker done early claims the next one.
+ * - The secondaries of a call live in frame memory and are executed in batch order.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#include "vultra/vrender.h"
+#include "vultra/vultra.h"
+#include "vultra/vutils.h"
+
+#include "vultra/vvul.h"
+
+#ifndef RECORD_BATCHES_PER_WORKER
+#    define RECORD_BATCHES_PER_WORKER 4 // Batches a draw list is split in per worker, for load balancing
+#endif
+#ifndef RECORD_MIN_BATCH_SIZE
+#    define RECORD_MIN_BATCH_SIZE 64 // Default items per batch, below it recording is cheaper than a secondary
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Shared by the jobs of a RecordParallel() call
+typedef struct RecordBatch
+{
+    const VkCommandBufferInheritanceInfo * inheritance;
+    RecordCallback                         callback;
+    void *                                 user;
+    int                                    itemCount;
+    int                                    batchCount;
+    VkCommandBuffer *                      cmds; // Secondary of every batch, NULL if it failed to record
+} RecordBatch;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Declaration
+//----------------------------------------------------------------------------------------------------------------------
+static void RecordBatchJob( void * user, int index );
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Recording
+//----------------------------------------------------------------------------------------------------------------------
+// Get the primary command buffer of the frame being drawn, NULL outside of BeginDrawing()/EndDrawing()
+VkCommandBuffer
+GetFrameCommandBuffer( void )
+{
+    return vGetFrameCommandBuffer();
+}
+
+// Record a draw list across the job workers, then execute the secondaries in order on the frame command buffer
+bool
+RecordParallel( int itemCount, int minBatchSize, const VkCommandBufferInheritanceInfo * inheritance,
+                RecordCallback callback, void * user )
+{
+    if( 0 >= itemCount ) return true;
+
+    if( VK_NULL_HANDLE == vGetFrameCommandBuffer() )
+        {
+            TRACELOG( LOG_WARNING, "RENDER: RecordParallel() called outside of a frame" );
+            return false;
+        }
+
+    if( 0 >= minBatchSize ) minBatchSize = RECORD_MIN_BATCH_SIZE;
+
+    const VkCommandBufferInheritanceInfo targetInheritance = vGetTargetInheritance();
+    if( NULL == inheritance ) inheritance = &targetInheritance;
+
+    RecordBatch batch = { 0 };
+    batch.inheritance = inheritance;
+    batch.callback    = callback;
+    batch.user        = user;
+    batch.itemCount   = itemCount;
+    batch.batchCount  = GetWorkerCount() * RECORD_BATCHES_PER_WORKER;
+
+    const int maxBatches = ( itemCount + minBatchSize - 1 ) / minBatchSize;
+    if( maxBatches < batch.batchCount ) batch.batchCount = maxBatches;
+
+    batch.cmds = (VkCommandBuffer *)VUL_FRAME_MALLOC( (size_t)batch.batchCount * sizeof( VkCommandBuffer ) );
+    if( NULL == batch.cmds ) return false;
+
+    ParallelFor( batch.batchCount, RecordBatchJob, &batch );
+
+    // Failed batches are dropped, the remaining draws are still executed in order
+    uint32_t recorded = 0;
+    for( int i = 0; i < batch.batchCount; ++i )
+        {
+            if( VK_NULL_HANDLE != batch.cmds[i] ) batch.cmds[recorded++] = batch.cmds[i];
+        }
+
+    vCmdExecuteSecondaries( batch.cmds, recorded );
+
+    if( (int)recorded != batch.batchCount )
+        {
+            TRACELOG( LOG_WARNING, "RENDER: %d/%d draw batches failed to record", batch.batchCount - (int)recorded,
+                      batch.batchCount );
+        }
+
+    return ( (int)recorded == batch.batchCount );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Job: record one contiguous batch of the draw list into a secondary of the calling thread
+static void
+RecordBatchJob( void * user, int index )
+{
+    RecordBatch * batch = (RecordBatch *)user;
+
+    const int first = (int)( (long long)batch->itemCount * index / batch->batchCount );
+    const int last  = (int)( (long long)batch->itemCount * ( index + 1 ) / batch->batchCount );
+
+    VkCommandBuffer cmd = vBeginSecondary( (uint32_t)GetWorkerIndex(), batch->inheritance );
+    if( VK_NULL_HANDLE != cmd )
+        {
+            batch->callback( cmd, first, last - first, batch->user );
+            if( !vEndSecondary( cmd ) ) cmd = VK_NULL_HANDLE;
+        }
+
+    batch->cmds[index] = cmd;
+}
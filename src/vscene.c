@@ -0,0 +1,1703 @@
+/******************************** VSCENE *********************************
+ * vscene: GPU-driven instance rendering
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - A frame records, outside of any render pass: the copy of the instances and mesh records
+ *   changed since the last frame (from a staging buffer of the frame slot, so the frames in
+ *   flight never see a partial update), the culling dispatch (one thread per instance), the
+ *   compaction dispatch (one thread per mesh), then a render pass with the indirect draws.
+ * - Survivors are bucketed per mesh: every mesh owns a range of the visible list, sized by its
+ *   instance count (a prefix sum kept on the CPU, rebuilt only when instances are added). The
+ *   draw record of a mesh points its firstInstance at its range, the vertex shader reads the
+ *   instance index from the visible list at gl_InstanceIndex.
+ * - Meshes are uploaded through the staging ring: their record keeps an index count of 0, which
+ *   culls every instance of them, until the frame their upload is visible to.
+ * - Occlusion culling runs in two phases. The early phase draws the instances visible last frame
+ *   (a flag per instance) that pass the frustum test. Their depth is reduced into a Hi-Z pyramid
+ *   (farthest depth per texel) by a single dispatch: every workgroup reduces a 32x32 tile down
+ *   to one texel, the last workgroup to finish (a global atomic) reduces the remaining levels.
+ *   The late phase then tests the screen rectangle of every instance bounding box against the
+ *   pyramid level where it spans at most 2x2 texels, draws the visible ones not drawn yet and
+ *   rewrites the flags for the next frame. Stale flags only cost draws, never missing objects.
+ * - The depth buffer, the pyramid and the framebuffer follow the render target, they are
+ *   recreated the first frame drawing after a resize.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#include "vultra/vscene.h"
+#include "vultra/vshader.h"
+#include "vultra/vultra.h"
+#include "vultra/vutils.h"
+
+#include "vultra/vvul.h"
+
+#include "vdraw_internal.h"
+
+#include <math.h>   /* sqrtf */
+#include <stddef.h> /* offsetof */
+#include <string.h> /* memcpy, memset */
+
+#ifndef SCENE_MAX_MESHES
+#    define SCENE_MAX_MESHES 4096 // Meshes per scene, sizes the mesh records and the draw records
+#endif
+
+#ifndef SCENE_PYRAMID_LEVELS
+#    define SCENE_PYRAMID_LEVELS 16 // Hi-Z pyramid levels, for render targets up to 65535 pixels wide
+#endif
+
+#define SCENE_GROUP_SIZE    64                                                  // Compute workgroup size
+#define SCENE_PUSH_STAGES   ( VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT ) // Single push range
+#define SCENE_STAGING_BLOCK ( (VkDeviceSize)64 << 10 )                          // Smallest staging buffer
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Buffers of a scene
+typedef enum
+{
+    SCENE_BUFFER_VERTICES = 0, // MeshVertex of every mesh
+    SCENE_BUFFER_INDICES,      // uint32_t indices of every mesh
+    SCENE_BUFFER_INSTANCES,    // SceneInstance
+    SCENE_BUFFER_MESHES,       // SceneMesh
+    SCENE_BUFFER_COUNTERS,     // Draw count, then the visible instances of every mesh
+    SCENE_BUFFER_VISIBLE,      // Visible instance indices, bucketed per mesh
+    SCENE_BUFFER_COMMANDS,     // VkDrawIndexedIndirectCommand
+    SCENE_BUFFER_FLAGS,        // Visibility of every instance in the last frame
+    SCENE_BUFFER_COUNT
+} SceneBuffer;
+
+// Indirect draw path, from the device features
+typedef enum
+{
+    SCENE_DRAW_COUNT = 0, // Compacted records, one vkCmdDrawIndexedIndirectCount()
+    SCENE_DRAW_MULTI,     // One record per mesh, one vkCmdDrawIndexedIndirect()
+    SCENE_DRAW_SINGLE     // One record per mesh, one vkCmdDrawIndexedIndirect() per mesh
+} SceneDrawMode;
+
+// Culling phases
+typedef enum
+{
+    SCENE_PHASE_EARLY = 0, // Instances visible last frame, frustum test only
+    SCENE_PHASE_LATE,      // Frustum and Hi-Z tests, draws the instances the early phase did not
+    SCENE_PHASE_FRUSTUM    // Frustum test only, occlusion culling disabled
+} ScenePhase;
+
+// Instance, as read by the shaders (std430)
+typedef struct SceneInstance
+{
+    float    rows[12]; // 3x4 row-major affine transform
+    uint32_t mesh;
+    uint32_t color; // RGBA8
+    uint32_t reserved[2];
+} SceneInstance;
+
+// Mesh record, as read by the shaders (std430)
+typedef struct SceneMesh
+{
+    uint32_t indexCount; // 0 until the upload is visible
+    uint32_t firstIndex;
+    int32_t  vertexOffset;
+    uint32_t instanceBase; // First slot of the mesh in the visible list
+    float    sphere[4];    // Bounding sphere in mesh space: center, radius
+    float    scale[4];     // Position dequantization
+    float    offset[4];
+} SceneMesh;
+
+// Mesh state kept on the CPU only
+typedef struct SceneMeshInfo
+{
+    uint32_t indexCount;
+    uint32_t instanceCount;
+    uint64_t readyFrame; // First frame number the upload is visible to
+} SceneMeshInfo;
+
+// Push constants of the culling passes, the frustum planes are extracted by the shader
+typedef struct ScenePushCull
+{
+    float    viewProjection[16];
+    uint32_t instanceCount;
+    uint32_t meshCount;
+    uint32_t phase; // ScenePhase
+} ScenePushCull;
+
+// Push constants of the pyramid reduction
+typedef struct ScenePushPyramid
+{
+    uint32_t depthSize[2];
+    uint32_t size[2]; // Level 0, the depth size rounded down to powers of two
+    uint32_t levelCount;
+    uint32_t groupCount;
+} ScenePushPyramid;
+
+// Push constants of the draws
+typedef struct ScenePushDraw
+{
+    float    viewProjection[16];
+    uint32_t base; // Added to gl_InstanceIndex, used by the per-mesh draws only
+} ScenePushDraw;
+
+// Host visible buffer of a frame slot, for the updates recorded in its frames
+typedef struct SceneStaging
+{
+    VkBuffer       buffer;
+    vvulAllocation memory;
+    VkDeviceSize   size;
+    VkDeviceSize   used;  // Bytes written in the frame
+    uint64_t       frame; // Frame number the used bytes belong to
+} SceneStaging;
+
+struct Scene
+{
+    VkBuffer       buffers[SCENE_BUFFER_COUNT];
+    vvulAllocation memory[SCENE_BUFFER_COUNT];
+    SceneStaging   staging[VVUL_MAX_FRAMES_IN_FLIGHT];
+
+    VkDescriptorSetLayout setLayout;
+    VkDescriptorPool      descriptorPool;
+    VkDescriptorSet       set;
+    VkDescriptorSetLayout targetSetLayout; // Depth and pyramid, reallocated with the render target
+    VkDescriptorPool      targetPool;
+    vvulPooledSet         targetSet;
+    VkSampler             sampler; // Nearest, the pyramid is only fetched
+    VkPipelineLayout      layout;
+    VkPipeline            cullPipeline;
+    VkPipeline            compactPipeline;
+    VkPipeline            pyramidPipeline;
+    VkPipeline            drawPipeline;
+    VkRenderPass          renderPasses[2]; // Target color loaded, depth cleared by the first, loaded by the second
+    SceneDrawMode         drawMode;
+    bool                  occlusion;    // Two-phase occlusion culling
+    bool                  flagsCleared; // Visibility flags initialized
+
+    VkFormat       depthFormat;
+    VkImage        depthImage;
+    VkImageView    depthView;
+    vvulAllocation depthMemory;
+    VkFramebuffer  framebuffer;
+    VkImageView    targetView; // Target view the framebuffer was created with
+    VkExtent2D     extent;
+
+    VkImage        pyramid;
+    VkImageView    pyramidView;
+    VkImageView    pyramidLevels[SCENE_PYRAMID_LEVELS];
+    vvulAllocation pyramidMemory;
+    VkExtent2D     pyramidExtent;
+    uint32_t       pyramidLevelCount;
+
+    SceneInstance * instances; // CPU copy, the dirty range is copied to the GPU
+    uint32_t        instanceCount;
+    uint32_t        maxInstances;
+    uint32_t        dirtyFirst; // Dirty instance range, empty when dirtyFirst >= dirtyEnd
+    uint32_t        dirtyEnd;
+
+    SceneMesh     meshes[SCENE_MAX_MESHES];
+    SceneMeshInfo meshInfos[SCENE_MAX_MESHES];
+    uint32_t      meshCount;
+    uint32_t      pendingMeshes; // Meshes whose upload is not visible yet
+    bool          meshesDirty;   // Mesh records to rebuild and copy
+
+    uint32_t vertexCount;
+    uint32_t maxVertices;
+    uint32_t indexCount;
+    uint32_t maxIndices;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// Variables Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Shared declarations of the instance and mesh records
+#define SCENE_GLSL_RECORDS                                                                                           \
+    "struct Instance { vec4 rows[3]; uvec4 data; }; // data: mesh, color\n"                                         \
+    "struct Mesh { uint indexCount; uint firstIndex; int vertexOffset; uint instanceBase;\n"                        \
+    "              vec4 sphere; vec4 scale; vec4 offset; };\n"                                                       \
+    "layout( std430, set = 0, binding = 0 ) readonly buffer Instances { Instance instances[]; };\n"                 \
+    "layout( std430, set = 0, binding = 1 ) readonly buffer Meshes { Mesh meshes[]; };\n"
+
+// Counters: draw count, workgroups done reducing the pyramid, then the visible instances of every mesh
+#define SCENE_GLSL_COUNTERS                                                                                          \
+    "layout( std430, set = 0, binding = 2 ) buffer Counters { uint drawCount; uint pyramidGroups; uint counts[]; };\n"
+
+// Culling: tests the bounding sphere against the frustum, the bounding box against the pyramid in the late phase,
+// and appends the survivors to the bucket of their mesh
+static const char * sceneCullShader
+    = "#version 450\n"
+      "layout( local_size_x = 64 ) in;\n" SCENE_GLSL_RECORDS SCENE_GLSL_COUNTERS
+      "layout( std430, set = 0, binding = 3 ) writeonly buffer Visible { uint visible[]; };\n"
+      "layout( std430, set = 0, binding = 5 ) buffer Flags { uint flags[]; };\n"
+      "layout( set = 1, binding = 2 ) uniform sampler2D uPyramid;\n"
+      "layout( push_constant ) uniform Push { mat4 viewProjection; uint instanceCount; uint meshCount;\n"
+      "                                       uint phase; } push;\n"
+      "vec3 Transform( Instance instance, vec3 position )\n"
+      "{\n"
+      "    vec4 local = vec4( position, 1.0 );\n"
+      "    return vec3( dot( instance.rows[0], local ), dot( instance.rows[1], local ),\n"
+      "                 dot( instance.rows[2], local ) );\n"
+      "}\n"
+      "bool InFrustum( Instance instance, Mesh mesh )\n"
+      "{\n"
+      "    vec3 center = Transform( instance, mesh.sphere.xyz );\n"
+      "    vec3 axisX  = vec3( instance.rows[0].x, instance.rows[1].x, instance.rows[2].x );\n"
+      "    vec3 axisY  = vec3( instance.rows[0].y, instance.rows[1].y, instance.rows[2].y );\n"
+      "    vec3 axisZ  = vec3( instance.rows[0].z, instance.rows[1].z, instance.rows[2].z );\n"
+      "    float radius = mesh.sphere.w * sqrt( max( max( dot( axisX, axisX ), dot( axisY, axisY ) ),\n"
+      "                                              dot( axisZ, axisZ ) ) );\n"
+      "    mat4 m = transpose( push.viewProjection );\n"
+      "    vec4 planes[6] = vec4[6]( m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[2], m[3] - m[2] );\n"
+      "    for( int i = 0; i < 6; ++i )\n"
+      "        if( dot( planes[i].xyz, center ) + planes[i].w < -radius * length( planes[i].xyz ) ) return false;\n"
+      "    return true;\n"
+      "}\n"
+      "bool Occluded( Instance instance, Mesh mesh )\n"
+      "{\n"
+      "    vec2  lo      = vec2( 1.0 );\n"
+      "    vec2  hi      = vec2( 0.0 );\n"
+      "    float nearest = 1.0;\n"
+      "    for( int i = 0; i < 8; ++i )\n"
+      "    {\n"
+      "        vec3 corner = mesh.offset.xyz + mesh.scale.xyz * vec3( i & 1, ( i >> 1 ) & 1, ( i >> 2 ) & 1 );\n"
+      "        vec4 clip   = push.viewProjection * vec4( Transform( instance, corner ), 1.0 );\n"
+      "        if( clip.w <= 1e-5 ) return false; // Crosses the camera plane\n"
+      "        vec3 ndc = clip.xyz / clip.w;\n"
+      "        lo       = min( lo, ndc.xy * 0.5 + 0.5 );\n"
+      "        hi       = max( hi, ndc.xy * 0.5 + 0.5 );\n"
+      "        nearest  = min( nearest, ndc.z );\n"
+      "    }\n"
+      "    lo = clamp( lo, 0.0, 1.0 );\n"
+      "    hi = clamp( hi, 0.0, 1.0 );\n"
+      "    // Level where the rectangle spans at most 2x2 texels\n"
+      "    vec2  span  = ( hi - lo ) * vec2( textureSize( uPyramid, 0 ) );\n"
+      "    int   level = int( ceil( log2( max( max( span.x, span.y ), 1.0 ) ) ) );\n"
+      "    level       = min( level, textureQueryLevels( uPyramid ) - 1 );\n"
+      "    ivec2 size  = textureSize( uPyramid, level );\n"
+      "    ivec2 a     = clamp( ivec2( lo * vec2( size ) ), ivec2( 0 ), size - 1 );\n"
+      "    ivec2 b     = clamp( ivec2( hi * vec2( size ) ), ivec2( 0 ), size - 1 );\n"
+      "    float depth = max( max( texelFetch( uPyramid, a, level ).r,\n"
+      "                            texelFetch( uPyramid, ivec2( b.x, a.y ), level ).r ),\n"
+      "                       max( texelFetch( uPyramid, ivec2( a.x, b.y ), level ).r,\n"
+      "                            texelFetch( uPyramid, b, level ).r ) );\n"
+      "    return nearest > depth;\n"
+      "}\n"
+      "void main()\n"
+      "{\n"
+      "    uint id = gl_GlobalInvocationID.x;\n"
+      "    if( id >= push.instanceCount ) return;\n"
+      "    Instance instance = instances[id];\n"
+      "    Mesh     mesh     = meshes[instance.data.x];\n"
+      "    if( 0u == mesh.indexCount ) return;\n"
+      "    bool seen   = InFrustum( instance, mesh );\n"
+      "    bool append = seen;\n"
+      "    if( 0u == push.phase ) append = seen && 0u != flags[id];\n"
+      "    if( 1u == push.phase )\n"
+      "    {\n"
+      "        seen      = seen && !Occluded( instance, mesh );\n"
+      "        append    = seen && 0u == flags[id];\n"
+      "        flags[id] = seen ? 1u : 0u;\n"
+      "    }\n"
+      "    if( !append ) return;\n"
+      "    uint slot = atomicAdd( counts[instance.data.x], 1u );\n"
+      "    visible[mesh.instanceBase + slot] = id;\n"
+      "}\n";
+
+// Compaction: writes the draw record of every mesh, only the non-empty ones with a draw count
+static const char * sceneCompactShader
+    = "#version 450\n"
+      "layout( local_size_x = 64 ) in;\n"
+      "layout( constant_id = 0 ) const uint MODE = 0u; // SceneDrawMode\n" SCENE_GLSL_RECORDS SCENE_GLSL_COUNTERS
+      "struct Command { uint indexCount; uint instanceCount; uint firstIndex; int vertexOffset;\n"
+      "                 uint firstInstance; };\n"
+      "layout( std430, set = 0, binding = 4 ) writeonly buffer Commands { Command commands[]; };\n"
+      "layout( push_constant ) uniform Push { mat4 viewProjection; uint instanceCount; uint meshCount; } push;\n"
+      "void main()\n"
+      "{\n"
+      "    uint id = gl_GlobalInvocationID.x;\n"
+      "    if( id >= push.meshCount ) return;\n"
+      "    Mesh mesh  = meshes[id];\n"
+      "    uint count = counts[id];\n"
+      "    uint slot  = id;\n"
+      "    if( 0u == MODE )\n"
+      "    {\n"
+      "        if( 0u == count ) return;\n"
+      "        slot = atomicAdd( drawCount, 1u );\n"
+      "    }\n"
+      "    uint first = ( 2u == MODE ) ? 0u : mesh.instanceBase;\n"
+      "    commands[slot] = Command( mesh.indexCount, count, mesh.firstIndex, mesh.vertexOffset, first );\n"
+      "}\n";
+
+// Pyramid reduction, single pass: every workgroup reduces a 32x32 tile of level 0 down to level 5, the last one to
+// finish reduces the rest. Levels are indexed by constants only, dynamic indexing of image arrays is optional
+static const char * scenePyramidShader
+    = "#version 450\n"
+      "layout( local_size_x = 16, local_size_y = 16 ) in;\n" SCENE_GLSL_COUNTERS
+      "layout( set = 1, binding = 0 ) uniform sampler2D uDepth;\n"
+      "layout( set = 1, binding = 1, r32f ) uniform coherent image2D uLevels[16];\n"
+      "layout( push_constant ) uniform Push { uvec2 depthSize; uvec2 size; uint levelCount; uint groupCount; } push;\n"
+      "shared float tile[16][16];\n"
+      "shared bool  last;\n"
+      "ivec2 LevelSize( uint level ) { return max( ivec2( push.size ) >> int( level ), ivec2( 1 ) ); }\n"
+      "void Store( uint level, ivec2 p, float depth )\n"
+      "{\n"
+      "    if( level >= push.levelCount || any( greaterThanEqual( p, LevelSize( level ) ) ) ) return;\n"
+      "    vec4 v = vec4( depth );\n"
+      "    switch( level )\n"
+      "    {\n"
+      "        case 0: imageStore( uLevels[0], p, v ); break;    case 1: imageStore( uLevels[1], p, v ); break;\n"
+      "        case 2: imageStore( uLevels[2], p, v ); break;    case 3: imageStore( uLevels[3], p, v ); break;\n"
+      "        case 4: imageStore( uLevels[4], p, v ); break;    case 5: imageStore( uLevels[5], p, v ); break;\n"
+      "        case 6: imageStore( uLevels[6], p, v ); break;    case 7: imageStore( uLevels[7], p, v ); break;\n"
+      "        case 8: imageStore( uLevels[8], p, v ); break;    case 9: imageStore( uLevels[9], p, v ); break;\n"
+      "        case 10: imageStore( uLevels[10], p, v ); break;  case 11: imageStore( uLevels[11], p, v ); break;\n"
+      "        case 12: imageStore( uLevels[12], p, v ); break;  case 13: imageStore( uLevels[13], p, v ); break;\n"
+      "        case 14: imageStore( uLevels[14], p, v ); break;  default: imageStore( uLevels[15], p, v ); break;\n"
+      "    }\n"
+      "}\n"
+      "float Load( uint level, ivec2 p )\n"
+      "{\n"
+      "    switch( level )\n"
+      "    {\n"
+      "        case 5: return imageLoad( uLevels[5], p ).r;      case 6: return imageLoad( uLevels[6], p ).r;\n"
+      "        case 7: return imageLoad( uLevels[7], p ).r;      case 8: return imageLoad( uLevels[8], p ).r;\n"
+      "        case 9: return imageLoad( uLevels[9], p ).r;      case 10: return imageLoad( uLevels[10], p ).r;\n"
+      "        case 11: return imageLoad( uLevels[11], p ).r;    case 12: return imageLoad( uLevels[12], p ).r;\n"
+      "        case 13: return imageLoad( uLevels[13], p ).r;    default: return imageLoad( uLevels[14], p ).r;\n"
+      "    }\n"
+      "}\n"
+      "// Farthest depth under a level 0 texel, up to 3x3 depth texels since level 0 is at most twice smaller\n"
+      "float Reduce0( ivec2 p )\n"
+      "{\n"
+      "    if( any( greaterThanEqual( p, ivec2( push.size ) ) ) ) return 0.0;\n"
+      "    vec2  scale = vec2( push.depthSize ) / vec2( push.size );\n"
+      "    ivec2 lo    = ivec2( vec2( p ) * scale );\n"
+      "    ivec2 hi    = min( ivec2( ceil( vec2( p + 1 ) * scale ) ) - 1, ivec2( push.depthSize ) - 1 );\n"
+      "    float depth = 0.0;\n"
+      "    for( int y = lo.y; y <= hi.y; ++y )\n"
+      "        for( int x = lo.x; x <= hi.x; ++x ) depth = max( depth, texelFetch( uDepth, ivec2( x, y ), 0 ).r );\n"
+      "    Store( 0u, p, depth );\n"
+      "    return depth;\n"
+      "}\n"
+      "void main()\n"
+      "{\n"
+      "    ivec2 local = ivec2( gl_LocalInvocationID.xy );\n"
+      "    ivec2 group = ivec2( gl_WorkGroupID.xy );\n"
+      "    ivec2 p     = group * 32 + local * 2;\n"
+      "    float depth = max( max( Reduce0( p ), Reduce0( p + ivec2( 1, 0 ) ) ),\n"
+      "                       max( Reduce0( p + ivec2( 0, 1 ) ), Reduce0( p + ivec2( 1, 1 ) ) ) );\n"
+      "    Store( 1u, group * 16 + local, depth );\n"
+      "    tile[local.y][local.x] = depth;\n"
+      "    for( uint level = 2u, width = 8u; level <= 5u; ++level, width >>= 1u )\n"
+      "    {\n"
+      "        barrier();\n"
+      "        bool  active = all( lessThan( local, ivec2( width ) ) );\n"
+      "        ivec2 q      = local * 2;\n"
+      "        if( active ) depth = max( max( tile[q.y][q.x], tile[q.y][q.x + 1] ),\n"
+      "                                  max( tile[q.y + 1][q.x], tile[q.y + 1][q.x + 1] ) );\n"
+      "        barrier();\n"
+      "        if( active ) tile[local.y][local.x] = depth;\n"
+      "        if( active ) Store( level, group * int( width ) + local, depth );\n"
+      "    }\n"
+      "    if( push.levelCount <= 6u ) return;\n"
+      "    // Level 5 of every workgroup is visible to the last one before it reads it\n"
+      "    memoryBarrier();\n"
+      "    barrier();\n"
+      "    if( 0u == gl_LocalInvocationIndex ) last = ( push.groupCount - 1u == atomicAdd( pyramidGroups, 1u ) );\n"
+      "    barrier();\n"
+      "    if( !last ) return;\n"
+      "    for( uint level = 6u; level < push.levelCount; ++level )\n"
+      "    {\n"
+      "        ivec2 size     = LevelSize( level );\n"
+      "        ivec2 previous = LevelSize( level - 1u );\n"
+      "        for( int i = int( gl_LocalInvocationIndex ); i < size.x * size.y; i += 256 )\n"
+      "        {\n"
+      "            ivec2 a = ivec2( i % size.x, i / size.x ) * 2;\n"
+      "            ivec2 b = min( a + 1, previous - 1 );\n"
+      "            Store( level, a / 2, max( max( Load( level - 1u, a ), Load( level - 1u, ivec2( b.x, a.y ) ) ),\n"
+      "                                      max( Load( level - 1u, ivec2( a.x, b.y ) ), Load( level - 1u, b ) ) ) );\n"
+      "        }\n"
+      "        memoryBarrierImage();\n"
+      "        barrier();\n"
+      "    }\n"
+      "}\n";
+
+// Vertex shader: fetches the instance of the visible slot, dequantizes and transforms the vertex
+static const char * sceneVertexShader
+    = "#version 450\n" SCENE_GLSL_RECORDS
+      "layout( std430, set = 0, binding = 3 ) readonly buffer Visible { uint visible[]; };\n"
+      "layout( push_constant ) uniform Push { mat4 viewProjection; uint base; } push;\n"
+      "layout( location = 0 ) in vec4 inPosition;\n"
+      "layout( location = 1 ) in vec4 inNormal;\n"
+      "layout( location = 0 ) out vec4 outColor;\n"
+      "void main()\n"
+      "{\n"
+      "    Instance instance = instances[visible[push.base + uint( gl_InstanceIndex )]];\n"
+      "    Mesh     mesh     = meshes[instance.data.x];\n"
+      "    vec4 local  = vec4( mesh.offset.xyz + inPosition.xyz * mesh.scale.xyz, 1.0 );\n"
+      "    vec3 world  = vec3( dot( instance.rows[0], local ), dot( instance.rows[1], local ),\n"
+      "                        dot( instance.rows[2], local ) );\n"
+      "    vec3 normal = normalize( vec3( dot( instance.rows[0].xyz, inNormal.xyz ),\n"
+      "                                   dot( instance.rows[1].xyz, inNormal.xyz ),\n"
+      "                                   dot( instance.rows[2].xyz, inNormal.xyz ) ) );\n"
+      "    float light = 0.3 + 0.7 * max( dot( normal, vec3( 0.37, 0.84, 0.4 ) ), 0.0 );\n"
+      "    vec4  color = unpackUnorm4x8( instance.data.y );\n"
+      "    outColor    = vec4( color.rgb * light, color.a );\n"
+      "    gl_Position = push.viewProjection * vec4( world, 1.0 );\n"
+      "}\n";
+
+static const char * sceneFragmentShader = "#version 450\n"
+                                          "layout( location = 0 ) in vec4 inColor;\n"
+                                          "layout( location = 0 ) out vec4 outColor;\n"
+                                          "void main()\n"
+                                          "{\n"
+                                          "    outColor = inColor;\n"
+                                          "}\n";
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Declaration
+//----------------------------------------------------------------------------------------------------------------------
+static bool     CreateSceneBuffer( Scene * scene, SceneBuffer index, VkDeviceSize size, VkBufferUsageFlags usage );
+static bool     CreateSceneDescriptors( Scene * scene );
+static bool     CreateScenePipelines( Scene * scene );
+static bool     CreateSceneRenderPass( Scene * scene, VkAttachmentLoadOp depthLoad, VkRenderPass * renderPass );
+static bool     PrepareSceneTarget( Scene * scene, VkCommandBuffer cmd );
+static void     RetireSceneTarget( Scene * scene );
+static bool     StageSceneUpdates( Scene * scene, VkCommandBuffer cmd );
+static void     RecordScene( VkCommandBuffer cmd, void * user, const float * viewProjection );
+static void     CmdCullScene( Scene * scene, VkCommandBuffer cmd, const float * viewProjection, ScenePhase phase );
+static void     CmdDrawSceneBuckets( Scene * scene, VkCommandBuffer cmd, const float * viewProjection,
+                                     bool clearDepth );
+static void     CmdBuildPyramid( Scene * scene, VkCommandBuffer cmd );
+static void     CmdSceneBarrier( VkCommandBuffer cmd, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess,
+                                 VkPipelineStageFlags dstStage, VkAccessFlags dstAccess );
+static void     MarkInstancesDirty( Scene * scene, uint32_t first, uint32_t end );
+static uint32_t PackSceneColor( Color color );
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Create a scene holding up to maxInstances instances of meshes totaling maxVertices and maxIndices
+Scene *
+LoadScene( uint32_t maxInstances, uint32_t maxVertices, uint32_t maxIndices )
+{
+    if( VK_NULL_HANDLE == vGetDevice() || 0 == maxInstances || 0 == maxVertices || 0 == maxIndices ) return NULL;
+
+    Scene * scene = (Scene *)VUL_CALLOC( 1, sizeof( Scene ) );
+    if( NULL == scene ) return NULL;
+
+    scene->maxInstances = maxInstances;
+    scene->maxVertices  = maxVertices;
+    scene->maxIndices   = maxIndices;
+    scene->instances    = (SceneInstance *)VUL_MALLOC( (size_t)maxInstances * sizeof( SceneInstance ) );
+    scene->occlusion    = true;
+
+    const vvulDeviceFeatures * features = vGetDeviceFeatures();
+    if( features->drawIndirectCount && features->multiDrawIndirect ) scene->drawMode = SCENE_DRAW_COUNT;
+    else if( features->multiDrawIndirect ) scene->drawMode = SCENE_DRAW_MULTI;
+    else scene->drawMode = SCENE_DRAW_SINGLE;
+
+    const VkBufferUsageFlags storage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    const VkBufferUsageFlags upload  = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    const VkBufferUsageFlags command = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | storage;
+
+    const VkDeviceSize sizes[SCENE_BUFFER_COUNT] = {
+        (VkDeviceSize)maxVertices * sizeof( MeshVertex ),     (VkDeviceSize)maxIndices * sizeof( uint32_t ),
+        (VkDeviceSize)maxInstances * sizeof( SceneInstance ), SCENE_MAX_MESHES * sizeof( SceneMesh ),
+        ( 2 + SCENE_MAX_MESHES ) * sizeof( uint32_t ),        (VkDeviceSize)maxInstances * sizeof( uint32_t ),
+        SCENE_MAX_MESHES * sizeof( VkDrawIndexedIndirectCommand ), (VkDeviceSize)maxInstances * sizeof( uint32_t ),
+    };
+    const VkBufferUsageFlags usages[SCENE_BUFFER_COUNT] = {
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | upload, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | upload, storage | upload,
+        storage | upload, command | upload, storage, command, storage | upload,
+    };
+
+    bool created = ( NULL != scene->instances );
+    for( int i = 0; created && i < SCENE_BUFFER_COUNT; ++i )
+        {
+            created = CreateSceneBuffer( scene, (SceneBuffer)i, sizes[i], usages[i] );
+        }
+    created = created && CreateSceneDescriptors( scene ) && CreateScenePipelines( scene );
+
+    if( !created )
+        {
+            TRACELOG( LOG_WARNING, "SCENE: Failed to create a scene of %u instances", maxInstances );
+            UnloadScene( scene );
+            return NULL;
+        }
+
+    static const char * modes[] = { "draw count", "multi-draw", "draw per mesh" };
+    TRACELOG( LOG_INFO, "SCENE: Scene created (%u instances, %u vertices, %u indices, %s)", maxInstances, maxVertices,
+              maxIndices, modes[scene->drawMode] );
+
+    return scene;
+}
+
+// Destroy a scene and its GPU resources, drains the device
+void
+UnloadScene( Scene * scene )
+{
+    const VkDevice device = vGetDevice();
+
+    if( NULL == scene ) return;
+
+    // Scenes are unloaded with their level, draining is simpler than deferring the pipelines
+    if( VK_NULL_HANDLE != device )
+        {
+            vkDeviceWaitIdle( device );
+
+            for( int i = 0; i < SCENE_BUFFER_COUNT; ++i )
+                {
+                    vkDestroyBuffer( device, scene->buffers[i], NULL );
+                    vFreeMemory( &scene->memory[i] );
+                }
+
+            for( int i = 0; i < VVUL_MAX_FRAMES_IN_FLIGHT; ++i )
+                {
+                    vkDestroyBuffer( device, scene->staging[i].buffer, NULL );
+                    vFreeMemory( &scene->staging[i].memory );
+                }
+
+            vkDestroyFramebuffer( device, scene->framebuffer, NULL );
+            vkDestroyImageView( device, scene->depthView, NULL );
+            vkDestroyImage( device, scene->depthImage, NULL );
+            vFreeMemory( &scene->depthMemory );
+
+            for( uint32_t i = 0; i < scene->pyramidLevelCount; ++i )
+                {
+                    vkDestroyImageView( device, scene->pyramidLevels[i], NULL );
+                }
+            vkDestroyImageView( device, scene->pyramidView, NULL );
+            vkDestroyImage( device, scene->pyramid, NULL );
+            vFreeMemory( &scene->pyramidMemory );
+
+            vkDestroyPipeline( device, scene->drawPipeline, NULL );
+            vkDestroyPipeline( device, scene->pyramidPipeline, NULL );
+            vkDestroyPipeline( device, scene->compactPipeline, NULL );
+            vkDestroyPipeline( device, scene->cullPipeline, NULL );
+            vkDestroyRenderPass( device, scene->renderPasses[0], NULL );
+            vkDestroyRenderPass( device, scene->renderPasses[1], NULL );
+            vkDestroyPipelineLayout( device, scene->layout, NULL );
+            vkDestroySampler( device, scene->sampler, NULL );
+            vkDestroyDescriptorPool( device, scene->targetPool, NULL ); // Frees the target set
+            vkDestroyDescriptorPool( device, scene->descriptorPool, NULL );
+            vkDestroyDescriptorSetLayout( device, scene->targetSetLayout, NULL );
+            vkDestroyDescriptorSetLayout( device, scene->setLayout, NULL );
+        }
+
+    VUL_FREE( scene->instances );
+    VUL_FREE( scene );
+}
+
+// Upload a cooked mesh into the shared geometry buffers, drawable from the next frame
+uint32_t
+AddSceneMesh( Scene * scene, const CookedMesh * mesh )
+{
+    if( NULL == scene || NULL == mesh || NULL == mesh->header || 0 == mesh->header->indexCount ) return SCENE_NONE;
+
+    const MeshHeader * header = mesh->header;
+
+    if( SCENE_MAX_MESHES == scene->meshCount || header->vertexCount > scene->maxVertices - scene->vertexCount
+        || header->indexCount > scene->maxIndices - scene->indexCount )
+        {
+            TRACELOG( LOG_WARNING, "SCENE: Geometry limit reached, mesh of %u vertices not added",
+                      header->vertexCount );
+            return SCENE_NONE;
+        }
+
+    // Indices are widened to 32 bits, a single index buffer then serves every mesh
+    uint32_t * widened = NULL;
+    if( 2 == header->indexSize )
+        {
+            widened = (uint32_t *)VUL_MALLOC( (size_t)header->indexCount * sizeof( uint32_t ) );
+            if( NULL == widened ) return SCENE_NONE;
+
+            for( uint32_t i = 0; i < header->indexCount; ++i )
+                {
+                    widened[i] = ( (const uint16_t *)mesh->indices )[i];
+                }
+        }
+
+    const vvulUploadTicket vertices
+        = vUploadBuffer( scene->buffers[SCENE_BUFFER_VERTICES], (VkDeviceSize)scene->vertexCount * sizeof( MeshVertex ),
+                         mesh->vertices, (VkDeviceSize)header->vertexCount * sizeof( MeshVertex ) );
+    const vvulUploadTicket indices
+        = ( VVUL_UPLOAD_FAILED == vertices )
+              ? VVUL_UPLOAD_FAILED
+              : vUploadBuffer( scene->buffers[SCENE_BUFFER_INDICES],
+                               (VkDeviceSize)scene->indexCount * sizeof( uint32_t ),
+                               ( NULL != widened ) ? (const void *)widened : mesh->indices,
+                               (VkDeviceSize)header->indexCount * sizeof( uint32_t ) );
+
+    VUL_FREE( widened );
+
+    if( VVUL_UPLOAD_FAILED == vertices || VVUL_UPLOAD_FAILED == indices )
+        {
+            // The vertex range is given back to the next mesh, copies recorded into it (even partial ones) land first
+            vWaitUpload( vFlushUploads() );
+
+            TRACELOG( LOG_WARNING, "SCENE: Failed to upload a mesh of %u vertices", header->vertexCount );
+            return SCENE_NONE;
+        }
+
+    const uint32_t id     = scene->meshCount++;
+    SceneMesh *    record = &scene->meshes[id];
+    SceneMeshInfo * info  = &scene->meshInfos[id];
+
+    memset( record, 0, sizeof( SceneMesh ) );
+    record->firstIndex   = scene->indexCount;
+    record->vertexOffset = (int32_t)scene->vertexCount;
+
+    // Sphere bounding the quantization box, positions never leave it
+    float squared = 0.0F;
+    for( int i = 0; i < 3; ++i )
+        {
+            record->scale[i]  = header->positionScale[i];
+            record->offset[i] = header->positionOffset[i];
+            record->sphere[i] = header->positionOffset[i] + 0.5F * header->positionScale[i];
+            squared += header->positionScale[i] * header->positionScale[i];
+        }
+    record->sphere[3] = 0.5F * sqrtf( squared );
+
+    // Uploads recorded during a frame are visible to the next one
+    info->indexCount    = header->indexCount;
+    info->instanceCount = 0;
+    info->readyFrame    = vGetFrameNumber() + ( ( VK_NULL_HANDLE != vGetFrameCommandBuffer() ) ? 1 : 0 );
+
+    scene->vertexCount += header->vertexCount;
+    scene->indexCount += header->indexCount;
+    scene->meshesDirty = true;
+
+    return id;
+}
+
+// Add an instance of a mesh, SCENE_NONE when the scene is full
+uint32_t
+AddSceneInstance( Scene * scene, uint32_t mesh, const float transform[12], Color color )
+{
+    if( NULL == scene || NULL == transform || mesh >= scene->meshCount ) return SCENE_NONE;
+
+    if( scene->instanceCount == scene->maxInstances )
+        {
+            TRACELOG( LOG_WARNING, "SCENE: Instance limit reached (%u), instance not added", scene->maxInstances );
+            return SCENE_NONE;
+        }
+
+    const uint32_t  id       = scene->instanceCount++;
+    SceneInstance * instance = &scene->instances[id];
+
+    memset( instance, 0, sizeof( SceneInstance ) );
+    memcpy( instance->rows, transform, sizeof( instance->rows ) );
+    instance->mesh  = mesh;
+    instance->color = PackSceneColor( color );
+
+    // The buckets move, every mesh record is rebuilt
+    ++scene->meshInfos[mesh].instanceCount;
+    scene->meshesDirty = true;
+
+    MarkInstancesDirty( scene, id, id + 1 );
+
+    return id;
+}
+
+// Replace the transforms of count instances from first, 12 floats each
+void
+SetSceneInstanceTransforms( Scene * scene, uint32_t first, uint32_t count, const float * transforms )
+{
+    if( NULL == scene || NULL == transforms || first >= scene->instanceCount ) return;
+    if( count > scene->instanceCount - first ) count = scene->instanceCount - first;
+
+    for( uint32_t i = 0; i < count; ++i )
+        {
+            memcpy( scene->instances[first + i].rows, transforms + 12 * (size_t)i, sizeof( float ) * 12 );
+        }
+
+    MarkInstancesDirty( scene, first, first + count );
+}
+
+// Replace the color of an instance
+void
+SetSceneInstanceColor( Scene * scene, uint32_t instance, Color color )
+{
+    if( NULL == scene || instance >= scene->instanceCount ) return;
+
+    scene->instances[instance].color = PackSceneColor( color );
+    MarkInstancesDirty( scene, instance, instance + 1 );
+}
+
+// Remove every instance, the meshes stay loaded
+void
+ClearSceneInstances( Scene * scene )
+{
+    if( NULL == scene ) return;
+
+    for( uint32_t i = 0; i < scene->meshCount; ++i )
+        {
+            scene->meshInfos[i].instanceCount = 0;
+        }
+
+    scene->instanceCount = 0;
+    scene->dirtyFirst    = 0;
+    scene->dirtyEnd      = 0;
+    scene->meshesDirty   = true;
+}
+
+uint32_t
+GetSceneInstanceCount( const Scene * scene )
+{
+    return ( NULL != scene ) ? scene->instanceCount : 0;
+}
+
+// Enable or disable the two-phase occlusion culling, enabled by default
+void
+SetSceneOcclusion( Scene * scene, bool enabled )
+{
+    if( NULL != scene ) scene->occlusion = enabled;
+}
+
+// Cull and draw the scene, recorded in the 2D draw order
+void
+DrawScene( Scene * scene, const float viewProjection[16] )
+{
+    if( NULL == scene || NULL == viewProjection ) return;
+
+    PushDrawCallback( RecordScene, scene, viewProjection, 16 );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Create a device local buffer of the scene
+static bool
+CreateSceneBuffer( Scene * scene, SceneBuffer index, VkDeviceSize size, VkBufferUsageFlags usage )
+{
+    VkBufferCreateInfo bufferInfo = { 0 };
+    bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size               = size;
+    bufferInfo.usage              = usage;
+    bufferInfo.sharingMode        = VK_SHARING_MODE_EXCLUSIVE;
+
+    const VkResult result = vkCreateBuffer( vGetDevice(), &bufferInfo, NULL, &scene->buffers[index] );
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_WARNING, "SCENE: Failed to create a buffer of %llu bytes (%d)", (unsigned long long)size,
+                      (int)result );
+            return false;
+        }
+
+    return vAllocateBufferMemory( scene->buffers[index], VVUL_MEMORY_GPU_ONLY, &scene->memory[index] );
+}
+
+// Create the set binding the scene buffers, shared by every pass, and the layout of the render target set
+static bool
+CreateSceneDescriptors( Scene * scene )
+{
+    const VkDevice device = vGetDevice();
+    VkResult       result;
+
+    VkDescriptorSetLayoutBinding bindings[6] = { 0 };
+    for( uint32_t i = 0; i < 6; ++i )
+        {
+            bindings[i].binding         = i;
+            bindings[i].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags      = SCENE_PUSH_STAGES;
+        }
+
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo = { 0 };
+    setLayoutInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.bindingCount                    = 6;
+    setLayoutInfo.pBindings                       = bindings;
+
+    result = vkCreateDescriptorSetLayout( device, &setLayoutInfo, NULL, &scene->setLayout );
+
+    // Render target set: depth, pyramid levels written, whole pyramid fetched
+    VkDescriptorSetLayoutBinding targetBindings[3] = { 0 };
+    for( uint32_t i = 0; i < 3; ++i )
+        {
+            targetBindings[i].binding         = i;
+            targetBindings[i].descriptorType  = ( 1 == i ) ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+                                                           : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            targetBindings[i].descriptorCount = ( 1 == i ) ? SCENE_PYRAMID_LEVELS : 1;
+            targetBindings[i].stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+    setLayoutInfo.bindingCount = 3;
+    setLayoutInfo.pBindings    = targetBindings;
+
+    if( VK_SUCCESS == result )
+        {
+            result = vkCreateDescriptorSetLayout( device, &setLayoutInfo, NULL, &scene->targetSetLayout );
+        }
+
+    const VkDescriptorPoolSize poolSize = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 6 };
+
+    VkDescriptorPoolCreateInfo poolInfo = { 0 };
+    poolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets                    = 1;
+    poolInfo.poolSizeCount              = 1;
+    poolInfo.pPoolSizes                 = &poolSize;
+
+    if( VK_SUCCESS == result ) result = vkCreateDescriptorPool( device, &poolInfo, NULL, &scene->descriptorPool );
+
+    // Retired target sets wait for the frames in flight, a few resizes may overlap
+    const VkDescriptorPoolSize targetPoolSizes[2] = {
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 * 4 },
+        { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, SCENE_PYRAMID_LEVELS * 4 },
+    };
+
+    poolInfo.flags         = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    poolInfo.maxSets       = 4;
+    poolInfo.poolSizeCount = 2;
+    poolInfo.pPoolSizes    = targetPoolSizes;
+
+    if( VK_SUCCESS == result ) result = vkCreateDescriptorPool( device, &poolInfo, NULL, &scene->targetPool );
+
+    VkSamplerCreateInfo samplerInfo = { 0 };
+    samplerInfo.sType               = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter           = VK_FILTER_NEAREST;
+    samplerInfo.minFilter           = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode          = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxLod              = VK_LOD_CLAMP_NONE;
+
+    if( VK_SUCCESS == result ) result = vkCreateSampler( device, &samplerInfo, NULL, &scene->sampler );
+
+    VkDescriptorSetAllocateInfo allocateInfo = { 0 };
+    allocateInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorPool              = scene->descriptorPool;
+    allocateInfo.descriptorSetCount          = 1;
+    allocateInfo.pSetLayouts                 = &scene->setLayout;
+
+    if( VK_SUCCESS == result ) result = vkAllocateDescriptorSets( device, &allocateInfo, &scene->set );
+
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_WARNING, "SCENE: Failed to create the descriptor sets (%d)", (int)result );
+            return false;
+        }
+
+    // Binding order of the shaders
+    const SceneBuffer bound[6] = { SCENE_BUFFER_INSTANCES, SCENE_BUFFER_MESHES,   SCENE_BUFFER_COUNTERS,
+                                   SCENE_BUFFER_VISIBLE,   SCENE_BUFFER_COMMANDS, SCENE_BUFFER_FLAGS };
+
+    VkDescriptorBufferInfo bufferInfos[6] = { 0 };
+    VkWriteDescriptorSet   writes[6]      = { 0 };
+    for( uint32_t i = 0; i < 6; ++i )
+        {
+            bufferInfos[i].buffer = scene->buffers[bound[i]];
+            bufferInfos[i].range  = VK_WHOLE_SIZE;
+
+            writes[i].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet          = scene->set;
+            writes[i].dstBinding      = i;
+            writes[i].descriptorCount = 1;
+            writes[i].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].pBufferInfo     = &bufferInfos[i];
+        }
+
+    vkUpdateDescriptorSets( device, 6, writes, 0, NULL );
+
+    return true;
+}
+
+// Compile the shaders, create the render passes and the culling, reduction and drawing pipelines
+static bool
+CreateScenePipelines( Scene * scene )
+{
+    const VkDevice device = vGetDevice();
+    VkResult       result;
+
+    ShaderDesc shaders[5] = { 0 };
+    shaders[0].path       = "vultra/scene_cull.comp";
+    shaders[0].source     = sceneCullShader;
+    shaders[0].stage      = SHADER_STAGE_COMPUTE;
+    shaders[1].path       = "vultra/scene_compact.comp";
+    shaders[1].source     = sceneCompactShader;
+    shaders[1].stage      = SHADER_STAGE_COMPUTE;
+    shaders[2].path       = "vultra/scene_pyramid.comp";
+    shaders[2].source     = scenePyramidShader;
+    shaders[2].stage      = SHADER_STAGE_COMPUTE;
+    shaders[3].path       = "vultra/scene.vert";
+    shaders[3].source     = sceneVertexShader;
+    shaders[3].stage      = SHADER_STAGE_VERTEX;
+    shaders[4].path       = "vultra/scene.frag";
+    shaders[4].source     = sceneFragmentShader;
+    shaders[4].stage      = SHADER_STAGE_FRAGMENT;
+    for( int i = 0; i < 5; ++i ) shaders[i].optimize = true;
+
+    VkShaderModule modules[5] = { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE };
+    if( 5 != LoadShaderModules( shaders, 5, modules ) )
+        {
+            for( int i = 0; i < 5; ++i ) UnloadShaderModule( modules[i] );
+            return false;
+        }
+
+    // Layout, the pyramid push constants are the smallest
+    //--------------------------------------------------------------
+    const uint32_t pushSize = ( sizeof( ScenePushCull ) > sizeof( ScenePushDraw ) ) ? sizeof( ScenePushCull )
+                                                                                    : sizeof( ScenePushDraw );
+    const VkPushConstantRange   pushRange  = { SCENE_PUSH_STAGES, 0, pushSize };
+    const VkDescriptorSetLayout layouts[2] = { scene->setLayout, scene->targetSetLayout };
+
+    VkPipelineLayoutCreateInfo layoutInfo = { 0 };
+    layoutInfo.sType                      = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount             = 2;
+    layoutInfo.pSetLayouts                = layouts;
+    layoutInfo.pushConstantRangeCount     = 1;
+    layoutInfo.pPushConstantRanges        = &pushRange;
+
+    result = vkCreatePipelineLayout( device, &layoutInfo, NULL, &scene->layout );
+
+    // Render passes: the early phase clears the depth, the late one keeps it. Both are compatible, the
+    // pipeline and the framebuffer serve both
+    //--------------------------------------------------------------
+    const VkFormatFeatureFlags depthFeatures
+        = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+
+    VkFormatProperties formatProperties = { 0 };
+    vkGetPhysicalDeviceFormatProperties( vGetPhysicalDevice(), VK_FORMAT_D32_SFLOAT, &formatProperties );
+    scene->depthFormat = ( depthFeatures == ( formatProperties.optimalTilingFeatures & depthFeatures ) )
+                           ? VK_FORMAT_D32_SFLOAT
+                           : VK_FORMAT_D16_UNORM; // Always supported, sampled included
+
+    if( VK_SUCCESS == result
+        && ( !CreateSceneRenderPass( scene, VK_ATTACHMENT_LOAD_OP_CLEAR, &scene->renderPasses[0] )
+             || !CreateSceneRenderPass( scene, VK_ATTACHMENT_LOAD_OP_LOAD, &scene->renderPasses[1] ) ) )
+        {
+            result = VK_ERROR_INITIALIZATION_FAILED;
+        }
+
+    // Compute pipelines
+    //--------------------------------------------------------------
+    const uint32_t                 mode      = (uint32_t)scene->drawMode;
+    const VkSpecializationMapEntry modeEntry = { 0, 0, sizeof( uint32_t ) };
+
+    VkSpecializationInfo specialization = { 0 };
+    specialization.mapEntryCount        = 1;
+    specialization.pMapEntries          = &modeEntry;
+    specialization.dataSize             = sizeof( uint32_t );
+    specialization.pData                = &mode;
+
+    VkComputePipelineCreateInfo computeInfos[3] = { 0 };
+    for( int i = 0; i < 3; ++i )
+        {
+            computeInfos[i].sType        = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+            computeInfos[i].stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            computeInfos[i].stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+            computeInfos[i].stage.module = modules[i];
+            computeInfos[i].stage.pName  = "main";
+            computeInfos[i].layout       = scene->layout;
+        }
+    computeInfos[1].stage.pSpecializationInfo = &specialization;
+
+    VkPipeline computePipelines[3] = { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE };
+    if( VK_SUCCESS == result )
+        {
+            result = vkCreateComputePipelines( device, vGetPipelineCache(), 3, computeInfos, NULL, computePipelines );
+        }
+    scene->cullPipeline    = computePipelines[0];
+    scene->compactPipeline = computePipelines[1];
+    scene->pyramidPipeline = computePipelines[2];
+
+    // Drawing pipeline
+    //--------------------------------------------------------------
+    VkPipelineShaderStageCreateInfo stages[2] = { 0 };
+    for( int i = 0; i < 2; ++i )
+        {
+            stages[i].sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            stages[i].stage  = ( 0 == i ) ? VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_FRAGMENT_BIT;
+            stages[i].module = modules[3 + i];
+            stages[i].pName  = "main";
+        }
+
+    const VkVertexInputBindingDescription vertexBinding = { 0, sizeof( MeshVertex ), VK_VERTEX_INPUT_RATE_VERTEX };
+
+    const VkVertexInputAttributeDescription attributes[2] = {
+        { 0, 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof( MeshVertex, position ) },
+        { 1, 0, VK_FORMAT_R8G8B8A8_SNORM, offsetof( MeshVertex, normal ) },
+    };
+
+    VkPipelineVertexInputStateCreateInfo vertexInput = { 0 };
+    vertexInput.sType                                = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInput.vertexBindingDescriptionCount        = 1;
+    vertexInput.pVertexBindingDescriptions           = &vertexBinding;
+    vertexInput.vertexAttributeDescriptionCount      = 2;
+    vertexInput.pVertexAttributeDescriptions         = attributes;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly = { 0 };
+    inputAssembly.sType    = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo viewportState = { 0 };
+    viewportState.sType                             = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount                     = 1;
+    viewportState.scissorCount                      = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterization = { 0 };
+    rasterization.sType       = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterization.cullMode    = VK_CULL_MODE_BACK_BIT;
+    rasterization.frontFace   = VK_FRONT_FACE_CLOCKWISE; // Counter-clockwise once y points down
+    rasterization.lineWidth   = 1.0F;
+
+    VkPipelineMultisampleStateCreateInfo multisample = { 0 };
+    multisample.sType                                = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisample.rasterizationSamples                 = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil = { 0 };
+    depthStencil.sType            = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable  = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp   = VK_COMPARE_OP_LESS;
+
+    VkPipelineColorBlendAttachmentState blendAttachment = { 0 };
+    blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT
+                                   | VK_COLOR_COMPONENT_A_BIT;
+
+    VkPipelineColorBlendStateCreateInfo colorBlend = { 0 };
+    colorBlend.sType                               = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlend.attachmentCount                     = 1;
+    colorBlend.pAttachments                        = &blendAttachment;
+
+    const VkDynamicState dynamicStates[2] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+    VkPipelineDynamicStateCreateInfo dynamicState = { 0 };
+    dynamicState.sType                            = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount                = 2;
+    dynamicState.pDynamicStates                   = dynamicStates;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo = { 0 };
+    pipelineInfo.sType                        = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount                   = 2;
+    pipelineInfo.pStages                      = stages;
+    pipelineInfo.pVertexInputState            = &vertexInput;
+    pipelineInfo.pInputAssemblyState          = &inputAssembly;
+    pipelineInfo.pViewportState               = &viewportState;
+    pipelineInfo.pRasterizationState          = &rasterization;
+    pipelineInfo.pMultisampleState            = &multisample;
+    pipelineInfo.pDepthStencilState           = &depthStencil;
+    pipelineInfo.pColorBlendState             = &colorBlend;
+    pipelineInfo.pDynamicState                = &dynamicState;
+    pipelineInfo.layout                       = scene->layout;
+    pipelineInfo.renderPass                   = scene->renderPasses[0];
+    pipelineInfo.subpass                      = 0;
+
+    if( VK_SUCCESS == result )
+        {
+            result = vkCreateGraphicsPipelines( device, vGetPipelineCache(), 1, &pipelineInfo, NULL,
+                                                &scene->drawPipeline );
+        }
+
+    for( int i = 0; i < 5; ++i ) UnloadShaderModule( modules[i] );
+
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_WARNING, "SCENE: Failed to create the pipelines (%d)", (int)result );
+            return false;
+        }
+
+    return true;
+}
+
+// Create a render pass loading the target color, the depth is cleared or loaded and left readable by the pyramid
+static bool
+CreateSceneRenderPass( Scene * scene, VkAttachmentLoadOp depthLoad, VkRenderPass * renderPass )
+{
+    const bool clear = ( VK_ATTACHMENT_LOAD_OP_CLEAR == depthLoad );
+
+    VkAttachmentDescription attachments[2] = { 0 };
+    attachments[0].format                  = VVUL_TARGET_FORMAT;
+    attachments[0].samples                 = VK_SAMPLE_COUNT_1_BIT;
+    attachments[0].loadOp                  = VK_ATTACHMENT_LOAD_OP_LOAD;
+    attachments[0].storeOp                 = VK_ATTACHMENT_STORE_OP_STORE;
+    attachments[0].stencilLoadOp           = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[0].stencilStoreOp          = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[0].initialLayout           = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    attachments[0].finalLayout             = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    attachments[1].format                  = scene->depthFormat;
+    attachments[1].samples                 = VK_SAMPLE_COUNT_1_BIT;
+    attachments[1].loadOp                  = depthLoad;
+    attachments[1].storeOp                 = VK_ATTACHMENT_STORE_OP_STORE;
+    attachments[1].stencilLoadOp           = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[1].stencilStoreOp          = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[1].initialLayout = clear ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    attachments[1].finalLayout   = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+    const VkAttachmentReference colorReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+    const VkAttachmentReference depthReference = { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+    VkSubpassDescription subpass    = { 0 };
+    subpass.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount    = 1;
+    subpass.pColorAttachments       = &colorReference;
+    subpass.pDepthStencilAttachment = &depthReference;
+
+    // In: earlier color writes and the pyramid reads of the depth finish first. Out: the depth written is
+    // visible to the pyramid reduction
+    const VkPipelineStageFlags fragmentTests
+        = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    const VkAccessFlags depthAccess
+        = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    VkSubpassDependency dependencies[2] = { 0 };
+    dependencies[0].srcSubpass          = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass          = 0;
+    dependencies[0].srcStageMask        = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT
+                                 | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | fragmentTests;
+    dependencies[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | depthAccess;
+    dependencies[0].dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | fragmentTests;
+    dependencies[0].dstAccessMask
+        = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | depthAccess;
+    dependencies[1].srcSubpass    = 0;
+    dependencies[1].dstSubpass    = VK_SUBPASS_EXTERNAL;
+    dependencies[1].srcStageMask  = fragmentTests;
+    dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencies[1].dstStageMask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    VkRenderPassCreateInfo renderPassInfo = { 0 };
+    renderPassInfo.sType                  = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount        = 2;
+    renderPassInfo.pAttachments           = attachments;
+    renderPassInfo.subpassCount           = 1;
+    renderPassInfo.pSubpasses             = &subpass;
+    renderPassInfo.dependencyCount        = 2;
+    renderPassInfo.pDependencies          = dependencies;
+
+    const VkResult result = vkCreateRenderPass( vGetDevice(), &renderPassInfo, NULL, renderPass );
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_WARNING, "SCENE: Failed to create a render pass (%d)", (int)result );
+            return false;
+        }
+
+    return true;
+}
+
+// Create the depth buffer, the pyramid, their set and the framebuffer for the current render target, if it changed
+static bool
+PrepareSceneTarget( Scene * scene, VkCommandBuffer cmd )
+{
+    const VkDevice    device = vGetDevice();
+    const VkImageView view   = vGetTargetView();
+    const VkExtent2D  extent = vGetTargetExtent();
+    VkResult          result;
+
+    if( VK_NULL_HANDLE != scene->framebuffer && view == scene->targetView && extent.width == scene->extent.width
+        && extent.height == scene->extent.height )
+        {
+            return true;
+        }
+
+    RetireSceneTarget( scene );
+
+    // Depth buffer
+    //--------------------------------------------------------------
+    VkImageCreateInfo imageInfo = { 0 };
+    imageInfo.sType             = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType         = VK_IMAGE_TYPE_2D;
+    imageInfo.format            = scene->depthFormat;
+    imageInfo.extent.width      = extent.width;
+    imageInfo.extent.height     = extent.height;
+    imageInfo.extent.depth      = 1;
+    imageInfo.mipLevels         = 1;
+    imageInfo.arrayLayers       = 1;
+    imageInfo.samples           = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling            = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage             = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode       = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    result = vkCreateImage( device, &imageInfo, NULL, &scene->depthImage );
+    if( VK_SUCCESS == result
+        && !vAllocateImageMemory( scene->depthImage, VVUL_MEMORY_GPU_ONLY, &scene->depthMemory ) )
+        {
+            result = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+
+    VkImageViewCreateInfo viewInfo       = { 0 };
+    viewInfo.sType                       = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image                       = scene->depthImage;
+    viewInfo.viewType                    = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format                      = scene->depthFormat;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    if( VK_SUCCESS == result ) result = vkCreateImageView( device, &viewInfo, NULL, &scene->depthView );
+
+    const VkImageView framebufferViews[2] = { view, scene->depthView };
+
+    VkFramebufferCreateInfo framebufferInfo = { 0 };
+    framebufferInfo.sType                   = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass              = scene->renderPasses[0];
+    framebufferInfo.attachmentCount         = 2;
+    framebufferInfo.pAttachments            = framebufferViews;
+    framebufferInfo.width                   = extent.width;
+    framebufferInfo.height                  = extent.height;
+    framebufferInfo.layers                  = 1;
+
+    if( VK_SUCCESS == result ) result = vkCreateFramebuffer( device, &framebufferInfo, NULL, &scene->framebuffer );
+
+    // Pyramid: the depth size rounded down to powers of two, so every texel covers at most 3x3 depth texels
+    //--------------------------------------------------------------
+    VkExtent2D pyramidExtent = { 1, 1 };
+    while( pyramidExtent.width * 2 <= extent.width ) pyramidExtent.width *= 2;
+    while( pyramidExtent.height * 2 <= extent.height ) pyramidExtent.height *= 2;
+
+    const uint32_t side       = ( pyramidExtent.width > pyramidExtent.height ) ? pyramidExtent.width
+                                                                               : pyramidExtent.height;
+    uint32_t       levelCount = 1;
+    while( levelCount < SCENE_PYRAMID_LEVELS && ( 1U << levelCount ) <= side ) ++levelCount;
+
+    imageInfo.format        = VK_FORMAT_R32_SFLOAT;
+    imageInfo.extent.width  = pyramidExtent.width;
+    imageInfo.extent.height = pyramidExtent.height;
+    imageInfo.mipLevels     = levelCount;
+    imageInfo.usage         = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+    if( VK_SUCCESS == result ) result = vkCreateImage( device, &imageInfo, NULL, &scene->pyramid );
+    if( VK_SUCCESS == result && !vAllocateImageMemory( scene->pyramid, VVUL_MEMORY_GPU_ONLY, &scene->pyramidMemory ) )
+        {
+            result = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+
+    viewInfo.image                       = scene->pyramid;
+    viewInfo.format                      = VK_FORMAT_R32_SFLOAT;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.levelCount = levelCount;
+
+    if( VK_SUCCESS == result ) result = vkCreateImageView( device, &viewInfo, NULL, &scene->pyramidView );
+
+    viewInfo.subresourceRange.levelCount = 1;
+    for( uint32_t i = 0; VK_SUCCESS == result && i < levelCount; ++i )
+        {
+            viewInfo.subresourceRange.baseMipLevel = i;
+            result = vkCreateImageView( device, &viewInfo, NULL, &scene->pyramidLevels[i] );
+            if( VK_SUCCESS == result ) scene->pyramidLevelCount = i + 1;
+        }
+
+    // Target set
+    //--------------------------------------------------------------
+    VkDescriptorSetAllocateInfo allocateInfo = { 0 };
+    allocateInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorPool              = scene->targetPool;
+    allocateInfo.descriptorSetCount          = 1;
+    allocateInfo.pSetLayouts                 = &scene->targetSetLayout;
+
+    if( VK_SUCCESS == result ) result = vkAllocateDescriptorSets( device, &allocateInfo, &scene->targetSet.set );
+
+    if( VK_SUCCESS != result )
+        {
+            // Retried the next frame drawing the scene
+            TRACELOG( LOG_WARNING, "SCENE: Failed to create the depth buffer (%d), scene not drawn", (int)result );
+            RetireSceneTarget( scene );
+            return false;
+        }
+
+    scene->targetSet.pool = scene->targetPool;
+
+    // Levels past the last repeat it, every array element must be valid
+    VkDescriptorImageInfo imageInfos[2 + SCENE_PYRAMID_LEVELS] = { 0 };
+    imageInfos[0].sampler     = scene->sampler;
+    imageInfos[0].imageView   = scene->depthView;
+    imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    imageInfos[1].sampler     = scene->sampler;
+    imageInfos[1].imageView   = scene->pyramidView;
+    imageInfos[1].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    for( uint32_t i = 0; i < SCENE_PYRAMID_LEVELS; ++i )
+        {
+            imageInfos[2 + i].imageView   = scene->pyramidLevels[( i < levelCount ) ? i : levelCount - 1];
+            imageInfos[2 + i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        }
+
+    const uint32_t       writeBindings[3] = { 0, 2, 1 };
+    VkWriteDescriptorSet writes[3]        = { 0 };
+    for( uint32_t i = 0; i < 3; ++i )
+        {
+            writes[i].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet          = scene->targetSet.set;
+            writes[i].dstBinding      = writeBindings[i];
+            writes[i].descriptorCount = ( 2 == i ) ? SCENE_PYRAMID_LEVELS : 1;
+            writes[i].descriptorType  = ( 2 == i ) ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+                                                   : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writes[i].pImageInfo      = &imageInfos[i];
+        }
+
+    vkUpdateDescriptorSets( device, 3, writes, 0, NULL );
+
+    // The pyramid stays in the general layout, written and fetched by compute only
+    VkImageMemoryBarrier barrier        = { 0 };
+    barrier.sType                       = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.dstAccessMask               = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.oldLayout                   = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout                   = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image                       = scene->pyramid;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = levelCount;
+    barrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier( cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0,
+                          NULL, 1, &barrier );
+
+    scene->targetView    = view;
+    scene->extent        = extent;
+    scene->pyramidExtent = pyramidExtent;
+
+    return true;
+}
+
+// Retire the depth buffer, the pyramid, their set and the framebuffer, frames in flight may still use them
+static void
+RetireSceneTarget( Scene * scene )
+{
+    if( VK_NULL_HANDLE != scene->targetSet.set ) vDeferDestroy( VVUL_GARBAGE_DESCRIPTOR_SET, &scene->targetSet );
+    if( VK_NULL_HANDLE != scene->framebuffer ) vDeferDestroy( VVUL_GARBAGE_FRAMEBUFFER, &scene->framebuffer );
+    vDeferDestroyImage( scene->depthImage, &scene->depthView, 1, &scene->depthMemory );
+
+    // The pyramid and all of its views go as one entry, resizes retire a single image per target
+    VkImageView pyramidViews[1 + SCENE_PYRAMID_LEVELS] = { VK_NULL_HANDLE };
+    pyramidViews[0]                                    = scene->pyramidView;
+    for( uint32_t i = 0; i < scene->pyramidLevelCount; ++i )
+        {
+            pyramidViews[1 + i]     = scene->pyramidLevels[i];
+            scene->pyramidLevels[i] = VK_NULL_HANDLE;
+        }
+    vDeferDestroyImage( scene->pyramid, pyramidViews, 1 + scene->pyramidLevelCount, &scene->pyramidMemory );
+
+    memset( &scene->targetSet, 0, sizeof( vvulPooledSet ) );
+    scene->framebuffer       = VK_NULL_HANDLE;
+    scene->depthView         = VK_NULL_HANDLE;
+    scene->depthImage        = VK_NULL_HANDLE;
+    scene->targetView        = VK_NULL_HANDLE;
+    scene->pyramidView       = VK_NULL_HANDLE;
+    scene->pyramid           = VK_NULL_HANDLE;
+    scene->pyramidLevelCount = 0;
+    memset( &scene->depthMemory, 0, sizeof( vvulAllocation ) );
+    memset( &scene->pyramidMemory, 0, sizeof( vvulAllocation ) );
+}
+
+// Record the copies of the changed instances and mesh records, then reset the counters
+static bool
+StageSceneUpdates( Scene * scene, VkCommandBuffer cmd )
+{
+    const uint64_t frame = vGetFrameNumber();
+
+    // Buckets follow the instance counts, records of meshes still uploading cull their instances
+    if( scene->meshesDirty || 0 < scene->pendingMeshes )
+        {
+            uint32_t base = 0;
+
+            scene->pendingMeshes = 0;
+            for( uint32_t i = 0; i < scene->meshCount; ++i )
+                {
+                    const SceneMeshInfo * info  = &scene->meshInfos[i];
+                    const bool            ready = ( frame >= info->readyFrame );
+
+                    scene->meshes[i].instanceBase = base;
+                    scene->meshes[i].indexCount   = ready ? info->indexCount : 0;
+                    scene->pendingMeshes += ready ? 0 : 1;
+                    base += info->instanceCount;
+                }
+
+            scene->meshesDirty = true;
+        }
+
+    const uint32_t     dirty
+        = ( scene->dirtyFirst < scene->dirtyEnd ) ? scene->dirtyEnd - scene->dirtyFirst : 0;
+    const VkDeviceSize meshBytes     = scene->meshesDirty ? scene->meshCount * sizeof( SceneMesh ) : 0;
+    const VkDeviceSize instanceBytes = (VkDeviceSize)dirty * sizeof( SceneInstance );
+
+    // Previous reads and writes of the scene buffers, by earlier frames or draws, end before they are rewritten
+    CmdSceneBarrier( cmd,
+                     VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+                         | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                     VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                     VK_ACCESS_TRANSFER_WRITE_BIT );
+
+    if( 0 < meshBytes + instanceBytes )
+        {
+            SceneStaging * staging = &scene->staging[vGetFrameIndex()];
+            if( frame != staging->frame ) staging->used = 0;
+            staging->frame = frame;
+
+            // Grown buffers are retired, copies already recorded in the frame still read the old one
+            if( staging->size - staging->used < meshBytes + instanceBytes )
+                {
+                    VkDeviceSize size = SCENE_STAGING_BLOCK;
+                    while( size < meshBytes + instanceBytes ) size *= 2;
+
+                    if( VK_NULL_HANDLE != staging->buffer ) vDeferDestroy( VVUL_GARBAGE_BUFFER, &staging->buffer );
+                    vDeferFreeMemory( &staging->memory );
+                    memset( staging, 0, sizeof( SceneStaging ) );
+                    staging->frame = frame;
+
+                    VkBufferCreateInfo bufferInfo = { 0 };
+                    bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+                    bufferInfo.size               = size;
+                    bufferInfo.usage              = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+                    bufferInfo.sharingMode        = VK_SHARING_MODE_EXCLUSIVE;
+
+                    if( VK_SUCCESS != vkCreateBuffer( vGetDevice(), &bufferInfo, NULL, &staging->buffer )
+                        || !vAllocateBufferMemory( staging->buffer, VVUL_MEMORY_CPU_TO_GPU, &staging->memory )
+                        || NULL == staging->memory.mapped )
+                        {
+                            TRACELOG( LOG_WARNING, "SCENE: Failed to allocate %llu staging bytes, scene not drawn",
+                                      (unsigned long long)size );
+                            vkDestroyBuffer( vGetDevice(), staging->buffer, NULL );
+                            vFreeMemory( &staging->memory );
+                            memset( staging, 0, sizeof( SceneStaging ) );
+                            return false;
+                        }
+
+                    staging->size = size;
+                }
+
+            unsigned char * mapped = (unsigned char *)staging->memory.mapped + staging->used;
+            VkBufferCopy    region = { staging->used, 0, 0 };
+
+            if( 0 < meshBytes )
+                {
+                    memcpy( mapped, scene->meshes, (size_t)meshBytes );
+                    region.size = meshBytes;
+                    vkCmdCopyBuffer( cmd, staging->buffer, scene->buffers[SCENE_BUFFER_MESHES], 1, &region );
+                    region.srcOffset += meshBytes;
+                }
+
+            if( 0 < instanceBytes )
+                {
+                    memcpy( mapped + meshBytes, &scene->instances[scene->dirtyFirst], (size_t)instanceBytes );
+                    region.dstOffset = (VkDeviceSize)scene->dirtyFirst * sizeof( SceneInstance );
+                    region.size      = instanceBytes;
+                    vkCmdCopyBuffer( cmd, staging->buffer, scene->buffers[SCENE_BUFFER_INSTANCES], 1, &region );
+                }
+
+            staging->used += meshBytes + instanceBytes;
+        }
+
+    scene->meshesDirty = false;
+    scene->dirtyFirst  = 0;
+    scene->dirtyEnd    = 0;
+
+    // Every instance starts hidden: the first early phase draws nothing, the late one draws what it sees
+    if( !scene->flagsCleared )
+        {
+            vkCmdFillBuffer( cmd, scene->buffers[SCENE_BUFFER_FLAGS], 0, VK_WHOLE_SIZE, 0 );
+            scene->flagsCleared = true;
+        }
+
+    vkCmdFillBuffer( cmd, scene->buffers[SCENE_BUFFER_COUNTERS], 0, ( 2 + scene->meshCount ) * sizeof( uint32_t ), 0 );
+
+    CmdSceneBarrier( cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                     VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT );
+
+    return true;
+}
+
+// Draw callback, from EndDrawing() outside of any render pass. With occlusion culling, the instances visible last
+// frame are drawn first, the pyramid is reduced from their depth, then the rest is tested against it and drawn
+static void
+RecordScene( VkCommandBuffer cmd, void * user, const float * viewProjection )
+{
+    Scene * scene = (Scene *)user;
+
+    if( 0 == scene->instanceCount || !PrepareSceneTarget( scene, cmd ) || !StageSceneUpdates( scene, cmd ) ) return;
+
+    const VkDescriptorSet sets[2] = { scene->set, scene->targetSet.set };
+    vkCmdBindDescriptorSets( cmd, VK_PIPELINE_BIND_POINT_COMPUTE, scene->layout, 0, 2, sets, 0, NULL );
+
+    CmdCullScene( scene, cmd, viewProjection, scene->occlusion ? SCENE_PHASE_EARLY : SCENE_PHASE_FRUSTUM );
+    CmdDrawSceneBuckets( scene, cmd, viewProjection, true );
+
+    if( !scene->occlusion ) return;
+
+    CmdBuildPyramid( scene, cmd );
+
+    // The early draws are done with the counters and the records before they are reset
+    CmdSceneBarrier( cmd,
+                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT
+                         | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                     0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT );
+    vkCmdFillBuffer( cmd, scene->buffers[SCENE_BUFFER_COUNTERS], 0, ( 2 + scene->meshCount ) * sizeof( uint32_t ), 0 );
+    CmdSceneBarrier( cmd, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                     VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                     VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT );
+
+    CmdCullScene( scene, cmd, viewProjection, SCENE_PHASE_LATE );
+    CmdDrawSceneBuckets( scene, cmd, viewProjection, false );
+}
+
+// Record the culling of a phase and the compaction of its buckets into draw records
+static void
+CmdCullScene( Scene * scene, VkCommandBuffer cmd, const float * viewProjection, ScenePhase phase )
+{
+    ScenePushCull cull = { 0 };
+    memcpy( cull.viewProjection, viewProjection, sizeof( cull.viewProjection ) );
+    cull.instanceCount = scene->instanceCount;
+    cull.meshCount     = scene->meshCount;
+    cull.phase         = (uint32_t)phase;
+
+    vkCmdPushConstants( cmd, scene->layout, SCENE_PUSH_STAGES, 0, sizeof( cull ), &cull );
+
+    vkCmdBindPipeline( cmd, VK_PIPELINE_BIND_POINT_COMPUTE, scene->cullPipeline );
+    vkCmdDispatch( cmd, ( scene->instanceCount + SCENE_GROUP_SIZE - 1 ) / SCENE_GROUP_SIZE, 1, 1 );
+
+    CmdSceneBarrier( cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT );
+
+    vkCmdBindPipeline( cmd, VK_PIPELINE_BIND_POINT_COMPUTE, scene->compactPipeline );
+    vkCmdDispatch( cmd, ( scene->meshCount + SCENE_GROUP_SIZE - 1 ) / SCENE_GROUP_SIZE, 1, 1 );
+
+    CmdSceneBarrier( cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                     VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                     VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT );
+}
+
+// Record the draws of the compacted buckets, in the pass clearing the depth or in the one keeping it
+static void
+CmdDrawSceneBuckets( Scene * scene, VkCommandBuffer cmd, const float * viewProjection, bool clearDepth )
+{
+    const VkExtent2D extent = scene->extent;
+
+    VkClearValue clears[2]       = { 0 };
+    clears[1].depthStencil.depth = 1.0F; // The target color is loaded, its clear value is unused
+
+    VkRenderPassBeginInfo beginInfo = { 0 };
+    beginInfo.sType                 = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    beginInfo.renderPass            = scene->renderPasses[clearDepth ? 0 : 1];
+    beginInfo.framebuffer           = scene->framebuffer;
+    beginInfo.renderArea.extent     = extent;
+    beginInfo.clearValueCount       = 2;
+    beginInfo.pClearValues          = clears;
+
+    vkCmdBeginRenderPass( cmd, &beginInfo, VK_SUBPASS_CONTENTS_INLINE );
+    vkCmdBindPipeline( cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, scene->drawPipeline );
+    vkCmdBindDescriptorSets( cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, scene->layout, 0, 1, &scene->set, 0, NULL );
+
+    const VkViewport viewport = { 0.0F, 0.0F, (float)extent.width, (float)extent.height, 0.0F, 1.0F };
+    const VkRect2D   scissor  = { { 0, 0 }, extent };
+    vkCmdSetViewport( cmd, 0, 1, &viewport );
+    vkCmdSetScissor( cmd, 0, 1, &scissor );
+
+    const VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers( cmd, 0, 1, &scene->buffers[SCENE_BUFFER_VERTICES], &offset );
+    vkCmdBindIndexBuffer( cmd, scene->buffers[SCENE_BUFFER_INDICES], 0, VK_INDEX_TYPE_UINT32 );
+
+    ScenePushDraw push = { 0 };
+    memcpy( push.viewProjection, viewProjection, sizeof( push.viewProjection ) );
+    vkCmdPushConstants( cmd, scene->layout, SCENE_PUSH_STAGES, 0, sizeof( push ), &push );
+
+    const VkBuffer commands = scene->buffers[SCENE_BUFFER_COMMANDS];
+    const uint32_t stride   = sizeof( VkDrawIndexedIndirectCommand );
+
+    if( SCENE_DRAW_COUNT == scene->drawMode )
+        {
+            vkCmdDrawIndexedIndirectCount( cmd, commands, 0, scene->buffers[SCENE_BUFFER_COUNTERS], 0,
+                                           scene->meshCount, stride );
+        }
+    else if( SCENE_DRAW_MULTI == scene->drawMode )
+        {
+            vkCmdDrawIndexedIndirect( cmd, commands, 0, scene->meshCount, stride );
+        }
+    else
+        {
+            // firstInstance must stay 0 without the feature, the bucket offset is pushed instead
+            for( uint32_t i = 0; i < scene->meshCount; ++i )
+                {
+                    if( 0 == scene->meshes[i].indexCount || 0 == scene->meshInfos[i].instanceCount ) continue;
+
+                    push.base = scene->meshes[i].instanceBase;
+                    vkCmdPushConstants( cmd, scene->layout, SCENE_PUSH_STAGES, offsetof( ScenePushDraw, base ),
+                                        sizeof( uint32_t ), &push.base );
+                    vkCmdDrawIndexedIndirect( cmd, commands, (VkDeviceSize)i * stride, 1, stride );
+                }
+        }
+
+    vkCmdEndRenderPass( cmd );
+}
+
+// Record the reduction of the depth into the pyramid, one workgroup per 32x32 texels of its first level
+static void
+CmdBuildPyramid( Scene * scene, VkCommandBuffer cmd )
+{
+    ScenePushPyramid push = { 0 };
+    push.depthSize[0]     = scene->extent.width;
+    push.depthSize[1]     = scene->extent.height;
+    push.size[0]          = scene->pyramidExtent.width;
+    push.size[1]          = scene->pyramidExtent.height;
+    push.levelCount       = scene->pyramidLevelCount;
+
+    const uint32_t groupsX = ( scene->pyramidExtent.width + 31 ) / 32;
+    const uint32_t groupsY = ( scene->pyramidExtent.height + 31 ) / 32;
+    push.groupCount        = groupsX * groupsY;
+
+    vkCmdPushConstants( cmd, scene->layout, SCENE_PUSH_STAGES, 0, sizeof( push ), &push );
+    vkCmdBindPipeline( cmd, VK_PIPELINE_BIND_POINT_COMPUTE, scene->pyramidPipeline );
+    vkCmdDispatch( cmd, groupsX, groupsY, 1 );
+}
+
+// Global memory barrier between two uses of the scene buffers
+static void
+CmdSceneBarrier( VkCommandBuffer cmd, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess,
+                 VkPipelineStageFlags dstStage, VkAccessFlags dstAccess )
+{
+    VkMemoryBarrier barrier = { 0 };
+    barrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask   = srcAccess;
+    barrier.dstAccessMask   = dstAccess;
+
+    vkCmdPipelineBarrier( cmd, srcStage, dstStage, 0, 1, &barrier, 0, NULL, 0, NULL );
+}
+
+// Extend the range of instances copied to the GPU by the next frame
+static void
+MarkInstancesDirty( Scene * scene, uint32_t first, uint32_t end )
+{
+    if( scene->dirtyFirst >= scene->dirtyEnd )
+        {
+            scene->dirtyFirst = first;
+            scene->dirtyEnd   = end;
+            return;
+        }
+
+    if( first < scene->dirtyFirst ) scene->dirtyFirst = first;
+    if( end > scene->dirtyEnd ) scene->dirtyEnd = end;
+}
+
+// Pack a normalized color into RGBA8
+static uint32_t
+PackSceneColor( Color color )
+{
+    const float components[4] = { color.r, color.g, color.b, color.a };
+    uint32_t    packed        = 0;
+
+    for( int i = 0; i < 4; ++i )
+        {
+            const float c = ( components[i] < 0.0F ) ? 0.0F : ( 1.0F < components[i] ) ? 1.0F : components[i];
+            packed |= (uint32_t)( c * 255.0F + 0.5F ) << ( 8 * i );
+        }
+
+    return packed;
+}
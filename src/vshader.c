@@ -0,0 +1,570 @@
+/******************************* VSHADER *********************************
+ * vshader: GLSL/HLSL to SPIR-V compilation with a persistent cache
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - Every shader is preprocessed first: the preprocessed text already contains the includes and
+ *   the expanded defines, so hashing it catches every input that can change the SPIR-V. Only
+ *   cache misses pay for the full compilation.
+ * - Cache files are written to a temporary name and renamed, concurrent instances never read a
+ *   partial binary; truncated or corrupt entries fail their checksum and are recompiled.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#include "vultra/vshader.h"
+#include "vultra/vultra.h"
+#include "vultra/vutils.h"
+
+#include "vcore_context.h"
+
+#include "vultra/vvul.h"
+
+#include <shaderc/shaderc.h>
+
+#include <stdio.h>  /* fopen, snprintf */
+#include <string.h> /* memcpy, strlen */
+
+#if defined( _WIN32 )
+#    include <process.h> /* _getpid */
+#    define PROCESS_ID() _getpid()
+// Declared manually to avoid pulling <windows.h> and its symbol clashes (CloseWindow, ...)
+__declspec( dllimport ) int __stdcall MoveFileExA( const char * existing, const char * replacement, unsigned long flags );
+#else
+#    include <unistd.h> /* getpid */
+#    define PROCESS_ID() getpid()
+#endif
+
+#define SHADER_CACHE_MAGIC  0x50535656U // "VVSP"
+#define SHADER_CACHE_FORMAT 1           // Bumped whenever ShaderCacheHeader changes
+#define SHADER_PATH_MAX     ( CACHE_PATH_MAX + 64 )
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Prefix of every cache entry
+typedef struct ShaderCacheHeader
+{
+    uint32_t magic;    // SHADER_CACHE_MAGIC
+    uint32_t format;   // SHADER_CACHE_FORMAT
+    uint64_t key[2];   // Key the entry was stored under, guards against hash file name collisions
+    uint64_t size;     // Bytes of SPIR-V following the header
+    uint64_t checksum; // FNV-1a of the SPIR-V
+} ShaderCacheHeader;
+
+// Shared by the jobs of a CompileShaders() call
+typedef struct ShaderBatch
+{
+    const ShaderDesc * descs;
+    ShaderCode *       codes;
+    bool *             cached; // Was the entry loaded from the cache?
+} ShaderBatch;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Variables Definition
+//----------------------------------------------------------------------------------------------------------------------
+extern CoreContext core;
+
+static shaderc_compiler_t compiler = NULL; // Thread-safe, shared by every job
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Declaration
+//----------------------------------------------------------------------------------------------------------------------
+void CloseShaders( void ); // Release the compiler
+
+static void       CompileShaderJob( void * user, int index );
+static ShaderCode CompileShaderCached( const ShaderDesc * desc, int index, bool * cached );
+static bool       InitCompiler( void );
+
+static shaderc_compile_options_t CreateCompileOptions( const ShaderDesc * desc );
+static shaderc_include_result *  ResolveInclude( void * user, const char * requested, int type, const char * requesting,
+                                                 size_t depth );
+static void                      ReleaseInclude( void * user, shaderc_include_result * result );
+
+static uint64_t HashBytes( const void * data, size_t size, uint64_t hash );
+static char *   ReadTextFile( const char * path, size_t * size );
+static bool     LoadCacheEntry( const char * path, const uint64_t key[2], ShaderCode * code );
+static void     StoreCacheEntry( const char * path, const uint64_t key[2], const ShaderCode * code, int index );
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Compilation
+//----------------------------------------------------------------------------------------------------------------------
+// Compile a shader to SPIR-V, loading it from the cache when its inputs did not change
+ShaderCode
+CompileShader( const ShaderDesc * desc )
+{
+    ShaderCode code = { 0 };
+    CompileShaders( desc, 1, &code );
+
+    return code;
+}
+
+// Compile shaders across the job workers, returns how many succeeded (failed entries have a NULL code)
+int
+CompileShaders( const ShaderDesc * descs, int count, ShaderCode * codes )
+{
+    if( 0 >= count ) return 0;
+
+    memset( codes, 0, (size_t)count * sizeof( ShaderCode ) );
+    if( !InitCompiler() ) return 0;
+
+    ShaderBatch batch = { descs, codes, (bool *)VUL_CALLOC( (size_t)count, sizeof( bool ) ) };
+    if( NULL == batch.cached ) return 0;
+
+    const double start = GetTime();
+    ParallelFor( count, CompileShaderJob, &batch );
+
+    int compiled = 0;
+    int cached   = 0;
+    for( int i = 0; i < count; ++i )
+        {
+            if( NULL != codes[i].code ) ++compiled;
+            if( batch.cached[i] ) ++cached;
+        }
+
+    TRACELOG( LOG_INFO, "SHADER: %d/%d shaders ready in %.1f ms (%d cached, %d compiled)", compiled, count,
+              ( GetTime() - start ) * 1000.0, cached, compiled - cached );
+
+    VUL_FREE( batch.cached );
+
+    return compiled;
+}
+
+// Unload a SPIR-V binary
+void
+UnloadShaderCode( ShaderCode code )
+{
+    VUL_FREE( code.code );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Shader modules
+//----------------------------------------------------------------------------------------------------------------------
+// Compile a shader and create its module, VK_NULL_HANDLE on failure
+VkShaderModule
+LoadShaderModule( const ShaderDesc * desc )
+{
+    VkShaderModule module = VK_NULL_HANDLE;
+    LoadShaderModules( desc, 1, &module );
+
+    return module;
+}
+
+// Compile shaders in parallel and create their modules, returns how many were created
+int
+LoadShaderModules( const ShaderDesc * descs, int count, VkShaderModule * modules )
+{
+    if( 0 >= count ) return 0;
+
+    ShaderCode * codes  = (ShaderCode *)VUL_CALLOC( (size_t)count, sizeof( ShaderCode ) );
+    int          loaded = 0;
+
+    if( NULL != codes ) CompileShaders( descs, count, codes );
+
+    for( int i = 0; i < count; ++i )
+        {
+            modules[i] = VK_NULL_HANDLE;
+            if( NULL == codes || NULL == codes[i].code ) continue;
+
+            VkShaderModuleCreateInfo moduleInfo = { 0 };
+            moduleInfo.sType                    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+            moduleInfo.codeSize                 = codes[i].size;
+            moduleInfo.pCode                    = codes[i].code;
+
+            const VkResult result = vkCreateShaderModule( vGetDevice(), &moduleInfo, NULL, &modules[i] );
+            if( VK_SUCCESS == result ) ++loaded;
+            else TRACELOG( LOG_WARNING, "SHADER: [%s] Failed to create shader module", descs[i].path );
+
+            UnloadShaderCode( codes[i] );
+        }
+
+    VUL_FREE( codes );
+
+    return loaded;
+}
+
+// Destroy a shader module, pipelines created from it stay valid
+void
+UnloadShaderModule( VkShaderModule module )
+{
+    vkDestroyShaderModule( vGetDevice(), module, NULL );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Core
+//----------------------------------------------------------------------------------------------------------------------
+void
+CloseShaders( void )
+{
+    if( NULL != compiler ) shaderc_compiler_release( compiler );
+    compiler = NULL;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Job: compile one shader of a batch
+static void
+CompileShaderJob( void * user, int index )
+{
+    ShaderBatch * batch = (ShaderBatch *)user;
+
+    batch->codes[index] = CompileShaderCached( &batch->descs[index], index, &batch->cached[index] );
+}
+
+// Preprocess, look the result up in the cache and compile on a miss
+static ShaderCode
+CompileShaderCached( const ShaderDesc * desc, int index, bool * cached )
+{
+    static const shaderc_shader_kind kinds[] = { shaderc_vertex_shader,       shaderc_fragment_shader,
+                                                 shaderc_compute_shader,      shaderc_geometry_shader,
+                                                 shaderc_tess_control_shader, shaderc_tess_evaluation_shader };
+
+    ShaderCode   code       = { 0 };
+    const char * name       = STR_NONEMPTY( desc->path ) ? desc->path : "shader";
+    const char * entryPoint = STR_NONEMPTY( desc->entryPoint ) ? desc->entryPoint : "main";
+    char *       loaded     = NULL;
+    const char * source     = desc->source;
+    size_t       sourceSize = ( NULL != source ) ? strlen( source ) : 0;
+
+    *cached = false;
+
+    if( (unsigned int)desc->stage >= sizeof( kinds ) / sizeof( kinds[0] ) )
+        {
+            TRACELOG( LOG_WARNING, "SHADER: [%s] Invalid shader stage (%d)", name, (int)desc->stage );
+            return code;
+        }
+
+    if( NULL == source )
+        {
+            loaded = ReadTextFile( name, &sourceSize );
+            source = loaded;
+            if( NULL == source )
+                {
+                    TRACELOG( LOG_WARNING, "SHADER: [%s] Failed to read shader source", name );
+                    return code;
+                }
+        }
+
+    shaderc_compile_options_t options = CreateCompileOptions( desc );
+    if( NULL == options )
+        {
+            VUL_FREE( loaded );
+            return code;
+        }
+
+    // Key: preprocessed text, then everything that changes the output without changing the text
+    //--------------------------------------------------------------
+    shaderc_compilation_result_t result = shaderc_compile_into_preprocessed_text(
+        compiler, source, sourceSize, kinds[desc->stage], name, entryPoint, options );
+
+    if( shaderc_compilation_status_success != shaderc_result_get_compilation_status( result ) )
+        {
+            TRACELOG( LOG_WARNING, "SHADER: [%s] Preprocessing failed:\n%s", name,
+                      shaderc_result_get_error_message( result ) );
+            shaderc_result_release( result );
+            shaderc_compile_options_release( options );
+            VUL_FREE( loaded );
+            return code;
+        }
+
+    unsigned int spvVersion  = 0;
+    unsigned int spvRevision = 0;
+    shaderc_get_spv_version( &spvVersion, &spvRevision );
+
+    const uint32_t parameters[] = { SHADER_CACHE_FORMAT, (uint32_t)desc->stage, (uint32_t)desc->language,
+                                    (uint32_t)desc->optimize, (uint32_t)desc->debugInfo, spvVersion, spvRevision };
+
+    // Two differently seeded hashes, a 128-bit key keeps accidental collisions out of reach
+    uint64_t key[2] = { 14695981039346656037ULL, 0x6c62272e07bb0142ULL };
+    for( int k = 0; k < 2; ++k )
+        {
+            key[k] = HashBytes( shaderc_result_get_bytes( result ), shaderc_result_get_length( result ), key[k] );
+            key[k] = HashBytes( entryPoint, strlen( entryPoint ) + 1, key[k] );
+            key[k] = HashBytes( parameters, sizeof( parameters ), key[k] );
+            for( int d = 0; d < desc->defineCount; ++d )
+                {
+                    const ShaderDefine * define = &desc->defines[d];
+                    key[k]                      = HashBytes( define->name, strlen( define->name ) + 1, key[k] );
+                    if( NULL != define->value ) key[k] = HashBytes( define->value, strlen( define->value ), key[k] );
+                }
+        }
+
+    shaderc_result_release( result );
+
+    char cachePath[SHADER_PATH_MAX] = { 0 };
+    if( '\0' != core.graphics.cachePath[0] )
+        {
+            snprintf( cachePath, sizeof( cachePath ), "%s/%016llx%016llx.spv", core.graphics.cachePath,
+                      (unsigned long long)key[0], (unsigned long long)key[1] );
+        }
+
+    // Cache hit
+    //--------------------------------------------------------------
+    if( '\0' != cachePath[0] && LoadCacheEntry( cachePath, key, &code ) )
+        {
+            *cached = true;
+        }
+    else
+        {
+            result = shaderc_compile_into_spv( compiler, source, sourceSize, kinds[desc->stage], name, entryPoint,
+                                               options );
+
+            if( shaderc_compilation_status_success == shaderc_result_get_compilation_status( result ) )
+                {
+                    code.size = shaderc_result_get_length( result );
+                    code.code = (uint32_t *)VUL_MALLOC( code.size );
+                    if( NULL != code.code ) memcpy( code.code, shaderc_result_get_bytes( result ), code.size );
+                    else code.size = 0;
+
+                    if( NULL != code.code && '\0' != cachePath[0] ) StoreCacheEntry( cachePath, key, &code, index );
+                }
+            else
+                {
+                    TRACELOG( LOG_WARNING, "SHADER: [%s] Compilation failed:\n%s", name,
+                              shaderc_result_get_error_message( result ) );
+                }
+
+            shaderc_result_release( result );
+        }
+
+    shaderc_compile_options_release( options );
+    VUL_FREE( loaded );
+
+    return code;
+}
+
+// Create the shared compiler, on the calling thread before any job uses it
+static bool
+InitCompiler( void )
+{
+    if( NULL == compiler ) compiler = shaderc_compiler_initialize();
+    if( NULL == compiler ) TRACELOG( LOG_ERROR, "SHADER: Failed to initialize shaderc" );
+
+    return ( NULL != compiler );
+}
+
+// Translate a shader description into shaderc options, every option must also be part of the cache key
+static shaderc_compile_options_t
+CreateCompileOptions( const ShaderDesc * desc )
+{
+    shaderc_compile_options_t options = shaderc_compile_options_initialize();
+    if( NULL == options ) return NULL;
+
+    shaderc_compile_options_set_source_language(
+        options, ( SHADER_LANGUAGE_HLSL == desc->language ) ? shaderc_source_language_hlsl : shaderc_source_language_glsl );
+    shaderc_compile_options_set_target_env( options, shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_0 );
+    shaderc_compile_options_set_optimization_level(
+        options, desc->optimize ? shaderc_optimization_level_performance : shaderc_optimization_level_zero );
+    if( desc->debugInfo ) shaderc_compile_options_set_generate_debug_info( options );
+
+    for( int i = 0; i < desc->defineCount; ++i )
+        {
+            const ShaderDefine * define = &desc->defines[i];
+            shaderc_compile_options_add_macro_definition( options, define->name, strlen( define->name ), define->value,
+                                                          ( NULL != define->value ) ? strlen( define->value ) : 0 );
+        }
+
+    shaderc_compile_options_set_include_callbacks( options, ResolveInclude, ReleaseInclude, (void *)desc );
+
+    return options;
+}
+
+// Read an included file: relative includes next to the including file, standard ones from the include directory
+static shaderc_include_result *
+ResolveInclude( void * user, const char * requested, int type, const char * requesting, size_t depth )
+{
+    const ShaderDesc * desc = (const ShaderDesc *)user;
+    char               path[SHADER_PATH_MAX];
+    size_t             contentSize = 0;
+
+    UNUSED( depth );
+
+    if( shaderc_include_type_standard == type && STR_NONEMPTY( desc->includeDirectory ) )
+        {
+            snprintf( path, sizeof( path ), "%s/%s", desc->includeDirectory, requested );
+        }
+    else
+        {
+            // Directory of the including file, kept with its trailing separator
+            size_t directory = strlen( requesting );
+            while( 0 < directory && '/' != requesting[directory - 1] && '\\' != requesting[directory - 1] ) --directory;
+            snprintf( path, sizeof( path ), "%.*s%s", (int)directory, requesting, requested );
+        }
+
+    char * content = ReadTextFile( path, &contentSize );
+
+    // Failures are reported through an empty source name with the error message as content
+    const char * message  = "Include file not found";
+    const size_t nameSize = ( NULL != content ) ? strlen( path ) : 0;
+    if( NULL == content ) contentSize = strlen( message );
+
+    shaderc_include_result * result
+        = (shaderc_include_result *)VUL_MALLOC( sizeof( shaderc_include_result ) + nameSize + 1 );
+    if( NULL == result )
+        {
+            VUL_FREE( content );
+            return NULL;
+        }
+
+    char * name = (char *)( result + 1 );
+    memcpy( name, path, nameSize );
+    name[nameSize] = '\0';
+
+    result->source_name        = name;
+    result->source_name_length = nameSize;
+    result->content            = ( NULL != content ) ? content : message;
+    result->content_length     = contentSize;
+    result->user_data          = content;
+
+    return result;
+}
+
+// Release an include resolved by ResolveInclude()
+static void
+ReleaseInclude( void * user, shaderc_include_result * result )
+{
+    UNUSED( user );
+
+    if( NULL == result ) return;
+
+    VUL_FREE( result->user_data );
+    VUL_FREE( result );
+}
+
+// 64-bit FNV-1a, continues from hash
+static uint64_t
+HashBytes( const void * data, size_t size, uint64_t hash )
+{
+    const unsigned char * bytes = (const unsigned char *)data;
+
+    for( size_t i = 0; i < size; ++i )
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+
+    return hash;
+}
+
+// Read a whole file, NUL terminated, the returned memory must be released with VUL_FREE
+static char *
+ReadTextFile( const char * path, size_t * size )
+{
+    FILE * file = fopen( path, "rb" );
+    char * text = NULL;
+    long   length;
+
+    *size = 0;
+    if( NULL == file ) return NULL;
+
+    if( 0 == fseek( file, 0, SEEK_END ) && 0 <= ( length = ftell( file ) ) && 0 == fseek( file, 0, SEEK_SET ) )
+        {
+            text = (char *)VUL_MALLOC( (size_t)length + 1 );
+            if( NULL != text && (size_t)length == fread( text, 1, (size_t)length, file ) )
+                {
+                    text[length] = '\0';
+                    *size        = (size_t)length;
+                }
+            else
+                {
+                    VUL_FREE( text );
+                    text = NULL;
+                }
+        }
+
+    fclose( file );
+
+    return text;
+}
+
+// Load a cache entry, false when it is missing, stored under another key or corrupt
+static bool
+LoadCacheEntry( const char * path, const uint64_t key[2], ShaderCode * code )
+{
+    size_t            size  = 0;
+    char *            entry = ReadTextFile( path, &size );
+    ShaderCacheHeader header;
+
+    if( NULL == entry ) return false;
+
+    bool valid = ( sizeof( header ) < size );
+    if( valid )
+        {
+            memcpy( &header, entry, sizeof( header ) );
+            valid = SHADER_CACHE_MAGIC == header.magic && SHADER_CACHE_FORMAT == header.format
+                 && key[0] == header.key[0] && key[1] == header.key[1] && header.size == size - sizeof( header )
+                 && 0 == header.size % 4
+                 && header.checksum == HashBytes( entry + sizeof( header ), (size_t)header.size, 14695981039346656037ULL );
+        }
+
+    if( valid )
+        {
+            code->size = (size_t)header.size;
+            code->code = (uint32_t *)VUL_MALLOC( code->size );
+            if( NULL != code->code ) memcpy( code->code, entry + sizeof( header ), code->size );
+            valid = ( NULL != code->code );
+        }
+
+    if( !valid ) TRACELOG( LOG_DEBUG, "SHADER: Discarding cache entry %s", path );
+
+    VUL_FREE( entry );
+
+    return valid;
+}
+
+// Store a cache entry through a temporary file, readers never observe a partial entry
+static void
+StoreCacheEntry( const char * path, const uint64_t key[2], const ShaderCode * code, int index )
+{
+    // Unique per process and batch index, several processes may share the cache directory
+    char temporary[SHADER_PATH_MAX + 32];
+    snprintf( temporary, sizeof( temporary ), "%s.%d.%d.tmp", path, (int)PROCESS_ID(), index );
+
+    ShaderCacheHeader header = { 0 };
+    header.magic             = SHADER_CACHE_MAGIC;
+    header.format            = SHADER_CACHE_FORMAT;
+    header.key[0]            = key[0];
+    header.key[1]            = key[1];
+    header.size              = code->size;
+    header.checksum          = HashBytes( code->code, code->size, 14695981039346656037ULL );
+
+    FILE * file = fopen( temporary, "wb" );
+    if( NULL == file ) return;
+
+    bool written = ( 1 == fwrite( &header, sizeof( header ), 1, file ) )
+                && ( code->size == fwrite( code->code, 1, code->size, file ) );
+    written = ( 0 == fclose( file ) ) && written;
+
+#if defined( _WIN32 )
+    // rename() never replaces an existing file on Windows
+    if( written ) written = ( 0 != MoveFileExA( temporary, path, 0x1 /* MOVEFILE_REPLACE_EXISTING */ ) );
+#else
+    if( written ) written = ( 0 == rename( temporary, path ) );
+#endif
+
+    if( !written )
+        {
+            remove( temporary );
+            TRACELOG( LOG_WARNING, "SHADER: Failed to write cache entry %s", path );
+        }
+}
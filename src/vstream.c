@@ -0,0 +1,958 @@
+/******************************** VSTREAM ********************************
+ * vstream: Asynchronous texture streaming, lowest mips first
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - LoadTexture() only reads the file header: the texture gets its slot and size right away and
+ *   the file is decoded by a background job (SubmitJob()). Draws are dropped until its first mips
+ *   are resident, the caller never blocks on disk or decoding.
+ * - The mip tail (mips of STREAM_TAIL_SIZE pixels and below) is uploaded first, then every frame
+ *   promotes the textures drawn recently by one mip, within an upload budget per frame. Every
+ *   step builds a new image holding the resident mips and swaps it into the texture slot once
+ *   its upload completed, so no frame ever samples a mip that is not there yet.
+ * - Above STREAM_PRESSURE_HIGH of the memory budget (SetTextureStreamingBudget(), or the device
+ *   heap budget) the least recently drawn texture loses its finest mip every frame, down to the
+ *   tail; promotions resume below STREAM_PRESSURE_LOW. The smaller image is a copy of the coarser
+ *   mips recorded on the frame, the file is not read again; both images exist until the swap.
+ * - Decoded pixels are kept only until the texture reached its finest allowed mip, they are
+ *   decoded again when a promotion needs them.
+ * - Formats: PNG and JPEG (decoded to RGBA8, mips box filtered) and KTX2 without supercompression
+ *   holding RGBA8 levels (missing levels are box filtered) or BC7/BC5 levels, as written by the
+ *   vultra-cook tool (tools/). Block compressed levels are copied as is, the chain ends at the
+ *   last level of the file; they need the textureCompressionBC device feature.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#include "vultra/vultra.h"
+#include "vultra/vutils.h"
+
+#include "vultra/vvul.h"
+
+#include "vdraw_internal.h"
+
+#include <stdio.h>  /* fopen */
+#include <string.h> /* memcpy, strlen */
+
+// stb_image is compiled here only, with the library allocator and its warnings silenced
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_STATIC
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#define STBI_MALLOC( sz )        VUL_MALLOC( sz )
+#define STBI_REALLOC( p, newsz ) VUL_REALLOC( p, newsz )
+#define STBI_FREE( p )           VUL_FREE( p )
+#if defined( _MSC_VER )
+#    pragma warning( push, 0 )
+#elif defined( __clang__ )
+#    pragma clang diagnostic push
+#    pragma clang diagnostic ignored "-Weverything"
+#elif defined( __GNUC__ )
+#    pragma GCC diagnostic push
+#    pragma GCC diagnostic ignored "-Wall"
+#    pragma GCC diagnostic ignored "-Wextra"
+#endif
+#include <stb_image.h>
+#if defined( _MSC_VER )
+#    pragma warning( pop )
+#elif defined( __clang__ )
+#    pragma clang diagnostic pop
+#elif defined( __GNUC__ )
+#    pragma GCC diagnostic pop
+#endif
+
+#ifndef STREAM_MAX_MIPS
+#    define STREAM_MAX_MIPS 16 // Mips of a streamed texture, up to 32768 pixels wide
+#endif
+#ifndef STREAM_TAIL_SIZE
+#    define STREAM_TAIL_SIZE 64 // Largest mip of the tail, the first upload of every texture
+#endif
+#ifndef STREAM_IDLE_FRAMES
+#    define STREAM_IDLE_FRAMES 120 // Frames without a draw before a texture stops being promoted
+#endif
+#ifndef STREAM_UPLOAD_KILOBYTES
+#    define STREAM_UPLOAD_KILOBYTES 4096 // Upload budget per frame when none is set
+#endif
+
+#define STREAM_PRESSURE_HIGH 0.9 // Budget ratio above which mips are evicted
+#define STREAM_PRESSURE_LOW  0.8 // Budget ratio below which evicted textures may grow again
+
+#define KTX2_HEADER_SIZE         80 // Header and index, the level index follows
+#define KTX2_LEVEL_SIZE          24 // byteOffset, byteLength, uncompressedByteLength
+#define KTX2_FORMAT_RGBA8_UNORM  37 // VK_FORMAT_R8G8B8A8_UNORM
+#define KTX2_FORMAT_RGBA8_SRGB   43 // VK_FORMAT_R8G8B8A8_SRGB, sampled as UNORM like every other texture
+#define KTX2_FORMAT_BC5_UNORM   141 // VK_FORMAT_BC5_UNORM_BLOCK, two channels (normal maps)
+#define KTX2_FORMAT_BC7_UNORM   145 // VK_FORMAT_BC7_UNORM_BLOCK
+#define KTX2_FORMAT_BC7_SRGB    146 // VK_FORMAT_BC7_SRGB_BLOCK, sampled as UNORM
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Decoding state, published by the decode job
+typedef enum
+{
+    STREAM_IDLE = 0, // No decoded pixels
+    STREAM_DECODING, // Decode job queued or running, the job owns pixels
+    STREAM_DECODED,  // pixels holds every mip
+    STREAM_FAILED    // The file could not be decoded, the texture is never drawn
+} StreamState;
+
+// Streamed texture
+typedef struct StreamTexture
+{
+    char *       fileName;
+    unsigned int id; // Texture slot, 0 once unloaded
+    uint32_t     width;
+    uint32_t     height;
+    uint32_t     mipCount;
+    VkFormat     format;                       // RGBA8, or block compressed from a KTX2 file
+    uint32_t     blockSize;                    // Bytes per 4x4 block, 0 for RGBA8 texels
+    size_t       offsets[STREAM_MAX_MIPS + 1]; // Mip offsets in pixels, the last one is the total size
+
+    unsigned char * pixels; // Decoded mips, RGBA8 texels or blocks tightly packed
+    long            state;  // StreamState
+
+    uint32_t     resident;      // Finest mip of the slot image, mipCount when none
+    uint32_t     limit;         // Finest mip allowed, raised by evictions
+    VkDeviceSize residentBytes; // Memory of the slot image
+
+    // Image uploading, swapped into the slot once the upload completed
+    uint32_t         pending; // Finest mip, mipCount when none
+    VkImage          pendingImage;
+    VkImageView      pendingView;
+    vvulAllocation   pendingMemory;
+    vvulUploadTicket pendingTicket;
+    uint64_t         pendingFrame; // Frame the upload was recorded in
+} StreamTexture;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Variables Definition
+//----------------------------------------------------------------------------------------------------------------------
+static struct
+{
+    StreamTexture ** records; // Loaded and unloaded textures, the latter until their decode job is done
+    uint32_t         count;
+    uint32_t         capacity;
+    StreamTexture ** byId;    // Loaded textures by slot
+    uint32_t         idCount;
+    uint32_t         cursor;  // Record the promotions resume from, so every texture gets its turn
+
+    VkDeviceSize uploadBudget;   // Bytes uploaded per frame, 0: STREAM_UPLOAD_KILOBYTES
+    VkDeviceSize residentBudget; // Bytes of resident textures, 0: the device heap budget
+    VkDeviceSize residentBytes;  // Memory of every resident image
+    uint64_t     frame;
+} stream = { 0 };
+
+static const unsigned char ktx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Declaration
+//----------------------------------------------------------------------------------------------------------------------
+void CloseStreaming( void );   // Wait for the decode jobs and release every streaming resource
+void BeginStreamFrame( void ); // Swap, evict and promote the resident mips
+void ReleaseTextureStream( unsigned int id );
+
+static StreamTexture * FindStreamTexture( unsigned int id );
+static void            FreeStreamTexture( StreamTexture * record );
+static bool            ReadImageInfo( const char * fileName, uint32_t * width, uint32_t * height, VkFormat * format,
+                                      uint32_t * levels );
+static VkFormat        GetKtx2Format( uint32_t format );
+static unsigned char * ReadFile( const char * fileName, size_t * size );
+static void            DecodeJob( void * user, int index );
+static uint32_t        DecodeKtx2( const StreamTexture * record, const unsigned char * data, size_t size,
+                                   unsigned char * pixels );
+static void            BuildMips( const StreamTexture * record, unsigned char * pixels, uint32_t first );
+static void            RequestDecode( StreamTexture * record );
+static void            SwapPending( StreamTexture * record );
+static bool            UploadMips( StreamTexture * record, uint32_t first );
+static void            CopyResidentMips( const StreamTexture * record, VkImage source, uint32_t first );
+static void            EvictLeastRecent( void );
+static double          GetMemoryPressure( void );
+static uint32_t        GetTailMip( const StreamTexture * record );
+static uint32_t        GetMipSize( uint32_t size, uint32_t mip );
+static uint32_t        ReadU32( const unsigned char * data );
+static uint64_t        ReadU64( const unsigned char * data );
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Textures
+//----------------------------------------------------------------------------------------------------------------------
+// Load a PNG, JPEG or KTX2 file in the background, drawable once its lowest mips are resident
+Texture
+LoadTexture( const char * fileName )
+{
+    Texture  texture = { 0 };
+    uint32_t width   = 0;
+    uint32_t height  = 0;
+    uint32_t levels  = 0;
+    VkFormat format  = VK_FORMAT_R8G8B8A8_UNORM;
+
+    if( !STR_NONEMPTY( fileName ) ) return texture;
+
+    if( !ReadImageInfo( fileName, &width, &height, &format, &levels ) )
+        {
+            TRACELOG( LOG_WARNING, "TEXTURE: [%s] Unsupported or missing image file", fileName );
+            return texture;
+        }
+
+    // Block compressed levels cannot be filtered here, the file must hold them
+    const uint32_t blockSize = ( VK_FORMAT_R8G8B8A8_UNORM == format ) ? 0 : 16;
+    if( 0 < blockSize && ( 0 == levels || !vGetDeviceFeatures()->textureCompressionBC ) )
+        {
+            TRACELOG( LOG_WARNING, "TEXTURE: [%s] Block compressed texture not supported (format %d, %u levels)",
+                      fileName, (int)format, levels );
+            return texture;
+        }
+
+    const uint32_t maxSize = vGetDeviceProperties()->limits.maxImageDimension2D;
+    if( 0 == width || 0 == height || width > maxSize || height > maxSize
+        || ( 1U << ( STREAM_MAX_MIPS - 1 ) ) < ( ( width > height ) ? width : height ) )
+        {
+            TRACELOG( LOG_WARNING, "TEXTURE: [%s] Unsupported image size (%ux%u)", fileName, width, height );
+            return texture;
+        }
+
+    const unsigned int id = ReserveTextureSlot();
+    if( 0 == id ) return texture;
+
+    const size_t    nameLength = strlen( fileName ) + 1;
+    StreamTexture * record     = (StreamTexture *)VUL_CALLOC( 1, sizeof( StreamTexture ) );
+    char *          name       = (char *)VUL_MALLOC( nameLength );
+
+    if( stream.count == stream.capacity && NULL != record )
+        {
+            const uint32_t   capacity = ( 0 == stream.capacity ) ? 64 : stream.capacity * 2;
+            StreamTexture ** records
+                = (StreamTexture **)VUL_REALLOC( stream.records, capacity * sizeof( StreamTexture * ) );
+            if( NULL != records )
+                {
+                    stream.records  = records;
+                    stream.capacity = capacity;
+                }
+        }
+
+    if( id >= stream.idCount && NULL != record )
+        {
+            const uint32_t   idCount = ( id + 1 > 2 * stream.idCount ) ? id + 1 : 2 * stream.idCount;
+            StreamTexture ** byId
+                = (StreamTexture **)VUL_REALLOC( stream.byId, idCount * sizeof( StreamTexture * ) );
+            if( NULL != byId )
+                {
+                    memset( byId + stream.idCount, 0, ( idCount - stream.idCount ) * sizeof( StreamTexture * ) );
+                    stream.byId    = byId;
+                    stream.idCount = idCount;
+                }
+        }
+
+    if( NULL == record || NULL == name || stream.count == stream.capacity || id >= stream.idCount )
+        {
+            TRACELOG( LOG_WARNING, "TEXTURE: [%s] Failed to allocate streaming state", fileName );
+            VUL_FREE( record );
+            VUL_FREE( name );
+            const Texture reserved = { id, (int)width, (int)height };
+            UnloadTexture( reserved );
+            return texture;
+        }
+
+    memcpy( name, fileName, nameLength );
+    record->fileName  = name;
+    record->id        = id;
+    record->width     = width;
+    record->height    = height;
+    record->format    = format;
+    record->blockSize = blockSize;
+
+    // Full chain down to 1x1, or the levels of a block compressed file
+    for( uint32_t size = ( width > height ) ? width : height; 0 < size; size >>= 1 ) ++record->mipCount;
+    if( 0 < blockSize && levels < record->mipCount ) record->mipCount = levels;
+
+    for( uint32_t mip = 0; mip < record->mipCount; ++mip )
+        {
+            const size_t mipWidth    = GetMipSize( width, mip );
+            const size_t mipHeight   = GetMipSize( height, mip );
+            const size_t mipBlocks   = ( ( mipWidth + 3 ) / 4 ) * ( ( mipHeight + 3 ) / 4 );
+            const size_t mipSize     = ( 0 < blockSize ) ? mipBlocks * blockSize : mipWidth * mipHeight * 4;
+            record->offsets[mip + 1] = record->offsets[mip] + mipSize;
+        }
+
+    record->resident = record->mipCount;
+    record->pending  = record->mipCount;
+
+    stream.records[stream.count++] = record;
+    stream.byId[id]                = record;
+
+    RequestDecode( record );
+
+    texture.id     = id;
+    texture.width  = (int)width;
+    texture.height = (int)height;
+
+    TRACELOG( LOG_DEBUG, "TEXTURE: [ID %u] Streaming %s (%ux%u, %u mips)", id, fileName, width, height,
+              record->mipCount );
+
+    return texture;
+}
+
+// Set the upload budget per frame and the memory budget of the resident mips, 0 selects the default
+void
+SetTextureStreamingBudget( int uploadKilobytes, int residentMegabytes )
+{
+    stream.uploadBudget   = ( 0 < uploadKilobytes ) ? (VkDeviceSize)uploadKilobytes * 1024 : 0;
+    stream.residentBudget = ( 0 < residentMegabytes ) ? (VkDeviceSize)residentMegabytes * 1024 * 1024 : 0;
+}
+
+// Get the finest mip a texture is drawn with, -1 while nothing is resident (0 for textures not streamed)
+int
+GetTextureResidentMip( Texture texture )
+{
+    if( !IsTextureValid( texture ) ) return -1;
+
+    const StreamTexture * record = FindStreamTexture( texture.id );
+    if( NULL == record ) return 0;
+
+    return ( record->resident < record->mipCount ) ? (int)record->resident : -1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition: Core
+//----------------------------------------------------------------------------------------------------------------------
+void
+CloseStreaming( void )
+{
+    // Jobs write into the records, none may still be running
+    WaitJobs();
+
+    for( uint32_t i = 0; i < stream.count; ++i ) FreeStreamTexture( stream.records[i] );
+
+    VUL_FREE( stream.records );
+    VUL_FREE( stream.byId );
+    memset( &stream, 0, sizeof( stream ) );
+}
+
+// Runs after BeginDrawBatch(), swaps become visible to the frame being recorded
+void
+BeginStreamFrame( void )
+{
+    // Uploads are only known to be acquired by recorded frames
+    if( 0 == stream.count || VK_NULL_HANDLE == vGetFrameCommandBuffer() ) return;
+
+    ++stream.frame;
+
+    for( uint32_t i = 0; i < stream.count; )
+        {
+            StreamTexture * record = stream.records[i];
+
+            if( 0 == record->id )
+                {
+                    // Unloaded, freed once its decode job let go of it
+                    if( STREAM_DECODING != ATOMIC_LOAD( &record->state ) )
+                        {
+                            FreeStreamTexture( record );
+                            stream.records[i] = stream.records[--stream.count];
+                            continue;
+                        }
+                }
+            else if( record->pending < record->mipCount && stream.frame > record->pendingFrame
+                     && vIsUploadComplete( record->pendingTicket ) )
+                {
+                    SwapPending( record );
+                }
+
+            ++i;
+        }
+
+    const double pressure = GetMemoryPressure();
+    const bool   high     = ( STREAM_PRESSURE_HIGH < pressure );
+    const bool   low      = ( STREAM_PRESSURE_LOW > pressure );
+
+    if( high ) EvictLeastRecent();
+
+    const VkDeviceSize budget = ( 0 < stream.uploadBudget ) ? stream.uploadBudget : STREAM_UPLOAD_KILOBYTES * 1024;
+    VkDeviceSize       spent  = 0;
+
+    for( uint32_t n = 0; n < stream.count; ++n )
+        {
+            const uint32_t  index  = ( stream.cursor + n ) % stream.count;
+            StreamTexture * record = stream.records[index];
+
+            if( 0 == record->id || record->pending < record->mipCount ) continue;
+
+            const long state = ATOMIC_LOAD( &record->state );
+            if( STREAM_FAILED == state ) continue;
+
+            const bool drawn = ( STREAM_IDLE_FRAMES > GetTextureSlotIdleFrames( record->id ) );
+            if( low && drawn ) record->limit = 0;
+
+            // Tail first, then one mip at a time while the texture is drawn, or down to the limit after an eviction
+            uint32_t target = record->resident;
+            if( record->resident == record->mipCount ) target = GetTailMip( record );
+            else if( record->resident < record->limit ) target = record->limit;
+            else if( record->resident > record->limit && drawn && !high ) target = record->resident - 1;
+
+            if( target == record->resident ) continue;
+
+            // Evictions copy the mips already resident, only growing needs the decoded file
+            const bool shrink = ( record->resident < target );
+            if( !shrink )
+                {
+                    if( STREAM_IDLE == state ) RequestDecode( record );
+                    if( STREAM_DECODED != ATOMIC_LOAD( &record->state ) ) continue;
+                }
+
+            // At least one upload per frame, so a texture larger than the budget still makes progress
+            const VkDeviceSize cost = shrink ? 0 : ( record->offsets[record->mipCount] - record->offsets[target] );
+            if( 0 < spent && spent + cost > budget )
+                {
+                    stream.cursor = index;
+                    break;
+                }
+
+            if( UploadMips( record, target ) ) spent += cost;
+        }
+}
+
+// Called by UnloadTexture(), the slot image is released by vdraw.c
+void
+ReleaseTextureStream( unsigned int id )
+{
+    StreamTexture * record = FindStreamTexture( id );
+    if( NULL == record ) return;
+
+    stream.byId[id] = NULL;
+    stream.residentBytes -= record->residentBytes;
+    record->residentBytes = 0;
+    record->id            = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Find the streaming state of a texture slot, NULL when the texture is not streamed
+static StreamTexture *
+FindStreamTexture( unsigned int id )
+{
+    return ( id < stream.idCount ) ? stream.byId[id] : NULL;
+}
+
+// Free a record and its pending image, its decode job must be done
+static void
+FreeStreamTexture( StreamTexture * record )
+{
+    vDeferDestroyImage( record->pendingImage, &record->pendingView, 1, &record->pendingMemory );
+
+    VUL_FREE( record->pixels );
+    VUL_FREE( record->fileName );
+    VUL_FREE( record );
+}
+
+// Read the image size from the file header, without decoding; format and levels are only known for KTX2 files
+static bool
+ReadImageInfo( const char * fileName, uint32_t * width, uint32_t * height, VkFormat * format, uint32_t * levels )
+{
+    unsigned char header[KTX2_HEADER_SIZE];
+    FILE *        file = fopen( fileName, "rb" );
+
+    if( NULL == file ) return false;
+
+    const size_t read = fread( header, 1, sizeof( header ), file );
+    fclose( file );
+
+    if( sizeof( header ) == read && 0 == memcmp( header, ktx2Identifier, sizeof( ktx2Identifier ) ) )
+        {
+            *width  = ReadU32( header + 20 );
+            *height = ReadU32( header + 24 );
+            *levels = ReadU32( header + 40 );
+
+            // Unsupported formats are reported by the decode job, as RGBA8 ones
+            const VkFormat ktx2Format = GetKtx2Format( ReadU32( header + 12 ) );
+            if( VK_FORMAT_UNDEFINED != ktx2Format ) *format = ktx2Format;
+
+            return true;
+        }
+
+    int x = 0, y = 0, components = 0;
+    if( !stbi_info( fileName, &x, &y, &components ) ) return false;
+
+    *width  = (uint32_t)x;
+    *height = (uint32_t)y;
+
+    return true;
+}
+
+// Read a whole file, NULL on failure
+static unsigned char *
+ReadFile( const char * fileName, size_t * size )
+{
+    FILE *          file = fopen( fileName, "rb" );
+    unsigned char * data = NULL;
+    long            length;
+
+    *size = 0;
+    if( NULL == file ) return NULL;
+
+    if( 0 == fseek( file, 0, SEEK_END ) && 0 < ( length = ftell( file ) ) && 0 == fseek( file, 0, SEEK_SET ) )
+        {
+            data = (unsigned char *)VUL_MALLOC( (size_t)length );
+            if( NULL != data && (size_t)length == fread( data, 1, (size_t)length, file ) )
+                {
+                    *size = (size_t)length;
+                }
+            else
+                {
+                    VUL_FREE( data );
+                    data = NULL;
+                }
+        }
+
+    fclose( file );
+
+    return data;
+}
+
+// Decode every mip of a texture, on a worker
+static void
+DecodeJob( void * user, int index )
+{
+    StreamTexture * record = (StreamTexture *)user;
+    size_t          size   = 0;
+    unsigned char * data   = ReadFile( record->fileName, &size );
+    unsigned char * pixels = NULL;
+    uint32_t        levels = 0;
+
+    (void)index;
+
+    if( NULL != data ) pixels = (unsigned char *)VUL_MALLOC( record->offsets[record->mipCount] );
+
+    const bool ktx2
+        = ( sizeof( ktx2Identifier ) <= size && 0 == memcmp( data, ktx2Identifier, sizeof( ktx2Identifier ) ) );
+
+    if( NULL != pixels && ktx2 )
+        {
+            levels = DecodeKtx2( record, data, size, pixels );
+        }
+    else if( NULL != pixels && (size_t)INT32_MAX >= size )
+        {
+            int             width = 0, height = 0, components = 0;
+            unsigned char * image = stbi_load_from_memory( data, (int)size, &width, &height, &components, 4 );
+
+            if( NULL == image )
+                {
+                    TRACELOG( LOG_WARNING, "TEXTURE: [%s] Failed to decode (%s)", record->fileName,
+                              stbi_failure_reason() );
+                }
+            else if( record->width == (uint32_t)width && record->height == (uint32_t)height )
+                {
+                    memcpy( pixels, image, record->offsets[1] );
+                    levels = 1;
+                }
+
+            stbi_image_free( image );
+        }
+
+    VUL_FREE( data );
+
+    if( 0 == levels )
+        {
+            TRACELOG( LOG_WARNING, "TEXTURE: [%s] Failed to load texture data", record->fileName );
+            VUL_FREE( pixels );
+            ATOMIC_STORE( &record->state, STREAM_FAILED );
+            return;
+        }
+
+    BuildMips( record, pixels, levels );
+
+    record->pixels = pixels;
+    ATOMIC_STORE( &record->state, STREAM_DECODED );
+}
+
+// Vulkan format a KTX2 format is sampled as, VK_FORMAT_UNDEFINED when not supported
+static VkFormat
+GetKtx2Format( uint32_t format )
+{
+    switch( format )
+        {
+        case KTX2_FORMAT_RGBA8_UNORM:
+        case KTX2_FORMAT_RGBA8_SRGB:  return VK_FORMAT_R8G8B8A8_UNORM;
+        case KTX2_FORMAT_BC5_UNORM:   return VK_FORMAT_BC5_UNORM_BLOCK;
+        case KTX2_FORMAT_BC7_UNORM:
+        case KTX2_FORMAT_BC7_SRGB:    return VK_FORMAT_BC7_UNORM_BLOCK;
+        default:                      return VK_FORMAT_UNDEFINED;
+        }
+}
+
+// Copy the levels of a KTX2 file in the format of the record, returns the levels copied (0 on failure)
+static uint32_t
+DecodeKtx2( const StreamTexture * record, const unsigned char * data, size_t size, unsigned char * pixels )
+{
+    if( KTX2_HEADER_SIZE > size ) return 0;
+
+    const uint32_t format     = ReadU32( data + 12 );
+    const uint32_t depth      = ReadU32( data + 28 );
+    const uint32_t layers     = ReadU32( data + 32 );
+    const uint32_t faces      = ReadU32( data + 36 );
+    const uint32_t levelCount = ReadU32( data + 40 );
+    const uint32_t scheme     = ReadU32( data + 44 );
+
+    if( GetKtx2Format( format ) != record->format || 0 != scheme || 1 < depth || 1 < layers || 1 != faces )
+        {
+            TRACELOG( LOG_WARNING, "TEXTURE: [%s] Only RGBA8, BC5 and BC7 2D KTX2 textures are supported (format %u)",
+                      record->fileName, format );
+            return 0;
+        }
+
+    // levelCount 0 asks the loader to generate the mips
+    const uint32_t levels = ( 0 == levelCount ) ? 1 : ( levelCount < record->mipCount ) ? levelCount : record->mipCount;
+    if( KTX2_HEADER_SIZE + (size_t)levels * KTX2_LEVEL_SIZE > size ) return 0;
+
+    for( uint32_t level = 0; level < levels; ++level )
+        {
+            const unsigned char * entry  = data + KTX2_HEADER_SIZE + (size_t)level * KTX2_LEVEL_SIZE;
+            const uint64_t        offset = ReadU64( entry );
+            const uint64_t        length = ReadU64( entry + 8 );
+            const size_t          expect = record->offsets[level + 1] - record->offsets[level];
+
+            if( expect != length || offset > size || length > size - offset ) return 0;
+
+            memcpy( pixels + record->offsets[level], data + offset, expect );
+        }
+
+    return levels;
+}
+
+// Box filter the mips from first on, each from the previous one
+static void
+BuildMips( const StreamTexture * record, unsigned char * pixels, uint32_t first )
+{
+    for( uint32_t mip = ( 0 < first ) ? first : 1; mip < record->mipCount; ++mip )
+        {
+            const uint32_t        srcWidth  = GetMipSize( record->width, mip - 1 );
+            const uint32_t        srcHeight = GetMipSize( record->height, mip - 1 );
+            const uint32_t        width     = GetMipSize( record->width, mip );
+            const uint32_t        height    = GetMipSize( record->height, mip );
+            const unsigned char * src       = pixels + record->offsets[mip - 1];
+            unsigned char *       dst       = pixels + record->offsets[mip];
+
+            for( uint32_t y = 0; y < height; ++y )
+                {
+                    const uint32_t y0 = 2 * y;
+                    const uint32_t y1 = ( y0 + 1 < srcHeight ) ? y0 + 1 : y0;
+
+                    for( uint32_t x = 0; x < width; ++x )
+                        {
+                            const uint32_t x0 = 2 * x;
+                            const uint32_t x1 = ( x0 + 1 < srcWidth ) ? x0 + 1 : x0;
+
+                            for( uint32_t c = 0; c < 4; ++c )
+                                {
+                                    const uint32_t sum
+                                        = src[( y0 * srcWidth + x0 ) * 4 + c] + src[( y0 * srcWidth + x1 ) * 4 + c]
+                                        + src[( y1 * srcWidth + x0 ) * 4 + c] + src[( y1 * srcWidth + x1 ) * 4 + c];
+                                    dst[( y * width + x ) * 4 + c] = (unsigned char)( ( sum + 2 ) / 4 );
+                                }
+                        }
+                }
+        }
+}
+
+// Queue the decoding of a texture that has no pixels
+static void
+RequestDecode( StreamTexture * record )
+{
+    if( STREAM_IDLE != ATOMIC_LOAD( &record->state ) ) return;
+
+    ATOMIC_STORE( &record->state, STREAM_DECODING );
+    SubmitJob( DecodeJob, record, 0 );
+}
+
+// Make the completed upload the image of the texture slot
+static void
+SwapPending( StreamTexture * record )
+{
+    if( SetTextureSlotImage( record->id, record->pendingImage, record->pendingView, &record->pendingMemory ) )
+        {
+            stream.residentBytes  = stream.residentBytes - record->residentBytes + record->pendingMemory.size;
+            record->resident      = record->pending;
+            record->residentBytes = record->pendingMemory.size;
+        }
+    else
+        {
+            TRACELOG( LOG_WARNING, "TEXTURE: [ID %u] Failed to swap streamed mips", record->id );
+            vDeferDestroyImage( record->pendingImage, &record->pendingView, 1, &record->pendingMemory );
+        }
+
+    memset( &record->pendingMemory, 0, sizeof( vvulAllocation ) );
+    record->pending      = record->mipCount;
+    record->pendingImage = VK_NULL_HANDLE;
+    record->pendingView  = VK_NULL_HANDLE;
+
+    // Done for now: the pixels are decoded again when the texture can grow
+    const bool final = ( record->resident <= record->limit
+                         || STREAM_IDLE_FRAMES <= GetTextureSlotIdleFrames( record->id ) );
+    if( final && STREAM_DECODED == ATOMIC_LOAD( &record->state ) )
+        {
+            VUL_FREE( record->pixels );
+            record->pixels = NULL;
+            ATOMIC_STORE( &record->state, STREAM_IDLE );
+        }
+}
+
+// Create an image holding the mips [first, mipCount) and upload them, swapped in by a later frame.
+// Below the resident mip they are copied from the slot image instead, the pixels are not needed.
+static bool
+UploadMips( StreamTexture * record, uint32_t first )
+{
+    const VkDevice device = vGetDevice();
+    const uint32_t width  = GetMipSize( record->width, first );
+    const uint32_t height = GetMipSize( record->height, first );
+    const VkImage  source = ( first > record->resident ) ? GetTextureSlotImage( record->id ) : VK_NULL_HANDLE;
+    VkResult       result;
+
+    if( first > record->resident && VK_NULL_HANDLE == source ) return false;
+
+    VkImageCreateInfo imageInfo = { 0 };
+    imageInfo.sType             = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType         = VK_IMAGE_TYPE_2D;
+    imageInfo.format            = record->format;
+    imageInfo.extent.width      = width;
+    imageInfo.extent.height     = height;
+    imageInfo.extent.depth      = 1;
+    imageInfo.mipLevels         = record->mipCount - first;
+    imageInfo.arrayLayers       = 1;
+    imageInfo.samples           = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling            = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage             = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT
+                                  | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    imageInfo.sharingMode       = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    result = vkCreateImage( device, &imageInfo, NULL, &record->pendingImage );
+
+    if( VK_SUCCESS == result
+        && !vAllocateImageMemory( record->pendingImage, VVUL_MEMORY_GPU_ONLY, &record->pendingMemory ) )
+        {
+            result = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+
+    if( VK_SUCCESS == result )
+        {
+            VkImageViewCreateInfo viewInfo       = { 0 };
+            viewInfo.sType                       = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image                       = record->pendingImage;
+            viewInfo.viewType                    = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format                      = record->format;
+            viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            viewInfo.subresourceRange.levelCount = imageInfo.mipLevels;
+            viewInfo.subresourceRange.layerCount = 1;
+
+            result = vkCreateImageView( device, &viewInfo, NULL, &record->pendingView );
+        }
+
+    if( VK_SUCCESS == result && VK_NULL_HANDLE != source ) CopyResidentMips( record, source, first );
+
+    record->pendingTicket = 0;
+    for( uint32_t mip = first; VK_SUCCESS == result && VK_NULL_HANDLE == source && mip < record->mipCount; ++mip )
+        {
+            const uint32_t        mipWidth  = GetMipSize( record->width, mip );
+            const uint32_t        mipHeight = GetMipSize( record->height, mip );
+            const unsigned char * data      = record->pixels + record->offsets[mip];
+
+            vvulUploadTicket ticket;
+            if( 0 < record->blockSize )
+                {
+                    ticket = vUploadImageBlocks( record->pendingImage, mip - first, mipWidth, mipHeight, 4, 4,
+                                                 record->blockSize, data, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+                }
+            else
+                {
+                    ticket = vUploadImage( record->pendingImage, mip - first, mipWidth, mipHeight, 4, data,
+                                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+                }
+
+            // Tickets grow with the batches, the image is ready once the latest one completed
+            if( VVUL_UPLOAD_FAILED == ticket ) result = VK_ERROR_OUT_OF_HOST_MEMORY;
+            else if( ticket > record->pendingTicket ) record->pendingTicket = ticket;
+        }
+
+    if( VK_SUCCESS != result )
+        {
+            TRACELOG( LOG_WARNING, "TEXTURE: [ID %u] Failed to upload mips %u+ (%d)", record->id, first, (int)result );
+
+            // Uploads already recorded may reference the image
+            vDeferDestroyImage( record->pendingImage, &record->pendingView, 1, &record->pendingMemory );
+
+            memset( &record->pendingMemory, 0, sizeof( vvulAllocation ) );
+            record->pendingImage = VK_NULL_HANDLE;
+            record->pendingView  = VK_NULL_HANDLE;
+
+            return false;
+        }
+
+    record->pending      = first;
+    record->pendingFrame = stream.frame;
+
+    return true;
+}
+
+// Record the copy of the mips [first, mipCount) of the slot image into the pending image, on the frame
+static void
+CopyResidentMips( const StreamTexture * record, VkImage source, uint32_t first )
+{
+    const VkCommandBuffer cmd   = vGetFrameCommandBuffer();
+    const uint32_t        count = record->mipCount - first;
+
+    // Earlier frames may still sample the slot image, this one does again after the copy
+    VkImageMemoryBarrier barriers[2]            = { { 0 }, { 0 } };
+    barriers[0].sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barriers[0].dstAccessMask                   = VK_ACCESS_TRANSFER_READ_BIT;
+    barriers[0].oldLayout                       = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barriers[0].newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[0].srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barriers[0].dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barriers[0].image                           = source;
+    barriers[0].subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    barriers[0].subresourceRange.baseMipLevel   = first - record->resident;
+    barriers[0].subresourceRange.levelCount     = count;
+    barriers[0].subresourceRange.layerCount     = 1;
+    barriers[1]                                 = barriers[0];
+    barriers[1].dstAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[1].oldLayout                       = VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[1].newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[1].image                           = record->pendingImage;
+    barriers[1].subresourceRange.baseMipLevel   = 0;
+
+    vkCmdPipelineBarrier( cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL,
+                          2, barriers );
+
+    VkImageCopy regions[STREAM_MAX_MIPS];
+    memset( regions, 0, sizeof( regions ) );
+    for( uint32_t level = 0; level < count; ++level )
+        {
+            VkImageCopy * region = &regions[level];
+
+            region->srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region->srcSubresource.mipLevel   = first - record->resident + level;
+            region->srcSubresource.layerCount = 1;
+            region->dstSubresource            = region->srcSubresource;
+            region->dstSubresource.mipLevel   = level;
+            region->extent.width              = GetMipSize( record->width, first + level );
+            region->extent.height             = GetMipSize( record->height, first + level );
+            region->extent.depth              = 1;
+        }
+
+    vkCmdCopyImage( cmd, source, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, record->pendingImage,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, count, regions );
+
+    barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barriers[0].oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[0].newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barriers[1].oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[1].newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    vkCmdPipelineBarrier( cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, NULL, 0, NULL,
+                          2, barriers );
+}
+
+// Drop the finest mip of the texture drawn least recently, never below the tail
+static void
+EvictLeastRecent( void )
+{
+    StreamTexture * victim = NULL;
+    uint64_t        oldest = 0;
+
+    for( uint32_t i = 0; i < stream.count; ++i )
+        {
+            StreamTexture * record = stream.records[i];
+
+            if( 0 == record->id || record->pending < record->mipCount || record->limit > record->resident ) continue;
+            if( record->resident >= GetTailMip( record ) ) continue;
+
+            const uint64_t idle = GetTextureSlotIdleFrames( record->id );
+            if( NULL == victim || idle > oldest )
+                {
+                    victim = record;
+                    oldest = idle;
+                }
+        }
+
+    if( NULL != victim ) victim->limit = victim->resident + 1;
+}
+
+// Ratio of the memory in use to its budget: the streaming budget if set, else the fullest device local heap
+static double
+GetMemoryPressure( void )
+{
+    if( 0 < stream.residentBudget ) return (double)stream.residentBytes / (double)stream.residentBudget;
+
+    VkPhysicalDeviceMemoryProperties properties;
+    vkGetPhysicalDeviceMemoryProperties( vGetPhysicalDevice(), &properties );
+
+    double pressure = 0.0;
+    for( uint32_t heap = 0; heap < properties.memoryHeapCount; ++heap )
+        {
+            if( 0 == ( properties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT ) ) continue;
+
+            const vvulMemoryBudget budget = vGetMemoryBudget( heap );
+            if( 0 == budget.budget ) continue;
+
+            const double ratio = (double)budget.usage / (double)budget.budget;
+            if( ratio > pressure ) pressure = ratio;
+        }
+
+    return pressure;
+}
+
+// First mip of the tail, uploaded before any other
+static uint32_t
+GetTailMip( const StreamTexture * record )
+{
+    uint32_t mip  = 0;
+    uint32_t size = ( record->width > record->height ) ? record->width : record->height;
+
+    while( STREAM_TAIL_SIZE < size && mip + 1 < record->mipCount )
+        {
+            size >>= 1;
+            ++mip;
+        }
+
+    return mip;
+}
+
+// Size of a mip along one axis
+static uint32_t
+GetMipSize( uint32_t size, uint32_t mip )
+{
+    return ( 1 < ( size >> mip ) ) ? ( size >> mip ) : 1;
+}
+
+// Little endian reads, KTX2 fields are not aligned
+static uint32_t
+ReadU32( const unsigned char * data )
+{
+    return (uint32_t)data[0] | ( (uint32_t)data[1] << 8 ) | ( (uint32_t)data[2] << 16 ) | ( (uint32_t)data[3] << 24 );
+}
+
+static uint64_t
+ReadU64( const unsigned char * data )
+{
+    return (uint64_t)ReadU32( data ) | ( (uint64_t)ReadU32( data + 4 ) << 32 );
+}
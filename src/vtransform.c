@@ -0,0 +1,546 @@
+/****************************** VTRANSFORM *******************************
+ * vtransform: Transform hierarchy, updated incrementally
+ *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - The depth-first order is rebuilt in O(n) after structural changes: children are grouped by
+ *   parent with a counting sort, then walked with an explicit stack. Every position stores the
+ *   size of its subtree, so a subtree is the range [position, position + span).
+ * - Changed handles are sorted by position, the ones inside an earlier subtree are dropped: what
+ *   is left are disjoint subtrees, each one only depending on the world of its root's parent.
+ * - Subtrees larger than a batch are split: their root is computed first on the calling thread,
+ *   its children become subtrees of their own. Batches then gather subtrees of similar total
+ *   size, one ParallelFor() index each.
+ *
+ *                               LICENSE
+ * ------------------------------------------------------------------------
+ * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you
+ *   wrote the original software. If you use this software in a product, an acknowledgment
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ *
+ *************************************************************************/
+
+#include "vultra/vtransform.h"
+#include "vultra/vultra.h"
+#include "vultra/vutils.h"
+
+#include <stdlib.h> /* qsort */
+#include <string.h> /* memcpy, memset */
+
+#ifndef TRANSFORM_BATCH_SIZE
+#    define TRANSFORM_BATCH_SIZE 1024 // Fewest transforms worth a worker, smaller updates run on the calling thread
+#endif
+#ifndef TRANSFORM_MAX_BATCHES
+#    define TRANSFORM_MAX_BATCHES 256 // Batches of an update, several per worker to balance them
+#endif
+
+#define TRANSFORM_FLAG_USED  0x01 // Handle allocated
+#define TRANSFORM_FLAG_DIRTY 0x02 // Local transform changed since the last update, queued in the dirty list
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Subtree to recompute, as a range of positions
+typedef struct TransformRange
+{
+    uint32_t first;
+    uint32_t end;
+} TransformRange;
+
+// Ranges updated by one worker, and the handles they changed
+typedef struct TransformBatch
+{
+    uint32_t firstRange;
+    uint32_t endRange;
+    uint32_t changedFirst;
+    uint32_t changedEnd;
+} TransformBatch;
+
+struct TransformTree
+{
+    float *    locals;    // 12 floats per handle
+    float *    worlds;    // 12 floats per handle
+    uint32_t * parents;   // Parent handle of every handle, TRANSFORM_NONE for the roots
+    uint32_t * positions; // Position of every handle in the order
+    uint8_t *  flags;     // TRANSFORM_FLAG_*
+
+    uint32_t * order; // Handles in depth-first order
+    uint32_t * spans; // Size of the subtree at every position, its root included
+    uint32_t   orderCount;
+    bool       orderDirty; // Structure changed, the order is rebuilt by the next update
+
+    uint32_t * freeHandles;
+    uint32_t   freeCount;
+    uint32_t   handleCount; // Handles ever allocated, the length of the world buffer
+    uint32_t   capacity;
+
+    uint32_t * dirty; // Handles whose local transform changed
+    uint32_t   dirtyCount;
+
+    // Update scratch
+    uint32_t *       starts;  // Children offsets by parent, capacity + 1 (the roots) entries
+    uint32_t *       scratch; // Children grouped by parent, then the positions of the changed handles
+    uint32_t *       pending; // Depth-first stack, then the subtrees waiting to be split
+    TransformRange * ranges;
+    TransformBatch   batches[TRANSFORM_MAX_BATCHES];
+
+    uint32_t changedFirst; // Handles changed by the last update
+    uint32_t changedEnd;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Declaration
+//----------------------------------------------------------------------------------------------------------------------
+static bool IsTransformValid( const TransformTree * tree, uint32_t transform );
+static void RebuildTransformOrder( TransformTree * tree );
+static void ComputeTransformWorld( TransformTree * tree, uint32_t transform );
+static void UpdateTransformBatch( void * user, int index );
+static int  ComparePositions( const void * a, const void * b );
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Create an empty hierarchy of up to capacity transforms
+TransformTree *
+LoadTransformTree( uint32_t capacity )
+{
+    if( 0 == capacity || TRANSFORM_NONE == capacity ) return NULL;
+
+    TransformTree * tree = (TransformTree *)VUL_CALLOC( 1, sizeof( TransformTree ) );
+    if( NULL == tree ) return NULL;
+
+    const size_t matrices = (size_t)capacity * 12 * sizeof( float );
+    const size_t indices  = (size_t)capacity * sizeof( uint32_t );
+
+    tree->capacity    = capacity;
+    tree->locals      = (float *)VUL_MALLOC( matrices );
+    tree->worlds      = (float *)VUL_CALLOC( 1, matrices );
+    tree->parents     = (uint32_t *)VUL_MALLOC( indices );
+    tree->positions   = (uint32_t *)VUL_MALLOC( indices );
+    tree->flags       = (uint8_t *)VUL_CALLOC( capacity, sizeof( uint8_t ) );
+    tree->order       = (uint32_t *)VUL_MALLOC( indices );
+    tree->spans       = (uint32_t *)VUL_MALLOC( indices );
+    tree->freeHandles = (uint32_t *)VUL_MALLOC( indices );
+    tree->dirty       = (uint32_t *)VUL_MALLOC( indices );
+    tree->starts      = (uint32_t *)VUL_MALLOC( indices + sizeof( uint32_t ) );
+    tree->scratch     = (uint32_t *)VUL_MALLOC( indices );
+    tree->pending     = (uint32_t *)VUL_MALLOC( indices );
+    tree->ranges      = (TransformRange *)VUL_MALLOC( (size_t)capacity * sizeof( TransformRange ) );
+
+    if( NULL == tree->locals || NULL == tree->worlds || NULL == tree->parents || NULL == tree->positions
+        || NULL == tree->flags || NULL == tree->order || NULL == tree->spans || NULL == tree->freeHandles
+        || NULL == tree->dirty || NULL == tree->starts || NULL == tree->scratch || NULL == tree->pending
+        || NULL == tree->ranges )
+        {
+            TRACELOG( LOG_WARNING, "TRANSFORM: Failed to allocate a hierarchy of %u transforms", capacity );
+            UnloadTransformTree( tree );
+            return NULL;
+        }
+
+    return tree;
+}
+
+// Free a hierarchy
+void
+UnloadTransformTree( TransformTree * tree )
+{
+    if( NULL == tree ) return;
+
+    VUL_FREE( tree->locals );
+    VUL_FREE( tree->worlds );
+    VUL_FREE( tree->parents );
+    VUL_FREE( tree->positions );
+    VUL_FREE( tree->flags );
+    VUL_FREE( tree->order );
+    VUL_FREE( tree->spans );
+    VUL_FREE( tree->freeHandles );
+    VUL_FREE( tree->dirty );
+    VUL_FREE( tree->starts );
+    VUL_FREE( tree->scratch );
+    VUL_FREE( tree->pending );
+    VUL_FREE( tree->ranges );
+    VUL_FREE( tree );
+}
+
+// Add a transform under parent (TRANSFORM_NONE: a root), its world is computed by the next update
+uint32_t
+AddTransform( TransformTree * tree, uint32_t parent, const float local[12] )
+{
+    if( NULL == tree || NULL == local ) return TRANSFORM_NONE;
+    if( TRANSFORM_NONE != parent && !IsTransformValid( tree, parent ) ) return TRANSFORM_NONE;
+
+    uint32_t transform = TRANSFORM_NONE;
+    if( 0 < tree->freeCount ) transform = tree->freeHandles[--tree->freeCount];
+    else if( tree->handleCount < tree->capacity ) transform = tree->handleCount++;
+    else return TRANSFORM_NONE;
+
+    memcpy( &tree->locals[12 * transform], local, 12 * sizeof( float ) );
+    tree->parents[transform] = parent;
+    tree->flags[transform]   = TRANSFORM_FLAG_USED | ( tree->flags[transform] & TRANSFORM_FLAG_DIRTY );
+    tree->orderDirty         = true;
+
+    return transform;
+}
+
+// Remove a transform and every transform below it, their handles are reused
+void
+RemoveTransform( TransformTree * tree, uint32_t transform )
+{
+    if( !IsTransformValid( tree, transform ) ) return;
+
+    // Descendants are found through the order
+    if( tree->orderDirty ) RebuildTransformOrder( tree );
+
+    const uint32_t first = tree->positions[transform];
+    for( uint32_t position = first; position < first + tree->spans[first]; ++position )
+        {
+            const uint32_t removed = tree->order[position];
+
+            tree->flags[removed] &= TRANSFORM_FLAG_DIRTY; // Still queued, skipped by the update
+            tree->parents[removed]               = TRANSFORM_NONE;
+            tree->freeHandles[tree->freeCount++] = removed;
+        }
+
+    tree->orderDirty = true;
+}
+
+// Move a transform, with its descendants, under another parent (TRANSFORM_NONE: a root)
+bool
+SetTransformParent( TransformTree * tree, uint32_t transform, uint32_t parent )
+{
+    if( !IsTransformValid( tree, transform ) ) return false;
+    if( TRANSFORM_NONE != parent && !IsTransformValid( tree, parent ) ) return false;
+
+    // A transform cannot move below itself
+    for( uint32_t ancestor = parent; TRANSFORM_NONE != ancestor; ancestor = tree->parents[ancestor] )
+        {
+            if( ancestor == transform ) return false;
+        }
+
+    if( parent == tree->parents[transform] ) return true;
+
+    tree->parents[transform] = parent;
+    tree->orderDirty         = true;
+
+    return true;
+}
+
+// Set the local transform, its subtree is recomputed by the next update
+void
+SetTransformLocal( TransformTree * tree, uint32_t transform, const float local[12] )
+{
+    if( !IsTransformValid( tree, transform ) || NULL == local ) return;
+
+    memcpy( &tree->locals[12 * transform], local, 12 * sizeof( float ) );
+
+    if( 0 == ( tree->flags[transform] & TRANSFORM_FLAG_DIRTY ) )
+        {
+            tree->flags[transform] |= TRANSFORM_FLAG_DIRTY;
+            tree->dirty[tree->dirtyCount++] = transform;
+        }
+}
+
+// Recompute the world transforms of the changed subtrees, in parallel
+uint32_t
+UpdateTransforms( TransformTree * tree )
+{
+    if( NULL == tree ) return 0;
+
+    tree->changedFirst = 0;
+    tree->changedEnd   = 0;
+
+    // Roots of the subtrees to recompute, by position: everything after a structural change
+    //--------------------------------------------------------------
+    const bool rebuilt = tree->orderDirty;
+    if( rebuilt ) RebuildTransformOrder( tree );
+
+    uint32_t * roots     = tree->scratch;
+    uint32_t   rootCount = 0;
+
+    for( uint32_t i = 0; i < tree->dirtyCount; ++i )
+        {
+            const uint32_t transform = tree->dirty[i];
+
+            tree->flags[transform] &= (uint8_t)~TRANSFORM_FLAG_DIRTY;
+            if( !rebuilt && 0 != ( tree->flags[transform] & TRANSFORM_FLAG_USED ) )
+                {
+                    roots[rootCount++] = tree->positions[transform];
+                }
+        }
+    tree->dirtyCount = 0;
+
+    if( rebuilt )
+        {
+            for( uint32_t position = 0; position < tree->orderCount; position += tree->spans[position] )
+                {
+                    roots[rootCount++] = position;
+                }
+        }
+    else
+        {
+            qsort( roots, rootCount, sizeof( uint32_t ), ComparePositions );
+        }
+
+    if( 0 == rootCount ) return 0;
+
+    // Disjoint subtrees: a root inside the previous subtree is already covered by it
+    //--------------------------------------------------------------
+    uint32_t * subtrees     = tree->pending;
+    uint32_t   subtreeCount = 0;
+    uint32_t   subtreeEnd   = 0;
+    uint32_t   total        = 0;
+
+    for( uint32_t i = 0; i < rootCount; ++i )
+        {
+            const uint32_t position = roots[i];
+            if( position < subtreeEnd ) continue;
+
+            subtrees[subtreeCount++] = position;
+            subtreeEnd               = position + tree->spans[position];
+            total += tree->spans[position];
+        }
+
+    // Split the large subtrees below their root, so a single one still spreads over the workers
+    //--------------------------------------------------------------
+    const uint32_t workers   = (uint32_t)GetWorkerCount();
+    uint32_t       batchSize = total / ( 4 * workers );
+    if( TRANSFORM_BATCH_SIZE > batchSize ) batchSize = TRANSFORM_BATCH_SIZE;
+
+    uint32_t changedFirst = TRANSFORM_NONE;
+    uint32_t changedEnd   = 0;
+    uint32_t rangeCount   = 0;
+    uint32_t rangeTotal   = 0;
+
+    while( 0 < subtreeCount )
+        {
+            const uint32_t position = subtrees[--subtreeCount];
+            const uint32_t span     = tree->spans[position];
+
+            if( span <= batchSize )
+                {
+                    tree->ranges[rangeCount].first = position;
+                    tree->ranges[rangeCount].end   = position + span;
+                    ++rangeCount;
+                    rangeTotal += span;
+                    continue;
+                }
+
+            const uint32_t transform = tree->order[position];
+            ComputeTransformWorld( tree, transform );
+            if( transform < changedFirst ) changedFirst = transform;
+            if( transform >= changedEnd ) changedEnd = transform + 1;
+
+            for( uint32_t child = position + 1; child < position + span; child += tree->spans[child] )
+                {
+                    subtrees[subtreeCount++] = child;
+                }
+        }
+
+    // Batches of about the same size, one per job index
+    //--------------------------------------------------------------
+    uint32_t batchCount = ( rangeTotal <= TRANSFORM_BATCH_SIZE ) ? 1 : 4 * workers;
+    if( TRANSFORM_MAX_BATCHES < batchCount ) batchCount = TRANSFORM_MAX_BATCHES;
+    if( rangeCount < batchCount ) batchCount = rangeCount;
+
+    uint32_t batch = 0;
+    uint32_t done  = 0;
+
+    tree->batches[0].firstRange = 0;
+    for( uint32_t i = 0; i < rangeCount && 1 < batchCount; ++i )
+        {
+            done += tree->ranges[i].end - tree->ranges[i].first;
+            if( batch + 1 < batchCount && (uint64_t)done * batchCount >= (uint64_t)( batch + 1 ) * rangeTotal )
+                {
+                    tree->batches[batch].endRange     = i + 1;
+                    tree->batches[++batch].firstRange = i + 1;
+                }
+        }
+    tree->batches[batch].endRange = rangeCount;
+    batchCount                    = batch + 1;
+
+    ParallelFor( (int)batchCount, UpdateTransformBatch, tree );
+
+    for( uint32_t i = 0; i < batchCount; ++i )
+        {
+            const TransformBatch * result = &tree->batches[i];
+            if( result->changedFirst >= result->changedEnd ) continue;
+
+            if( result->changedFirst < changedFirst ) changedFirst = result->changedFirst;
+            if( result->changedEnd > changedEnd ) changedEnd = result->changedEnd;
+        }
+
+    tree->changedFirst = changedFirst;
+    tree->changedEnd   = changedEnd;
+
+    return total;
+}
+
+// Get the world transform of a transform, as of the last update
+const float *
+GetTransformWorld( const TransformTree * tree, uint32_t transform )
+{
+    if( !IsTransformValid( tree, transform ) ) return NULL;
+
+    return &tree->worlds[12 * transform];
+}
+
+// Get the world transforms of every handle, and the range of handles the last update changed
+const float *
+GetWorldTransforms( const TransformTree * tree, uint32_t * first, uint32_t * count )
+{
+    if( NULL != first ) *first = ( NULL != tree ) ? tree->changedFirst : 0;
+    if( NULL != count ) *count = ( NULL != tree ) ? tree->changedEnd - tree->changedFirst : 0;
+
+    return ( NULL != tree ) ? tree->worlds : NULL;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Check a handle is allocated
+static bool
+IsTransformValid( const TransformTree * tree, uint32_t transform )
+{
+    return NULL != tree && transform < tree->handleCount && 0 != ( tree->flags[transform] & TRANSFORM_FLAG_USED );
+}
+
+// Rebuild the depth-first order and the subtree spans
+static void
+RebuildTransformOrder( TransformTree * tree )
+{
+    const uint32_t roots    = tree->capacity; // Key of the roots, grouped as the children of a virtual node
+    uint32_t *     starts   = tree->starts;
+    uint32_t *     children = tree->scratch;
+    uint32_t *     stack    = tree->pending;
+
+    // Group the handles by parent: once filled, the children of key k are [starts[k - 1], starts[k])
+    memset( starts, 0, ( (size_t)tree->capacity + 1 ) * sizeof( uint32_t ) );
+    for( uint32_t transform = 0; transform < tree->handleCount; ++transform )
+        {
+            if( 0 == ( tree->flags[transform] & TRANSFORM_FLAG_USED ) ) continue;
+
+            const uint32_t parent = tree->parents[transform];
+            ++starts[( TRANSFORM_NONE == parent ) ? roots : parent];
+        }
+
+    uint32_t offset = 0;
+    for( uint32_t key = 0; key <= roots; ++key )
+        {
+            const uint32_t count = starts[key];
+            starts[key]          = offset;
+            offset += count;
+        }
+
+    for( uint32_t transform = 0; transform < tree->handleCount; ++transform )
+        {
+            if( 0 == ( tree->flags[transform] & TRANSFORM_FLAG_USED ) ) continue;
+
+            const uint32_t parent = tree->parents[transform];
+            children[starts[( TRANSFORM_NONE == parent ) ? roots : parent]++] = transform;
+        }
+
+    // Walk the hierarchy, lowest handles first: hierarchies created parents first keep their handle order
+    uint32_t top      = 0;
+    uint32_t position = 0;
+
+    for( uint32_t i = starts[roots]; i > starts[roots - 1]; ) stack[top++] = children[--i];
+
+    while( 0 < top )
+        {
+            const uint32_t transform = stack[--top];
+
+            tree->order[position]      = transform;
+            tree->spans[position]      = 1;
+            tree->positions[transform] = position;
+            ++position;
+
+            const uint32_t begin = ( 0 < transform ) ? starts[transform - 1] : 0;
+            for( uint32_t i = starts[transform]; i > begin; ) stack[top++] = children[--i];
+        }
+
+    tree->orderCount = position;
+    tree->orderDirty = false;
+
+    // Children follow their parent, accumulating backwards gives the subtree sizes
+    for( uint32_t i = position; 0 < i--; )
+        {
+            const uint32_t parent = tree->parents[tree->order[i]];
+            if( TRANSFORM_NONE != parent ) tree->spans[tree->positions[parent]] += tree->spans[i];
+        }
+}
+
+// World transform of a transform from the world of its parent
+static void
+ComputeTransformWorld( TransformTree * tree, uint32_t transform )
+{
+    const float *  local  = &tree->locals[12 * transform];
+    float *        world  = &tree->worlds[12 * transform];
+    const uint32_t parent = tree->parents[transform];
+
+    if( TRANSFORM_NONE == parent )
+        {
+            memcpy( world, local, 12 * sizeof( float ) );
+            return;
+        }
+
+    const float * p = &tree->worlds[12 * parent];
+    for( int r = 0; r < 3; ++r )
+        {
+            const float * row = &p[4 * r];
+            for( int c = 0; c < 4; ++c )
+                {
+                    world[4 * r + c] = row[0] * local[c] + row[1] * local[4 + c] + row[2] * local[8 + c];
+                }
+            world[4 * r + 3] += row[3];
+        }
+}
+
+// Job: recompute the ranges of a batch, parents before children
+static void
+UpdateTransformBatch( void * user, int index )
+{
+    TransformTree *  tree  = (TransformTree *)user;
+    TransformBatch * batch = &tree->batches[index];
+
+    uint32_t changedFirst = TRANSFORM_NONE;
+    uint32_t changedEnd   = 0;
+
+    for( uint32_t i = batch->firstRange; i < batch->endRange; ++i )
+        {
+            for( uint32_t position = tree->ranges[i].first; position < tree->ranges[i].end; ++position )
+                {
+                    const uint32_t transform = tree->order[position];
+
+                    ComputeTransformWorld( tree, transform );
+                    if( transform < changedFirst ) changedFirst = transform;
+                    if( transform >= changedEnd ) changedEnd = transform + 1;
+                }
+        }
+
+    batch->changedFirst = changedFirst;
+    batch->changedEnd   = changedEnd;
+}
+
+// qsort comparison of two positions
+static int
+ComparePositions( const void * a, const void * b )
+{
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+
+    return ( x > y ) - ( x < y );
+}
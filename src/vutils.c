@@ -1,6 +1,19 @@
 /******************************** VUTILS *********************************
  * vutils: Just general utilities
  *
+ *                                NOTES
+ * ------------------------------------------------------------------------
+ * INFO:
+ * - Every log line is formatted into one buffer and written with a single call, so lines from
+ *   different threads never interleave.
+ * - SetTraceLogAsync( true ) moves the writes to a background thread: TraceLog() formats the
+ *   message, stamps it with the time and the calling thread and pushes it into a lock-free ring
+ *   (bounded MPSC, one sequence number per slot), it never blocks on stdout. When the ring is
+ *   full the message is dropped and counted, the writer reports how many were lost.
+ * - LOG_FATAL flushes the ring before printing, so the messages leading to the abort are kept.
+ * - A SetTraceLogCallback() sink is always called on the logging thread, it receives the
+ *   caller's va_list.
+ *
  *                               LICENSE
  * ------------------------------------------------------------------------
  * Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
@@ -22,19 +35,76 @@
  *
  *************************************************************************/
 
+#if !defined( _WIN32 ) && !defined( _DEFAULT_SOURCE )
+#    define _DEFAULT_SOURCE // clock_gettime, nanosleep
+#endif
+
 #include "vultra/vutils.h"
 
 #include "vultra/vultra.h"
 
 #include <stdarg.h> /* va_start, va_end, va_list */
-#include <stdio.h>  /* fprintf, vfprintf, stdout */
+#include <stdint.h>
+#include <stdio.h>  /* fputs, vsnprintf, stdout */
 #include <stdlib.h> /* abort */
+#include <string.h> /* memcpy, strlen */
+
+#if defined( _WIN32 )
+#    include <process.h> /* _beginthreadex */
+// Declared manually to avoid pulling <windows.h> and its symbol clashes (CloseWindow, ...)
+__declspec( dllimport ) unsigned long __stdcall WaitForSingleObject( void * handle, unsigned long milliseconds );
+__declspec( dllimport ) int __stdcall CloseHandle( void * handle );
+__declspec( dllimport ) void __stdcall Sleep( unsigned long milliseconds );
+__declspec( dllimport ) int __stdcall QueryPerformanceCounter( int64_t * count );
+__declspec( dllimport ) int __stdcall QueryPerformanceFrequency( int64_t * frequency );
+typedef void * LogThread;
+#else
+#    include <pthread.h>
+#    include <time.h> /* clock_gettime, nanosleep */
+typedef pthread_t LogThread;
+#endif
+
+#ifndef LOG_QUEUE_SIZE
+#    define LOG_QUEUE_SIZE 1024 // Messages buffered in async mode (power of two)
+#endif
+
+#ifndef LOG_MESSAGE_LENGTH
+#    define LOG_MESSAGE_LENGTH 256 // Longer messages are truncated, ending with "..."
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Message waiting in the ring for the writer thread
+typedef struct LogRecord
+{
+    long   sequence; // Position the slot is ready for: enqueue when equal to it, dequeue when one past it (atomic)
+    double time;     // Seconds since async logging started
+    int    thread;   // Logging thread, in order of first use
+    int    level;
+    char   text[LOG_MESSAGE_LENGTH];
+} LogRecord;
 
 //----------------------------------------------------------------------------------------------------------------------
 // Module Declaration
 //----------------------------------------------------------------------------------------------------------------------
 void SetTraceLogLevel( int logType );                  // Set a minimum log level
 void TraceLog( int logLevel, const char * text, ... ); // Display a log message
+void SetTraceLogAsync( bool enabled );                 // Write log messages from a background thread
+void FlushTraceLog( void );                            // Wait until every queued message was written
+
+static const char * LevelToStr( int logType );
+static double       LogClock( void );
+static void         LogSleep( void );
+static void         FormatLogText( char * out, size_t size, const char * text, va_list args );
+static bool         PushRecord( int logType, const char * text, va_list args );
+static bool         PopRecord( LogRecord * out );
+static void         WriteRecords( void );
+#if defined( _WIN32 )
+static unsigned __stdcall WriterMain( void * argument );
+#else
+static void * WriterMain( void * argument );
+#endif
 
 //----------------------------------------------------------------------------------------------------------------------
 // Variables Definition
@@ -42,6 +112,21 @@ void TraceLog( int logLevel, const char * text, ... ); // Display a log message
 static int              logLevel = LOG_INFO; // Current log level
 static TraceLogCallback traceLog = NULL;     // Custom trace log function
 
+static struct
+{
+    LogRecord records[LOG_QUEUE_SIZE];
+    long      enqueue; // Next position claimed by a producer (atomic)
+    long      dequeue; // Next position read by the writer (atomic, written by the writer only)
+    long      dropped; // Messages lost to a full ring (atomic)
+    long      threads; // Logging threads seen so far (atomic)
+    long      running; // Writer thread keeps polling while set (atomic)
+    bool      enabled;
+    double    start;
+    LogThread writer;
+} queue = { 0 };
+
+static THREAD_LOCAL int threadId = -1; // Id of the calling thread in log lines, assigned on its first async message
+
 //----------------------------------------------------------------------------------------------------------------------
 // Callbacks
 //----------------------------------------------------------------------------------------------------------------------
@@ -80,26 +165,232 @@ TraceLog( int logType, const char * text, ... )
             return;
         }
 
-    // Determine log level string
-    char * levelString;
-    switch( logType )
+    // Queue for the writer thread, fatal messages are written right away after the queued ones
+    if( queue.enabled && LOG_FATAL != logType )
         {
-        case LOG_TRACE:   levelString = "TRACE"; break;
-        case LOG_DEBUG:   levelString = "DEBUG"; break;
-        case LOG_INFO:    levelString = "INFO"; break;
-        case LOG_WARNING: levelString = "WARNING"; break;
-        case LOG_ERROR:   levelString = "ERROR"; break;
-        case LOG_FATAL:   levelString = "FATAL"; break;
-        default:          levelString = "UNKNOWN"; break;
+            if( !PushRecord( logType, text, args ) ) ATOMIC_FETCH_ADD( &queue.dropped, 1 );
+            va_end( args );
+            return;
         }
 
-    // Print log message
-    fprintf( stdout, "%s: ", levelString );
-    vfprintf( stdout, text, args );
-    fprintf( stdout, "\n" );
+    if( queue.enabled ) FlushTraceLog();
+
+    // Print log message as a single write
+    char line[LOG_MESSAGE_LENGTH + 16];
+    int  length = snprintf( line, sizeof( line ), "%s: ", LevelToStr( logType ) );
+    FormatLogText( line + length, sizeof( line ) - (size_t)length - 1, text, args );
+    length           = (int)strlen( line );
+    line[length]     = '\n';
+    line[length + 1] = '\0';
+    fputs( line, stdout );
 
     va_end( args );
 
     // Handle fatal errors
-    if( UNLIKELY( logType == LOG_FATAL ) ) abort();
+    if( UNLIKELY( logType == LOG_FATAL ) )
+        {
+            fflush( stdout );
+            abort();
+        }
+}
+
+// Write log messages from a background thread, disabling it writes the pending messages first.
+// Toggle it while no other thread logs (before InitWindow() / after CloseWindow())
+void
+SetTraceLogAsync( bool enabled )
+{
+    if( enabled == queue.enabled ) return;
+
+    if( enabled )
+        {
+            for( long i = 0; i < LOG_QUEUE_SIZE; ++i ) queue.records[i].sequence = i;
+            queue.enqueue = 0;
+            queue.dequeue = 0;
+            queue.dropped = 0;
+            queue.start   = LogClock();
+            ATOMIC_STORE( &queue.running, 1 );
+
+#if defined( _WIN32 )
+            queue.writer = (LogThread)_beginthreadex( NULL, 0, WriterMain, NULL, 0, NULL );
+            if( NULL == queue.writer ) return;
+#else
+            if( 0 != pthread_create( &queue.writer, NULL, WriterMain, NULL ) ) return;
+#endif
+            queue.enabled = true;
+            return;
+        }
+
+    queue.enabled = false;
+    ATOMIC_STORE( &queue.running, 0 );
+#if defined( _WIN32 )
+    WaitForSingleObject( queue.writer, 0xFFFFFFFFUL );
+    CloseHandle( queue.writer );
+#else
+    pthread_join( queue.writer, NULL );
+#endif
+}
+
+// Wait until every message queued so far was written
+void
+FlushTraceLog( void )
+{
+    if( queue.enabled )
+        {
+            const long target = ATOMIC_LOAD( &queue.enqueue );
+            while( 0 < (long)( (unsigned long)target - (unsigned long)ATOMIC_LOAD( &queue.dequeue ) ) ) LogSleep();
+        }
+
+    fflush( stdout );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Get the name printed for a log level
+static const char *
+LevelToStr( int logType )
+{
+    switch( logType )
+        {
+        case LOG_TRACE:   return "TRACE";
+        case LOG_DEBUG:   return "DEBUG";
+        case LOG_INFO:    return "INFO";
+        case LOG_WARNING: return "WARNING";
+        case LOG_ERROR:   return "ERROR";
+        case LOG_FATAL:   return "FATAL";
+        default:          return "UNKNOWN";
+        }
+}
+
+// Get a monotonic time in seconds, usable before the platform is initialized
+static double
+LogClock( void )
+{
+#if defined( _WIN32 )
+    int64_t count, frequency;
+    QueryPerformanceCounter( &count );
+    QueryPerformanceFrequency( &frequency );
+    return (double)count / (double)frequency;
+#else
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#endif
+}
+
+// Yield the writer (or a flushing thread) while the ring has nothing for it
+static void
+LogSleep( void )
+{
+#if defined( _WIN32 )
+    Sleep( 1 );
+#else
+    const struct timespec delay = { 0, 500000 };
+    nanosleep( &delay, NULL );
+#endif
+}
+
+// Format a message into the next free slot, false when the ring is full
+static bool
+PushRecord( int logType, const char * text, va_list args )
+{
+    if( UNLIKELY( 0 > threadId ) ) threadId = (int)ATOMIC_FETCH_ADD( &queue.threads, 1 );
+
+    // Claim a position, the slot is free once the writer released the previous lap
+    LogRecord * record;
+    long        position = ATOMIC_LOAD( &queue.enqueue );
+    for( ;; )
+        {
+            record          = &queue.records[(unsigned long)position & ( LOG_QUEUE_SIZE - 1 )];
+            const long diff = (long)( (unsigned long)ATOMIC_LOAD( &record->sequence ) - (unsigned long)position );
+            if( 0 == diff )
+                {
+                    if( ATOMIC_CAS( &queue.enqueue, position, position + 1 ) ) break;
+                    position = ATOMIC_LOAD( &queue.enqueue );
+                }
+            else if( 0 > diff ) return false;
+            else position = ATOMIC_LOAD( &queue.enqueue );
+        }
+
+    record->time   = LogClock() - queue.start;
+    record->thread = threadId;
+    record->level  = logType;
+    FormatLogText( record->text, sizeof( record->text ), text, args );
+
+    // Publish to the writer
+    ATOMIC_STORE( &record->sequence, position + 1 );
+    return true;
+}
+
+// Format a message into out, a truncated one ends with "..." so it never passes for complete
+static void
+FormatLogText( char * out, size_t size, const char * text, va_list args )
+{
+    const int length = vsnprintf( out, size, text, args );
+    if( 4 <= size && 0 <= length && (size_t)length >= size ) memcpy( out + size - 4, "...", 4 );
+}
+
+// Copy the oldest published message out of the ring, false when it is empty
+static bool
+PopRecord( LogRecord * out )
+{
+    const long  position = queue.dequeue;
+    LogRecord * record   = &queue.records[(unsigned long)position & ( LOG_QUEUE_SIZE - 1 )];
+    if( position + 1 != ATOMIC_LOAD( &record->sequence ) ) return false;
+
+    *out = *record;
+
+    // Hand the slot to the producers of the next lap
+    ATOMIC_STORE( &record->sequence, position + LOG_QUEUE_SIZE );
+    ATOMIC_STORE( &queue.dequeue, position + 1 );
+    return true;
+}
+
+// Write every published message, one write per line
+static void
+WriteRecords( void )
+{
+    LogRecord record;
+    char      line[LOG_MESSAGE_LENGTH + 48];
+    bool      written = false;
+
+    while( PopRecord( &record ) )
+        {
+            snprintf( line, sizeof( line ), "[%10.6f] [%2d] %s: %s\n", record.time, record.thread,
+                      LevelToStr( record.level ), record.text );
+            fputs( line, stdout );
+            written = true;
+        }
+
+    const long dropped = ATOMIC_LOAD( &queue.dropped );
+    if( 0 < dropped )
+        {
+            ATOMIC_FETCH_ADD( &queue.dropped, -dropped );
+            fprintf( stdout, "WARNING: %ld log messages dropped, the queue was full\n", dropped );
+            written = true;
+        }
+
+    if( written ) fflush( stdout );
+}
+
+// Writer loop: write what was published, sleep briefly when idle, so producers never make a syscall
+#if defined( _WIN32 )
+static unsigned __stdcall WriterMain( void * argument )
+#else
+static void *
+WriterMain( void * argument )
+#endif
+{
+    UNUSED( argument );
+
+    while( ATOMIC_LOAD( &queue.running ) )
+        {
+            WriteRecords();
+            LogSleep();
+        }
+
+    // Drain what was queued before the shutdown
+    WriteRecords();
+
+    return 0;
 }
@@ -0,0 +1,1373 @@
+/*******************************************************************************************
+*
+*   Vultra Tool - Asset Cooker
+*
+*   Initially created with Vultra v25.0.0
+*
+*   Converts a source asset into the GPU ready format the runtime copies as is, so loading
+*   does no parsing, filtering nor compression. The type follows the input extension:
+*
+*       vultra-cook [-n | -u] input output
+*
+*       .obj        Cooked mesh (see vultra/vmesh.h): triangles ordered for the vertex cache,
+*                   then clusters ordered against overdraw, vertices ordered by first use and
+*                   quantized to 16 bytes (16 bit positions and texcoords, 8 bit snorm normals)
+*       .png .jpg   KTX2 texture holding its full mip chain, BC7 compressed (see LoadTexture())
+*       .tga .bmp
+*
+*       -n          Normal map: mips renormalized, BC5 compressed (x and y, the shader rebuilds z)
+*       -u          Texture left uncompressed (RGBA8), for devices without BC support
+*
+*   Cooked files can then be gathered into an asset pack with vultra-pack.
+*
+*   Licensed under the zlib/libpng license.
+*   Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+*
+********************************************************************************************/
+
+#include "vultra/vmesh.h"
+#include "vultra/vultra.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_STATIC
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#define STBI_ONLY_TGA
+#define STBI_ONLY_BMP
+#include "stb_image.h"
+
+#define FORSYTH_CACHE_SIZE          32    // Simulated LRU cache of the vertex cache optimization
+#define FORSYTH_DECAY_POWER         1.5f  // Score falloff along the cache
+#define FORSYTH_LAST_TRIANGLE_SCORE 0.75f // Vertices of the last triangle, discouraging strips that flip
+#define FORSYTH_VALENCE_SCALE       2.0f  // Boost of vertices with few triangles left, so none are orphaned
+#define FORSYTH_VALENCE_POWER       0.5f
+
+#define OVERDRAW_CACHE_SIZE 16 // FIFO cache simulated to split the triangles into clusters
+
+#define KTX2_FORMAT_RGBA8_UNORM 37
+#define KTX2_FORMAT_BC5_UNORM   141
+#define KTX2_FORMAT_BC7_UNORM   145
+#define KTX2_HEADER_SIZE        80
+#define KTX2_LEVEL_SIZE         24
+#define KTX2_MAX_LEVELS         16
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------------------------------------------
+// Mesh vertex before quantization
+typedef struct CookVertex
+{
+    float position[3];
+    float normal[3];
+    float texcoord[2];
+} CookVertex;
+
+// OBJ face corner, indices into the attribute arrays (-1 when missing)
+typedef struct ObjCorner
+{
+    int position;
+    int texcoord;
+    int normal;
+} ObjCorner;
+
+// Triangle cluster of the overdraw optimization
+typedef struct Cluster
+{
+    uint32_t first; // First triangle
+    uint32_t count;
+    float    sortKey;
+} Cluster;
+
+typedef enum
+{
+    TEXTURE_BC7 = 0,
+    TEXTURE_BC5,
+    TEXTURE_RGBA8
+} TextureEncoding;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Variables Definition
+//----------------------------------------------------------------------------------------------------------------------
+// BC7 mode 6 interpolation weights (one subset, RGBA endpoints of 7 bits plus a p-bit each, 4 bit indices)
+static const int bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Declaration
+//----------------------------------------------------------------------------------------------------------------------
+static bool CookMesh( const char * input, const char * output );
+static bool CookTexture( const char * input, const char * output, TextureEncoding encoding );
+
+static bool     ParseObj( char * text, CookVertex ** vertices, uint32_t * vertexCount, uint32_t ** indices,
+                          uint32_t * indexCount );
+static uint32_t HashCorner( const ObjCorner * corner );
+static bool     OptimizeVertexCache( uint32_t * indices, uint32_t indexCount, uint32_t vertexCount );
+static bool     OptimizeOverdraw( uint32_t * indices, uint32_t indexCount, const CookVertex * vertices,
+                                  uint32_t vertexCount );
+static uint32_t OptimizeVertexFetch( uint32_t * indices, uint32_t indexCount, CookVertex * vertices,
+                                     uint32_t vertexCount );
+static float    GetVertexScore( int cachePosition, uint32_t liveTriangles );
+static int      CompareClusters( const void * a, const void * b );
+
+static void BuildMip( const unsigned char * src, uint32_t srcWidth, uint32_t srcHeight, unsigned char * dst,
+                      uint32_t width, uint32_t height, bool normalMap );
+static void     EncodeBc7( const unsigned char pixels[16][4], unsigned char * block );
+static uint32_t FitBc7( const unsigned char pixels[16][4], const float low[4], const float high[4], int p0, int p1,
+                        unsigned char endpoints[2][4], unsigned char indices[16] );
+static void     EncodeBc4( const unsigned char values[16], unsigned char * block );
+
+static bool            Reserve( void ** data, uint32_t * capacity, uint32_t count, size_t size );
+static unsigned char * ReadWholeFile( const char * path, long * size );
+static bool            WriteWholeFile( const char * path, const void * data, size_t size );
+static void            PutBits( uint64_t bits[2], uint32_t * offset, uint32_t value, uint32_t width );
+static void            PutU32( unsigned char * data, uint32_t value );
+static void            PutU64( unsigned char * data, uint64_t value );
+static bool            HasExtension( const char * path, const char * extension );
+static uint32_t        GetMipSize( uint32_t size, uint32_t mip );
+
+//----------------------------------------------------------------------------------------------------------------------
+// Program main entry point
+//----------------------------------------------------------------------------------------------------------------------
+int
+main( int argc, char ** argv )
+{
+    TextureEncoding encoding = TEXTURE_BC7;
+    int             first    = 1;
+
+    for( ; first < argc && '-' == argv[first][0]; ++first )
+        {
+            if( 0 == strcmp( argv[first], "-n" ) ) encoding = TEXTURE_BC5;
+            else if( 0 == strcmp( argv[first], "-u" ) ) encoding = TEXTURE_RGBA8;
+            else break;
+        }
+
+    if( first + 2 != argc )
+        {
+            fprintf( stderr, "usage: vultra-cook [-n | -u] input output\n" );
+            return EXIT_FAILURE;
+        }
+
+    const char * input  = argv[first];
+    const char * output = argv[first + 1];
+
+    const bool success = HasExtension( input, ".obj" ) ? CookMesh( input, output )
+                                                        : CookTexture( input, output, encoding );
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Definition: Meshes
+//----------------------------------------------------------------------------------------------------------------------
+// Optimize, quantize and write a mesh
+static bool
+CookMesh( const char * input, const char * output )
+{
+    long            size        = 0;
+    char *          text        = (char *)ReadWholeFile( input, &size );
+    CookVertex *    vertices    = NULL;
+    uint32_t *      indices     = NULL;
+    uint32_t        vertexCount = 0;
+    uint32_t        indexCount  = 0;
+    unsigned char * data        = NULL;
+    bool            success     = false;
+
+    if( NULL == text )
+        {
+            fprintf( stderr, "vultra-cook: cannot read %s\n", input );
+            return false;
+        }
+
+    text[size] = '\0';
+
+    if( !ParseObj( text, &vertices, &vertexCount, &indices, &indexCount ) || 0 == indexCount )
+        {
+            fprintf( stderr, "vultra-cook: %s has no valid triangles\n", input );
+        }
+    else if( OptimizeVertexCache( indices, indexCount, vertexCount )
+             && OptimizeOverdraw( indices, indexCount, vertices, vertexCount ) )
+        {
+            vertexCount = OptimizeVertexFetch( indices, indexCount, vertices, vertexCount );
+
+            MeshHeader header  = { 0 };
+            header.magic       = MESH_MAGIC;
+            header.version     = MESH_VERSION;
+            header.vertexCount = vertexCount;
+            header.indexCount  = indexCount;
+            header.indexSize   = ( 65535 >= vertexCount ) ? 2 : 4;
+
+            // Bounds the attributes are normalized over
+            float low[5], high[5];
+            for( int c = 0; c < 5; ++c )
+                {
+                    low[c]  = FLT_MAX;
+                    high[c] = -FLT_MAX;
+                }
+
+            for( uint32_t i = 0; i < vertexCount; ++i )
+                {
+                    const float attributes[5] = { vertices[i].position[0], vertices[i].position[1],
+                                                  vertices[i].position[2], vertices[i].texcoord[0],
+                                                  vertices[i].texcoord[1] };
+                    for( int c = 0; c < 5; ++c )
+                        {
+                            if( attributes[c] < low[c] ) low[c] = attributes[c];
+                            if( attributes[c] > high[c] ) high[c] = attributes[c];
+                        }
+                }
+
+            for( int c = 0; c < 3; ++c )
+                {
+                    header.positionOffset[c] = low[c];
+                    header.positionScale[c]  = high[c] - low[c];
+                }
+
+            for( int c = 0; c < 2; ++c )
+                {
+                    header.texcoordOffset[c] = low[3 + c];
+                    header.texcoordScale[c]  = high[3 + c] - low[3 + c];
+                }
+
+            const size_t vertexBytes = (size_t)vertexCount * sizeof( MeshVertex );
+            const size_t dataSize    = sizeof( MeshHeader ) + vertexBytes + (size_t)indexCount * header.indexSize;
+
+            data = (unsigned char *)calloc( 1, dataSize );
+            if( NULL != data )
+                {
+                    MeshVertex * cooked = (MeshVertex *)( data + sizeof( MeshHeader ) );
+                    memcpy( data, &header, sizeof( MeshHeader ) );
+
+                    for( uint32_t i = 0; i < vertexCount; ++i )
+                        {
+                            const CookVertex * vertex = &vertices[i];
+
+                            for( int c = 0; c < 3; ++c )
+                                {
+                                    const float scale = header.positionScale[c];
+                                    const float unorm
+                                        = ( 0.0f < scale ) ? ( vertex->position[c] - low[c] ) / scale : 0.0f;
+                                    const float snorm = vertex->normal[c] * 127.0f;
+
+                                    cooked[i].position[c] = (uint16_t)( unorm * 65535.0f + 0.5f );
+                                    cooked[i].normal[c]   = (int8_t)( ( 0.0f > snorm ) ? snorm - 0.5f : snorm + 0.5f );
+                                }
+
+                            for( int c = 0; c < 2; ++c )
+                                {
+                                    const float scale = header.texcoordScale[c];
+                                    const float unorm
+                                        = ( 0.0f < scale ) ? ( vertex->texcoord[c] - low[3 + c] ) / scale : 0.0f;
+
+                                    cooked[i].texcoord[c] = (uint16_t)( unorm * 65535.0f + 0.5f );
+                                }
+                        }
+
+                    unsigned char * index = data + sizeof( MeshHeader ) + vertexBytes;
+                    for( uint32_t i = 0; i < indexCount; ++i )
+                        {
+                            if( 2 == header.indexSize ) ( (uint16_t *)index )[i] = (uint16_t)indices[i];
+                            else ( (uint32_t *)index )[i] = indices[i];
+                        }
+
+                    success = WriteWholeFile( output, data, dataSize );
+                }
+
+            if( success )
+                {
+                    printf( "vultra-cook: %s: %u vertices, %u triangles, %u byte indices\n", output, vertexCount,
+                            indexCount / 3, header.indexSize );
+                }
+        }
+
+    free( data );
+    free( indices );
+    free( vertices );
+    free( text );
+
+    return success;
+}
+
+// Parse the triangles of an OBJ file (polygons are fanned), corners sharing every attribute share a vertex
+static bool
+ParseObj( char * text, CookVertex ** vertices, uint32_t * vertexCount, uint32_t ** indices, uint32_t * indexCount )
+{
+    float *     positions        = NULL;
+    float *     texcoords        = NULL;
+    float *     normals          = NULL;
+    ObjCorner * corners          = NULL; // Unique corners, one per vertex
+    uint32_t *  table            = NULL; // Corner hash table, vertex index + 1 (0: empty)
+    uint32_t    positionCount    = 0;
+    uint32_t    positionCapacity = 0;
+    uint32_t    texcoordCount    = 0;
+    uint32_t    texcoordCapacity = 0;
+    uint32_t    normalCount      = 0;
+    uint32_t    normalCapacity   = 0;
+    uint32_t    cornerCapacity   = 0;
+    uint32_t    indexCapacity    = 0;
+    uint32_t    tableSize        = 0;
+    bool        success          = true;
+
+    *vertices    = NULL;
+    *indices     = NULL;
+    *vertexCount = 0;
+    *indexCount  = 0;
+
+    for( char * line = text; success && '\0' != *line; )
+        {
+            char * next = line + strcspn( line, "\n" );
+            if( '\0' != *next ) *next++ = '\0';
+
+            if( 'v' == line[0] && ' ' == line[1] )
+                {
+                    success = Reserve( (void **)&positions, &positionCapacity, positionCount + 1, 3 * sizeof( float ) );
+                    if( success )
+                        {
+                            float * p = positions + 3 * positionCount++;
+                            success   = ( 3 == sscanf( line + 2, "%f %f %f", &p[0], &p[1], &p[2] ) );
+                        }
+                }
+            else if( 'v' == line[0] && 't' == line[1] )
+                {
+                    success = Reserve( (void **)&texcoords, &texcoordCapacity, texcoordCount + 1, 2 * sizeof( float ) );
+                    if( success )
+                        {
+                            float * t = texcoords + 2 * texcoordCount++;
+                            success   = ( 2 == sscanf( line + 3, "%f %f", &t[0], &t[1] ) );
+                            t[1]      = 1.0f - t[1]; // OBJ puts v = 0 at the bottom
+                        }
+                }
+            else if( 'v' == line[0] && 'n' == line[1] )
+                {
+                    success = Reserve( (void **)&normals, &normalCapacity, normalCount + 1, 3 * sizeof( float ) );
+                    if( success )
+                        {
+                            float * n = normals + 3 * normalCount++;
+                            success   = ( 3 == sscanf( line + 3, "%f %f %f", &n[0], &n[1], &n[2] ) );
+                        }
+                }
+            else if( 'f' == line[0] && ' ' == line[1] )
+                {
+                    uint32_t face[3];
+                    uint32_t corner = 0;
+
+                    for( char * p = line + 2; success; ++corner )
+                        {
+                            while( ' ' == *p || '\t' == *p || '\r' == *p ) ++p;
+                            if( '\0' == *p ) break;
+
+                            // v, v/vt, v//vn or v/vt/vn, negative indices count from the end
+                            long values[3] = { 0, 0, 0 };
+                            for( int k = 0; k < 3 && success; ++k )
+                                {
+                                    char * end;
+                                    if( 0 < k && '/' != *p ) break;
+                                    if( 0 < k ) ++p;
+                                    if( 0 < k && '/' == *p ) continue;
+
+                                    values[k] = strtol( p, &end, 10 );
+                                    success   = ( end != p );
+                                    p         = end;
+                                }
+
+                            const long counts[3] = { (long)positionCount, (long)texcoordCount, (long)normalCount };
+                            int        resolved[3];
+                            for( int k = 0; k < 3; ++k )
+                                {
+                                    const long index = ( 0 > values[k] ) ? counts[k] + values[k] : values[k] - 1;
+                                    resolved[k]      = ( 0 <= index && index < counts[k] ) ? (int)index : -1;
+                                    if( 0 != values[k] && 0 > resolved[k] ) success = false;
+                                }
+
+                            if( !success || 0 > resolved[0] ) break;
+
+                            const ObjCorner key = { resolved[0], resolved[1], resolved[2] };
+
+                            // Deduplicate the corner
+                            if( 2 * ( *vertexCount + 1 ) > tableSize )
+                                {
+                                    const uint32_t size    = ( 0 == tableSize ) ? 1024 : 2 * tableSize;
+                                    uint32_t *     resized = (uint32_t *)calloc( size, sizeof( uint32_t ) );
+                                    if( NULL == resized )
+                                        {
+                                            success = false;
+                                            break;
+                                        }
+
+                                    for( uint32_t v = 0; v < *vertexCount; ++v )
+                                        {
+                                            uint32_t h = HashCorner( &corners[v] );
+                                            while( 0 != resized[h & ( size - 1 )] ) ++h;
+                                            resized[h & ( size - 1 )] = v + 1;
+                                        }
+
+                                    free( table );
+                                    table     = resized;
+                                    tableSize = size;
+                                }
+
+                            uint32_t h      = HashCorner( &key );
+                            uint32_t vertex = UINT32_MAX;
+                            for( ; 0 != table[h & ( tableSize - 1 )]; ++h )
+                                {
+                                    const uint32_t    candidate = table[h & ( tableSize - 1 )] - 1;
+                                    const ObjCorner * c         = &corners[candidate];
+                                    if( c->position == key.position && c->texcoord == key.texcoord
+                                        && c->normal == key.normal )
+                                        {
+                                            vertex = candidate;
+                                            break;
+                                        }
+                                }
+
+                            if( UINT32_MAX == vertex )
+                                {
+                                    if( !Reserve( (void **)&corners, &cornerCapacity, *vertexCount + 1,
+                                                  sizeof( ObjCorner ) ) )
+                                        {
+                                            success = false;
+                                            break;
+                                        }
+
+                                    vertex                       = ( *vertexCount )++;
+                                    corners[vertex]              = key;
+                                    table[h & ( tableSize - 1 )] = vertex + 1;
+                                }
+
+                            // Fan: 0 1 2, 0 2 3, ...
+                            if( 2 > corner ) face[corner] = vertex;
+                            else
+                                {
+                                    face[2] = vertex;
+
+                                    const bool degenerate
+                                        = ( face[0] == face[1] || face[1] == face[2] || face[0] == face[2] );
+                                    if( !degenerate )
+                                        {
+                                            if( !Reserve( (void **)indices, &indexCapacity, *indexCount + 3,
+                                                          sizeof( uint32_t ) ) )
+                                                {
+                                                    success = false;
+                                                    break;
+                                                }
+
+                                            memcpy( *indices + *indexCount, face, sizeof( face ) );
+                                            *indexCount += 3;
+                                        }
+
+                                    face[1] = face[2];
+                                }
+                        }
+                }
+
+            line = next;
+        }
+
+    if( success && 0 < *vertexCount )
+        {
+            *vertices = (CookVertex *)calloc( *vertexCount, sizeof( CookVertex ) );
+            success   = ( NULL != *vertices );
+        }
+
+    // Smooth normals per position for the corners that have none, area weighted
+    float * smooth = NULL;
+    if( success && 0 < *vertexCount )
+        {
+            smooth  = (float *)calloc( positionCount, 3 * sizeof( float ) );
+            success = ( NULL != smooth );
+        }
+
+    for( uint32_t i = 0; success && i < *indexCount; i += 3 )
+        {
+            const float * a     = positions + 3 * corners[( *indices )[i]].position;
+            const float * b     = positions + 3 * corners[( *indices )[i + 1]].position;
+            const float * c     = positions + 3 * corners[( *indices )[i + 2]].position;
+            const float   e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            const float   e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+            const float   n[3]  = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2],
+                                    e0[0] * e1[1] - e0[1] * e1[0] };
+
+            for( int k = 0; k < 3; ++k )
+                {
+                    float * accumulated = smooth + 3 * corners[( *indices )[i + k]].position;
+                    for( int j = 0; j < 3; ++j ) accumulated[j] += n[j];
+                }
+        }
+
+    for( uint32_t v = 0; success && v < *vertexCount; ++v )
+        {
+            const ObjCorner * corner = &corners[v];
+            CookVertex *      vertex = &( *vertices )[v];
+            const float *     normal = ( 0 <= corner->normal ) ? normals + 3 * corner->normal
+                                                                : smooth + 3 * corner->position;
+            const float       length
+                = sqrtf( normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2] );
+
+            memcpy( vertex->position, positions + 3 * corner->position, 3 * sizeof( float ) );
+            if( 0 <= corner->texcoord )
+                {
+                    memcpy( vertex->texcoord, texcoords + 2 * corner->texcoord, 2 * sizeof( float ) );
+                }
+            for( int k = 0; k < 3; ++k ) vertex->normal[k] = ( 0.0f < length ) ? normal[k] / length : 0.0f;
+        }
+
+    free( smooth );
+    free( table );
+    free( corners );
+    free( normals );
+    free( texcoords );
+    free( positions );
+
+    return success;
+}
+
+// Hash of the attribute indices of a corner
+static uint32_t
+HashCorner( const ObjCorner * corner )
+{
+    return ( (uint32_t)corner->position * 73856093U ) ^ ( (uint32_t)corner->texcoord * 19349663U )
+           ^ ( (uint32_t)corner->normal * 83492791U );
+}
+
+// Reorder the triangles for the post-transform vertex cache (Tom Forsyth's linear-speed algorithm)
+static bool
+OptimizeVertexCache( uint32_t * indices, uint32_t indexCount, uint32_t vertexCount )
+{
+    const uint32_t  triangleCount = indexCount / 3;
+    uint32_t *      live          = (uint32_t *)calloc( vertexCount + 1, sizeof( uint32_t ) );
+    uint32_t *      offsets       = (uint32_t *)calloc( vertexCount + 1, sizeof( uint32_t ) );
+    uint32_t *      adjacency     = (uint32_t *)malloc( indexCount * sizeof( uint32_t ) );
+    int *           position      = (int *)malloc( ( vertexCount + 1 ) * sizeof( int ) );
+    float *         score         = (float *)malloc( ( vertexCount + 1 ) * sizeof( float ) );
+    unsigned char * emitted       = (unsigned char *)calloc( triangleCount, 1 );
+    uint32_t *      output        = (uint32_t *)malloc( indexCount * sizeof( uint32_t ) );
+    const bool      success       = ( NULL != live && NULL != offsets && NULL != adjacency && NULL != position
+                                      && NULL != score && NULL != emitted && NULL != output );
+
+    if( success )
+        {
+            // Triangles of every vertex, live[] counts the ones not emitted yet
+            for( uint32_t i = 0; i < indexCount; ++i ) ++offsets[indices[i] + 1];
+            for( uint32_t v = 0; v < vertexCount; ++v ) offsets[v + 1] += offsets[v];
+            for( uint32_t i = 0; i < indexCount; ++i ) adjacency[offsets[indices[i]] + live[indices[i]]++] = i / 3;
+
+            for( uint32_t v = 0; v < vertexCount; ++v )
+                {
+                    position[v] = -1;
+                    score[v]    = GetVertexScore( -1, live[v] );
+                }
+
+            uint32_t best      = 0;
+            float    bestScore = -1.0f;
+            for( uint32_t t = 0; t < triangleCount; ++t )
+                {
+                    const float s = score[indices[3 * t]] + score[indices[3 * t + 1]] + score[indices[3 * t + 2]];
+                    if( s > bestScore )
+                        {
+                            best      = t;
+                            bestScore = s;
+                        }
+                }
+
+            uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+            uint32_t cacheCount = 0;
+            uint32_t cursor     = 0;
+
+            for( uint32_t out = 0; out < triangleCount; ++out )
+                {
+                    // Nothing left around the cache: resume from the first triangle not emitted
+                    if( UINT32_MAX == best )
+                        {
+                            while( emitted[cursor] ) ++cursor;
+                            best = cursor;
+                        }
+
+                    const uint32_t * triangle = indices + 3 * best;
+                    memcpy( output + 3 * out, triangle, 3 * sizeof( uint32_t ) );
+                    emitted[best] = 1;
+
+                    for( int k = 0; k < 3; ++k )
+                        {
+                            uint32_t * list = adjacency + offsets[triangle[k]];
+                            for( uint32_t j = 0; j < live[triangle[k]]; ++j )
+                                {
+                                    if( list[j] == best )
+                                        {
+                                            list[j] = list[--live[triangle[k]]];
+                                            break;
+                                        }
+                                }
+                        }
+
+                    // The triangle moves to the front of the cache, the entries pushed past its end leave it
+                    uint32_t next[FORSYTH_CACHE_SIZE + 3];
+                    uint32_t nextCount = 0;
+
+                    for( int k = 0; k < 3; ++k ) next[nextCount++] = triangle[k];
+                    for( uint32_t i = 0; i < cacheCount; ++i )
+                        {
+                            const uint32_t v = cache[i];
+                            if( v != triangle[0] && v != triangle[1] && v != triangle[2] ) next[nextCount++] = v;
+                        }
+
+                    for( uint32_t i = 0; i < nextCount; ++i )
+                        {
+                            const uint32_t v = next[i];
+                            position[v]      = ( FORSYTH_CACHE_SIZE > i ) ? (int)i : -1;
+                            score[v]         = GetVertexScore( position[v], live[v] );
+                        }
+
+                    // Next triangle: the best one touching the cache
+                    best      = UINT32_MAX;
+                    bestScore = -1.0f;
+                    for( uint32_t i = 0; i < nextCount; ++i )
+                        {
+                            const uint32_t * list = adjacency + offsets[next[i]];
+                            for( uint32_t j = 0; j < live[next[i]]; ++j )
+                                {
+                                    const uint32_t * t = indices + 3 * list[j];
+                                    const float      s = score[t[0]] + score[t[1]] + score[t[2]];
+                                    if( s > bestScore )
+                                        {
+                                            best      = list[j];
+                                            bestScore = s;
+                                        }
+                                }
+                        }
+
+                    cacheCount = ( FORSYTH_CACHE_SIZE < nextCount ) ? FORSYTH_CACHE_SIZE : nextCount;
+                    memcpy( cache, next, cacheCount * sizeof( uint32_t ) );
+                }
+
+            memcpy( indices, output, indexCount * sizeof( uint32_t ) );
+        }
+
+    free( output );
+    free( emitted );
+    free( score );
+    free( position );
+    free( adjacency );
+    free( offsets );
+    free( live );
+
+    return success;
+}
+
+// Score of a vertex for the next triangle, -1 once all its triangles are emitted
+static float
+GetVertexScore( int cachePosition, uint32_t liveTriangles )
+{
+    if( 0 == liveTriangles ) return -1.0f;
+
+    float score = 0.0f;
+    if( 0 <= cachePosition && 3 > cachePosition ) score = FORSYTH_LAST_TRIANGLE_SCORE;
+    else if( 0 <= cachePosition )
+        {
+            const float scale = 1.0f / ( FORSYTH_CACHE_SIZE - 3 );
+            score             = powf( 1.0f - (float)( cachePosition - 3 ) * scale, FORSYTH_DECAY_POWER );
+        }
+
+    return score + FORSYTH_VALENCE_SCALE * powf( (float)liveTriangles, -FORSYTH_VALENCE_POWER );
+}
+
+// Split the cache ordered triangles into clusters where the cache restarts, then draw the clusters facing away
+// from the mesh center first: they tend to occlude the others, which then fail the depth test (Sander et al.)
+static bool
+OptimizeOverdraw( uint32_t * indices, uint32_t indexCount, const CookVertex * vertices, uint32_t vertexCount )
+{
+    const uint32_t triangleCount = indexCount / 3;
+    uint32_t *     stamps        = (uint32_t *)calloc( vertexCount + 1, sizeof( uint32_t ) );
+    Cluster *      clusters      = (Cluster *)malloc( triangleCount * sizeof( Cluster ) );
+    uint32_t *     output        = (uint32_t *)malloc( indexCount * sizeof( uint32_t ) );
+    uint32_t       clusterCount  = 0;
+    uint32_t       time          = OVERDRAW_CACHE_SIZE + 1;
+    const bool     success       = ( NULL != stamps && NULL != clusters && NULL != output );
+
+    if( success )
+        {
+            for( uint32_t t = 0; t < triangleCount; ++t )
+                {
+                    uint32_t misses = 0;
+                    for( int k = 0; k < 3; ++k )
+                        {
+                            const uint32_t v = indices[3 * t + k];
+                            if( OVERDRAW_CACHE_SIZE < time - stamps[v] )
+                                {
+                                    stamps[v] = time++;
+                                    ++misses;
+                                }
+                        }
+
+                    if( 0 == t || 3 == misses ) clusters[clusterCount++].first = t;
+                    clusters[clusterCount - 1].count = t + 1 - clusters[clusterCount - 1].first;
+                }
+
+            // Area weighted mesh center
+            float center[3] = { 0.0f, 0.0f, 0.0f };
+            float area      = 0.0f;
+
+            for( uint32_t t = 0; t < triangleCount; ++t )
+                {
+                    const float * a     = vertices[indices[3 * t]].position;
+                    const float * b     = vertices[indices[3 * t + 1]].position;
+                    const float * c     = vertices[indices[3 * t + 2]].position;
+                    const float   e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+                    const float   e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+                    const float   n[3]  = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2],
+                                            e0[0] * e1[1] - e0[1] * e1[0] };
+                    const float   w     = sqrtf( n[0] * n[0] + n[1] * n[1] + n[2] * n[2] );
+
+                    for( int k = 0; k < 3; ++k ) center[k] += w * ( a[k] + b[k] + c[k] ) / 3.0f;
+                    area += w;
+                }
+
+            for( int k = 0; k < 3; ++k ) center[k] = ( 0.0f < area ) ? center[k] / area : 0.0f;
+
+            for( uint32_t i = 0; i < clusterCount; ++i )
+                {
+                    Cluster * cluster     = &clusters[i];
+                    float     centroid[3] = { 0.0f, 0.0f, 0.0f };
+                    float     normal[3]   = { 0.0f, 0.0f, 0.0f };
+                    float     weight      = 0.0f;
+
+                    for( uint32_t t = cluster->first; t < cluster->first + cluster->count; ++t )
+                        {
+                            const float * a     = vertices[indices[3 * t]].position;
+                            const float * b     = vertices[indices[3 * t + 1]].position;
+                            const float * c     = vertices[indices[3 * t + 2]].position;
+                            const float   e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+                            const float   e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+                            const float   n[3]  = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2],
+                                                    e0[0] * e1[1] - e0[1] * e1[0] };
+                            const float   w     = sqrtf( n[0] * n[0] + n[1] * n[1] + n[2] * n[2] );
+
+                            for( int k = 0; k < 3; ++k )
+                                {
+                                    centroid[k] += w * ( a[k] + b[k] + c[k] ) / 3.0f;
+                                    normal[k] += n[k];
+                                }
+                            weight += w;
+                        }
+
+                    const float length = sqrtf( normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2] );
+                    cluster->sortKey   = 0.0f;
+                    if( 0.0f < weight && 0.0f < length )
+                        {
+                            for( int k = 0; k < 3; ++k )
+                                {
+                                    cluster->sortKey += ( centroid[k] / weight - center[k] ) * normal[k] / length;
+                                }
+                        }
+                }
+
+            qsort( clusters, clusterCount, sizeof( Cluster ), CompareClusters );
+
+            uint32_t written = 0;
+            for( uint32_t i = 0; i < clusterCount; ++i )
+                {
+                    const size_t count = 3 * (size_t)clusters[i].count;
+                    memcpy( output + written, indices + 3 * clusters[i].first, count * sizeof( uint32_t ) );
+                    written += (uint32_t)count;
+                }
+
+            memcpy( indices, output, indexCount * sizeof( uint32_t ) );
+        }
+
+    free( output );
+    free( clusters );
+    free( stamps );
+
+    return success;
+}
+
+// Outward facing clusters first, ties keep the cache order
+static int
+CompareClusters( const void * a, const void * b )
+{
+    const Cluster * ca = (const Cluster *)a;
+    const Cluster * cb = (const Cluster *)b;
+
+    if( ca->sortKey != cb->sortKey ) return ( ca->sortKey > cb->sortKey ) ? -1 : 1;
+    return ( ca->first < cb->first ) ? -1 : ( ca->first > cb->first );
+}
+
+// Renumber the vertices in order of first use so the vertex fetch walks memory forward, returns the vertices kept
+static uint32_t
+OptimizeVertexFetch( uint32_t * indices, uint32_t indexCount, CookVertex * vertices, uint32_t vertexCount )
+{
+    uint32_t *   remap   = (uint32_t *)malloc( ( vertexCount + 1 ) * sizeof( uint32_t ) );
+    CookVertex * reorder = (CookVertex *)malloc( ( vertexCount + 1 ) * sizeof( CookVertex ) );
+    uint32_t     used    = 0;
+
+    if( NULL == remap || NULL == reorder )
+        {
+            // Still a valid mesh, only in the original order
+            free( reorder );
+            free( remap );
+            return vertexCount;
+        }
+
+    memset( remap, 0xFF, vertexCount * sizeof( uint32_t ) );
+
+    for( uint32_t i = 0; i < indexCount; ++i )
+        {
+            const uint32_t v = indices[i];
+            if( UINT32_MAX == remap[v] )
+                {
+                    remap[v]        = used;
+                    reorder[used++] = vertices[v];
+                }
+
+            indices[i] = remap[v];
+        }
+
+    memcpy( vertices, reorder, used * sizeof( CookVertex ) );
+
+    free( reorder );
+    free( remap );
+
+    return used;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Definition: Textures
+//----------------------------------------------------------------------------------------------------------------------
+// Build the mip chain of an image, compress it and write it as KTX2, levels stored smallest first
+static bool
+CookTexture( const char * input, const char * output, TextureEncoding encoding )
+{
+    int             width = 0, height = 0, components = 0;
+    unsigned char * image = stbi_load( input, &width, &height, &components, 4 );
+
+    if( NULL == image )
+        {
+            fprintf( stderr, "vultra-cook: cannot decode %s (%s)\n", input, stbi_failure_reason() );
+            return false;
+        }
+
+    const uint32_t blockSize  = ( TEXTURE_RGBA8 == encoding ) ? 0 : 16;
+    uint32_t       levelCount = 0;
+    for( uint32_t size = (uint32_t)( ( width > height ) ? width : height ); 0 < size; size >>= 1 ) ++levelCount;
+
+    if( KTX2_MAX_LEVELS < levelCount )
+        {
+            fprintf( stderr, "vultra-cook: %s is too large (%dx%d)\n", input, width, height );
+            stbi_image_free( image );
+            return false;
+        }
+
+    // Encoded levels and their place in the file
+    unsigned char * levels[KTX2_MAX_LEVELS] = { 0 };
+    size_t          sizes[KTX2_MAX_LEVELS]  = { 0 };
+    size_t          offsets[KTX2_MAX_LEVELS];
+    unsigned char * mip      = image;
+    unsigned char * previous = NULL;
+    bool            success  = true;
+
+    for( uint32_t level = 0; level < levelCount && success; ++level )
+        {
+            const uint32_t w  = GetMipSize( (uint32_t)width, level );
+            const uint32_t h  = GetMipSize( (uint32_t)height, level );
+            const uint32_t bx = ( w + 3 ) / 4;
+            const uint32_t by = ( h + 3 ) / 4;
+
+            if( 0 < level )
+                {
+                    mip = (unsigned char *)malloc( (size_t)w * h * 4 );
+                    if( NULL == mip )
+                        {
+                            success = false;
+                            break;
+                        }
+
+                    const uint32_t pw = GetMipSize( (uint32_t)width, level - 1 );
+                    const uint32_t ph = GetMipSize( (uint32_t)height, level - 1 );
+                    BuildMip( previous, pw, ph, mip, w, h, TEXTURE_BC5 == encoding );
+                }
+
+            sizes[level]  = ( 0 < blockSize ) ? (size_t)bx * by * blockSize : (size_t)w * h * 4;
+            levels[level] = (unsigned char *)malloc( sizes[level] );
+            success       = ( NULL != levels[level] );
+
+            for( uint32_t y = 0; success && y < by && 0 < blockSize; ++y )
+                {
+                    for( uint32_t x = 0; x < bx; ++x )
+                        {
+                            // Blocks past the edge repeat the last row and column
+                            unsigned char pixels[16][4];
+                            unsigned char red[16], green[16];
+                            for( uint32_t i = 0; i < 16; ++i )
+                                {
+                                    const uint32_t px = ( 4 * x + i % 4 < w ) ? 4 * x + i % 4 : w - 1;
+                                    const uint32_t py = ( 4 * y + i / 4 < h ) ? 4 * y + i / 4 : h - 1;
+                                    memcpy( pixels[i], mip + ( (size_t)py * w + px ) * 4, 4 );
+                                    red[i]   = pixels[i][0];
+                                    green[i] = pixels[i][1];
+                                }
+
+                            unsigned char * block = levels[level] + ( (size_t)y * bx + x ) * blockSize;
+                            if( TEXTURE_BC5 == encoding )
+                                {
+                                    EncodeBc4( red, block );
+                                    EncodeBc4( green, block + 8 );
+                                }
+                            else EncodeBc7( (const unsigned char( * )[4])pixels, block );
+                        }
+                }
+
+            if( success && 0 == blockSize ) memcpy( levels[level], mip, sizes[level] );
+
+            if( previous != image ) free( previous );
+            previous = mip;
+        }
+
+    if( previous != image ) free( previous );
+    stbi_image_free( image );
+
+    // Data Format Descriptor, basic block with one sample per plane
+    const uint32_t format      = ( TEXTURE_BC7 == encoding )   ? KTX2_FORMAT_BC7_UNORM
+                                 : ( TEXTURE_BC5 == encoding ) ? KTX2_FORMAT_BC5_UNORM
+                                                               : KTX2_FORMAT_RGBA8_UNORM;
+    const uint32_t sampleCount = ( TEXTURE_BC7 == encoding ) ? 1 : ( TEXTURE_BC5 == encoding ) ? 2 : 4;
+    const uint32_t dfdSize     = 4 + 24 + 16 * sampleCount;
+    const size_t   dfdOffset   = KTX2_HEADER_SIZE + (size_t)levelCount * KTX2_LEVEL_SIZE;
+    size_t         fileSize    = dfdOffset + dfdSize;
+
+    for( uint32_t level = levelCount; success && 0 < level--; )
+        {
+            fileSize        = ( fileSize + 15 ) & ~(size_t)15;
+            offsets[level]  = fileSize;
+            fileSize       += sizes[level];
+        }
+
+    unsigned char * file = success ? (unsigned char *)calloc( 1, fileSize ) : NULL;
+    if( NULL != file )
+        {
+            static const unsigned char identifier[12]
+                = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+            memcpy( file, identifier, sizeof( identifier ) );
+            PutU32( file + 12, format );
+            PutU32( file + 16, 1 ); // typeSize
+            PutU32( file + 20, (uint32_t)width );
+            PutU32( file + 24, (uint32_t)height );
+            PutU32( file + 36, 1 ); // faceCount
+            PutU32( file + 40, levelCount );
+            PutU32( file + 48, (uint32_t)dfdOffset );
+            PutU32( file + 52, dfdSize );
+
+            for( uint32_t level = 0; level < levelCount; ++level )
+                {
+                    unsigned char * entry = file + KTX2_HEADER_SIZE + (size_t)level * KTX2_LEVEL_SIZE;
+                    PutU64( entry, offsets[level] );
+                    PutU64( entry + 8, sizes[level] );
+                    PutU64( entry + 16, sizes[level] );
+                    memcpy( file + offsets[level], levels[level], sizes[level] );
+                }
+
+            // colorModel RGBSDA (1), BC5 (132) or BC7 (134), BT.709 primaries, linear transfer
+            unsigned char * dfd        = file + dfdOffset;
+            const uint32_t  colorModel = ( TEXTURE_BC7 == encoding ) ? 134 : ( TEXTURE_BC5 == encoding ) ? 132 : 1;
+            PutU32( dfd, dfdSize );
+            PutU32( dfd + 8, 2 | ( ( 24 + 16 * sampleCount ) << 16 ) );
+            PutU32( dfd + 12, colorModel | ( 1 << 8 ) | ( 1 << 16 ) );
+            PutU32( dfd + 16, ( 0 < blockSize ) ? 3 | ( 3 << 8 ) : 0 );
+            PutU32( dfd + 20, ( 0 < blockSize ) ? blockSize : 4 );
+
+            for( uint32_t s = 0; s < sampleCount; ++s )
+                {
+                    // BC7: the whole block, BC5: 64 bits per channel, RGBA8: 8 bits per channel (alpha is 15)
+                    unsigned char * sample  = dfd + 28 + 16 * s;
+                    const uint32_t  bits    = ( TEXTURE_BC7 == encoding ) ? 128 : ( TEXTURE_BC5 == encoding ) ? 64 : 8;
+                    const uint32_t  channel = ( 3 == s ) ? 15 : s;
+                    PutU32( sample, ( s * bits ) | ( ( bits - 1 ) << 16 ) | ( channel << 24 ) );
+                    PutU32( sample + 12, ( 0 < blockSize ) ? UINT32_MAX : 255 );
+                }
+
+            success = WriteWholeFile( output, file, fileSize );
+        }
+    else success = false;
+
+    if( success )
+        {
+            printf( "vultra-cook: %s: %dx%d, %u levels, %s\n", output, width, height, levelCount,
+                    ( TEXTURE_BC7 == encoding ) ? "BC7" : ( TEXTURE_BC5 == encoding ) ? "BC5" : "RGBA8" );
+        }
+    else fprintf( stderr, "vultra-cook: failed to cook %s\n", input );
+
+    free( file );
+    for( uint32_t level = 0; level < levelCount; ++level ) free( levels[level] );
+
+    return success;
+}
+
+// Box filter a mip from the previous one; normal map texels are averaged as vectors and renormalized
+static void
+BuildMip( const unsigned char * src, uint32_t srcWidth, uint32_t srcHeight, unsigned char * dst, uint32_t width,
+          uint32_t height, bool normalMap )
+{
+    for( uint32_t y = 0; y < height; ++y )
+        {
+            const uint32_t y0 = 2 * y;
+            const uint32_t y1 = ( y0 + 1 < srcHeight ) ? y0 + 1 : y0;
+
+            for( uint32_t x = 0; x < width; ++x )
+                {
+                    const uint32_t        x0   = 2 * x;
+                    const uint32_t        x1   = ( x0 + 1 < srcWidth ) ? x0 + 1 : x0;
+                    const unsigned char * s[4] = { src + ( y0 * srcWidth + x0 ) * 4, src + ( y0 * srcWidth + x1 ) * 4,
+                                                   src + ( y1 * srcWidth + x0 ) * 4, src + ( y1 * srcWidth + x1 ) * 4 };
+                    unsigned char *       d    = dst + ( (size_t)y * width + x ) * 4;
+                    float                 n[3] = { 0.0f, 0.0f, 0.0f };
+
+                    for( int c = 0; c < 4; ++c )
+                        {
+                            d[c] = (unsigned char)( ( s[0][c] + s[1][c] + s[2][c] + s[3][c] + 2 ) / 4 );
+                        }
+                    if( !normalMap ) continue;
+
+                    for( int k = 0; k < 4; ++k )
+                        {
+                            for( int c = 0; c < 3; ++c ) n[c] += s[k][c] / 127.5f - 1.0f;
+                        }
+
+                    const float length = sqrtf( n[0] * n[0] + n[1] * n[1] + n[2] * n[2] );
+                    if( 0.0f == length ) continue;
+
+                    for( int c = 0; c < 3; ++c ) d[c] = (unsigned char)( ( n[c] / length + 1.0f ) * 127.5f + 0.5f );
+                }
+        }
+}
+
+// Quantize the endpoints with the given p-bits and pick the indices, returns the squared error
+static uint32_t
+FitBc7( const unsigned char pixels[16][4], const float low[4], const float high[4], int p0, int p1,
+        unsigned char endpoints[2][4], unsigned char indices[16] )
+{
+    const float ends[2][4] = { { low[0], low[1], low[2], low[3] }, { high[0], high[1], high[2], high[3] } };
+    const int   pbits[2]   = { p0, p1 };
+    uint32_t    error      = 0;
+
+    for( int e = 0; e < 2; ++e )
+        {
+            for( int c = 0; c < 4; ++c )
+                {
+                    int q = (int)floorf( ( ends[e][c] - (float)pbits[e] ) * 0.5f + 0.5f );
+                    q     = ( 0 > q ) ? 0 : ( 127 < q ) ? 127 : q;
+
+                    endpoints[e][c] = (unsigned char)( ( q << 1 ) | pbits[e] );
+                }
+        }
+
+    for( int i = 0; i < 16; ++i )
+        {
+            uint32_t best = UINT32_MAX;
+            for( int w = 0; w < 16; ++w )
+                {
+                    uint32_t distance = 0;
+                    for( int c = 0; c < 4; ++c )
+                        {
+                            const int a     = ( 64 - bc7Weights[w] ) * endpoints[0][c];
+                            const int value = ( a + bc7Weights[w] * endpoints[1][c] + 32 ) >> 6;
+                            distance += (uint32_t)( ( value - pixels[i][c] ) * ( value - pixels[i][c] ) );
+                        }
+
+                    if( distance < best )
+                        {
+                            best       = distance;
+                            indices[i] = (unsigned char)w;
+                        }
+                }
+
+            error += best;
+        }
+
+    return error;
+}
+
+// Endpoints along the principal axis of the block colors, refined once by least squares on the chosen indices
+static void
+EncodeBc7( const unsigned char pixels[16][4], unsigned char * block )
+{
+    float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for( int i = 0; i < 16; ++i )
+        {
+            for( int c = 0; c < 4; ++c ) mean[c] += pixels[i][c] / 16.0f;
+        }
+
+    float covariance[4][4] = { { 0.0f } };
+    for( int i = 0; i < 16; ++i )
+        {
+            for( int a = 0; a < 4; ++a )
+                {
+                    for( int b = 0; b < 4; ++b )
+                        {
+                            covariance[a][b] += ( pixels[i][a] - mean[a] ) * ( pixels[i][b] - mean[b] );
+                        }
+                }
+        }
+
+    // Power iteration, from the row of the largest variance
+    float axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    int   row     = 0;
+    for( int c = 1; c < 4; ++c ) row = ( covariance[c][c] > covariance[row][row] ) ? c : row;
+    memcpy( axis, covariance[row], sizeof( axis ) );
+
+    for( int iteration = 0; iteration < 8; ++iteration )
+        {
+            float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            float scale   = 0.0f;
+            for( int a = 0; a < 4; ++a )
+                {
+                    for( int b = 0; b < 4; ++b ) next[a] += covariance[a][b] * axis[b];
+                    if( fabsf( next[a] ) > scale ) scale = fabsf( next[a] );
+                }
+
+            if( 0.0f == scale ) break;
+            for( int c = 0; c < 4; ++c ) axis[c] = next[c] / scale;
+        }
+
+    const float length = sqrtf( axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] + axis[3] * axis[3] );
+    float       low[4], high[4];
+    float       tmin = 0.0f, tmax = 0.0f;
+
+    for( int i = 0; i < 16 && 0.0f < length; ++i )
+        {
+            float t = 0.0f;
+            for( int c = 0; c < 4; ++c ) t += ( pixels[i][c] - mean[c] ) * axis[c] / length;
+            if( t < tmin ) tmin = t;
+            if( t > tmax ) tmax = t;
+        }
+
+    for( int c = 0; c < 4; ++c )
+        {
+            const float direction = ( 0.0f < length ) ? axis[c] / length : 0.0f;
+            low[c]                = mean[c] + tmin * direction;
+            high[c]               = mean[c] + tmax * direction;
+        }
+
+    unsigned char endpoints[2][4], indices[16];
+    unsigned char bestEndpoints[2][4], bestIndices[16];
+    uint32_t      bestError = UINT32_MAX;
+
+    for( int pass = 0; pass < 2; ++pass )
+        {
+            for( int p = 0; p < 4; ++p )
+                {
+                    const uint32_t error = FitBc7( pixels, low, high, p & 1, p >> 1, endpoints, indices );
+                    if( error < bestError )
+                        {
+                            bestError = error;
+                            memcpy( bestEndpoints, endpoints, sizeof( endpoints ) );
+                            memcpy( bestIndices, indices, sizeof( indices ) );
+                        }
+                }
+
+            // Least squares endpoints for the best indices, solved per channel
+            float a00 = 0.0f, a01 = 0.0f, a11 = 0.0f, b0[4] = { 0.0f }, b1[4] = { 0.0f };
+            for( int i = 0; i < 16; ++i )
+                {
+                    const float w = bc7Weights[bestIndices[i]] / 64.0f;
+                    a00 += ( 1.0f - w ) * ( 1.0f - w );
+                    a01 += ( 1.0f - w ) * w;
+                    a11 += w * w;
+                    for( int c = 0; c < 4; ++c )
+                        {
+                            b0[c] += ( 1.0f - w ) * pixels[i][c];
+                            b1[c] += w * pixels[i][c];
+                        }
+                }
+
+            const float determinant = a00 * a11 - a01 * a01;
+            if( 1e-6f > fabsf( determinant ) ) break;
+
+            for( int c = 0; c < 4; ++c )
+                {
+                    low[c]  = ( a11 * b0[c] - a01 * b1[c] ) / determinant;
+                    high[c] = ( a00 * b1[c] - a01 * b0[c] ) / determinant;
+                    low[c]  = ( 0.0f > low[c] ) ? 0.0f : ( 255.0f < low[c] ) ? 255.0f : low[c];
+                    high[c] = ( 0.0f > high[c] ) ? 0.0f : ( 255.0f < high[c] ) ? 255.0f : high[c];
+                }
+        }
+
+    // The first index has an implicit top bit of 0, swap the endpoints when it is set
+    if( 8 <= bestIndices[0] )
+        {
+            for( int c = 0; c < 4; ++c )
+                {
+                    const unsigned char swap = bestEndpoints[0][c];
+                    bestEndpoints[0][c]      = bestEndpoints[1][c];
+                    bestEndpoints[1][c]      = swap;
+                }
+
+            for( int i = 0; i < 16; ++i ) bestIndices[i] = (unsigned char)( 15 - bestIndices[i] );
+        }
+
+    // Mode bit, R0 R1 G0 G1 B0 B1 A0 A1 (7 bits), P0 P1, then the indices, least significant bit first
+    uint64_t bits[2] = { 0, 0 };
+    uint32_t offset  = 0;
+
+    PutBits( bits, &offset, 1 << 6, 7 );
+    for( int c = 0; c < 4; ++c )
+        {
+            for( int e = 0; e < 2; ++e ) PutBits( bits, &offset, bestEndpoints[e][c] >> 1, 7 );
+        }
+    for( int e = 0; e < 2; ++e ) PutBits( bits, &offset, bestEndpoints[e][0] & 1, 1 );
+    for( int i = 0; i < 16; ++i ) PutBits( bits, &offset, bestIndices[i], ( 0 == i ) ? 3 : 4 );
+
+    PutU64( block, bits[0] );
+    PutU64( block + 8, bits[1] );
+}
+
+// BC4: min and max endpoints with the six interpolated values, 3 bit indices
+static void
+EncodeBc4( const unsigned char values[16], unsigned char * block )
+{
+    unsigned char low = 255, high = 0;
+    for( int i = 0; i < 16; ++i )
+        {
+            if( values[i] < low ) low = values[i];
+            if( values[i] > high ) high = values[i];
+        }
+
+    int palette[8] = { high, low, 0, 0, 0, 0, 0, 0 };
+    for( int c = 2; c < 8; ++c ) palette[c] = ( ( 8 - c ) * high + ( c - 1 ) * low + 3 ) / 7;
+
+    // A flat block has high == low, index 0 then decodes exactly in either mode
+    uint64_t bits = 0;
+    for( int i = 0; i < 16 && high > low; ++i )
+        {
+            int best = 0;
+            for( int c = 1; c < 8; ++c )
+                {
+                    if( abs( palette[c] - values[i] ) < abs( palette[best] - values[i] ) ) best = c;
+                }
+
+            bits |= (uint64_t)best << ( 3 * i );
+        }
+
+    block[0] = high;
+    block[1] = low;
+    for( int b = 0; b < 6; ++b ) block[2 + b] = (unsigned char)( bits >> ( 8 * b ) );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Module Internal Functions Definition: Utils
+//----------------------------------------------------------------------------------------------------------------------
+// Grow an array to hold count elements
+static bool
+Reserve( void ** data, uint32_t * capacity, uint32_t count, size_t size )
+{
+    if( count <= *capacity ) return true;
+
+    const uint32_t grown   = ( 2 * *capacity > count ) ? 2 * *capacity : count + 1024;
+    void *         resized = realloc( *data, grown * size );
+    if( NULL == resized ) return false;
+
+    *data     = resized;
+    *capacity = grown;
+
+    return true;
+}
+
+// Read a whole file, one more byte allocated for a terminator, NULL on failure
+static unsigned char *
+ReadWholeFile( const char * path, long * size )
+{
+    FILE *          file = fopen( path, "rb" );
+    unsigned char * data = NULL;
+
+    *size = 0;
+    if( NULL == file ) return NULL;
+
+    if( 0 == fseek( file, 0, SEEK_END ) && 0 <= ( *size = ftell( file ) ) && 0 == fseek( file, 0, SEEK_SET ) )
+        {
+            data = (unsigned char *)malloc( (size_t)*size + 1 );
+            if( NULL != data && (size_t)*size != fread( data, 1, (size_t)*size, file ) )
+                {
+                    free( data );
+                    data = NULL;
+                }
+        }
+
+    fclose( file );
+    return data;
+}
+
+// Write a whole file, removed when incomplete
+static bool
+WriteWholeFile( const char * path, const void * data, size_t size )
+{
+    FILE * file = fopen( path, "wb" );
+    if( NULL == file )
+        {
+            fprintf( stderr, "vultra-cook: cannot write %s\n", path );
+            return false;
+        }
+
+    const bool written = ( size == fwrite( data, 1, size, file ) );
+    const bool closed  = ( 0 == fclose( file ) );
+
+    if( !written || !closed )
+        {
+            fprintf( stderr, "vultra-cook: cannot write %s\n", path );
+            remove( path );
+            return false;
+        }
+
+    return true;
+}
+
+// Append a field to a 128 bit block, least significant bit first
+static void
+PutBits( uint64_t bits[2], uint32_t * offset, uint32_t value, uint32_t width )
+{
+    for( uint32_t b = 0; b < width; ++b, ++*offset )
+        {
+            if( value & ( 1U << b ) ) bits[*offset >> 6] |= (uint64_t)1 << ( *offset & 63 );
+        }
+}
+
+// Little endian writes
+static void
+PutU32( unsigned char * data, uint32_t value )
+{
+    for( int b = 0; b < 4; ++b ) data[b] = (unsigned char)( value >> ( 8 * b ) );
+}
+
+static void
+PutU64( unsigned char * data, uint64_t value )
+{
+    PutU32( data, (uint32_t)value );
+    PutU32( data + 4, (uint32_t)( value >> 32 ) );
+}
+
+// Case insensitive extension check
+static bool
+HasExtension( const char * path, const char * extension )
+{
+    const size_t length = strlen( path );
+    const size_t suffix = strlen( extension );
+
+    if( length < suffix ) return false;
+
+    for( size_t i = 0; i < suffix; ++i )
+        {
+            char c = path[length - suffix + i];
+            if( 'A' <= c && 'Z' >= c ) c = (char)( c - 'A' + 'a' );
+            if( c != extension[i] ) return false;
+        }
+
+    return true;
+}
+
+// Size of a mip along one axis
+static uint32_t
+GetMipSize( uint32_t size, uint32_t mip )
+{
+    return ( 1 < ( size >> mip ) ) ? ( size >> mip ) : 1;
+}
@@ -0,0 +1,134 @@
+/*******************************************************************************************
+*
+*   Vultra Tool - Asset Packer
+*
+*   Initially created with Vultra v25.0.0
+*
+*   Builds an asset pack (see vultra/vpack.h) out of loose files, read at runtime through
+*   OpenAssetPack(). Entries are named after the input paths, with '\' turned into '/'.
+*
+*       vultra-pack [-z] [-l list.txt] output.vpak [files...]
+*
+*       -z          Compress the entries, chunks that do not shrink are stored as is
+*       -l list     Read more input paths from a text file, one per line
+*
+*   Licensed under the zlib/libpng license.
+*   Copyright (c) 2025 SOHNE, Leandro Peres (@zschzen)
+*
+********************************************************************************************/
+
+#include "vultra/vpack.h"
+#include "vultra/vultra.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PATH_LENGTH 1024
+
+// Read a whole file, NULL on failure
+static unsigned char *
+ReadWholeFile( const char * path, long * size )
+{
+    FILE *          file = fopen( path, "rb" );
+    unsigned char * data = NULL;
+
+    *size = 0;
+    if( NULL == file ) return NULL;
+
+    if( 0 == fseek( file, 0, SEEK_END ) && 0 <= ( *size = ftell( file ) ) && 0 == fseek( file, 0, SEEK_SET ) )
+        {
+            data = (unsigned char *)malloc( (size_t)*size + 1 ); // Never malloc( 0 )
+            if( NULL != data && (size_t)*size != fread( data, 1, (size_t)*size, file ) )
+                {
+                    free( data );
+                    data = NULL;
+                }
+        }
+
+    fclose( file );
+    return data;
+}
+
+// Add a file to the pack, named after its path
+static bool
+PackFile( AssetPackWriter * writer, const char * path, bool compress )
+{
+    char name[PATH_LENGTH];
+    long size = 0;
+
+    if( strlen( path ) >= sizeof( name ) ) return false;
+
+    strcpy( name, path );
+    for( char * c = name; '\0' != *c; ++c )
+        {
+            if( '\\' == *c ) *c = '/';
+        }
+
+    unsigned char * data = ReadWholeFile( path, &size );
+    if( NULL == data )
+        {
+            fprintf( stderr, "vultra-pack: cannot read %s\n", path );
+            return false;
+        }
+
+    const bool added = AddPackEntry( writer, name, data, (uint64_t)size, compress );
+    free( data );
+
+    return added;
+}
+
+int
+main( int argc, char ** argv )
+{
+    const char * output   = NULL;
+    const char * list     = NULL;
+    bool         compress = false;
+    int          first    = argc;
+
+    for( int i = 1; i < argc; ++i )
+        {
+            if( 0 == strcmp( argv[i], "-z" ) ) compress = true;
+            else if( 0 == strcmp( argv[i], "-l" ) && i + 1 < argc ) list = argv[++i];
+            else
+                {
+                    output = argv[i];
+                    first  = i + 1;
+                    break;
+                }
+        }
+
+    if( NULL == output || ( first == argc && NULL == list ) )
+        {
+            fprintf( stderr, "usage: vultra-pack [-z] [-l list.txt] output.vpak [files...]\n" );
+            return EXIT_FAILURE;
+        }
+
+    AssetPackWriter * writer = BeginAssetPack( output );
+    if( NULL == writer ) return EXIT_FAILURE;
+
+    bool success = true;
+    for( int i = first; i < argc && success; ++i ) success = PackFile( writer, argv[i], compress );
+
+    if( NULL != list && success )
+        {
+            FILE * file = fopen( list, "r" );
+            char   line[PATH_LENGTH];
+
+            success = ( NULL != file );
+            while( success && NULL != fgets( line, sizeof( line ), file ) )
+                {
+                    line[strcspn( line, "\r\n" )] = '\0';
+                    if( '\0' != line[0] ) success = PackFile( writer, line, compress );
+                }
+
+            if( NULL != file ) fclose( file );
+            else fprintf( stderr, "vultra-pack: cannot read %s\n", list );
+        }
+
+    // A pack missing some of its inputs is not kept
+    success = EndAssetPack( writer ) && success;
+    if( !success ) remove( output );
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}